@@ -242,6 +242,20 @@ xlc \
   ${ZSS}/c/unixFileService.c \
   ${ZSS}/c/datasetService.c \
   ${ZSS}/c/datasetjson.c \
+  ${ZSS}/c/datasetAllocCache.c \
+  ${ZSS}/c/datasetETagCache.c \
+  ${ZSS}/c/datasetDigest.c \
+  ${ZSS}/c/datasetBlockReader.c \
+  ${ZSS}/c/datasetRecordParser.c \
+  ${ZSS}/c/datasetRecordFormat.c \
+  ${ZSS}/c/datasetACBPool.c \
+  ${ZSS}/c/datasetDirectoryCache.c \
+  ${ZSS}/c/datasetVTOCCache.c \
+  ${ZSS}/c/datasetHLQCache.c \
+  ${ZSS}/c/datasetCSICache.c \
+  ${ZSS}/c/datasetCopyJobs.c \
+  ${ZSS}/c/datasetBlockCopy.c \
+  ${ZSS}/c/datasetCopy.c \
   ${ZSS}/c/envService.c \
   ${ZSS}/c/zosDiscovery.c \
   ${ZSS}/c/securityService.c \
@@ -0,0 +1,322 @@
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "zowetypes.h"
+#include "alloc.h"
+#include "logging.h"
+#include "scheduling.h"
+
+#include "datasetACBPool.h"
+
+/* ACBs are closed after the lock is released, at most this many at a time,
+   so that what is taken out fits on the stack however big the pool is */
+#define ACB_POOL_CLOSE_BATCH 8
+
+/* An ACB taken out of the pool, closed after the lock is released */
+typedef struct ClosingACB_tag {
+  StatefulACB state;
+  char ddName[ACB_POOL_DDNAME_LENGTH];
+} ClosingACB;
+
+ACBPool *makeACBPool(const ACBOpener *opener, int maxEntries, int idleSeconds) {
+  ACBPool *pool = (ACBPool *)safeMalloc(sizeof(ACBPool), "ACBPool");
+  memset(pool, 0, sizeof(ACBPool));
+  pool->opener = *opener;
+  pool->maxEntries = maxEntries > 0 ? maxEntries : 0;
+  pool->idleSeconds = idleSeconds > 0 ? idleSeconds : 0;
+  if (pool->maxEntries) {
+    int entriesSize = sizeof(PooledACB) * pool->maxEntries;
+    pool->entries = (PooledACB *)safeMalloc(entriesSize, "PooledACB entries");
+    memset(pool->entries, 0, entriesSize);
+    for (int i = 0; i < pool->maxEntries; i++) {
+      pthread_mutex_init(&pool->entries[i].useLock, NULL);
+    }
+  }
+  pthread_mutex_init(&pool->lock, NULL);
+  return pool;
+}
+
+static void closeACBs(ACBPool *pool, ClosingACB *closing, int count) {
+  for (int i = 0; i < count; i++) {
+    pool->opener.close(pool->opener.userData, &closing[i].state, closing[i].ddName);
+  }
+}
+
+/* The functions below must be called with the lock held */
+
+static void takeOut(ACBPool *pool, PooledACB *entry, ClosingACB *closing) {
+  closing->state = entry->state;
+  memcpy(closing->ddName, entry->ddName, ACB_POOL_DDNAME_LENGTH);
+  entry->valid = false;
+  pool->stats.closes++;
+}
+
+static int collectIdleEntries(ACBPool *pool, time_t now, ClosingACB *closing) {
+  int count = 0;
+  for (int i = 0; i < pool->maxEntries && count < ACB_POOL_CLOSE_BATCH; i++) {
+    PooledACB *entry = &pool->entries[i];
+    if (entry->valid && entry->refCount == 0 && now - entry->lastUsed >= pool->idleSeconds) {
+      takeOut(pool, entry, &closing[count++]);
+      pool->stats.idleCloses++;
+    }
+  }
+  return count;
+}
+
+static PooledACB *findEntry(ACBPool *pool, const char *userKey, const char *dsn) {
+  for (int i = 0; i < pool->maxEntries; i++) {
+    PooledACB *entry = &pool->entries[i];
+    if (entry->valid && !entry->stale &&
+        !strcmp(entry->user, userKey) &&
+        !memcmp(entry->dsn, dsn, ACB_POOL_DSN_LENGTH)) {
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+static void fillEntry(PooledACB *entry, const PooledACB *opened, time_t now) {
+  memcpy(entry->user, opened->user, sizeof(entry->user));
+  memcpy(entry->dsn, opened->dsn, sizeof(entry->dsn));
+  entry->attributes = opened->attributes;
+  entry->state = opened->state;
+  memcpy(entry->ddName, opened->ddName, sizeof(entry->ddName));
+  entry->refCount = 1;
+  entry->lastUsed = now;
+  entry->valid = true;
+  entry->stale = false;
+}
+
+static void setUserKey(char *key, const char *user) {
+  memset(key, 0, ACB_POOL_USER_LENGTH + 1);
+  if (user) {
+    strncpy(key, user, ACB_POOL_USER_LENGTH);
+  }
+}
+
+PooledACB *acquirePooledACB(ACBPool *pool, const char *user, const char *dsn, int *rc) {
+  char userKey[ACB_POOL_USER_LENGTH + 1];
+  setUserKey(userKey, user);
+  /* one extra for the entry that may be evicted to make room; idle entries
+     beyond a batch are left to the sweeper */
+  ClosingACB closing[ACB_POOL_CLOSE_BATCH + 1];
+  int closingCount = 0;
+  PooledACB *entry = NULL;
+  time_t now = time(NULL);
+
+  *rc = 0;
+  pthread_mutex_lock(&pool->lock);
+  {
+    closingCount = collectIdleEntries(pool, now, closing);
+    entry = findEntry(pool, userKey, dsn);
+    if (entry) {
+      entry->refCount++;
+      entry->lastUsed = now;
+      pool->stats.opensAvoided++;
+    }
+  }
+  pthread_mutex_unlock(&pool->lock);
+  closeACBs(pool, closing, closingCount);
+  if (entry) {
+    pthread_mutex_lock(&entry->useLock);
+    return entry;
+  }
+
+  /* the catalog search and the open are done without holding the lock */
+  PooledACB opened;
+  memset(&opened, 0, sizeof(PooledACB));
+  memcpy(opened.user, userKey, sizeof(opened.user));
+  memcpy(opened.dsn, dsn, ACB_POOL_DSN_LENGTH);
+  *rc = pool->opener.lookup(pool->opener.userData, dsn, &opened.attributes);
+  if (*rc == 0) {
+    *rc = pool->opener.open(pool->opener.userData, &opened);
+  }
+
+  closingCount = 0;
+  pthread_mutex_lock(&pool->lock);
+  {
+    if (*rc) {
+      pool->stats.openFailures++;
+    } else {
+      pool->stats.opens++;
+      /* a request that opened the same dataset meanwhile keeps the pooled one */
+      if (findEntry(pool, userKey, dsn) == NULL) {
+        PooledACB *leastRecent = NULL;
+        for (int i = 0; i < pool->maxEntries; i++) {
+          PooledACB *candidate = &pool->entries[i];
+          if (!candidate->valid) {
+            entry = candidate;
+            break;
+          }
+          if (candidate->refCount == 0 &&
+              (leastRecent == NULL || candidate->lastUsed < leastRecent->lastUsed)) {
+            leastRecent = candidate;
+          }
+        }
+        if (entry == NULL && leastRecent != NULL) {
+          takeOut(pool, leastRecent, &closing[closingCount++]);
+          pool->stats.evictions++;
+          entry = leastRecent;
+        }
+      }
+      if (entry) {
+        fillEntry(entry, &opened, now);
+        entry->cached = true;
+        pthread_mutex_lock(&entry->useLock);
+      }
+    }
+  }
+  pthread_mutex_unlock(&pool->lock);
+  closeACBs(pool, closing, closingCount);
+  if (*rc) {
+    return NULL;
+  }
+
+  if (entry == NULL) {
+    entry = (PooledACB *)safeMalloc(sizeof(PooledACB), "uncached PooledACB");
+    memset(entry, 0, sizeof(PooledACB));
+    pthread_mutex_init(&entry->useLock, NULL);
+    fillEntry(entry, &opened, now);
+    entry->cached = false;
+    pthread_mutex_lock(&entry->useLock);
+  }
+  return entry;
+}
+
+void releasePooledACB(ACBPool *pool, PooledACB *entry, bool close) {
+  ClosingACB closing;
+  bool closeNow = false;
+  bool cached = entry->cached;
+
+  pthread_mutex_unlock(&entry->useLock);
+  pthread_mutex_lock(&pool->lock);
+  {
+    entry->refCount--;
+    entry->lastUsed = time(NULL);
+    if (close) {
+      entry->stale = true;
+    }
+    if (entry->refCount == 0 && (entry->stale || !cached)) {
+      takeOut(pool, entry, &closing);
+      closeNow = true;
+    }
+  }
+  pthread_mutex_unlock(&pool->lock);
+
+  if (closeNow) {
+    closeACBs(pool, &closing, 1);
+  }
+  if (!cached) {
+    pthread_mutex_destroy(&entry->useLock);
+    safeFree((char *)entry, sizeof(PooledACB));
+  }
+}
+
+void invalidateACBPool(ACBPool *pool, const char *dsn) {
+  ClosingACB closing[ACB_POOL_CLOSE_BATCH];
+  int closingCount = 0;
+
+  do {
+    closingCount = 0;
+    pthread_mutex_lock(&pool->lock);
+    {
+      for (int i = 0; i < pool->maxEntries; i++) {
+        PooledACB *entry = &pool->entries[i];
+        if (!entry->valid || memcmp(entry->dsn, dsn, ACB_POOL_DSN_LENGTH)) {
+          continue;
+        }
+        if (!entry->stale) {
+          entry->stale = true;
+          pool->stats.invalidations++;
+        }
+        if (entry->refCount == 0 && closingCount < ACB_POOL_CLOSE_BATCH) {
+          takeOut(pool, entry, &closing[closingCount++]);
+        }
+      }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    closeACBs(pool, closing, closingCount);
+  } while (closingCount == ACB_POOL_CLOSE_BATCH);
+}
+
+void sweepACBPool(ACBPool *pool) {
+  ClosingACB closing[ACB_POOL_CLOSE_BATCH];
+  int closingCount = 0;
+
+  do {
+    pthread_mutex_lock(&pool->lock);
+    {
+      closingCount = collectIdleEntries(pool, time(NULL), closing);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    closeACBs(pool, closing, closingCount);
+  } while (closingCount == ACB_POOL_CLOSE_BATCH);
+}
+
+static int acbPoolSweeperMain(RLETask *task) {
+  ACBPool *pool = (ACBPool *)task->userPointer;
+  int interval = pool->idleSeconds > 0 ? pool->idleSeconds : 1;
+  while (true) {
+    sleep(interval);
+    sweepACBPool(pool);
+  }
+  return 0;
+}
+
+bool startACBPoolSweeper(ACBPool *pool, RLEAnchor *anchor) {
+  if (pool->maxEntries == 0) {
+    return false;
+  }
+  RLETask *task = makeRLETask(anchor, RLE_TASK_TCB_CAPABLE | RLE_TASK_DISPOSABLE, acbPoolSweeperMain);
+  if (!task) {
+    zowelog(NULL, LOG_COMP_DATASERVICE, ZOWE_LOG_WARNING, "failed to create ACB pool sweep task\n");
+    return false;
+  }
+  task->userPointer = pool;
+  startRLETask(task, NULL);
+  return true;
+}
+
+void getACBPoolStats(ACBPool *pool, ACBPoolStats *stats) {
+  pthread_mutex_lock(&pool->lock);
+  {
+    *stats = pool->stats;
+    stats->entries = 0;
+    stats->inUse = 0;
+    for (int i = 0; i < pool->maxEntries; i++) {
+      if (pool->entries[i].valid) {
+        stats->entries++;
+        if (pool->entries[i].refCount > 0) {
+          stats->inUse++;
+        }
+      }
+    }
+  }
+  pthread_mutex_unlock(&pool->lock);
+}
+
+
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
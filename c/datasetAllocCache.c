@@ -0,0 +1,329 @@
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "zowetypes.h"
+#include "alloc.h"
+#include "utils.h"
+#include "logging.h"
+#include "scheduling.h"
+#ifdef __ZOWE_OS_ZOS
+#include "zos.h"
+#include "dynalloc.h"
+#endif
+
+#include "datasetAllocCache.h"
+
+DatasetAllocCache *makeDatasetAllocCache(const DatasetAllocator *allocator,
+                                         int maxEntries, int idleSeconds) {
+  DatasetAllocCache *cache = (DatasetAllocCache *)safeMalloc(sizeof(DatasetAllocCache), "DatasetAllocCache");
+  memset(cache, 0, sizeof(DatasetAllocCache));
+  cache->allocator = *allocator;
+  cache->maxEntries = maxEntries > 0 ? maxEntries : 0;
+  cache->idleSeconds = idleSeconds > 0 ? idleSeconds : 0;
+  if (cache->maxEntries) {
+    int entriesSize = sizeof(DatasetAllocation) * cache->maxEntries;
+    cache->entries = (DatasetAllocation *)safeMalloc(entriesSize, "DatasetAllocation entries");
+    memset(cache->entries, 0, entriesSize);
+  }
+  pthread_mutex_init(&cache->lock, NULL);
+  return cache;
+}
+
+static void unallocateDDNames(DatasetAllocCache *cache, char (*ddNames)[ALLOC_CACHE_DDNAME_LENGTH], int count) {
+  for (int i = 0; i < count; i++) {
+    int sysRC = 0, sysRSN = 0;
+    int rc = cache->allocator.unallocate(cache->allocator.userData, ddNames[i], &sysRC, &sysRSN);
+    if (rc) {
+      zowelog(NULL, LOG_COMP_DATASERVICE, ZOWE_LOG_DEBUG,
+              "error: cached dd unalloc dd=\'%8.8s\', rc=%d sysRC=%d, sysRSN=0x%08X\n",
+              ddNames[i], rc, sysRC, sysRSN);
+    }
+  }
+}
+
+void freeDatasetAllocCache(DatasetAllocCache *cache) {
+  if (cache == NULL) {
+    return;
+  }
+  for (int i = 0; i < cache->maxEntries; i++) {
+    if (cache->entries[i].valid) {
+      unallocateDDNames(cache, &cache->entries[i].ddName, 1);
+    }
+  }
+  if (cache->entries) {
+    safeFree((char *)cache->entries, sizeof(DatasetAllocation) * cache->maxEntries);
+  }
+  pthread_mutex_destroy(&cache->lock);
+  safeFree((char *)cache, sizeof(DatasetAllocCache));
+}
+
+/* Must be called with the lock held; the DD names are unallocated by the caller after unlocking */
+static int collectIdleEntries(DatasetAllocCache *cache, time_t now,
+                              char (*ddNames)[ALLOC_CACHE_DDNAME_LENGTH]) {
+  int count = 0;
+  for (int i = 0; i < cache->maxEntries; i++) {
+    DatasetAllocation *entry = &cache->entries[i];
+    if (entry->valid && entry->refCount == 0 && now - entry->lastUsed >= cache->idleSeconds) {
+      memcpy(ddNames[count++], entry->ddName, ALLOC_CACHE_DDNAME_LENGTH);
+      entry->valid = false;
+      cache->stats.evictions++;
+    }
+  }
+  return count;
+}
+
+static void setUserKey(char *key, const char *user) {
+  memset(key, 0, ALLOC_CACHE_USER_LENGTH + 1);
+  if (user) {
+    strncpy(key, user, ALLOC_CACHE_USER_LENGTH);
+  }
+}
+
+static void fillAllocation(DatasetAllocation *allocation, const char *userKey,
+                           const char *dsn, const char *member, const char *ddName,
+                           time_t now) {
+  memset(allocation, 0, sizeof(DatasetAllocation));
+  memcpy(allocation->user, userKey, sizeof(allocation->user));
+  memcpy(allocation->dsn, dsn, ALLOC_CACHE_DSN_LENGTH);
+  memcpy(allocation->member, member, ALLOC_CACHE_MEMBER_LENGTH);
+  memcpy(allocation->ddName, ddName, ALLOC_CACHE_DDNAME_LENGTH);
+  allocation->valid = true;
+  allocation->refCount = 1;
+  allocation->lastUsed = now;
+}
+
+DatasetAllocation *acquireDatasetAllocation(DatasetAllocCache *cache, const char *user,
+                                            const char *dsn, const char *member,
+                                            int *rc, int *sysRC, int *sysRSN) {
+  char userKey[ALLOC_CACHE_USER_LENGTH + 1];
+  setUserKey(userKey, user);
+  /* one extra for the entry that may be evicted to make room */
+  char releasedDDNames[cache->maxEntries + 1][ALLOC_CACHE_DDNAME_LENGTH];
+  int releasedCount = 0;
+  DatasetAllocation *allocation = NULL;
+  time_t now = time(NULL);
+
+  *rc = 0;
+  pthread_mutex_lock(&cache->lock);
+  {
+    releasedCount = collectIdleEntries(cache, now, releasedDDNames);
+    for (int i = 0; i < cache->maxEntries; i++) {
+      DatasetAllocation *entry = &cache->entries[i];
+      if (entry->valid && !entry->stale &&
+          !strcmp(entry->user, userKey) &&
+          !memcmp(entry->dsn, dsn, ALLOC_CACHE_DSN_LENGTH) &&
+          !memcmp(entry->member, member, ALLOC_CACHE_MEMBER_LENGTH)) {
+        entry->refCount++;
+        entry->lastUsed = now;
+        cache->stats.hits++;
+        allocation = entry;
+        break;
+      }
+    }
+    if (allocation == NULL) {
+      cache->stats.misses++;
+    }
+  }
+  pthread_mutex_unlock(&cache->lock);
+  unallocateDDNames(cache, releasedDDNames, releasedCount);
+  if (allocation) {
+    return allocation;
+  }
+
+  /* the allocation itself is done without holding the lock */
+  char ddName[ALLOC_CACHE_DDNAME_LENGTH];
+  *rc = cache->allocator.allocate(cache->allocator.userData, dsn, member, ddName, sysRC, sysRSN);
+  if (*rc) {
+    return NULL;
+  }
+
+  releasedCount = 0;
+  pthread_mutex_lock(&cache->lock);
+  {
+    DatasetAllocation *leastRecent = NULL;
+    for (int i = 0; i < cache->maxEntries; i++) {
+      DatasetAllocation *entry = &cache->entries[i];
+      if (!entry->valid) {
+        allocation = entry;
+        break;
+      }
+      if (entry->refCount == 0 && (leastRecent == NULL || entry->lastUsed < leastRecent->lastUsed)) {
+        leastRecent = entry;
+      }
+    }
+    if (allocation == NULL && leastRecent != NULL) {
+      memcpy(releasedDDNames[releasedCount++], leastRecent->ddName, ALLOC_CACHE_DDNAME_LENGTH);
+      cache->stats.evictions++;
+      allocation = leastRecent;
+    }
+    if (allocation) {
+      fillAllocation(allocation, userKey, dsn, member, ddName, now);
+      allocation->cached = true;
+    }
+  }
+  pthread_mutex_unlock(&cache->lock);
+  unallocateDDNames(cache, releasedDDNames, releasedCount);
+
+  if (allocation == NULL) {
+    /* every entry is in use, this one is unallocated again on release */
+    allocation = (DatasetAllocation *)safeMalloc(sizeof(DatasetAllocation), "uncached DatasetAllocation");
+    fillAllocation(allocation, userKey, dsn, member, ddName, now);
+  }
+  return allocation;
+}
+
+void releaseDatasetAllocation(DatasetAllocCache *cache, DatasetAllocation *allocation) {
+  char ddName[ALLOC_CACHE_DDNAME_LENGTH];
+  bool unallocate = false;
+  bool cached = allocation->cached;
+
+  pthread_mutex_lock(&cache->lock);
+  {
+    allocation->refCount--;
+    allocation->lastUsed = time(NULL);
+    if (allocation->refCount == 0 && (allocation->stale || !cached)) {
+      memcpy(ddName, allocation->ddName, ALLOC_CACHE_DDNAME_LENGTH);
+      allocation->valid = false;
+      unallocate = true;
+    }
+  }
+  pthread_mutex_unlock(&cache->lock);
+
+  if (unallocate) {
+    unallocateDDNames(cache, &ddName, 1);
+  }
+  if (!cached) {
+    safeFree((char *)allocation, sizeof(DatasetAllocation));
+  }
+}
+
+void invalidateDatasetAllocations(DatasetAllocCache *cache, const char *dsn) {
+  char releasedDDNames[cache->maxEntries + 1][ALLOC_CACHE_DDNAME_LENGTH];
+  int releasedCount = 0;
+
+  pthread_mutex_lock(&cache->lock);
+  {
+    for (int i = 0; i < cache->maxEntries; i++) {
+      DatasetAllocation *entry = &cache->entries[i];
+      if (!entry->valid || memcmp(entry->dsn, dsn, ALLOC_CACHE_DSN_LENGTH)) {
+        continue;
+      }
+      cache->stats.invalidations++;
+      if (entry->refCount == 0) {
+        memcpy(releasedDDNames[releasedCount++], entry->ddName, ALLOC_CACHE_DDNAME_LENGTH);
+        entry->valid = false;
+      } else {
+        entry->stale = true;
+      }
+    }
+  }
+  pthread_mutex_unlock(&cache->lock);
+  unallocateDDNames(cache, releasedDDNames, releasedCount);
+}
+
+void sweepDatasetAllocCache(DatasetAllocCache *cache) {
+  char releasedDDNames[cache->maxEntries + 1][ALLOC_CACHE_DDNAME_LENGTH];
+  int releasedCount = 0;
+
+  pthread_mutex_lock(&cache->lock);
+  {
+    releasedCount = collectIdleEntries(cache, time(NULL), releasedDDNames);
+  }
+  pthread_mutex_unlock(&cache->lock);
+  unallocateDDNames(cache, releasedDDNames, releasedCount);
+}
+
+static int allocCacheSweeperMain(RLETask *task) {
+  DatasetAllocCache *cache = (DatasetAllocCache *)task->userPointer;
+  int interval = cache->idleSeconds > 0 ? cache->idleSeconds : 1;
+  while (true) {
+    sleep(interval);
+    sweepDatasetAllocCache(cache);
+  }
+  return 0;
+}
+
+bool startDatasetAllocCacheSweeper(DatasetAllocCache *cache, RLEAnchor *anchor) {
+  RLETask *task = makeRLETask(anchor, RLE_TASK_TCB_CAPABLE | RLE_TASK_DISPOSABLE, allocCacheSweeperMain);
+  if (!task) {
+    zowelog(NULL, LOG_COMP_DATASERVICE, ZOWE_LOG_WARNING, "failed to create allocation cache sweep task\n");
+    return false;
+  }
+  task->userPointer = cache;
+  startRLETask(task, NULL);
+  return true;
+}
+
+void getDatasetAllocCacheStats(DatasetAllocCache *cache, DatasetAllocCacheStats *stats) {
+  pthread_mutex_lock(&cache->lock);
+  {
+    *stats = cache->stats;
+    stats->entries = 0;
+    for (int i = 0; i < cache->maxEntries; i++) {
+      if (cache->entries[i].valid) {
+        stats->entries++;
+      }
+    }
+  }
+  pthread_mutex_unlock(&cache->lock);
+}
+
+#ifdef __ZOWE_OS_ZOS
+
+static int dynallocAllocateShared(void *userData, const char *dsn, const char *member, char *ddName,
+                                  int *sysRC, int *sysRSN) {
+  DynallocDatasetName daDsn;
+  DynallocMemberName daMember;
+  DynallocDDName daDDName = {.name = "????????"};
+  memcpy(daDsn.name, dsn, sizeof(daDsn.name));
+  memcpy(daMember.name, member, sizeof(daMember.name));
+  bool hasMember = memcmp(daMember.name, "        ", sizeof(daMember.name)) != 0;
+
+  int rc = dynallocAllocDataset(&daDsn, hasMember ? &daMember : NULL, &daDDName,
+                                DYNALLOC_DISP_SHR,
+                                DYNALLOC_ALLOC_FLAG_NO_CONVERSION | DYNALLOC_ALLOC_FLAG_NO_MOUNT,
+                                sysRC, sysRSN);
+  memcpy(ddName, daDDName.name, sizeof(daDDName.name));
+  return rc == RC_DYNALLOC_OK ? 0 : rc;
+}
+
+static int dynallocUnallocate(void *userData, const char *ddName, int *sysRC, int *sysRSN) {
+  DynallocDDName daDDName;
+  memcpy(daDDName.name, ddName, sizeof(daDDName.name));
+  int rc = dynallocUnallocDatasetByDDName(&daDDName, DYNALLOC_UNALLOC_FLAG_NONE, sysRC, sysRSN);
+  return rc == RC_DYNALLOC_OK ? 0 : rc;
+}
+
+const DatasetAllocator dynallocDatasetAllocator = {
+  .allocate = dynallocAllocateShared,
+  .unallocate = dynallocUnallocate,
+  .userData = NULL
+};
+
+#endif /* __ZOWE_OS_ZOS */
+
+
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
@@ -0,0 +1,316 @@
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "zowetypes.h"
+#include "alloc.h"
+#include "utils.h"
+#include "logging.h"
+
+#include "datasetBlockReader.h"
+#include "datasetRecordFormat.h"
+#include "datasetDigest.h"
+#include "datasetBlockCopy.h"
+
+#define BDW_LENGTH 4
+#define RDW_LENGTH 4
+
+static void writeHalfword(char *data, int value) {
+  unsigned char *bytes = (unsigned char *)data;
+  bytes[0] = (value >> 8) & 0xFF;
+  bytes[1] = value & 0xFF;
+  bytes[2] = 0;
+  bytes[3] = 0;
+}
+
+bool isBlockCopyFormat(const DatasetBlockFormat *source, const DatasetBlockFormat *target) {
+  if (!isBlockReadableFormat(source)) {
+    return false;
+  }
+  return source->recfm == target->recfm && source->lrecl == target->lrecl &&
+         !target->spanned;
+}
+
+static BlockSink *makeBlockSink(void *handle, const DatasetBlockFormat *format) {
+  BlockSink *sink = (BlockSink *)safeMalloc(sizeof(BlockSink), "BlockSink");
+  memset(sink, 0, sizeof(BlockSink));
+  sink->handle = handle;
+  sink->format = *format;
+  return sink;
+}
+
+#ifdef __ZOWE_OS_ZOS
+
+static int writeDatasetData(BlockSink *sink, const char *data, int length) {
+  FILE *out = (FILE *)sink->handle;
+  int bytesWritten = fwrite(data, 1, length, out);
+  /* an empty variable-length record is written but counted as 0 bytes */
+  if (ferror(out) || (bytesWritten != length && sink->format.recfm != 'V')) {
+    return BLOCK_COPY_RC_WRITE_ERROR;
+  }
+  return 0;
+}
+
+static int writeNoDatasetBlock(BlockSink *sink, const char *data, int length) {
+  return BLOCK_COPY_RC_WRITE_ERROR;
+}
+
+static int closeDatasetSink(BlockSink *sink) {
+  FILE *out = (FILE *)sink->handle;
+  return (out && fclose(out)) ? BLOCK_COPY_RC_WRITE_ERROR : 0;
+}
+
+/* Fixed-length targets are opened as a byte stream, so that a block of records
+   is written in one call and the runtime does the reblocking. The attributes
+   are checked against the opened dataset, as a stream that does not cut
+   records at format->lrecl would shift every record after the first. */
+BlockSink *openDatasetBlockSink(const char *filename, const DatasetBlockFormat *format) {
+  bool fixed = (format->recfm == 'F');
+  if (!fixed && format->recfm != 'V') {
+    return NULL;
+  }
+  FILE *out = fopen(filename, fixed ? "wb, recfm=*" : "wb, recfm=*, type=record");
+  if (out == NULL) {
+    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG,
+            "Block write open failed for %s, errno=%d\n", filename, errno);
+    return NULL;
+  }
+  fldata_t fileinfo = {0};
+  char filenameOutput[100];
+  if (fldata(out, filenameOutput, &fileinfo) ||
+      (fixed ? (!fileinfo.__recfmF || fileinfo.__maxreclen != format->lrecl) : !fileinfo.__recfmV)) {
+    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG,
+            "Block write not possible for %s, recfmF=%d maxreclen=%d\n",
+            filename, fileinfo.__recfmF, fileinfo.__maxreclen);
+    fclose(out);
+    return NULL;
+  }
+  BlockSink *sink = makeBlockSink(out, format);
+  sink->writeBlock = fixed ? writeDatasetData : writeNoDatasetBlock;
+  sink->writeRecord = writeDatasetData;
+  sink->close = closeDatasetSink;
+  return sink;
+}
+
+#endif /* __ZOWE_OS_ZOS */
+
+static int flushFileBlock(BlockSink *sink) {
+  if (sink->bufferLength == 0) {
+    return 0;
+  }
+  if (sink->format.recfm == 'V') {
+    writeHalfword(sink->buffer, sink->bufferLength);
+  }
+  FILE *out = (FILE *)sink->handle;
+  if ((int)fwrite(sink->buffer, 1, sink->bufferLength, out) != sink->bufferLength) {
+    return BLOCK_COPY_RC_WRITE_ERROR;
+  }
+  sink->bufferLength = 0;
+  return 0;
+}
+
+/* FB images are BLKSIZE blocks with a short last block, as the file source
+   reads them */
+static int writeFileFixed(BlockSink *sink, const char *data, int length) {
+  while (length > 0) {
+    int chunk = sink->bufferSize - sink->bufferLength;
+    if (chunk > length) {
+      chunk = length;
+    }
+    memcpy(sink->buffer + sink->bufferLength, data, chunk);
+    sink->bufferLength += chunk;
+    data += chunk;
+    length -= chunk;
+    if (sink->bufferLength == sink->bufferSize && flushFileBlock(sink)) {
+      return BLOCK_COPY_RC_WRITE_ERROR;
+    }
+  }
+  return 0;
+}
+
+static int writeFileVariable(BlockSink *sink, const char *record, int length) {
+  int needed = RDW_LENGTH + length;
+  if (BDW_LENGTH + needed > sink->bufferSize) {
+    return BLOCK_COPY_RC_WRITE_ERROR;
+  }
+  if (sink->bufferLength + needed > sink->bufferSize && flushFileBlock(sink)) {
+    return BLOCK_COPY_RC_WRITE_ERROR;
+  }
+  if (sink->bufferLength == 0) {
+    sink->bufferLength = BDW_LENGTH;
+  }
+  char *rdw = sink->buffer + sink->bufferLength;
+  writeHalfword(rdw, needed);
+  memcpy(rdw + RDW_LENGTH, record, length);
+  sink->bufferLength += needed;
+  if (!sink->format.blocked) {
+    return flushFileBlock(sink);
+  }
+  return 0;
+}
+
+static int writeNoFileBlock(BlockSink *sink, const char *data, int length) {
+  return BLOCK_COPY_RC_WRITE_ERROR;
+}
+
+static int closeFileSink(BlockSink *sink) {
+  FILE *out = (FILE *)sink->handle;
+  int rc = flushFileBlock(sink);
+  if (out && fclose(out)) {
+    rc = BLOCK_COPY_RC_WRITE_ERROR;
+  }
+  return rc;
+}
+
+BlockSink *openFileBlockSink(const char *path, const DatasetBlockFormat *format) {
+  if (!isBlockReadableFormat(format)) {
+    return NULL;
+  }
+  FILE *out = fopen(path, "wb");
+  if (out == NULL) {
+    return NULL;
+  }
+  bool fixed = (format->recfm == 'F');
+  BlockSink *sink = makeBlockSink(out, format);
+  sink->bufferSize = (fixed && !format->blocked) ? format->lrecl : format->blksize;
+  sink->buffer = safeMalloc(sink->bufferSize, "BlockSink buffer");
+  sink->writeBlock = fixed ? writeFileFixed : writeNoFileBlock;
+  sink->writeRecord = fixed ? writeFileFixed : writeFileVariable;
+  sink->close = closeFileSink;
+  return sink;
+}
+
+int closeBlockSink(BlockSink *sink) {
+  if (sink == NULL) {
+    return 0;
+  }
+  int rc = sink->close(sink);
+  if (sink->buffer) {
+    safeFree(sink->buffer, sink->bufferSize);
+  }
+  safeFree((char *)sink, sizeof(BlockSink));
+  return rc;
+}
+
+static void updateCopyDigest(DatasetDigest *digest, int *digestRC, const char *data, int length) {
+  if (digest && !*digestRC) {
+    *digestRC = datasetDigestUpdate(digest, data, length);
+  }
+}
+
+static int copyFixedBlocks(DatasetBlockReader *reader, BlockSink *sink,
+                           DatasetDigest *digest, int *digestRC,
+                           DatasetCopyProgressHandler *progress, void *progressData,
+                           DatasetCopyResult *result) {
+  int lrecl = sink->format.lrecl;
+  while (true) {
+    char *block = NULL;
+    int length = 0;
+    int readRC = blockReaderNextBlock(reader, &block, &length);
+    if (readRC == BLOCK_READER_RC_EOF) {
+      return BLOCK_COPY_RC_OK;
+    } else if (readRC != BLOCK_READER_RC_OK) {
+      result->readRC = readRC;
+      return BLOCK_COPY_RC_READ_ERROR;
+    }
+    if (sink->writeBlock(sink, block, length)) {
+      return BLOCK_COPY_RC_WRITE_ERROR;
+    }
+    updateCopyDigest(digest, digestRC, block, length);
+    result->records += length / lrecl;
+    result->bytes += length;
+    result->blocks = reader->blocksRead;
+    if (progress) {
+      progress(progressData, result);
+    }
+  }
+}
+
+static int copyRecords(DatasetBlockReader *reader, BlockSink *sink, bool reformat, char padByte,
+                       DatasetDigest *digest, int *digestRC,
+                       DatasetCopyProgressHandler *progress, void *progressData,
+                       DatasetCopyResult *result) {
+  bool fixed = (sink->format.recfm == 'F');
+  /* a variable LRECL counts the RDW */
+  int lrecl = fixed ? sink->format.lrecl : sink->format.lrecl - RDW_LENGTH;
+  char *buffer = (reformat && fixed) ? safeMalloc(lrecl, "copy record") : NULL;
+  int rc = BLOCK_COPY_RC_OK;
+  while (true) {
+    char *record = NULL;
+    int length = 0;
+    int readRC = blockReaderNextRecord(reader, &record, &length);
+    if (readRC == BLOCK_READER_RC_EOF) {
+      break;
+    } else if (readRC != BLOCK_READER_RC_OK) {
+      result->readRC = readRC;
+      rc = BLOCK_COPY_RC_READ_ERROR;
+      break;
+    }
+    if (progress && reader->blocksRead != result->blocks) {
+      /* reported before the first record of a block, so for whole blocks */
+      progress(progressData, result);
+      result->blocks = reader->blocksRead;
+    }
+    const char *data = record;
+    if (reformat) {
+      if (length > lrecl) {
+        rc = BLOCK_COPY_RC_TOO_LONG;
+        break;
+      }
+      data = formatDatasetRecord(record, length, lrecl, fixed, padByte, buffer, &length);
+    }
+    if (sink->writeRecord(sink, data, length)) {
+      rc = BLOCK_COPY_RC_WRITE_ERROR;
+      break;
+    }
+    updateCopyDigest(digest, digestRC, data, length);
+    result->records++;
+    result->bytes += length;
+  }
+  if (buffer) {
+    safeFree(buffer, lrecl);
+  }
+  return rc;
+}
+
+int copyDatasetBlocks(DatasetBlockReader *reader, BlockSink *sink, int flags, char padByte,
+                      DatasetDigest *digest, int *digestRC,
+                      DatasetCopyProgressHandler *progress, void *progressData,
+                      DatasetCopyResult *result) {
+  memset(result, 0, sizeof(DatasetCopyResult));
+  bool matching = !(flags & BLOCK_COPY_FLAG_RECORDS) &&
+                  isBlockCopyFormat(&reader->source->format, &sink->format);
+  result->blockMode = matching;
+  int rc = 0;
+  if (matching && sink->format.recfm == 'F') {
+    rc = copyFixedBlocks(reader, sink, digest, digestRC, progress, progressData, result);
+  } else {
+    rc = copyRecords(reader, sink, !matching, padByte, digest, digestRC, progress, progressData,
+                     result);
+  }
+  result->blocks = reader->blocksRead;
+  return rc;
+}
+
+
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
@@ -0,0 +1,318 @@
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "zowetypes.h"
+#include "alloc.h"
+#include "utils.h"
+#include "logging.h"
+
+#include "datasetBlockReader.h"
+
+#define BDW_LENGTH 4
+#define RDW_LENGTH 4
+
+static int readHalfword(const char *data) {
+  const unsigned char *bytes = (const unsigned char *)data;
+  return (bytes[0] << 8) | bytes[1];
+}
+
+bool isBlockReadableFormat(const DatasetBlockFormat *format) {
+  if (format->spanned) {
+    /* segments would have to be reassembled across blocks */
+    return false;
+  }
+  if (format->lrecl <= 0 || format->blksize <= 0 ||
+      format->blksize > BLOCK_READER_MAX_BLOCK_SIZE) {
+    return false;
+  }
+  if (format->recfm == 'F') {
+    return (format->blksize % format->lrecl) == 0;
+  }
+  if (format->recfm == 'V') {
+    return format->blksize >= BDW_LENGTH + RDW_LENGTH;
+  }
+  return false;
+}
+
+static int getBlockBufferSize(const DatasetBlockFormat *format) {
+  return format->blksize > 0 ? format->blksize : BLOCK_READER_MAX_BLOCK_SIZE;
+}
+
+static void closeFileBlockSource(BlockSource *source) {
+  FILE *file = (FILE *)source->handle;
+  if (file) {
+    fclose(file);
+  }
+  source->handle = NULL;
+}
+
+#ifdef __ZOWE_OS_ZOS
+
+/* With RECFM=U forced on the DCB every GET returns one physical block, BDW
+   included for variable-length datasets. */
+static int readDatasetBlock(BlockSource *source, char *buffer, int bufferSize) {
+  FILE *in = (FILE *)source->handle;
+  int bytesRead = fread(buffer, 1, bufferSize, in);
+  if (ferror(in)) {
+    return BLOCK_READER_RC_IO_ERROR;
+  }
+  return bytesRead;
+}
+
+BlockSource *openDatasetBlockSource(const char *filename, const DatasetBlockFormat *format) {
+  if (!isBlockReadableFormat(format)) {
+    return NULL;
+  }
+  FILE *in = fopen(filename, "rb, type=record, recfm=U");
+  if (in == NULL) {
+    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG,
+            "Block read open failed for %s, errno=%d\n", filename, errno);
+    return NULL;
+  }
+  fldata_t fileinfo = {0};
+  char filenameOutput[100];
+  if (fldata(in, filenameOutput, &fileinfo) || !fileinfo.__recfmU ||
+      fileinfo.__maxreclen < format->blksize) {
+    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG,
+            "Block read not possible for %s, recfmU=%d maxreclen=%d\n",
+            filename, fileinfo.__recfmU, fileinfo.__maxreclen);
+    fclose(in);
+    return NULL;
+  }
+  BlockSource *source = (BlockSource *)safeMalloc(sizeof(BlockSource), "BlockSource");
+  memset(source, 0, sizeof(BlockSource));
+  source->readBlock = readDatasetBlock;
+  source->close = closeFileBlockSource;
+  source->handle = in;
+  source->format = *format;
+  return source;
+}
+
+#endif /* __ZOWE_OS_ZOS */
+
+/* Dataset images: FB and FBS blocks are BLKSIZE bytes with a short last block,
+   VB blocks are self-describing through the BDW. */
+static int readFileBlock(BlockSource *source, char *buffer, int bufferSize) {
+  FILE *in = (FILE *)source->handle;
+  int bytesRead = 0;
+  if (source->format.recfm == 'V') {
+    bytesRead = fread(buffer, 1, BDW_LENGTH, in);
+    if (bytesRead == 0 && feof(in)) {
+      return 0;
+    }
+    if (bytesRead != BDW_LENGTH) {
+      return ferror(in) ? BLOCK_READER_RC_IO_ERROR : BLOCK_READER_RC_BAD_BLOCK;
+    }
+    int blockLength = readHalfword(buffer);
+    if (blockLength < BDW_LENGTH || blockLength > bufferSize) {
+      return BLOCK_READER_RC_BAD_BLOCK;
+    }
+    int remaining = blockLength - BDW_LENGTH;
+    if (remaining > 0 && (int)fread(buffer + BDW_LENGTH, 1, remaining, in) != remaining) {
+      return ferror(in) ? BLOCK_READER_RC_IO_ERROR : BLOCK_READER_RC_BAD_BLOCK;
+    }
+    return blockLength;
+  }
+  int blockSize = source->format.blksize < bufferSize ? source->format.blksize : bufferSize;
+  bytesRead = fread(buffer, 1, blockSize, in);
+  if (ferror(in)) {
+    return BLOCK_READER_RC_IO_ERROR;
+  }
+  return bytesRead;
+}
+
+BlockSource *openFileBlockSource(const char *path, const DatasetBlockFormat *format) {
+  if (!isBlockReadableFormat(format)) {
+    return NULL;
+  }
+  FILE *in = fopen(path, "rb");
+  if (in == NULL) {
+    return NULL;
+  }
+  BlockSource *source = (BlockSource *)safeMalloc(sizeof(BlockSource), "BlockSource");
+  memset(source, 0, sizeof(BlockSource));
+  source->readBlock = readFileBlock;
+  source->close = closeFileBlockSource;
+  source->handle = in;
+  source->format = *format;
+  return source;
+}
+
+void closeBlockSource(BlockSource *source) {
+  if (source == NULL) {
+    return;
+  }
+  source->close(source);
+  safeFree((char *)source, sizeof(BlockSource));
+}
+
+DatasetBlockReader *makeDatasetBlockReader(BlockSource *source, char *arena, int arenaSize) {
+  int neededSize = getBlockBufferSize(&source->format);
+  if (arena != NULL && arenaSize < neededSize) {
+    return NULL;
+  }
+  DatasetBlockReader *reader = (DatasetBlockReader *)safeMalloc(sizeof(DatasetBlockReader), "DatasetBlockReader");
+  memset(reader, 0, sizeof(DatasetBlockReader));
+  reader->source = source;
+  if (arena) {
+    reader->arena = arena;
+    reader->arenaSize = arenaSize;
+  } else {
+    reader->arena = safeMalloc(neededSize, "block reader arena");
+    reader->arenaSize = neededSize;
+    reader->ownsArena = true;
+  }
+  return reader;
+}
+
+void freeDatasetBlockReader(DatasetBlockReader *reader) {
+  if (reader == NULL) {
+    return;
+  }
+  if (reader->ownsArena) {
+    safeFree(reader->arena, reader->arenaSize);
+  }
+  safeFree((char *)reader, sizeof(DatasetBlockReader));
+}
+
+static int fillBlock(DatasetBlockReader *reader) {
+  BlockSource *source = reader->source;
+  int blockLength = source->readBlock(source, reader->arena, reader->arenaSize);
+  if (blockLength < 0) {
+    return blockLength;
+  }
+  if (blockLength == 0) {
+    return BLOCK_READER_RC_EOF;
+  }
+  reader->blockLength = blockLength;
+  reader->offset = 0;
+  reader->blocksRead++;
+  if (source->format.recfm == 'V') {
+    int bdwLength = readHalfword(reader->arena);
+    if (bdwLength != blockLength) {
+      zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG,
+              "BDW length %d does not match block length %d (block %d)\n",
+              bdwLength, blockLength, reader->blocksRead);
+      return BLOCK_READER_RC_BAD_BLOCK;
+    }
+    reader->offset = BDW_LENGTH;
+  }
+  return BLOCK_READER_RC_OK;
+}
+
+int blockReaderNextRecord(DatasetBlockReader *reader, char **record, int *recordLength) {
+  const DatasetBlockFormat *format = &reader->source->format;
+  while (reader->offset >= reader->blockLength) {
+    int rc = fillBlock(reader);
+    if (rc != BLOCK_READER_RC_OK) {
+      return rc;
+    }
+  }
+  char *data = reader->arena + reader->offset;
+  int remaining = reader->blockLength - reader->offset;
+  if (format->recfm == 'F') {
+    if (remaining < format->lrecl) {
+      return BLOCK_READER_RC_BAD_BLOCK;
+    }
+    *record = data;
+    *recordLength = format->lrecl;
+    reader->offset += format->lrecl;
+  } else {
+    if (remaining < RDW_LENGTH) {
+      return BLOCK_READER_RC_BAD_BLOCK;
+    }
+    int rdwLength = readHalfword(data);
+    if (rdwLength < RDW_LENGTH || rdwLength > remaining || data[2] != 0) {
+      /* a non-zero segment descriptor means the dataset is really spanned */
+      return BLOCK_READER_RC_BAD_BLOCK;
+    }
+    *record = data + RDW_LENGTH;
+    *recordLength = rdwLength - RDW_LENGTH;
+    reader->offset += rdwLength;
+  }
+  reader->recordsRead++;
+  return BLOCK_READER_RC_OK;
+}
+
+int blockReaderSkipRecords(DatasetBlockReader *reader, int count, int *skipped) {
+  const DatasetBlockFormat *format = &reader->source->format;
+  int rc = BLOCK_READER_RC_OK;
+  *skipped = 0;
+  while (*skipped < count) {
+    if (reader->offset >= reader->blockLength) {
+      rc = fillBlock(reader);
+      if (rc != BLOCK_READER_RC_OK) {
+        break;
+      }
+    }
+    if (format->recfm == 'F') {
+      int available = (reader->blockLength - reader->offset) / format->lrecl;
+      int wanted = count - *skipped;
+      int skipHere = wanted < available ? wanted : available;
+      if (skipHere == 0) {
+        return BLOCK_READER_RC_BAD_BLOCK;
+      }
+      reader->offset += skipHere * format->lrecl;
+      reader->recordsRead += skipHere;
+      *skipped += skipHere;
+    } else {
+      char *record = NULL;
+      int recordLength = 0;
+      rc = blockReaderNextRecord(reader, &record, &recordLength);
+      if (rc != BLOCK_READER_RC_OK) {
+        break;
+      }
+      (*skipped)++;
+    }
+  }
+  return rc;
+}
+
+int blockReaderNextBlock(DatasetBlockReader *reader, char **block, int *blockLength) {
+  const DatasetBlockFormat *format = &reader->source->format;
+  if (format->recfm != 'F') {
+    return BLOCK_READER_RC_BAD_FORMAT;
+  }
+  if (reader->offset < reader->blockLength) {
+    /* hand out what is left of a partially consumed block first */
+    *block = reader->arena + reader->offset;
+    *blockLength = reader->blockLength - reader->offset;
+  } else {
+    int rc = fillBlock(reader);
+    if (rc != BLOCK_READER_RC_OK) {
+      return rc;
+    }
+    *block = reader->arena;
+    *blockLength = reader->blockLength;
+  }
+  if (*blockLength % format->lrecl) {
+    return BLOCK_READER_RC_BAD_BLOCK;
+  }
+  reader->offset = reader->blockLength;
+  reader->recordsRead += *blockLength / format->lrecl;
+  return BLOCK_READER_RC_OK;
+}
+
+
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
@@ -0,0 +1,248 @@
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "zowetypes.h"
+#include "alloc.h"
+#include "utils.h"
+
+#include "datasetCSICache.h"
+
+CSIQueryCache *makeCSIQueryCache(int maxEntries, int64 maxBytes, int ttlSeconds) {
+  CSIQueryCache *cache = (CSIQueryCache *)safeMalloc(sizeof(CSIQueryCache), "CSIQueryCache");
+  memset(cache, 0, sizeof(CSIQueryCache));
+  cache->maxEntries = maxEntries > 0 ? maxEntries : 1;
+  cache->maxBytes = maxBytes > 0 ? maxBytes : 0;
+  cache->ttlSeconds = ttlSeconds > 0 ? ttlSeconds : 0;
+  int resultsSize = sizeof(CSIQueryResult *) * cache->maxEntries;
+  cache->results = (CSIQueryResult **)safeMalloc(resultsSize, "CSIQueryResult table");
+  memset(cache->results, 0, resultsSize);
+  pthread_mutex_init(&cache->lock, NULL);
+  return cache;
+}
+
+static void freeCSIQueryResult(CSIQueryResult *result) {
+  safeFree((char *)result, result->size);
+}
+
+void freeCSIQueryCache(CSIQueryCache *cache) {
+  if (cache == NULL) {
+    return;
+  }
+  /* results still referenced are left to their holders */
+  for (int i = 0; i < cache->resultCount; i++) {
+    CSIQueryResult *result = cache->results[i];
+    result->cached = false;
+    if (result->refCount == 0) {
+      freeCSIQueryResult(result);
+    }
+  }
+  safeFree((char *)cache->results, sizeof(CSIQueryResult *) * cache->maxEntries);
+  pthread_mutex_destroy(&cache->lock);
+  safeFree((char *)cache, sizeof(CSIQueryCache));
+}
+
+CSIQueryResult *makeCSIQueryResult(const CSIQueryKey *key, int entryCount) {
+  if (entryCount < 0) {
+    entryCount = 0;
+  }
+  int size = sizeof(CSIQueryResult) + entryCount * sizeof(CSIDatasetEntry);
+  CSIQueryResult *result = (CSIQueryResult *)safeMalloc(size, "CSIQueryResult");
+  memset(result, 0, size);
+  result->key = *key;
+  result->entryCount = entryCount;
+  result->entries = (CSIDatasetEntry *)(result + 1);
+  result->size = size;
+  result->refCount = 1;
+  return result;
+}
+
+static bool isSameKey(const CSIQueryKey *a, const CSIQueryKey *b) {
+  return a->workAreaSize == b->workAreaSize &&
+         !strcmp(a->pattern, b->pattern) &&
+         !strcmp(a->user, b->user) &&
+         !strcmp(a->types, b->types) &&
+         !strcmp(a->resumeName, b->resumeName) &&
+         !strcmp(a->resumeCatalogName, b->resumeCatalogName);
+}
+
+static bool isExpired(const CSIQueryCache *cache, const CSIQueryResult *result, time_t now) {
+  return now - result->storedTime >= cache->ttlSeconds;
+}
+
+/* Must be called with the lock held. A result still being written out is
+   freed by its last release. */
+static void removeResult(CSIQueryCache *cache, int index) {
+  CSIQueryResult *result = cache->results[index];
+  cache->bytesUsed -= result->size;
+  result->cached = false;
+  if (result->refCount == 0) {
+    freeCSIQueryResult(result);
+  }
+  memmove(&cache->results[index], &cache->results[index + 1],
+          (cache->resultCount - index - 1) * sizeof(CSIQueryResult *));
+  cache->resultCount--;
+}
+
+static void removeExpiredResults(CSIQueryCache *cache, time_t now) {
+  for (int i = 0; i < cache->resultCount; ) {
+    if (isExpired(cache, cache->results[i], now)) {
+      removeResult(cache, i);
+      cache->stats.expirations++;
+    } else {
+      i++;
+    }
+  }
+}
+
+static void removeLeastRecentlyUsed(CSIQueryCache *cache) {
+  int oldest = 0;
+  for (int i = 1; i < cache->resultCount; i++) {
+    if (cache->results[i]->lastUsed < cache->results[oldest]->lastUsed) {
+      oldest = i;
+    }
+  }
+  removeResult(cache, oldest);
+  cache->stats.evictions++;
+}
+
+CSIQueryResult *lookupCSIQueryResult(CSIQueryCache *cache, const CSIQueryKey *key) {
+  CSIQueryResult *found = NULL;
+  pthread_mutex_lock(&cache->lock);
+  {
+    for (int i = 0; i < cache->resultCount; i++) {
+      CSIQueryResult *result = cache->results[i];
+      if (isSameKey(&result->key, key)) {
+        if (isExpired(cache, result, time(NULL))) {
+          removeResult(cache, i);
+          cache->stats.expirations++;
+        } else {
+          result->refCount++;
+          result->lastUsed = ++cache->clock;
+          found = result;
+        }
+        break;
+      }
+    }
+    if (found) {
+      cache->stats.hits++;
+    } else {
+      cache->stats.misses++;
+    }
+  }
+  pthread_mutex_unlock(&cache->lock);
+  return found;
+}
+
+void storeCSIQueryResult(CSIQueryCache *cache, CSIQueryResult *result) {
+  if (result->cached || result->size > cache->maxBytes) {
+    return;
+  }
+  pthread_mutex_lock(&cache->lock);
+  {
+    time_t now = time(NULL);
+    for (int i = 0; i < cache->resultCount; i++) {
+      if (isSameKey(&cache->results[i]->key, &result->key)) {
+        removeResult(cache, i);
+        break;
+      }
+    }
+    removeExpiredResults(cache, now);
+    while (cache->resultCount > 0 &&
+           (cache->resultCount >= cache->maxEntries ||
+            cache->bytesUsed + result->size > cache->maxBytes)) {
+      removeLeastRecentlyUsed(cache);
+    }
+    result->cached = true;
+    result->storedTime = now;
+    result->lastUsed = ++cache->clock;
+    cache->results[cache->resultCount++] = result;
+    cache->bytesUsed += result->size;
+    cache->stats.stores++;
+  }
+  pthread_mutex_unlock(&cache->lock);
+}
+
+void releaseCSIQueryResult(CSIQueryCache *cache, CSIQueryResult *result) {
+  if (cache == NULL) {
+    if (--result->refCount == 0 && !result->cached) {
+      freeCSIQueryResult(result);
+    }
+    return;
+  }
+  pthread_mutex_lock(&cache->lock);
+  {
+    if (--result->refCount == 0 && !result->cached) {
+      freeCSIQueryResult(result);
+    }
+  }
+  pthread_mutex_unlock(&cache->lock);
+}
+
+/* The part of a pattern before its first wildcard, without the period that
+   ends it, as "HLQ.**" also matches "HLQ" */
+static int getPatternPrefixLength(const char *pattern) {
+  int length = 0;
+  while (pattern[length] && pattern[length] != '*' && pattern[length] != '%') {
+    length++;
+  }
+  if (pattern[length] && length > 0 && pattern[length - 1] == '.') {
+    length--;
+  }
+  return length;
+}
+
+void invalidateCSIQueryResults(CSIQueryCache *cache, const char *dsn) {
+  int dsnLength = 0;
+  while (dsnLength < CSI_CACHE_NAME_LENGTH && dsn[dsnLength] && dsn[dsnLength] != ' ') {
+    dsnLength++;
+  }
+  pthread_mutex_lock(&cache->lock);
+  {
+    for (int i = 0; i < cache->resultCount; ) {
+      const char *pattern = cache->results[i]->key.pattern;
+      int prefixLength = getPatternPrefixLength(pattern);
+      if (prefixLength <= dsnLength && !memcmp(pattern, dsn, prefixLength)) {
+        removeResult(cache, i);
+        cache->stats.invalidations++;
+      } else {
+        i++;
+      }
+    }
+  }
+  pthread_mutex_unlock(&cache->lock);
+}
+
+void getCSIQueryCacheStats(CSIQueryCache *cache, CSIQueryCacheStats *stats) {
+  pthread_mutex_lock(&cache->lock);
+  {
+    *stats = cache->stats;
+    stats->entries = cache->resultCount;
+    stats->bytes = cache->bytesUsed;
+  }
+  pthread_mutex_unlock(&cache->lock);
+}
+
+
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
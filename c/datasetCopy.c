@@ -0,0 +1,427 @@
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "zowetypes.h"
+#include "alloc.h"
+#include "logging.h"
+#include "impersonation.h"
+
+#include "datasetRecordFormat.h"
+#include "datasetCopy.h"
+
+#define STAGED_LENGTH_PREFIX 2
+#define STAGED_INITIAL_SIZE  0x10000
+#define RECORD_BUFFER_SIZE   32768  /* largest LRECL, with room for the null */
+
+#ifdef __ZOWE_OS_ZOS
+#define RECORD_READ_MODE  "rb, type=record"
+#define RECORD_WRITE_MODE "wb, recfm=*, type=record"
+#else
+#define RECORD_READ_MODE  "rb"
+#define RECORD_WRITE_MODE "wb"
+#endif
+
+static int defaultWorkerCount = PDS_COPY_DEFAULT_WORKERS;
+
+void setDefaultPDSCopyWorkers(int workerCount) {
+  if (workerCount < 0) {
+    workerCount = 0;
+  } else if (workerCount > PDS_COPY_MAX_WORKERS) {
+    workerCount = PDS_COPY_MAX_WORKERS;
+  }
+  defaultWorkerCount = workerCount;
+}
+
+int getDefaultPDSCopyWorkers(void) {
+  return defaultWorkerCount;
+}
+
+static bool isValidPattern(const char *pattern) {
+  const char *placeholder = strstr(pattern, "%s");
+  if (placeholder == NULL || strlen(pattern) >= PDS_COPY_PATH_LENGTH) {
+    return false;
+  }
+  /* no other conversions, they would read arguments that are not there */
+  for (const char *c = pattern; *c; c++) {
+    if (*c == '%' && c != placeholder) {
+      return false;
+    }
+  }
+  return true;
+}
+
+PDSCopy *makePDSCopy(const char *user, const char *sourcePattern, const char *targetPattern,
+                     int sourceLrecl, int targetLrecl, bool targetFixed,
+                     const char **members, int memberCount, int workerCount) {
+  if (!isValidPattern(sourcePattern) || !isValidPattern(targetPattern) || memberCount < 0 ||
+      sourceLrecl <= 0 || sourceLrecl >= RECORD_BUFFER_SIZE ||
+      targetLrecl <= 0 || targetLrecl >= RECORD_BUFFER_SIZE) {
+    return NULL;
+  }
+  PDSCopy *copy = (PDSCopy *)safeMalloc(sizeof(PDSCopy), "PDSCopy");
+  memset(copy, 0, sizeof(PDSCopy));
+  snprintf(copy->user, sizeof(copy->user), "%s", user ? user : "");
+  snprintf(copy->sourcePattern, sizeof(copy->sourcePattern), "%s", sourcePattern);
+  snprintf(copy->targetPattern, sizeof(copy->targetPattern), "%s", targetPattern);
+  copy->sourceMode = RECORD_READ_MODE;
+  copy->targetMode = RECORD_WRITE_MODE;
+  copy->sourceLrecl = sourceLrecl;
+  copy->targetLrecl = targetLrecl;
+  copy->targetFixed = targetFixed;
+  copy->padByte = ' ';
+  if (workerCount < 0) {
+    workerCount = defaultWorkerCount;
+  }
+  copy->workerCount = workerCount > PDS_COPY_MAX_WORKERS ? PDS_COPY_MAX_WORKERS : workerCount;
+  copy->maxAhead = copy->workerCount * 2;
+  copy->memberCount = memberCount;
+  if (memberCount > 0) {
+    copy->members = (PDSCopyMember *)safeMalloc(memberCount * sizeof(PDSCopyMember), "PDSCopyMembers");
+    memset(copy->members, 0, memberCount * sizeof(PDSCopyMember));
+    for (int i = 0; i < memberCount; i++) {
+      snprintf(copy->members[i].name, sizeof(copy->members[i].name), "%.8s", members[i]);
+    }
+  }
+  copy->progress.membersTotal = memberCount;
+  pthread_mutex_init(&copy->lock, NULL);
+  pthread_cond_init(&copy->changed, NULL);
+  return copy;
+}
+
+static void freeStaged(PDSCopyMember *member) {
+  if (member->staged) {
+    safeFree(member->staged, member->stagedSize);
+    member->staged = NULL;
+    member->stagedSize = 0;
+    member->stagedLength = 0;
+  }
+}
+
+void freePDSCopy(PDSCopy *copy) {
+  if (copy == NULL) {
+    return;
+  }
+  for (int i = 0; i < copy->memberCount; i++) {
+    freeStaged(&copy->members[i]);
+  }
+  if (copy->members) {
+    safeFree((char *)copy->members, copy->memberCount * sizeof(PDSCopyMember));
+  }
+  pthread_cond_destroy(&copy->changed);
+  pthread_mutex_destroy(&copy->lock);
+  safeFree((char *)copy, sizeof(PDSCopy));
+}
+
+void cancelPDSCopy(PDSCopy *copy) {
+  pthread_mutex_lock(&copy->lock);
+  copy->cancelled = true;
+  pthread_cond_broadcast(&copy->changed);
+  pthread_mutex_unlock(&copy->lock);
+}
+
+void getPDSCopyProgress(PDSCopy *copy, PDSCopyProgress *progress) {
+  pthread_mutex_lock(&copy->lock);
+  *progress = copy->progress;
+  pthread_mutex_unlock(&copy->lock);
+}
+
+static FILE *openMember(const char *pattern, const char *name, const char *mode) {
+  char path[PDS_COPY_PATH_LENGTH + 8];
+  snprintf(path, sizeof(path), pattern, name);
+  return fopen(path, mode);
+}
+
+static bool appendStagedRecord(PDSCopyMember *member, const char *record, int length) {
+  int needed = member->stagedLength + STAGED_LENGTH_PREFIX + length;
+  if (needed > PDS_COPY_MAX_STAGED_BYTES) {
+    return false;
+  }
+  if (needed > member->stagedSize) {
+    int newSize = member->stagedSize ? member->stagedSize : STAGED_INITIAL_SIZE;
+    while (newSize < needed) {
+      newSize *= 2;
+    }
+    if (newSize > PDS_COPY_MAX_STAGED_BYTES) {
+      newSize = PDS_COPY_MAX_STAGED_BYTES;
+    }
+    char *newStaged = safeMalloc(newSize, "PDSCopyStaged");
+    if (newStaged == NULL) {
+      return false;
+    }
+    if (member->staged) {
+      memcpy(newStaged, member->staged, member->stagedLength);
+      safeFree(member->staged, member->stagedSize);
+    }
+    member->staged = newStaged;
+    member->stagedSize = newSize;
+  }
+  char *next = member->staged + member->stagedLength;
+  next[0] = (length >> 8) & 0xFF;
+  next[1] = length & 0xFF;
+  memcpy(next + STAGED_LENGTH_PREFIX, record, length);
+  member->stagedLength = needed;
+  return true;
+}
+
+/* Reads a whole member into its staging buffer. Returns the state it ends in. */
+static int stageMember(PDSCopy *copy, PDSCopyMember *member, char *buffer) {
+  FILE *in = openMember(copy->sourcePattern, member->name, copy->sourceMode);
+  if (in == NULL) {
+    member->error = "Source member could not be opened";
+    return PDS_COPY_MEMBER_FAILED;
+  }
+  int state = PDS_COPY_MEMBER_STAGED;
+  while (!feof(in)) {
+    int bytesRead = fread(buffer, 1, copy->sourceLrecl, in);
+    if (ferror(in)) {
+      member->error = "Error reading source member";
+      state = PDS_COPY_MEMBER_FAILED;
+      break;
+    }
+    if (bytesRead > 0 && !appendStagedRecord(member, buffer, bytesRead)) {
+      state = PDS_COPY_MEMBER_DIRECT;
+      break;
+    }
+  }
+  fclose(in);
+  if (state != PDS_COPY_MEMBER_STAGED) {
+    freeStaged(member);
+  }
+  return state;
+}
+
+static bool writeRecord(PDSCopy *copy, FILE *out, const char *record, int length, char *padBuffer,
+                        PDSCopyMember *member) {
+  int outLength = 0;
+  const char *formatted = formatDatasetRecord(record, length, copy->targetLrecl, copy->targetFixed,
+                                              copy->padByte, padBuffer, &outLength);
+  int bytesWritten = fwrite(formatted, 1, outLength, out);
+  if (bytesWritten < outLength && ferror(out)) {
+    return false;
+  }
+  member->records++;
+  member->bytes += outLength;
+  return true;
+}
+
+/* Writes a member from its staging buffer, or from the source when it was
+   not staged. Returns false when the target could not be written. */
+static bool writeMember(PDSCopy *copy, PDSCopyMember *member, char *buffer, char *padBuffer) {
+  FILE *in = NULL;
+  if (member->state == PDS_COPY_MEMBER_DIRECT) {
+    in = openMember(copy->sourcePattern, member->name, copy->sourceMode);
+    if (in == NULL) {
+      member->error = "Source member could not be opened";
+      member->state = PDS_COPY_MEMBER_FAILED;
+      return true;
+    }
+  }
+  FILE *out = openMember(copy->targetPattern, member->name, copy->targetMode);
+  if (out == NULL) {
+    member->error = "Target member could not be opened";
+    member->state = PDS_COPY_MEMBER_FAILED;
+    if (in) {
+      fclose(in);
+    }
+    return false;
+  }
+  bool writeFailed = false;
+  member->records = 0;
+  member->bytes = 0;
+  if (in) {
+    while (!feof(in) && !writeFailed) {
+      int bytesRead = fread(buffer, 1, copy->sourceLrecl, in);
+      if (ferror(in)) {
+        member->error = "Error reading source member";
+        member->state = PDS_COPY_MEMBER_FAILED;
+        break;
+      }
+      if (bytesRead > 0) {
+        writeFailed = !writeRecord(copy, out, buffer, bytesRead, padBuffer, member);
+      }
+    }
+    fclose(in);
+  } else {
+    const unsigned char *next = (const unsigned char *)member->staged;
+    const unsigned char *end = next + member->stagedLength;
+    while (next < end && !writeFailed) {
+      int length = (next[0] << 8) | next[1];
+      writeFailed = !writeRecord(copy, out, (const char *)next + STAGED_LENGTH_PREFIX, length,
+                                 padBuffer, member);
+      next += STAGED_LENGTH_PREFIX + length;
+    }
+  }
+  if (fclose(out) != 0) {
+    writeFailed = true;
+  }
+  if (writeFailed) {
+    member->error = "Error writing target member";
+    member->state = PDS_COPY_MEMBER_FAILED;
+    return false;
+  }
+  if (member->state != PDS_COPY_MEMBER_FAILED) {
+    member->state = PDS_COPY_MEMBER_COPIED;
+  }
+  return true;
+}
+
+bool startDatasetCopyIdentity(const char *user) {
+  if (user == NULL || user[0] == '\0') {
+    return false;
+  }
+#ifdef __ZOWE_OS_ZOS
+  if (!startImpersonating((char *)user, NULL)) {
+    zowelog(NULL, LOG_COMP_DATASERVICE, ZOWE_LOG_WARNING,
+            "Dataset copy thread could not run as %s\n", user);
+    return false;
+  }
+#endif
+  return true;
+}
+
+void endDatasetCopyIdentity(const char *user) {
+#ifdef __ZOWE_OS_ZOS
+  endImpersonating((char *)user, NULL);
+#endif
+}
+
+static void *readerMain(void *arg) {
+  PDSCopy *copy = (PDSCopy *)arg;
+  if (!startDatasetCopyIdentity(copy->user)) {
+    return NULL;
+  }
+  char *buffer = safeMalloc(RECORD_BUFFER_SIZE, "PDSCopyReadBuffer");
+  while (true) {
+    pthread_mutex_lock(&copy->lock);
+    while (!copy->cancelled && copy->nextToRead < copy->memberCount &&
+           copy->nextToRead - copy->nextToWrite >= copy->maxAhead) {
+      pthread_cond_wait(&copy->changed, &copy->lock);
+    }
+    if (copy->cancelled || copy->nextToRead >= copy->memberCount) {
+      pthread_mutex_unlock(&copy->lock);
+      break;
+    }
+    PDSCopyMember *member = &copy->members[copy->nextToRead++];
+    member->state = PDS_COPY_MEMBER_READING;
+    pthread_mutex_unlock(&copy->lock);
+
+    int state = stageMember(copy, member, buffer);
+
+    pthread_mutex_lock(&copy->lock);
+    member->state = state;
+    pthread_cond_broadcast(&copy->changed);
+    pthread_mutex_unlock(&copy->lock);
+  }
+  safeFree(buffer, RECORD_BUFFER_SIZE);
+  endDatasetCopyIdentity(copy->user);
+  return NULL;
+}
+
+int runPDSCopy(PDSCopy *copy) {
+  pthread_t workers[PDS_COPY_MAX_WORKERS];
+  int workersStarted = 0;
+  copy->progress.startTime = time(NULL);
+  for (int i = 0; i < copy->workerCount; i++) {
+    if (pthread_create(&workers[workersStarted], NULL, readerMain, copy) != 0) {
+      zowelog(NULL, LOG_COMP_DATASERVICE, ZOWE_LOG_WARNING,
+              "PDS copy started %d of %d readers\n", workersStarted, copy->workerCount);
+      break;
+    }
+    workersStarted++;
+  }
+
+  char *buffer = safeMalloc(RECORD_BUFFER_SIZE, "PDSCopyWriteBuffer");
+  char *padBuffer = safeMalloc(RECORD_BUFFER_SIZE, "PDSCopyPadBuffer");
+  for (int i = 0; i < copy->memberCount; i++) {
+    PDSCopyMember *member = &copy->members[i];
+
+    pthread_mutex_lock(&copy->lock);
+    while (member->state == PDS_COPY_MEMBER_READING) {
+      pthread_cond_wait(&copy->changed, &copy->lock);
+    }
+    bool stop = copy->cancelled;
+    if (!stop && member->state == PDS_COPY_MEMBER_PENDING) {
+      /* no reader got to it, nextToRead is i as members are claimed in order */
+      copy->nextToRead = i + 1;
+      member->state = PDS_COPY_MEMBER_DIRECT;
+    }
+    pthread_mutex_unlock(&copy->lock);
+    if (stop) {
+      break;
+    }
+
+    bool written = true;
+    if (member->state != PDS_COPY_MEMBER_FAILED) {
+      written = writeMember(copy, member, buffer, padBuffer);
+    }
+    freeStaged(member);
+    if (member->state == PDS_COPY_MEMBER_FAILED) {
+      zowelog(NULL, LOG_COMP_DATASERVICE, ZOWE_LOG_DEBUG, "PDS copy of member %s failed: %s\n",
+              member->name, member->error);
+    }
+
+    pthread_mutex_lock(&copy->lock);
+    copy->nextToWrite = i + 1;
+    if (member->state == PDS_COPY_MEMBER_COPIED) {
+      copy->progress.membersCopied++;
+      copy->progress.recordsCopied += member->records;
+      copy->progress.bytesCopied += member->bytes;
+    } else {
+      copy->progress.membersFailed++;
+    }
+    if (!written) {
+      copy->cancelled = true;
+    }
+    pthread_cond_broadcast(&copy->changed);
+    pthread_mutex_unlock(&copy->lock);
+  }
+  safeFree(buffer, RECORD_BUFFER_SIZE);
+  safeFree(padBuffer, RECORD_BUFFER_SIZE);
+
+  cancelPDSCopy(copy);
+  for (int i = 0; i < workersStarted; i++) {
+    pthread_join(workers[i], NULL);
+  }
+
+  int failed = 0;
+  pthread_mutex_lock(&copy->lock);
+  for (int i = 0; i < copy->memberCount; i++) {
+    PDSCopyMember *member = &copy->members[i];
+    freeStaged(member);
+    if (member->state != PDS_COPY_MEMBER_COPIED && member->state != PDS_COPY_MEMBER_FAILED) {
+      member->state = PDS_COPY_MEMBER_SKIPPED;
+    }
+    if (member->state != PDS_COPY_MEMBER_COPIED) {
+      failed++;
+    }
+  }
+  copy->progress.membersFailed = failed;
+  copy->progress.endTime = time(NULL);
+  pthread_mutex_unlock(&copy->lock);
+  return failed;
+}
+
+
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
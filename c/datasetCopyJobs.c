@@ -0,0 +1,289 @@
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "zowetypes.h"
+#include "alloc.h"
+#include "logging.h"
+#include "scheduling.h"
+
+#include "datasetCopy.h"
+#include "datasetCopyJobs.h"
+
+static void copyString(char *target, int targetSize, const char *source) {
+  snprintf(target, targetSize, "%s", source ? source : "");
+}
+
+CopyJob *makeCopyJob(const char *user, const char *source, const char *target,
+                     CopyJobRunner *run, CopyJobCleanup *cleanup, void *userData) {
+  CopyJob *job = (CopyJob *)safeMalloc(sizeof(CopyJob), "CopyJob");
+  memset(job, 0, sizeof(CopyJob));
+  copyString(job->status.user, sizeof(job->status.user), user);
+  copyString(job->status.source, sizeof(job->status.source), source);
+  copyString(job->status.target, sizeof(job->status.target), target);
+  job->status.state = COPY_JOB_QUEUED;
+  job->run = run;
+  job->cleanup = cleanup;
+  job->userData = userData;
+  return job;
+}
+
+static void freeCopyJob(CopyJob *job) {
+  safeFree((char *)job, sizeof(CopyJob));
+}
+
+static void cleanUpCopyJob(CopyJob *job) {
+  if (job->cleanup) {
+    job->cleanup(job);
+  }
+  job->userData = NULL;
+}
+
+static bool isCopyJobFinished(const CopyJob *job) {
+  return job->status.state == COPY_JOB_SUCCEEDED || job->status.state == COPY_JOB_FAILED;
+}
+
+/* Runs with the lock held. A finished job is only looked at under the lock,
+   so freeing one here cannot pull it from under a worker or a poll. */
+static void removeCopyJob(CopyJobPool *pool, int index) {
+  freeCopyJob(pool->jobs[index]);
+  memmove(&pool->jobs[index], &pool->jobs[index + 1],
+          (pool->jobCount - index - 1) * sizeof(CopyJob *));
+  pool->jobCount--;
+}
+
+static void pruneCopyJobs(CopyJobPool *pool, time_t now) {
+  for (int i = 0; i < pool->jobCount; ) {
+    CopyJob *job = pool->jobs[i];
+    if (isCopyJobFinished(job) && now - job->status.endTime >= COPY_JOB_RETAIN_SECONDS) {
+      removeCopyJob(pool, i);
+    } else {
+      i++;
+    }
+  }
+  if (pool->jobCount < pool->maxJobs) {
+    return;
+  }
+  for (int i = 0; i < pool->jobCount; i++) {
+    if (isCopyJobFinished(pool->jobs[i])) {
+      removeCopyJob(pool, i);
+      return;
+    }
+  }
+}
+
+int submitCopyJob(CopyJobPool *pool, CopyJob *job) {
+  pthread_mutex_lock(&pool->lock);
+  time_t now = time(NULL);
+  pruneCopyJobs(pool, now);
+  if (pool->jobCount >= pool->maxJobs) {
+    pool->stats.rejected++;
+    pthread_mutex_unlock(&pool->lock);
+    zowelog(NULL, LOG_COMP_DATASERVICE, ZOWE_LOG_WARNING,
+            "Copy of %s rejected, %d copy jobs are unfinished\n", job->status.source, pool->maxJobs);
+    cleanUpCopyJob(job);
+    freeCopyJob(job);
+    return -1;
+  }
+  int id = ++pool->nextId;
+  job->status.id = id;
+  job->status.queuedTime = now;
+  job->pool = pool;
+  pool->jobs[pool->jobCount++] = job;
+  if (pool->queueTail) {
+    pool->queueTail->next = job;
+  } else {
+    pool->queueHead = job;
+  }
+  pool->queueTail = job;
+  pool->stats.submitted++;
+  pthread_cond_signal(&pool->queued);
+  pthread_mutex_unlock(&pool->lock);
+  zowelog(NULL, LOG_COMP_DATASERVICE, ZOWE_LOG_DEBUG, "Copy job %d queued: %s to %s\n",
+          id, job->status.source, job->status.target);
+  return id;
+}
+
+static CopyJob *takeCopyJob(CopyJobPool *pool) {
+  pthread_mutex_lock(&pool->lock);
+  while (pool->queueHead == NULL) {
+    pthread_cond_wait(&pool->queued, &pool->lock);
+  }
+  CopyJob *job = pool->queueHead;
+  pool->queueHead = job->next;
+  if (pool->queueHead == NULL) {
+    pool->queueTail = NULL;
+  }
+  job->next = NULL;
+  job->status.state = COPY_JOB_RUNNING;
+  job->status.startTime = time(NULL);
+  pthread_mutex_unlock(&pool->lock);
+  return job;
+}
+
+static void runCopyJob(CopyJobPool *pool, CopyJob *job) {
+  char message[COPY_JOB_MESSAGE_LENGTH] = {0};
+  char eTag[COPY_JOB_ETAG_LENGTH] = {0};
+  int rc = -1;
+  if (startDatasetCopyIdentity(job->status.user)) {
+    rc = job->run(job, message, eTag);
+    endDatasetCopyIdentity(job->status.user);
+  } else {
+    snprintf(message, sizeof(message), "Copy could not be run as %s", job->status.user);
+  }
+
+  /* the last progress is read before cleanup frees what readProgress reads */
+  pthread_mutex_lock(&pool->lock);
+  if (job->readProgress) {
+    job->readProgress(job, &job->status.progress);
+    job->readProgress = NULL;
+  }
+  pthread_mutex_unlock(&pool->lock);
+
+  cleanUpCopyJob(job);
+
+  pthread_mutex_lock(&pool->lock);
+  job->status.state = rc ? COPY_JOB_FAILED : COPY_JOB_SUCCEEDED;
+  job->status.endTime = time(NULL);
+  copyString(job->status.message, sizeof(job->status.message), message);
+  copyString(job->status.eTag, sizeof(job->status.eTag), eTag);
+  if (rc) {
+    pool->stats.failed++;
+  } else {
+    pool->stats.succeeded++;
+  }
+  int id = job->status.id;
+  pthread_mutex_unlock(&pool->lock);
+  zowelog(NULL, LOG_COMP_DATASERVICE, ZOWE_LOG_DEBUG, "Copy job %d finished, rc=%d: %s\n",
+          id, rc, message);
+}
+
+static int copyJobWorkerMain(RLETask *task) {
+  CopyJobPool *pool = (CopyJobPool *)task->userPointer;
+  while (true) {
+    CopyJob *job = takeCopyJob(pool);
+    runCopyJob(pool, job);
+  }
+  return 0;
+}
+
+CopyJobPool *makeCopyJobPool(RLEAnchor *anchor, int workerCount, int maxJobs) {
+  if (workerCount > COPY_JOB_MAX_WORKERS) {
+    workerCount = COPY_JOB_MAX_WORKERS;
+  }
+  if (workerCount <= 0 || maxJobs <= 0) {
+    return NULL;
+  }
+  CopyJobPool *pool = (CopyJobPool *)safeMalloc(sizeof(CopyJobPool), "CopyJobPool");
+  memset(pool, 0, sizeof(CopyJobPool));
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->queued, NULL);
+  pool->maxJobs = maxJobs;
+  pool->jobs = (CopyJob **)safeMalloc(maxJobs * sizeof(CopyJob *), "CopyJobPool jobs");
+  pool->workerCount = workerCount;
+
+  for (int i = 0; i < workerCount; i++) {
+    RLETask *task = makeRLETask(anchor, RLE_TASK_TCB_CAPABLE | RLE_TASK_DISPOSABLE, copyJobWorkerMain);
+    if (!task) {
+      zowelog(NULL, LOG_COMP_DATASERVICE, ZOWE_LOG_WARNING,
+              "failed to create background task %d for copy jobs\n", i);
+      break;
+    }
+    task->userPointer = pool;
+    startRLETask(task, NULL);
+    pool->workersRunning++;
+  }
+  if (pool->workersRunning == 0) {
+    /* nothing can be referring to the pool yet */
+    pthread_cond_destroy(&pool->queued);
+    pthread_mutex_destroy(&pool->lock);
+    safeFree((char *)pool->jobs, maxJobs * sizeof(CopyJob *));
+    safeFree((char *)pool, sizeof(CopyJobPool));
+    return NULL;
+  }
+  return pool;
+}
+
+bool getCopyJobStatus(CopyJobPool *pool, int id, const char *user, CopyJobStatus *status) {
+  bool found = false;
+  pthread_mutex_lock(&pool->lock);
+  for (int i = 0; i < pool->jobCount; i++) {
+    CopyJob *job = pool->jobs[i];
+    if (job->status.id != id) {
+      continue;
+    }
+    if (user && strcmp(job->status.user, user)) {
+      break;
+    }
+    *status = job->status;
+    if (job->status.state == COPY_JOB_RUNNING && job->readProgress) {
+      job->readProgress(job, &status->progress);
+    }
+    found = true;
+    break;
+  }
+  pthread_mutex_unlock(&pool->lock);
+  return found;
+}
+
+void setCopyJobProgress(CopyJob *job, const CopyJobProgress *progress) {
+  pthread_mutex_lock(&job->pool->lock);
+  job->status.progress = *progress;
+  pthread_mutex_unlock(&job->pool->lock);
+}
+
+void addCopyJobFailure(CopyJob *job, const char *name, const char *error) {
+  pthread_mutex_lock(&job->pool->lock);
+  int count = job->status.failureCount++;
+  if (count < COPY_JOB_MAX_FAILURES) {
+    CopyJobFailure *failure = &job->status.failures[count];
+    copyString(failure->name, sizeof(failure->name), name);
+    copyString(failure->error, sizeof(failure->error), error);
+  }
+  pthread_mutex_unlock(&job->pool->lock);
+}
+
+const char *getCopyJobStateName(int state) {
+  switch (state) {
+  case COPY_JOB_QUEUED:
+    return "queued";
+  case COPY_JOB_RUNNING:
+    return "running";
+  case COPY_JOB_SUCCEEDED:
+    return "succeeded";
+  case COPY_JOB_FAILED:
+    return "failed";
+  default:
+    return "unknown";
+  }
+}
+
+void getCopyJobPoolStats(CopyJobPool *pool, CopyJobPoolStats *stats) {
+  pthread_mutex_lock(&pool->lock);
+  *stats = pool->stats;
+  pthread_mutex_unlock(&pool->lock);
+}
+
+
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
@@ -0,0 +1,406 @@
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef __ZOWE_OS_ZOS
+#include "zowetypes.h"
+#include "icsf.h"
+#endif
+
+#include "datasetDigest.h"
+
+#ifdef __ZOWE_OS_ZOS
+static int defaultDigestType = DATASET_DIGEST_ICSF_SHA1;
+#else
+static int defaultDigestType = DATASET_DIGEST_SHA1;
+#endif
+
+/* SHA-1, FIPS 180-4 */
+
+#define ROTL32(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+
+static void sha1Init(DigestSHA1 *sha1) {
+  sha1->h[0] = 0x67452301;
+  sha1->h[1] = 0xEFCDAB89;
+  sha1->h[2] = 0x98BADCFE;
+  sha1->h[3] = 0x10325476;
+  sha1->h[4] = 0xC3D2E1F0;
+  sha1->length = 0;
+  sha1->blockUsed = 0;
+}
+
+static void sha1Block(DigestSHA1 *sha1, const unsigned char *block) {
+  uint32_t w[80];
+  for (int i = 0; i < 16; i++) {
+    w[i] = ((uint32_t)block[i * 4] << 24) | ((uint32_t)block[i * 4 + 1] << 16) |
+           ((uint32_t)block[i * 4 + 2] << 8) | block[i * 4 + 3];
+  }
+  for (int i = 16; i < 80; i++) {
+    w[i] = ROTL32(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+  }
+  uint32_t a = sha1->h[0], b = sha1->h[1], c = sha1->h[2], d = sha1->h[3], e = sha1->h[4];
+  for (int i = 0; i < 80; i++) {
+    uint32_t f, k;
+    if (i < 20) {
+      f = (b & c) | (~b & d);
+      k = 0x5A827999;
+    } else if (i < 40) {
+      f = b ^ c ^ d;
+      k = 0x6ED9EBA1;
+    } else if (i < 60) {
+      f = (b & c) | (b & d) | (c & d);
+      k = 0x8F1BBCDC;
+    } else {
+      f = b ^ c ^ d;
+      k = 0xCA62C1D6;
+    }
+    uint32_t temp = ROTL32(a, 5) + f + e + k + w[i];
+    e = d;
+    d = c;
+    c = ROTL32(b, 30);
+    b = a;
+    a = temp;
+  }
+  sha1->h[0] += a;
+  sha1->h[1] += b;
+  sha1->h[2] += c;
+  sha1->h[3] += d;
+  sha1->h[4] += e;
+}
+
+static void sha1Update(DigestSHA1 *sha1, const unsigned char *data, int length) {
+  sha1->length += length;
+  if (sha1->blockUsed > 0) {
+    int take = 64 - sha1->blockUsed;
+    if (take > length) {
+      take = length;
+    }
+    memcpy(sha1->block + sha1->blockUsed, data, take);
+    sha1->blockUsed += take;
+    data += take;
+    length -= take;
+    if (sha1->blockUsed < 64) {
+      return;
+    }
+    sha1Block(sha1, sha1->block);
+    sha1->blockUsed = 0;
+  }
+  while (length >= 64) {
+    sha1Block(sha1, data);
+    data += 64;
+    length -= 64;
+  }
+  memcpy(sha1->block, data, length);
+  sha1->blockUsed = length;
+}
+
+static void sha1Finish(DigestSHA1 *sha1, char *hash) {
+  uint64_t bitLength = sha1->length * 8;
+  unsigned char padding[72] = {0x80};
+  int padLength = (sha1->blockUsed < 56) ? 56 - sha1->blockUsed : 120 - sha1->blockUsed;
+  for (int i = 0; i < 8; i++) {
+    padding[padLength + i] = (unsigned char)(bitLength >> (56 - i * 8));
+  }
+  sha1Update(sha1, padding, padLength + 8);
+  for (int i = 0; i < 5; i++) {
+    hash[i * 4] = (char)(sha1->h[i] >> 24);
+    hash[i * 4 + 1] = (char)(sha1->h[i] >> 16);
+    hash[i * 4 + 2] = (char)(sha1->h[i] >> 8);
+    hash[i * 4 + 3] = (char)sha1->h[i];
+  }
+}
+
+/* xxHash64 with seed 0. Lanes are read little-endian whatever the platform,
+   so the result is the same everywhere. */
+
+#define XXH_PRIME64_1 0x9E3779B185EBCA87ULL
+#define XXH_PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define XXH_PRIME64_3 0x165667B19E3779F9ULL
+#define XXH_PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define XXH_PRIME64_5 0x27D4EB2F165667C5ULL
+
+#define ROTL64(x, n) (((x) << (n)) | ((x) >> (64 - (n))))
+
+static uint64_t readLE64(const unsigned char *p) {
+  uint64_t value = 0;
+  for (int i = 7; i >= 0; i--) {
+    value = (value << 8) | p[i];
+  }
+  return value;
+}
+
+static uint32_t readLE32(const unsigned char *p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t xxh64Round(uint64_t accumulator, uint64_t input) {
+  accumulator += input * XXH_PRIME64_2;
+  accumulator = ROTL64(accumulator, 31);
+  return accumulator * XXH_PRIME64_1;
+}
+
+static uint64_t xxh64MergeRound(uint64_t accumulator, uint64_t value) {
+  accumulator ^= xxh64Round(0, value);
+  return accumulator * XXH_PRIME64_1 + XXH_PRIME64_4;
+}
+
+static void xxh64Init(DigestXXH64 *xxh) {
+  xxh->v[0] = XXH_PRIME64_1 + XXH_PRIME64_2;
+  xxh->v[1] = XXH_PRIME64_2;
+  xxh->v[2] = 0;
+  xxh->v[3] = 0 - XXH_PRIME64_1;
+  xxh->length = 0;
+  xxh->stripeUsed = 0;
+}
+
+static void xxh64Stripe(DigestXXH64 *xxh, const unsigned char *stripe) {
+  for (int i = 0; i < 4; i++) {
+    xxh->v[i] = xxh64Round(xxh->v[i], readLE64(stripe + i * 8));
+  }
+}
+
+static void xxh64Update(DigestXXH64 *xxh, const unsigned char *data, int length) {
+  xxh->length += length;
+  if (xxh->stripeUsed > 0) {
+    int take = 32 - xxh->stripeUsed;
+    if (take > length) {
+      take = length;
+    }
+    memcpy(xxh->stripe + xxh->stripeUsed, data, take);
+    xxh->stripeUsed += take;
+    data += take;
+    length -= take;
+    if (xxh->stripeUsed < 32) {
+      return;
+    }
+    xxh64Stripe(xxh, xxh->stripe);
+    xxh->stripeUsed = 0;
+  }
+  while (length >= 32) {
+    xxh64Stripe(xxh, data);
+    data += 32;
+    length -= 32;
+  }
+  memcpy(xxh->stripe, data, length);
+  xxh->stripeUsed = length;
+}
+
+static void xxh64Finish(DigestXXH64 *xxh, char *hash) {
+  uint64_t h64;
+  if (xxh->length >= 32) {
+    h64 = ROTL64(xxh->v[0], 1) + ROTL64(xxh->v[1], 7) +
+          ROTL64(xxh->v[2], 12) + ROTL64(xxh->v[3], 18);
+    for (int i = 0; i < 4; i++) {
+      h64 = xxh64MergeRound(h64, xxh->v[i]);
+    }
+  } else {
+    h64 = xxh->v[2] + XXH_PRIME64_5;
+  }
+  h64 += xxh->length;
+
+  const unsigned char *p = xxh->stripe;
+  int remaining = xxh->stripeUsed;
+  while (remaining >= 8) {
+    h64 ^= xxh64Round(0, readLE64(p));
+    h64 = ROTL64(h64, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+    p += 8;
+    remaining -= 8;
+  }
+  if (remaining >= 4) {
+    h64 ^= (uint64_t)readLE32(p) * XXH_PRIME64_1;
+    h64 = ROTL64(h64, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+    p += 4;
+    remaining -= 4;
+  }
+  while (remaining > 0) {
+    h64 ^= (*p) * XXH_PRIME64_5;
+    h64 = ROTL64(h64, 11) * XXH_PRIME64_1;
+    p++;
+    remaining--;
+  }
+  h64 ^= h64 >> 33;
+  h64 *= XXH_PRIME64_2;
+  h64 ^= h64 >> 29;
+  h64 *= XXH_PRIME64_3;
+  h64 ^= h64 >> 32;
+
+  for (int i = 0; i < 8; i++) {
+    hash[i] = (char)(h64 >> (56 - i * 8));
+  }
+}
+
+/* Backend dispatch */
+
+static int backendUpdate(DatasetDigest *digest, const char *data, int length) {
+  digest->backendCalls++;
+  switch (digest->type) {
+#ifdef __ZOWE_OS_ZOS
+  case DATASET_DIGEST_ICSF_SHA1:
+    return icsfDigestUpdate(&digest->state.icsf, (char *)data, length);
+#endif
+  case DATASET_DIGEST_SHA1:
+    sha1Update(&digest->state.sha1, (const unsigned char *)data, length);
+    return DATASET_DIGEST_RC_OK;
+  case DATASET_DIGEST_XXHASH64:
+    xxh64Update(&digest->state.xxh64, (const unsigned char *)data, length);
+    return DATASET_DIGEST_RC_OK;
+  default:
+    return DATASET_DIGEST_RC_UNSUPPORTED;
+  }
+}
+
+static int flushBatch(DatasetDigest *digest) {
+  if (digest->batchUsed > 0 && !digest->rc) {
+    digest->rc = backendUpdate(digest, digest->batch, digest->batchUsed);
+  }
+  digest->batchUsed = 0;
+  return digest->rc;
+}
+
+int datasetDigestInit(DatasetDigest *digest, int type, char *batch, int batchSize) {
+  memset(digest, 0, sizeof(DatasetDigest));
+  digest->type = type ? type : defaultDigestType;
+  if (batch != NULL && batchSize > 0) {
+    digest->batch = batch;
+    digest->batchSize = batchSize;
+  }
+  switch (digest->type) {
+#ifdef __ZOWE_OS_ZOS
+  case DATASET_DIGEST_ICSF_SHA1:
+    digest->rc = icsfDigestInit(&digest->state.icsf, ICSF_DIGEST_SHA1);
+    digest->hashLength = digest->state.icsf.hashLength;
+    break;
+#endif
+  case DATASET_DIGEST_SHA1:
+    sha1Init(&digest->state.sha1);
+    digest->hashLength = 20;
+    break;
+  case DATASET_DIGEST_XXHASH64:
+    xxh64Init(&digest->state.xxh64);
+    digest->hashLength = 8;
+    break;
+  default:
+    digest->rc = DATASET_DIGEST_RC_UNSUPPORTED;
+  }
+  return digest->rc;
+}
+
+int datasetDigestUpdate(DatasetDigest *digest, const char *data, int length) {
+  if (digest->rc || length <= 0) {
+    return digest->rc;
+  }
+  if (digest->batch == NULL) {
+    digest->rc = backendUpdate(digest, data, length);
+    return digest->rc;
+  }
+  if (digest->batchUsed + length > digest->batchSize) {
+    if (flushBatch(digest)) {
+      return digest->rc;
+    }
+    if (length >= digest->batchSize) {
+      /* nothing to gain from copying data that fills a batch on its own */
+      digest->rc = backendUpdate(digest, data, length);
+      return digest->rc;
+    }
+  }
+  memcpy(digest->batch + digest->batchUsed, data, length);
+  digest->batchUsed += length;
+  return DATASET_DIGEST_RC_OK;
+}
+
+int datasetDigestFinish(DatasetDigest *digest, char *hash) {
+  if (digest->batch && flushBatch(digest)) {
+    return digest->rc;
+  }
+  if (digest->rc) {
+    return digest->rc;
+  }
+  switch (digest->type) {
+#ifdef __ZOWE_OS_ZOS
+  case DATASET_DIGEST_ICSF_SHA1:
+    digest->rc = icsfDigestFinish(&digest->state.icsf, hash);
+    break;
+#endif
+  case DATASET_DIGEST_SHA1:
+    sha1Finish(&digest->state.sha1, hash);
+    break;
+  case DATASET_DIGEST_XXHASH64:
+    xxh64Finish(&digest->state.xxh64, hash);
+    break;
+  default:
+    digest->rc = DATASET_DIGEST_RC_UNSUPPORTED;
+  }
+  return digest->rc;
+}
+
+int datasetDigestFinishHex(DatasetDigest *digest, char *hex) {
+  char hash[DATASET_DIGEST_MAX_HASH_LENGTH];
+  static const char hexDigits[] = "0123456789abcdef";
+  int rc = datasetDigestFinish(digest, hash);
+  if (rc) {
+    return rc;
+  }
+  for (int i = 0; i < digest->hashLength; i++) {
+    hex[i * 2] = hexDigits[(hash[i] >> 4) & 0xF];
+    hex[i * 2 + 1] = hexDigits[hash[i] & 0xF];
+  }
+  hex[digest->hashLength * 2] = '\0';
+  return DATASET_DIGEST_RC_OK;
+}
+
+int getDatasetDigestType(const char *name) {
+#ifdef __ZOWE_OS_ZOS
+  if (!strcmp(name, "icsf-sha1")) {
+    return DATASET_DIGEST_ICSF_SHA1;
+  }
+#endif
+  if (!strcmp(name, "sha1")) {
+    return DATASET_DIGEST_SHA1;
+  }
+  if (!strcmp(name, "xxhash64")) {
+    return DATASET_DIGEST_XXHASH64;
+  }
+  return 0;
+}
+
+const char *getDatasetDigestName(int type) {
+  switch (type) {
+  case DATASET_DIGEST_ICSF_SHA1:
+    return "icsf-sha1";
+  case DATASET_DIGEST_SHA1:
+    return "sha1";
+  case DATASET_DIGEST_XXHASH64:
+    return "xxhash64";
+  default:
+    return "unknown";
+  }
+}
+
+void setDefaultDatasetDigestType(int type) {
+  defaultDigestType = type;
+}
+
+int getDefaultDatasetDigestType(void) {
+  return defaultDigestType;
+}
+
+
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
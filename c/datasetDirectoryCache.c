@@ -0,0 +1,282 @@
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "zowetypes.h"
+#include "alloc.h"
+
+#include "datasetDirectoryCache.h"
+
+#define DIRECTORY_INITIAL_CAPACITY 64
+
+PDSDirectoryCache *makePDSDirectoryCache(int maxEntries, int64 maxBytes, int ttlSeconds) {
+  PDSDirectoryCache *cache = (PDSDirectoryCache *)safeMalloc(sizeof(PDSDirectoryCache), "PDSDirectoryCache");
+  memset(cache, 0, sizeof(PDSDirectoryCache));
+  cache->maxEntries = maxEntries > 0 ? maxEntries : 1;
+  cache->maxBytes = maxBytes > 0 ? maxBytes : 0;
+  cache->ttlSeconds = ttlSeconds > 0 ? ttlSeconds : 0;
+  int directoriesSize = sizeof(PDSDirectory *) * cache->maxEntries;
+  cache->directories = (PDSDirectory **)safeMalloc(directoriesSize, "PDSDirectory table");
+  memset(cache->directories, 0, directoriesSize);
+  pthread_mutex_init(&cache->lock, NULL);
+  return cache;
+}
+
+static int getDirectorySize(int capacity) {
+  return sizeof(PDSDirectory) + capacity * sizeof(PDSMemberEntry);
+}
+
+static void resizeMembers(PDSDirectory *directory, int capacity) {
+  PDSMemberEntry *members = (PDSMemberEntry *)safeMalloc(capacity * sizeof(PDSMemberEntry), "PDSMemberEntries");
+  memcpy(members, directory->members, directory->memberCount * sizeof(PDSMemberEntry));
+  safeFree((char *)directory->members, directory->capacity * sizeof(PDSMemberEntry));
+  directory->members = members;
+  directory->capacity = capacity;
+  directory->size = getDirectorySize(capacity);
+}
+
+PDSDirectory *makePDSDirectory(const char *dsn, const char *user,
+                               const DatasetChangeIndicators *indicators, int capacity) {
+  if (capacity < 1) {
+    capacity = DIRECTORY_INITIAL_CAPACITY;
+  }
+  PDSDirectory *directory = (PDSDirectory *)safeMalloc(sizeof(PDSDirectory), "PDSDirectory");
+  memset(directory, 0, sizeof(PDSDirectory));
+  memcpy(directory->dsn, dsn, sizeof(directory->dsn));
+  snprintf(directory->user, sizeof(directory->user), "%s", user ? user : "");
+  directory->indicators = *indicators;
+  directory->members = (PDSMemberEntry *)safeMalloc(capacity * sizeof(PDSMemberEntry), "PDSMemberEntries");
+  directory->capacity = capacity;
+  directory->size = getDirectorySize(capacity);
+  directory->refCount = 1;
+  return directory;
+}
+
+static void freePDSDirectory(PDSDirectory *directory) {
+  safeFree((char *)directory->members, directory->capacity * sizeof(PDSMemberEntry));
+  safeFree((char *)directory, sizeof(PDSDirectory));
+}
+
+void addPDSMember(PDSDirectory *directory, const char *name, const char *data, int dataLength) {
+  if (directory->memberCount == directory->capacity) {
+    resizeMembers(directory, directory->capacity * 2);
+  }
+  if (dataLength > DIRECTORY_CACHE_MAX_ENTRY_DATA) {
+    dataLength = DIRECTORY_CACHE_MAX_ENTRY_DATA;
+  }
+  PDSMemberEntry *member = &directory->members[directory->memberCount++];
+  memcpy(member->name, name, sizeof(member->name));
+  member->dataLength = (unsigned char)dataLength;
+  memcpy(member->data, data, dataLength);
+}
+
+static bool isExpired(const PDSDirectoryCache *cache, const PDSDirectory *directory, time_t now) {
+  return now - directory->storedTime >= cache->ttlSeconds;
+}
+
+/* Must be called with the lock held. A directory still being written out is
+   freed by its last release. */
+static void removeDirectory(PDSDirectoryCache *cache, int index) {
+  PDSDirectory *directory = cache->directories[index];
+  cache->bytesUsed -= directory->size;
+  directory->cached = false;
+  if (directory->refCount == 0) {
+    freePDSDirectory(directory);
+  }
+  memmove(&cache->directories[index], &cache->directories[index + 1],
+          (cache->directoryCount - index - 1) * sizeof(PDSDirectory *));
+  cache->directoryCount--;
+}
+
+static int findDirectory(PDSDirectoryCache *cache, const char *dsn, const char *user) {
+  for (int i = 0; i < cache->directoryCount; i++) {
+    if (!memcmp(cache->directories[i]->dsn, dsn, DIRECTORY_CACHE_DSN_LENGTH) &&
+        !strcmp(cache->directories[i]->user, user)) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static bool isSameIndicators(const DatasetChangeIndicators *a, const DatasetChangeIndicators *b) {
+  return a->length == b->length && !memcmp(a->data, b->data, a->length);
+}
+
+PDSDirectory *lookupPDSDirectory(PDSDirectoryCache *cache, const char *dsn, const char *user,
+                                 const DatasetChangeIndicators *indicators) {
+  PDSDirectory *found = NULL;
+  pthread_mutex_lock(&cache->lock);
+  {
+    int index = findDirectory(cache, dsn, user ? user : "");
+    if (index >= 0) {
+      PDSDirectory *directory = cache->directories[index];
+      if (isExpired(cache, directory, time(NULL))) {
+        removeDirectory(cache, index);
+        cache->stats.expirations++;
+      } else if (!isSameIndicators(&directory->indicators, indicators)) {
+        removeDirectory(cache, index);
+        cache->stats.changes++;
+      } else {
+        directory->refCount++;
+        directory->lastUsed = ++cache->clock;
+        found = directory;
+      }
+    }
+    if (found) {
+      cache->stats.hits++;
+    } else {
+      cache->stats.misses++;
+    }
+  }
+  pthread_mutex_unlock(&cache->lock);
+  return found;
+}
+
+static void removeLeastRecentlyUsed(PDSDirectoryCache *cache) {
+  int oldest = 0;
+  for (int i = 1; i < cache->directoryCount; i++) {
+    if (cache->directories[i]->lastUsed < cache->directories[oldest]->lastUsed) {
+      oldest = i;
+    }
+  }
+  removeDirectory(cache, oldest);
+  cache->stats.evictions++;
+}
+
+void storePDSDirectory(PDSDirectoryCache *cache, PDSDirectory *directory) {
+  if (directory->cached) {
+    return;
+  }
+  /* nobody else has the directory yet, so it can still move */
+  if (directory->capacity > directory->memberCount && directory->memberCount > 0) {
+    resizeMembers(directory, directory->memberCount);
+  }
+  if (directory->size > cache->maxBytes) {
+    return;
+  }
+  pthread_mutex_lock(&cache->lock);
+  {
+    time_t now = time(NULL);
+    int index = findDirectory(cache, directory->dsn, directory->user);
+    if (index >= 0) {
+      removeDirectory(cache, index);
+    }
+    for (int i = 0; i < cache->directoryCount; ) {
+      if (isExpired(cache, cache->directories[i], now)) {
+        removeDirectory(cache, i);
+        cache->stats.expirations++;
+      } else {
+        i++;
+      }
+    }
+    while (cache->directoryCount > 0 &&
+           (cache->directoryCount >= cache->maxEntries ||
+            cache->bytesUsed + directory->size > cache->maxBytes)) {
+      removeLeastRecentlyUsed(cache);
+    }
+    directory->cached = true;
+    directory->storedTime = now;
+    directory->lastUsed = ++cache->clock;
+    cache->directories[cache->directoryCount++] = directory;
+    cache->bytesUsed += directory->size;
+    cache->stats.stores++;
+  }
+  pthread_mutex_unlock(&cache->lock);
+}
+
+void releasePDSDirectory(PDSDirectoryCache *cache, PDSDirectory *directory) {
+  if (cache == NULL) {
+    if (--directory->refCount == 0 && !directory->cached) {
+      freePDSDirectory(directory);
+    }
+    return;
+  }
+  pthread_mutex_lock(&cache->lock);
+  {
+    if (--directory->refCount == 0 && !directory->cached) {
+      freePDSDirectory(directory);
+    }
+  }
+  pthread_mutex_unlock(&cache->lock);
+}
+
+void invalidatePDSDirectory(PDSDirectoryCache *cache, const char *dsn) {
+  pthread_mutex_lock(&cache->lock);
+  {
+    for (int i = 0; i < cache->directoryCount; ) {
+      if (!memcmp(cache->directories[i]->dsn, dsn, DIRECTORY_CACHE_DSN_LENGTH)) {
+        removeDirectory(cache, i);
+        cache->stats.invalidations++;
+      } else {
+        i++;
+      }
+    }
+  }
+  pthread_mutex_unlock(&cache->lock);
+}
+
+/* The first member whose name compared over length characters is not below
+   key, or above it when after is set */
+static int findBound(const PDSDirectory *directory, const char *key, int length, bool after) {
+  int low = 0;
+  int high = directory->memberCount;
+  while (low < high) {
+    int middle = (low + high) / 2;
+    int order = memcmp(directory->members[middle].name, key, length);
+    if (order < 0 || (after && order == 0)) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return low;
+}
+
+void findPDSMemberRange(const PDSDirectory *directory, const char *prefix, int prefixLength,
+                        const char *from, int *first, int *end) {
+  if (prefixLength > DIRECTORY_CACHE_MEMBER_LENGTH) {
+    prefixLength = DIRECTORY_CACHE_MEMBER_LENGTH;
+  }
+  *first = findBound(directory, prefix, prefixLength, false);
+  *end = findBound(directory, prefix, prefixLength, true);
+  if (from) {
+    int fromIndex = findBound(directory, from, DIRECTORY_CACHE_MEMBER_LENGTH, false);
+    if (fromIndex > *first) {
+      *first = fromIndex < *end ? fromIndex : *end;
+    }
+  }
+}
+
+void getPDSDirectoryCacheStats(PDSDirectoryCache *cache, PDSDirectoryCacheStats *stats) {
+  pthread_mutex_lock(&cache->lock);
+  {
+    *stats = cache->stats;
+    stats->entries = cache->directoryCount;
+    stats->bytes = cache->bytesUsed;
+  }
+  pthread_mutex_unlock(&cache->lock);
+}
+
+
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
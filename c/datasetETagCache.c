@@ -0,0 +1,178 @@
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "zowetypes.h"
+#include "alloc.h"
+#include "utils.h"
+
+#include "datasetETagCache.h"
+
+DatasetETagCache *makeDatasetETagCache(int maxEntries) {
+  DatasetETagCache *cache = (DatasetETagCache *)safeMalloc(sizeof(DatasetETagCache), "DatasetETagCache");
+  memset(cache, 0, sizeof(DatasetETagCache));
+  cache->setCount = (maxEntries + ETAG_CACHE_WAYS - 1) / ETAG_CACHE_WAYS;
+  if (cache->setCount < 1) {
+    cache->setCount = 1;
+  }
+  int entriesSize = sizeof(DatasetETagEntry) * cache->setCount * ETAG_CACHE_WAYS;
+  cache->entries = (DatasetETagEntry *)safeMalloc(entriesSize, "DatasetETagEntry entries");
+  memset(cache->entries, 0, entriesSize);
+  pthread_mutex_init(&cache->lock, NULL);
+  return cache;
+}
+
+void freeDatasetETagCache(DatasetETagCache *cache) {
+  if (cache == NULL) {
+    return;
+  }
+  safeFree((char *)cache->entries, sizeof(DatasetETagEntry) * cache->setCount * ETAG_CACHE_WAYS);
+  pthread_mutex_destroy(&cache->lock);
+  safeFree((char *)cache, sizeof(DatasetETagCache));
+}
+
+/* FNV-1a over the space padded names */
+static DatasetETagEntry *getSet(DatasetETagCache *cache, const char *dsn, const char *member) {
+  unsigned int hash = 2166136261u;
+  for (int i = 0; i < ETAG_CACHE_DSN_LENGTH; i++) {
+    hash = (hash ^ (unsigned char)dsn[i]) * 16777619u;
+  }
+  for (int i = 0; i < ETAG_CACHE_MEMBER_LENGTH; i++) {
+    hash = (hash ^ (unsigned char)member[i]) * 16777619u;
+  }
+  return &cache->entries[(hash % cache->setCount) * ETAG_CACHE_WAYS];
+}
+
+static bool isSameName(const DatasetETagEntry *entry, const char *dsn, const char *member) {
+  return !memcmp(entry->dsn, dsn, ETAG_CACHE_DSN_LENGTH) &&
+         !memcmp(entry->member, member, ETAG_CACHE_MEMBER_LENGTH);
+}
+
+static bool isSameIndicators(const DatasetChangeIndicators *a, const DatasetChangeIndicators *b) {
+  return a->length == b->length && !memcmp(a->data, b->data, a->length);
+}
+
+bool lookupDatasetETag(DatasetETagCache *cache, const char *dsn, const char *member,
+                       const DatasetChangeIndicators *indicators, char *eTag) {
+  bool found = false;
+  pthread_mutex_lock(&cache->lock);
+  {
+    DatasetETagEntry *set = getSet(cache, dsn, member);
+    for (int i = 0; i < ETAG_CACHE_WAYS; i++) {
+      DatasetETagEntry *entry = &set[i];
+      if (entry->valid && isSameName(entry, dsn, member)) {
+        if (isSameIndicators(&entry->indicators, indicators)) {
+          strcpy(eTag, entry->eTag);
+          entry->lastUsed = ++cache->clock;
+          found = true;
+        } else {
+          /* the dataset changed since, the entry is of no further use */
+          entry->valid = false;
+        }
+        break;
+      }
+    }
+    if (found) {
+      cache->stats.hits++;
+    } else {
+      cache->stats.misses++;
+    }
+  }
+  pthread_mutex_unlock(&cache->lock);
+  return found;
+}
+
+void storeDatasetETag(DatasetETagCache *cache, const char *dsn, const char *member,
+                      const DatasetChangeIndicators *indicators, const char *eTag) {
+  if (indicators->length <= 0 || indicators->length > ETAG_CACHE_MAX_INDICATORS ||
+      strlen(eTag) > ETAG_CACHE_MAX_ETAG_LENGTH) {
+    return;
+  }
+  pthread_mutex_lock(&cache->lock);
+  {
+    DatasetETagEntry *set = getSet(cache, dsn, member);
+    DatasetETagEntry *slot = NULL;
+    for (int i = 0; i < ETAG_CACHE_WAYS; i++) {
+      DatasetETagEntry *entry = &set[i];
+      if (entry->valid && isSameName(entry, dsn, member)) {
+        slot = entry;
+        break;
+      }
+      if (slot == NULL || (slot->valid && (!entry->valid || entry->lastUsed < slot->lastUsed))) {
+        slot = entry;
+      }
+    }
+    memcpy(slot->dsn, dsn, ETAG_CACHE_DSN_LENGTH);
+    memcpy(slot->member, member, ETAG_CACHE_MEMBER_LENGTH);
+    slot->indicators = *indicators;
+    strcpy(slot->eTag, eTag);
+    slot->lastUsed = ++cache->clock;
+    slot->valid = true;
+    cache->stats.stores++;
+  }
+  pthread_mutex_unlock(&cache->lock);
+}
+
+void invalidateDatasetETag(DatasetETagCache *cache, const char *dsn, const char *member) {
+  pthread_mutex_lock(&cache->lock);
+  {
+    if (member) {
+      DatasetETagEntry *set = getSet(cache, dsn, member);
+      for (int i = 0; i < ETAG_CACHE_WAYS; i++) {
+        if (set[i].valid && isSameName(&set[i], dsn, member)) {
+          set[i].valid = false;
+          cache->stats.invalidations++;
+        }
+      }
+    } else {
+      /* members of a dataset are spread over all sets */
+      int entryCount = cache->setCount * ETAG_CACHE_WAYS;
+      for (int i = 0; i < entryCount; i++) {
+        DatasetETagEntry *entry = &cache->entries[i];
+        if (entry->valid && !memcmp(entry->dsn, dsn, ETAG_CACHE_DSN_LENGTH)) {
+          entry->valid = false;
+          cache->stats.invalidations++;
+        }
+      }
+    }
+  }
+  pthread_mutex_unlock(&cache->lock);
+}
+
+void getDatasetETagCacheStats(DatasetETagCache *cache, DatasetETagCacheStats *stats) {
+  pthread_mutex_lock(&cache->lock);
+  {
+    *stats = cache->stats;
+    stats->entries = 0;
+    int entryCount = cache->setCount * ETAG_CACHE_WAYS;
+    for (int i = 0; i < entryCount; i++) {
+      if (cache->entries[i].valid) {
+        stats->entries++;
+      }
+    }
+  }
+  pthread_mutex_unlock(&cache->lock);
+}
+
+
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
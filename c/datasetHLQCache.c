@@ -0,0 +1,309 @@
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "zowetypes.h"
+#include "alloc.h"
+#include "logging.h"
+#include "scheduling.h"
+
+#include "datasetCSICache.h"
+#include "datasetHLQCache.h"
+
+const char hlqCacheFirstChars[HLQ_CACHE_BUCKET_COUNT] = {
+  'A','B','C','D','E','F','G','H','I','J','K','L','M','N','O','P','Q','R','S','T','U','V','W','X','Y','Z','$','@','#'
+};
+
+HLQCache *makeHLQCache(HLQSearch *search, void *searchData, int ttlSeconds, int searchWorkers) {
+  HLQCache *cache = (HLQCache *)safeMalloc(sizeof(HLQCache), "HLQCache");
+  memset(cache, 0, sizeof(HLQCache));
+  cache->search = search;
+  cache->searchData = searchData;
+  cache->ttlSeconds = ttlSeconds > 0 ? ttlSeconds : 0;
+  if (searchWorkers < 0) {
+    searchWorkers = 0;
+  } else if (searchWorkers > HLQ_CACHE_MAX_SEARCH_WORKERS) {
+    searchWorkers = HLQ_CACHE_MAX_SEARCH_WORKERS;
+  }
+  cache->searchWorkers = searchWorkers;
+  pthread_mutex_init(&cache->lock, NULL);
+  pthread_cond_init(&cache->refreshQueued, NULL);
+  return cache;
+}
+
+/* Buckets hold one reference for the cache and one for every reader, and are
+   only referenced and released with the lock held */
+static void releaseBucket(CSIQueryResult *bucket) {
+  if (bucket) {
+    releaseCSIQueryResult(NULL, bucket);
+  }
+}
+
+static void publishBucket(HLQCache *cache, int index, CSIQueryResult *bucket, time_t now) {
+  releaseBucket(cache->buckets[index]);
+  cache->buckets[index] = bucket;
+  cache->refreshedTime[index] = now;
+}
+
+static void fillSnapshot(HLQCache *cache, HLQSnapshot *snapshot) {
+  for (int i = 0; i < HLQ_CACHE_BUCKET_COUNT; i++) {
+    CSIQueryResult *bucket = cache->buckets[i];
+    if (bucket) {
+      bucket->refCount++;
+    }
+    snapshot->buckets[i] = bucket;
+  }
+}
+
+static bool isBuiltFor(const HLQCache *cache, const char *types, int workAreaSize) {
+  return cache->built && cache->workAreaSize == workAreaSize && !strcmp(cache->types, types);
+}
+
+bool acquireHLQSnapshot(HLQCache *cache, const char *user, const char *types, int workAreaSize,
+                        HLQSnapshot *snapshot) {
+  bool found = false;
+  pthread_mutex_lock(&cache->lock);
+  {
+    if (isBuiltFor(cache, types, workAreaSize)) {
+      time_t now = time(NULL);
+      bool stale = false;
+      for (int i = 0; i < HLQ_CACHE_BUCKET_COUNT; i++) {
+        if (cache->ttlSeconds == 0 || now - cache->refreshedTime[i] < cache->ttlSeconds) {
+          continue;
+        }
+        stale = true;
+        /* a refresh runs as a user, so a read without one leaves it stale */
+        if (cache->refresherRunning && !cache->refreshPending[i] && user && user[0]) {
+          cache->refreshPending[i] = true;
+          snprintf(cache->refreshUser[i], sizeof(cache->refreshUser[i]), "%s", user);
+          cache->stats.pendingRefreshes++;
+          pthread_cond_signal(&cache->refreshQueued);
+        }
+      }
+      fillSnapshot(cache, snapshot);
+      found = true;
+      if (stale) {
+        cache->stats.staleHits++;
+      } else {
+        cache->stats.hits++;
+      }
+    } else {
+      cache->stats.misses++;
+    }
+  }
+  pthread_mutex_unlock(&cache->lock);
+  return found;
+}
+
+/* The searches of one rebuild, which the threads take in order */
+typedef struct HLQFanOut_tag {
+  HLQCache *cache;
+  const char *user;
+  const char *types;
+  int workAreaSize;
+  pthread_mutex_t lock;
+  int nextBucket;
+  CSIQueryResult **buckets;
+} HLQFanOut;
+
+typedef struct HLQSearcher_tag {
+  HLQFanOut *fanOut;
+  const char *user;                  /* NULL on the rebuilding thread */
+} HLQSearcher;
+
+static void *searchBuckets(void *data) {
+  HLQSearcher *searcher = (HLQSearcher *)data;
+  HLQFanOut *fanOut = searcher->fanOut;
+  HLQCache *cache = fanOut->cache;
+  while (true) {
+    pthread_mutex_lock(&fanOut->lock);
+    int index = fanOut->nextBucket++;
+    pthread_mutex_unlock(&fanOut->lock);
+    if (index >= HLQ_CACHE_BUCKET_COUNT) {
+      break;
+    }
+    /* each thread writes only the buckets it took */
+    fanOut->buckets[index] = cache->search(cache->searchData, searcher->user,
+                                           hlqCacheFirstChars[index],
+                                           fanOut->types, fanOut->workAreaSize);
+  }
+  return NULL;
+}
+
+static void searchAllBuckets(HLQCache *cache, const char *user, const char *types,
+                             int workAreaSize, CSIQueryResult **buckets) {
+  HLQFanOut fanOut = {
+    .cache = cache,
+    .user = user,
+    .types = types,
+    .workAreaSize = workAreaSize,
+    .nextBucket = 0,
+    .buckets = buckets
+  };
+  pthread_mutex_init(&fanOut.lock, NULL);
+  pthread_t workers[HLQ_CACHE_MAX_SEARCH_WORKERS];
+  HLQSearcher workerSearcher = {.fanOut = &fanOut, .user = user};
+  int workersStarted = 0;
+  for (int i = 0; i < cache->searchWorkers; i++) {
+    if (pthread_create(&workers[workersStarted], NULL, searchBuckets, &workerSearcher) != 0) {
+      zowelog(NULL, LOG_COMP_DATASERVICE, ZOWE_LOG_DEBUG,
+              "HLQ search started %d of %d workers\n", workersStarted, cache->searchWorkers);
+      break;
+    }
+    workersStarted++;
+  }
+  HLQSearcher ownSearcher = {.fanOut = &fanOut, .user = NULL};
+  searchBuckets(&ownSearcher);
+  for (int i = 0; i < workersStarted; i++) {
+    pthread_join(workers[i], NULL);
+  }
+  pthread_mutex_destroy(&fanOut.lock);
+}
+
+void rebuildHLQCache(HLQCache *cache, const char *user, const char *types, int workAreaSize,
+                     HLQSnapshot *snapshot) {
+  CSIQueryResult *buckets[HLQ_CACHE_BUCKET_COUNT];
+  searchAllBuckets(cache, user, types, workAreaSize, buckets);
+  pthread_mutex_lock(&cache->lock);
+  {
+    time_t now = time(NULL);
+    bool sameSearch = isBuiltFor(cache, types, workAreaSize);
+    if (!sameSearch) {
+      snprintf(cache->types, sizeof(cache->types), "%s", types);
+      cache->workAreaSize = workAreaSize;
+      cache->generation++;
+      cache->built = true;
+    }
+    for (int i = 0; i < HLQ_CACHE_BUCKET_COUNT; i++) {
+      if (buckets[i]) {
+        publishBucket(cache, i, buckets[i], now);
+      } else if (!sameSearch) {
+        publishBucket(cache, i, NULL, now);
+      }
+    }
+    fillSnapshot(cache, snapshot);
+  }
+  pthread_mutex_unlock(&cache->lock);
+}
+
+void releaseHLQSnapshot(HLQCache *cache, HLQSnapshot *snapshot) {
+  pthread_mutex_lock(&cache->lock);
+  {
+    for (int i = 0; i < HLQ_CACHE_BUCKET_COUNT; i++) {
+      releaseBucket(snapshot->buckets[i]);
+      snapshot->buckets[i] = NULL;
+    }
+  }
+  pthread_mutex_unlock(&cache->lock);
+}
+
+typedef struct HLQRefresh_tag {
+  int index;
+  char user[HLQ_CACHE_USER_LENGTH + 1];
+  char types[CSI_CACHE_TYPES_LENGTH + 1];
+  int workAreaSize;
+  uint64 generation;
+} HLQRefresh;
+
+static void takeRefresh(HLQCache *cache, HLQRefresh *refresh) {
+  pthread_mutex_lock(&cache->lock);
+  while (cache->stats.pendingRefreshes == 0) {
+    pthread_cond_wait(&cache->refreshQueued, &cache->lock);
+  }
+  for (int i = 0; i < HLQ_CACHE_BUCKET_COUNT; i++) {
+    if (cache->refreshPending[i]) {
+      refresh->index = i;
+      memcpy(refresh->user, cache->refreshUser[i], sizeof(refresh->user));
+      memcpy(refresh->types, cache->types, sizeof(refresh->types));
+      refresh->workAreaSize = cache->workAreaSize;
+      refresh->generation = cache->generation;
+      break;
+    }
+  }
+  pthread_mutex_unlock(&cache->lock);
+}
+
+static void refreshBucket(HLQCache *cache, const HLQRefresh *refresh) {
+  CSIQueryResult *bucket = cache->search(cache->searchData, refresh->user,
+                                         hlqCacheFirstChars[refresh->index],
+                                         refresh->types, refresh->workAreaSize);
+  pthread_mutex_lock(&cache->lock);
+  {
+    time_t now = time(NULL);
+    cache->refreshPending[refresh->index] = false;
+    cache->stats.pendingRefreshes--;
+    if (bucket == NULL) {
+      /* tried again once the bucket is stale again */
+      cache->refreshedTime[refresh->index] = now;
+      cache->stats.refreshFailures++;
+    } else if (refresh->generation != cache->generation) {
+      /* rebuilt for other types meanwhile */
+      releaseBucket(bucket);
+    } else {
+      publishBucket(cache, refresh->index, bucket, now);
+      cache->stats.refreshes++;
+    }
+  }
+  pthread_mutex_unlock(&cache->lock);
+  if (bucket == NULL) {
+    zowelog(NULL, LOG_COMP_DATASERVICE, ZOWE_LOG_DEBUG, "HLQ refresh of '%c' failed\n",
+            hlqCacheFirstChars[refresh->index]);
+  }
+}
+
+static int hlqCacheRefresherMain(RLETask *task) {
+  HLQCache *cache = (HLQCache *)task->userPointer;
+  while (true) {
+    HLQRefresh refresh;
+    takeRefresh(cache, &refresh);
+    refreshBucket(cache, &refresh);
+  }
+  return 0;
+}
+
+bool startHLQCacheRefresher(HLQCache *cache, RLEAnchor *anchor) {
+  if (cache->ttlSeconds == 0) {
+    return false;
+  }
+  RLETask *task = makeRLETask(anchor, RLE_TASK_TCB_CAPABLE | RLE_TASK_DISPOSABLE, hlqCacheRefresherMain);
+  if (!task) {
+    zowelog(NULL, LOG_COMP_DATASERVICE, ZOWE_LOG_WARNING, "failed to create HLQ refresh task\n");
+    return false;
+  }
+  task->userPointer = cache;
+  pthread_mutex_lock(&cache->lock);
+  cache->refresherRunning = true;
+  pthread_mutex_unlock(&cache->lock);
+  startRLETask(task, NULL);
+  return true;
+}
+
+void getHLQCacheStats(HLQCache *cache, HLQCacheStats *stats) {
+  pthread_mutex_lock(&cache->lock);
+  *stats = cache->stats;
+  pthread_mutex_unlock(&cache->lock);
+}
+
+
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
@@ -0,0 +1,70 @@
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "datasetRecordFormat.h"
+
+#define WORD_ONES  0x0101010101010101ULL
+#define WORD_HIGHS 0x8080808080808080ULL
+
+/* Non-zero when a byte of the word is over DATASET_RECORD_BLANK_MAX. Bytes
+   up to it stay below X'80' when it is added to X'7F' less it, the others
+   either get there or already were; a carry only ever comes out of a byte
+   that is flagged itself. Byte order does not matter. */
+static uint64_t hasNonBlank(uint64_t word) {
+  return ((word + WORD_ONES * (0x7F - DATASET_RECORD_BLANK_MAX)) | word) & WORD_HIGHS;
+}
+
+int findDatasetRecordOverflow(const char *record, int length, int lrecl) {
+  int i = lrecl;
+  for (; i + (int)sizeof(uint64_t) <= length; i += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, record + i, sizeof(word));
+    if (hasNonBlank(word)) {
+      break;
+    }
+  }
+  for (; i < length; i++) {
+    if ((unsigned char)record[i] > DATASET_RECORD_BLANK_MAX) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+const char *formatDatasetRecord(const char *record, int length, int lrecl, bool fixed,
+                                char pad, char *buffer, int *outLength) {
+  if (length >= lrecl) {
+    *outLength = lrecl;
+    return record;
+  }
+  if (!fixed) {
+    *outLength = length;
+    return record;
+  }
+  memcpy(buffer, record, length);
+  memset(buffer + length, pad, lrecl - length);
+  *outLength = lrecl;
+  return buffer;
+}
+
+
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
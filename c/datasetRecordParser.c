@@ -0,0 +1,649 @@
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "zowetypes.h"
+#include "alloc.h"
+
+#include "datasetRecordParser.h"
+
+/* The input is UTF-8 whatever the code page this is compiled in, so JSON
+   syntax is matched by value and not with character literals. */
+#define U8_QUOTE      0x22
+#define U8_PLUS       0x2B
+#define U8_COMMA      0x2C
+#define U8_MINUS      0x2D
+#define U8_PERIOD     0x2E
+#define U8_SLASH      0x2F
+#define U8_0          0x30
+#define U8_9          0x39
+#define U8_COLON      0x3A
+#define U8_UPPER_A    0x41
+#define U8_UPPER_E    0x45
+#define U8_UPPER_F    0x46
+#define U8_LBRACKET   0x5B
+#define U8_BACKSLASH  0x5C
+#define U8_RBRACKET   0x5D
+#define U8_LOWER_A    0x61
+#define U8_LOWER_B    0x62
+#define U8_LOWER_E    0x65
+#define U8_LOWER_F    0x66
+#define U8_LOWER_N    0x6E
+#define U8_LOWER_R    0x72
+#define U8_LOWER_T    0x74
+#define U8_LOWER_U    0x75
+#define U8_LOWER_Z    0x7A
+#define U8_LBRACE     0x7B
+#define U8_RBRACE     0x7D
+
+static const char U8_RECORDS[] = {0x72, 0x65, 0x63, 0x6F, 0x72, 0x64, 0x73, 0x00};
+static const char U8_TRUE[]    = {0x74, 0x72, 0x75, 0x65, 0x00};
+static const char U8_FALSE[]   = {0x66, 0x61, 0x6C, 0x73, 0x65, 0x00};
+static const char U8_NULL[]    = {0x6E, 0x75, 0x6C, 0x6C, 0x00};
+
+#define TOKEN_NONE    0
+#define TOKEN_STRING  1
+#define TOKEN_ESCAPE  2
+#define TOKEN_UNICODE 3
+#define TOKEN_LITERAL 4
+
+#define CONTAINER_OBJECT 'o'
+#define CONTAINER_ARRAY  'a'
+#define VALUE_STRING     's'
+#define VALUE_LITERAL    'l'
+
+#define EXPECT_VALUE         1
+#define EXPECT_VALUE_OR_END  2 /* just after [ */
+#define EXPECT_KEY           3
+#define EXPECT_KEY_OR_END    4 /* just after { */
+#define EXPECT_COLON         5
+#define EXPECT_COMMA_OR_END  6
+
+#define STRING_INITIAL_CAPACITY 256
+
+void initJsonRecordParser(JsonRecordParser *parser, int maxStringLength,
+                          JsonRecordHandler *recordHandler,
+                          JsonPropertyHandler *propertyHandler,
+                          void *userData) {
+  memset(parser, 0, sizeof(JsonRecordParser));
+  parser->maxStringLength = maxStringLength;
+  parser->recordHandler = recordHandler;
+  parser->propertyHandler = propertyHandler;
+  parser->userData = userData;
+  parser->errorIndex = -1;
+  parser->field = -1;
+}
+
+void setJsonRecordParserFields(JsonRecordParser *parser, const char **names, int count,
+                               JsonRecordFieldsHandler *handler) {
+  if (count > RECORD_PARSER_MAX_FIELDS) {
+    count = RECORD_PARSER_MAX_FIELDS;
+  }
+  for (int i = 0; i < count; i++) {
+    parser->fieldNames[i] = names[i];
+  }
+  parser->fieldCount = count;
+  parser->fieldsHandler = handler;
+}
+
+void termJsonRecordParser(JsonRecordParser *parser) {
+  if (parser->string) {
+    safeFree(parser->string, parser->stringCapacity);
+    parser->string = NULL;
+    parser->stringCapacity = 0;
+  }
+  for (int i = 0; i < parser->fieldCount; i++) {
+    if (parser->fieldValues[i]) {
+      safeFree(parser->fieldValues[i], parser->fieldCapacities[i]);
+      parser->fieldValues[i] = NULL;
+      parser->fieldCapacities[i] = 0;
+    }
+  }
+}
+
+static int fail(JsonRecordParser *parser, int rc) {
+  if (parser->rc == RECORD_PARSER_RC_OK) {
+    parser->rc = rc;
+    parser->errorOffset = parser->offset;
+  }
+  return parser->rc;
+}
+
+static bool isWhitespace(unsigned char c) {
+  return c == 0x20 || c == 0x09 || c == 0x0A || c == 0x0D;
+}
+
+static bool isLiteralChar(unsigned char c) {
+  return (c >= U8_LOWER_A && c <= U8_LOWER_Z) || (c >= U8_0 && c <= U8_9) ||
+         c == U8_PLUS || c == U8_MINUS || c == U8_PERIOD || c == U8_UPPER_E;
+}
+
+static bool isValidNumber(const char *text, int length) {
+  int i = 0;
+  if (i < length && text[i] == U8_MINUS) {
+    i++;
+  }
+  int digits = 0;
+  while (i < length && text[i] >= U8_0 && text[i] <= U8_9) {
+    i++;
+    digits++;
+  }
+  if (digits == 0) {
+    return false;
+  }
+  if (i < length && text[i] == U8_PERIOD) {
+    i++;
+    digits = 0;
+    while (i < length && text[i] >= U8_0 && text[i] <= U8_9) {
+      i++;
+      digits++;
+    }
+    if (digits == 0) {
+      return false;
+    }
+  }
+  if (i < length && (text[i] == U8_LOWER_E || text[i] == U8_UPPER_E)) {
+    i++;
+    if (i < length && (text[i] == U8_PLUS || text[i] == U8_MINUS)) {
+      i++;
+    }
+    digits = 0;
+    while (i < length && text[i] >= U8_0 && text[i] <= U8_9) {
+      i++;
+      digits++;
+    }
+    if (digits == 0) {
+      return false;
+    }
+  }
+  return i == length;
+}
+
+static int appendToString(JsonRecordParser *parser, const char *data, int length) {
+  if (!parser->keepString) {
+    return RECORD_PARSER_RC_OK;
+  }
+  if (parser->stringLength + length > parser->maxStringLength) {
+    return fail(parser, RECORD_PARSER_RC_TOO_LONG);
+  }
+  if (parser->stringLength + length > parser->stringCapacity) {
+    int newCapacity = parser->stringCapacity ? parser->stringCapacity : STRING_INITIAL_CAPACITY;
+    while (newCapacity < parser->stringLength + length) {
+      newCapacity *= 2;
+    }
+    if (newCapacity > parser->maxStringLength) {
+      newCapacity = parser->maxStringLength;
+    }
+    char *newString = safeMalloc(newCapacity, "JSON record string");
+    if (parser->string) {
+      memcpy(newString, parser->string, parser->stringLength);
+      safeFree(parser->string, parser->stringCapacity);
+    }
+    parser->string = newString;
+    parser->stringCapacity = newCapacity;
+  }
+  memcpy(parser->string + parser->stringLength, data, length);
+  parser->stringLength += length;
+  return RECORD_PARSER_RC_OK;
+}
+
+static int appendCodePoint(JsonRecordParser *parser, unsigned int codePoint) {
+  unsigned char utf8[4];
+  int length = 0;
+  if (codePoint < 0x80) {
+    utf8[length++] = codePoint;
+  } else if (codePoint < 0x800) {
+    utf8[length++] = 0xC0 | (codePoint >> 6);
+    utf8[length++] = 0x80 | (codePoint & 0x3F);
+  } else if (codePoint < 0x10000) {
+    utf8[length++] = 0xE0 | (codePoint >> 12);
+    utf8[length++] = 0x80 | ((codePoint >> 6) & 0x3F);
+    utf8[length++] = 0x80 | (codePoint & 0x3F);
+  } else {
+    utf8[length++] = 0xF0 | (codePoint >> 18);
+    utf8[length++] = 0x80 | ((codePoint >> 12) & 0x3F);
+    utf8[length++] = 0x80 | ((codePoint >> 6) & 0x3F);
+    utf8[length++] = 0x80 | (codePoint & 0x3F);
+  }
+  return appendToString(parser, (char *)utf8, length);
+}
+
+/* A value (scalar or container) has been completed at the current depth */
+static void endValue(JsonRecordParser *parser) {
+  if (parser->depth == 0) {
+    parser->rootDone = true;
+  } else {
+    parser->expect[parser->depth - 1] = EXPECT_COMMA_OR_END;
+  }
+}
+
+/* valueType is VALUE_* or CONTAINER_* */
+static int startValue(JsonRecordParser *parser, char valueType) {
+  if (parser->depth == 0) {
+    if (parser->rootDone) {
+      return fail(parser, RECORD_PARSER_RC_SYNTAX);
+    }
+    return RECORD_PARSER_RC_OK;
+  }
+  char expect = parser->expect[parser->depth - 1];
+  if (expect != EXPECT_VALUE && expect != EXPECT_VALUE_OR_END) {
+    return fail(parser, RECORD_PARSER_RC_SYNTAX);
+  }
+  if (parser->inRecords) {
+    char recordType = parser->fieldCount ? CONTAINER_OBJECT : VALUE_STRING;
+    if ((parser->depth == 2 && valueType != recordType) ||
+        (parser->depth == 3 && parser->field >= 0 && valueType != VALUE_STRING)) {
+      parser->errorIndex = parser->recordIndex;
+      return fail(parser, RECORD_PARSER_RC_NOT_A_STRING);
+    }
+  }
+  return RECORD_PARSER_RC_OK;
+}
+
+static int openContainer(JsonRecordParser *parser, char type) {
+  if (startValue(parser, type)) {
+    return parser->rc;
+  }
+  if (parser->depth == 0 && type != CONTAINER_OBJECT) {
+    return fail(parser, RECORD_PARSER_RC_NOT_AN_OBJECT);
+  }
+  if (parser->depth == RECORD_PARSER_MAX_DEPTH) {
+    return fail(parser, RECORD_PARSER_RC_TOO_DEEP);
+  }
+  if (parser->depth == 1 && type == CONTAINER_ARRAY && !strcmp(parser->key, U8_RECORDS)) {
+    parser->inRecords = true;
+    parser->hasRecords = true;
+    parser->recordIndex = 0;
+  } else if (parser->depth == 2 && parser->inRecords) {
+    /* a record object, startValue let through only with fields */
+    memset(parser->fieldSeen, 0, sizeof(parser->fieldSeen));
+    parser->field = -1;
+  }
+  parser->containers[parser->depth] = type;
+  parser->expect[parser->depth] = (type == CONTAINER_OBJECT) ? EXPECT_KEY_OR_END : EXPECT_VALUE_OR_END;
+  parser->depth++;
+  return RECORD_PARSER_RC_OK;
+}
+
+/* Hands the fields of the record object just closed to the handler */
+static int endRecordObject(JsonRecordParser *parser) {
+  const char *values[RECORD_PARSER_MAX_FIELDS];
+  int lengths[RECORD_PARSER_MAX_FIELDS];
+  for (int i = 0; i < parser->fieldCount; i++) {
+    if (parser->fieldSeen[i]) {
+      values[i] = parser->fieldValues[i] ? parser->fieldValues[i] : "";
+      lengths[i] = parser->fieldLengths[i];
+    } else {
+      values[i] = NULL;
+      lengths[i] = 0;
+    }
+  }
+  parser->field = -1;
+  if (parser->fieldsHandler) {
+    int handlerRC = parser->fieldsHandler(parser->userData, values, lengths, parser->recordIndex);
+    if (handlerRC) {
+      parser->handlerRC = handlerRC;
+      parser->errorIndex = parser->recordIndex;
+      return fail(parser, RECORD_PARSER_RC_HANDLER);
+    }
+  }
+  parser->recordIndex++;
+  return RECORD_PARSER_RC_OK;
+}
+
+static int closeContainer(JsonRecordParser *parser, char type) {
+  if (parser->depth == 0 || parser->containers[parser->depth - 1] != type) {
+    return fail(parser, RECORD_PARSER_RC_SYNTAX);
+  }
+  char expect = parser->expect[parser->depth - 1];
+  bool allowed = (expect == EXPECT_COMMA_OR_END) ||
+                 (type == CONTAINER_OBJECT && expect == EXPECT_KEY_OR_END) ||
+                 (type == CONTAINER_ARRAY && expect == EXPECT_VALUE_OR_END);
+  if (!allowed) {
+    return fail(parser, RECORD_PARSER_RC_SYNTAX);
+  }
+  parser->depth--;
+  if (parser->depth == 1 && parser->inRecords) {
+    parser->inRecords = false;
+  } else if (parser->depth == 2 && parser->inRecords && endRecordObject(parser)) {
+    return parser->rc;
+  }
+  endValue(parser);
+  return RECORD_PARSER_RC_OK;
+}
+
+static int beginString(JsonRecordParser *parser) {
+  bool isKey = parser->depth > 0 &&
+               (parser->expect[parser->depth - 1] == EXPECT_KEY ||
+                parser->expect[parser->depth - 1] == EXPECT_KEY_OR_END);
+  if (!isKey && startValue(parser, VALUE_STRING)) {
+    return parser->rc;
+  }
+  if (parser->depth == 0) {
+    return fail(parser, RECORD_PARSER_RC_NOT_AN_OBJECT);
+  }
+  /* only root keys, root string values, records and the keys and fields of
+     record objects are of interest */
+  parser->keepString = (parser->depth == 1) || (parser->depth == 2 && parser->inRecords) ||
+                       (parser->depth == 3 && parser->inRecords && (isKey || parser->field >= 0));
+  parser->stringLength = 0;
+  parser->tokenState = TOKEN_STRING;
+  parser->highSurrogate = 0;
+  return RECORD_PARSER_RC_OK;
+}
+
+/* Root keys must be unique, or a second "records" would carry on the first */
+static int addRootKey(JsonRecordParser *parser, const char *name, int length) {
+  if (length > RECORD_PARSER_MAX_KEY) {
+    /* too long to be a member of interest, and not kept to compare against */
+    return RECORD_PARSER_RC_OK;
+  }
+  for (int i = 0; i < parser->rootKeyCount; i++) {
+    if (parser->rootKeyLengths[i] == length && !memcmp(parser->rootKeys[i], name, length)) {
+      return fail(parser, RECORD_PARSER_RC_DUPLICATE_KEY);
+    }
+  }
+  if (parser->rootKeyCount == RECORD_PARSER_MAX_ROOT_KEYS) {
+    return fail(parser, RECORD_PARSER_RC_TOO_MANY_KEYS);
+  }
+  memcpy(parser->rootKeys[parser->rootKeyCount], name, length);
+  parser->rootKeyLengths[parser->rootKeyCount++] = length;
+  return RECORD_PARSER_RC_OK;
+}
+
+static int findField(JsonRecordParser *parser, const char *name, int length) {
+  for (int i = 0; i < parser->fieldCount; i++) {
+    if ((int)strlen(parser->fieldNames[i]) == length && !memcmp(parser->fieldNames[i], name, length)) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/* The string just parsed becomes the field's value by swapping buffers, and
+   the field's old buffer is used for the next string */
+static void keepField(JsonRecordParser *parser, int field) {
+  char *fieldValue = parser->fieldValues[field];
+  int fieldCapacity = parser->fieldCapacities[field];
+  parser->fieldValues[field] = parser->string;
+  parser->fieldCapacities[field] = parser->stringCapacity;
+  parser->fieldLengths[field] = parser->stringLength;
+  parser->fieldSeen[field] = true;
+  parser->string = fieldValue;
+  parser->stringCapacity = fieldCapacity;
+  parser->stringLength = 0;
+}
+
+static int endString(JsonRecordParser *parser) {
+  parser->tokenState = TOKEN_NONE;
+  char *value = parser->string ? parser->string : "";
+  int container = parser->containers[parser->depth - 1];
+  char *expect = &parser->expect[parser->depth - 1];
+
+  if (container == CONTAINER_OBJECT && (*expect == EXPECT_KEY || *expect == EXPECT_KEY_OR_END)) {
+    if (parser->depth == 1) {
+      int keyLength = parser->stringLength < RECORD_PARSER_MAX_KEY ? parser->stringLength : RECORD_PARSER_MAX_KEY;
+      memcpy(parser->key, value, keyLength);
+      parser->key[keyLength] = '\0';
+      if (addRootKey(parser, value, parser->stringLength)) {
+        return parser->rc;
+      }
+    } else if (parser->depth == 3 && parser->inRecords) {
+      parser->field = findField(parser, value, parser->stringLength);
+      if (parser->field >= 0 && parser->fieldSeen[parser->field]) {
+        parser->errorIndex = parser->recordIndex;
+        return fail(parser, RECORD_PARSER_RC_DUPLICATE_KEY);
+      }
+    }
+    *expect = EXPECT_COLON;
+    return RECORD_PARSER_RC_OK;
+  }
+
+  if (parser->depth == 3 && parser->inRecords) {
+    if (parser->field >= 0) {
+      keepField(parser, parser->field);
+    }
+    endValue(parser);
+    return RECORD_PARSER_RC_OK;
+  }
+
+  if (parser->depth == 2 && parser->inRecords) {
+    if (parser->recordHandler) {
+      int handlerRC = parser->recordHandler(parser->userData, value, parser->stringLength,
+                                            parser->recordIndex);
+      if (handlerRC) {
+        parser->handlerRC = handlerRC;
+        parser->errorIndex = parser->recordIndex;
+        return fail(parser, RECORD_PARSER_RC_HANDLER);
+      }
+    }
+    parser->recordIndex++;
+  } else if (parser->depth == 1 && parser->propertyHandler) {
+    int handlerRC = parser->propertyHandler(parser->userData, parser->key, value, parser->stringLength);
+    if (handlerRC) {
+      parser->handlerRC = handlerRC;
+      return fail(parser, RECORD_PARSER_RC_HANDLER);
+    }
+  }
+  endValue(parser);
+  return RECORD_PARSER_RC_OK;
+}
+
+static int endLiteral(JsonRecordParser *parser) {
+  parser->tokenState = TOKEN_NONE;
+  parser->literal[parser->literalLength] = '\0';
+  if (strcmp(parser->literal, U8_TRUE) && strcmp(parser->literal, U8_FALSE) &&
+      strcmp(parser->literal, U8_NULL) &&
+      !isValidNumber(parser->literal, parser->literalLength)) {
+    return fail(parser, RECORD_PARSER_RC_SYNTAX);
+  }
+  endValue(parser);
+  return RECORD_PARSER_RC_OK;
+}
+
+static int hexValue(unsigned char c) {
+  if (c >= U8_0 && c <= U8_9) {
+    return c - U8_0;
+  }
+  if (c >= U8_LOWER_A && c <= U8_LOWER_F) {
+    return c - U8_LOWER_A + 10;
+  }
+  if (c >= U8_UPPER_A && c <= U8_UPPER_F) {
+    return c - U8_UPPER_A + 10;
+  }
+  return -1;
+}
+
+static int escapedChar(unsigned char c) {
+  switch (c) {
+  case U8_QUOTE:     return U8_QUOTE;
+  case U8_BACKSLASH: return U8_BACKSLASH;
+  case U8_SLASH:     return U8_SLASH;
+  case U8_LOWER_B:   return 0x08;
+  case U8_LOWER_F:   return 0x0C;
+  case U8_LOWER_N:   return 0x0A;
+  case U8_LOWER_R:   return 0x0D;
+  case U8_LOWER_T:   return 0x09;
+  default:           return -1;
+  }
+}
+
+/* A high surrogate escape must be followed directly by a low one */
+static int checkNoSurrogate(JsonRecordParser *parser) {
+  if (parser->highSurrogate) {
+    return fail(parser, RECORD_PARSER_RC_SYNTAX);
+  }
+  return RECORD_PARSER_RC_OK;
+}
+
+int jsonRecordParserFeed(JsonRecordParser *parser, const char *data, int length) {
+  const unsigned char *input = (const unsigned char *)data;
+  int i = 0;
+  while (i < length && parser->rc == RECORD_PARSER_RC_OK) {
+    unsigned char c = input[i];
+
+    if (parser->tokenState == TOKEN_STRING) {
+      /* copy the run of plain characters in one go */
+      int runStart = i;
+      while (i < length && input[i] != U8_QUOTE && input[i] != U8_BACKSLASH) {
+        i++;
+      }
+      parser->offset += i - runStart;
+      if (i > runStart) {
+        if (checkNoSurrogate(parser) || appendToString(parser, data + runStart, i - runStart)) {
+          break;
+        }
+      }
+      if (i == length) {
+        break;
+      }
+      c = input[i];
+      if (c == U8_QUOTE) {
+        if (checkNoSurrogate(parser)) {
+          break;
+        }
+        endString(parser);
+      } else {
+        parser->tokenState = TOKEN_ESCAPE;
+      }
+    } else if (parser->tokenState == TOKEN_ESCAPE) {
+      if (c == U8_LOWER_U) {
+        parser->tokenState = TOKEN_UNICODE;
+        parser->codePoint = 0;
+        parser->hexDigits = 0;
+      } else {
+        int decoded = escapedChar(c);
+        if (decoded < 0) {
+          fail(parser, RECORD_PARSER_RC_SYNTAX);
+          break;
+        }
+        char decodedChar = (char)decoded;
+        if (checkNoSurrogate(parser) || appendToString(parser, &decodedChar, 1)) {
+          break;
+        }
+        parser->tokenState = TOKEN_STRING;
+      }
+    } else if (parser->tokenState == TOKEN_UNICODE) {
+      int digit = hexValue(c);
+      if (digit < 0) {
+        fail(parser, RECORD_PARSER_RC_SYNTAX);
+        break;
+      }
+      parser->codePoint = (parser->codePoint << 4) | digit;
+      if (++parser->hexDigits == 4) {
+        unsigned int codePoint = parser->codePoint;
+        int rc = RECORD_PARSER_RC_OK;
+        if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+          rc = checkNoSurrogate(parser);
+          parser->highSurrogate = codePoint;
+        } else if (codePoint >= 0xDC00 && codePoint <= 0xDFFF) {
+          /* a low surrogate on its own has no UTF-8 form */
+          if (!parser->highSurrogate) {
+            rc = fail(parser, RECORD_PARSER_RC_SYNTAX);
+          } else {
+            codePoint = 0x10000 + ((parser->highSurrogate - 0xD800) << 10) + (codePoint - 0xDC00);
+            parser->highSurrogate = 0;
+            rc = appendCodePoint(parser, codePoint);
+          }
+        } else {
+          rc = checkNoSurrogate(parser);
+          if (!rc) {
+            rc = appendCodePoint(parser, codePoint);
+          }
+        }
+        if (rc) {
+          break;
+        }
+        parser->tokenState = TOKEN_STRING;
+      }
+    } else if (parser->tokenState == TOKEN_LITERAL && isLiteralChar(c)) {
+      if (parser->literalLength == sizeof(parser->literal) - 1) {
+        fail(parser, RECORD_PARSER_RC_SYNTAX);
+        break;
+      }
+      parser->literal[parser->literalLength++] = c;
+    } else {
+      if (parser->tokenState == TOKEN_LITERAL && endLiteral(parser)) {
+        break;
+      }
+      if (isWhitespace(c)) {
+        /* nothing */
+      } else if (parser->rootDone) {
+        fail(parser, RECORD_PARSER_RC_SYNTAX);
+      } else if (c == U8_QUOTE) {
+        beginString(parser);
+      } else if (c == U8_LBRACE) {
+        openContainer(parser, CONTAINER_OBJECT);
+      } else if (c == U8_LBRACKET) {
+        openContainer(parser, CONTAINER_ARRAY);
+      } else if (c == U8_RBRACE) {
+        closeContainer(parser, CONTAINER_OBJECT);
+      } else if (c == U8_RBRACKET) {
+        closeContainer(parser, CONTAINER_ARRAY);
+      } else if (c == U8_COLON) {
+        if (parser->depth == 0 || parser->expect[parser->depth - 1] != EXPECT_COLON) {
+          fail(parser, RECORD_PARSER_RC_SYNTAX);
+        } else {
+          parser->expect[parser->depth - 1] = EXPECT_VALUE;
+        }
+      } else if (c == U8_COMMA) {
+        if (parser->depth == 0 || parser->expect[parser->depth - 1] != EXPECT_COMMA_OR_END) {
+          fail(parser, RECORD_PARSER_RC_SYNTAX);
+        } else {
+          parser->expect[parser->depth - 1] =
+              parser->containers[parser->depth - 1] == CONTAINER_OBJECT ? EXPECT_KEY : EXPECT_VALUE;
+        }
+      } else if (isLiteralChar(c)) {
+        if (!startValue(parser, VALUE_LITERAL)) {
+          if (parser->depth == 0) {
+            fail(parser, RECORD_PARSER_RC_NOT_AN_OBJECT);
+          } else {
+            parser->tokenState = TOKEN_LITERAL;
+            parser->literal[0] = c;
+            parser->literalLength = 1;
+          }
+        }
+      } else {
+        fail(parser, RECORD_PARSER_RC_SYNTAX);
+      }
+    }
+    if (parser->rc == RECORD_PARSER_RC_OK) {
+      parser->offset++;
+      i++;
+    }
+  }
+  return parser->rc;
+}
+
+int jsonRecordParserFinish(JsonRecordParser *parser) {
+  if (parser->rc != RECORD_PARSER_RC_OK) {
+    return parser->rc;
+  }
+  if (parser->tokenState != TOKEN_NONE || !parser->rootDone) {
+    return fail(parser, parser->offset == 0 ? RECORD_PARSER_RC_NOT_AN_OBJECT
+                                            : RECORD_PARSER_RC_INCOMPLETE);
+  }
+  return RECORD_PARSER_RC_OK;
+}
+
+
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
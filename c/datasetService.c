@@ -40,6 +40,17 @@
 #include "datasetjson.h"
 #include "logging.h"
 #include "zssLogging.h"
+#include "configmgr.h"
+#include "zss.h"
+#include "datasetAllocCache.h"
+#include "datasetETagCache.h"
+#include "datasetDigest.h"
+#include "datasetCopy.h"
+#include "datasetCopyJobs.h"
+#include "datasetCSICache.h"
+#include "datasetVTOCCache.h"
+#include "datasetDirectoryCache.h"
+#include "datasetACBPool.h"
 
 #include "datasetService.h"
 
@@ -48,11 +59,6 @@ static int serveDatasetMetadata(HttpService *service, HttpResponse *response) {
   zowelog(NULL, LOG_COMP_ID_MVD_SERVER, ZOWE_LOG_DEBUG2, "begin %s\n", __FUNCTION__);
   HttpRequest *request = response->request;
   if (!strcmp(request->method, methodGET)) {
-    if (service->userPointer == NULL){
-      MetadataQueryCache *userData = (MetadataQueryCache*)safeMalloc(sizeof(MetadataQueryCache),"Pointer to metadata cache");
-      service->userPointer = userData;
-    }
-
     char *l1 = stringListPrint(request->parsedFile, 1, 1, "/", 0); //expect name or hlq
     zowelog(NULL, LOG_COMP_ID_MVD_SERVER, ZOWE_LOG_DEBUG, "L1=%s\n", l1);
     if (!strcmp(l1, "name")){
@@ -85,6 +91,54 @@ static int serveDatasetMetadata(HttpService *service, HttpResponse *response) {
   return 0;
 }
 
+/*
+  Picks the response format for dataset contents from the first media type in
+  the Accept header. Anything other than plain text or binary gets JSON.
+ */
+static int getDatasetContentMode(HttpRequest *request) {
+  HttpHeader *acceptHeader = getHeader(request, "Accept");
+  if (acceptHeader == NULL || acceptHeader->nativeValue == NULL) {
+    return DATASET_CONTENT_MODE_JSON;
+  }
+  char *accept = acceptHeader->nativeValue;
+  int typeLength = strcspn(accept, ",;");
+  while (typeLength > 0 && accept[typeLength - 1] == ' ') {
+    typeLength--;
+  }
+  if (typeLength == strlen("text/plain") &&
+      !strncasecmp(accept, "text/plain", typeLength)) {
+    return DATASET_CONTENT_MODE_TEXT;
+  } else if (typeLength == strlen("application/octet-stream") &&
+             !strncasecmp(accept, "application/octet-stream", typeLength)) {
+    return DATASET_CONTENT_MODE_BINARY;
+  }
+  return DATASET_CONTENT_MODE_JSON;
+}
+
+/*
+  Picks how a dataset write body is read from its Content-Type: lines of
+  text/plain, RDW framed records of application/octet-stream, or JSON.
+ */
+static int getDatasetBodyMode(HttpRequest *request) {
+  HttpHeader *typeHeader = getHeader(request, "Content-Type");
+  if (typeHeader == NULL || typeHeader->nativeValue == NULL) {
+    return DATASET_CONTENT_MODE_JSON;
+  }
+  char *contentType = typeHeader->nativeValue;
+  int typeLength = strcspn(contentType, ";");
+  while (typeLength > 0 && contentType[typeLength - 1] == ' ') {
+    typeLength--;
+  }
+  if (typeLength == strlen("text/plain") &&
+      !strncasecmp(contentType, "text/plain", typeLength)) {
+    return DATASET_CONTENT_MODE_TEXT;
+  } else if (typeLength == strlen("application/octet-stream") &&
+             !strncasecmp(contentType, "application/octet-stream", typeLength)) {
+    return DATASET_CONTENT_MODE_BINARY;
+  }
+  return DATASET_CONTENT_MODE_JSON;
+}
+
 static int serveDatasetContents(HttpService *service, HttpResponse *response){
   zowelog(NULL, LOG_COMP_ID_MVD_SERVER, ZOWE_LOG_DEBUG2, "begin %s\n", __FUNCTION__);
   HttpRequest *request = response->request;
@@ -96,7 +150,7 @@ static int serveDatasetContents(HttpService *service, HttpResponse *response){
     char *filename = stringConcatenate(response->slh, filenamep1, "'");
     zowelog(NULL, LOG_COMP_ID_MVD_SERVER, ZOWE_LOG_DEBUG, "Serving: %s\n", filename);
     fflush(stdout);
-    respondWithDataset(response, filename, TRUE);
+    respondWithDataset(response, filename, getDatasetContentMode(request));
   }
   else if (!strcmp(request->method, methodPOST)){
     char *l1 = stringListPrint(request->parsedFile, 1, 1, "/", 0);
@@ -105,7 +159,7 @@ static int serveDatasetContents(HttpService *service, HttpResponse *response){
     char *filename = stringConcatenate(response->slh, filenamep1, "'");
     zowelog(NULL, LOG_COMP_ID_MVD_SERVER, ZOWE_LOG_DEBUG, "Updating if exists: %s\n", filename);
     fflush(stdout);
-    updateDataset(response, filename, TRUE);
+    updateDataset(response, filename, getDatasetBodyMode(request));
   }
   else if (!strcmp(request->method, methodDELETE)) {
     char *l1 = stringListPrint(request->parsedFile, 1, 1, "/", 0);
@@ -156,13 +210,24 @@ static int serveDatasetCopy(HttpService *service, HttpResponse *response){
     char *newDataset = getQueryParam(response->request, "newDataset");
     char *newDatasetNameP1 = stringConcatenate(response->slh, "//'", newDataset);
     char *newDatasetName = stringConcatenate(response->slh, newDatasetNameP1, "'");
-    copyDatasetAndRespond(response, datasetName, newDatasetName);
+    char *asyncParam = getQueryParam(response->request, "async");
+    bool async = (asyncParam != NULL && !strcmp(asyncParam, "true"));
+    copyDatasetAndRespond(response, datasetName, newDatasetName, async);
+  } else if (!strcmp(request->method, methodGET)) {
+    /* /datasetCopy/jobs/<id> */
+    char *l1 = stringListPrint(request->parsedFile, 1, 1, "/", 0);
+    char *jobId = stringListPrint(request->parsedFile, 2, 1, "/", 0);
+    if (l1 != NULL && !strcmp(l1, "jobs")) {
+      respondWithCopyJob(response, jobId);
+    } else {
+      respondWithError(response, HTTP_STATUS_NOT_FOUND, "Copy job not found");
+    }
   } else {
     setContentType(response, "text/json");
     setResponseStatus(response, 405, "Method Not Allowed");
     addStringHeader(response, "Server", "jdmfws");
     addStringHeader(response, "Transfer-Encoding", "chunked");
-    addStringHeader(response, "Allow", "POST");
+    addStringHeader(response, "Allow", "GET, POST");
     writeHeader(response);
     finishResponse(response);
   }
@@ -179,13 +244,13 @@ static int serveVSAMDatasetContents(HttpService *service, HttpResponse *response
     char *filename = stringListPrint(request->parsedFile, 1, 1, "/", 0);
     zowelog(NULL, LOG_COMP_ID_MVD_SERVER, ZOWE_LOG_DEBUG, "Serving: %s\n", filename);
     fflush(stdout);
-    respondWithVSAMDataset(response, filename, cache->acbTable, TRUE);
+    respondWithVSAMDataset(response, filename, cache->acbPool, getDatasetContentMode(request));
   }
   else if (!strcmp(request->method, methodPOST)){
     char *filename = stringListPrint(request->parsedFile, 1, 1, "/", 0);
     zowelog(NULL, LOG_COMP_ID_MVD_SERVER, ZOWE_LOG_DEBUG, "Updating if exists: %s\n", filename);
     fflush(stdout);
-    updateVSAMDataset(response, filename, cache->acbTable, TRUE);
+    updateVSAMDataset(response, filename, cache->acbPool, getDatasetBodyMode(request));
   }
   else if (!strcmp(request->method, methodDELETE)) {
     char *l1 = stringListPrint(request->parsedFile, 1, 1, "/", 0);
@@ -194,7 +259,7 @@ static int serveVSAMDatasetContents(HttpService *service, HttpResponse *response
     char *filename = stringConcatenate(response->slh, filenamep1, "'");
     zowelog(NULL, LOG_COMP_ID_MVD_SERVER, ZOWE_LOG_DEBUG, "Deleting if exists: %s\n", filename);
     fflush(stdout);
-    deleteVSAMDataset(response, filename);
+    deleteVSAMDataset(response, filename, cache->acbPool);
   }
   else {
     jsonPrinter *out = respondWithJsonPrinter(response);
@@ -216,6 +281,161 @@ static int serveVSAMDatasetContents(HttpService *service, HttpResponse *response
   return 0;
 }
 
+static int getDatasetCacheSetting(ConfigManager *configmgr, char *cacheName, char *name,
+                                  int defaultValue) {
+  int value = 0;
+  int getStatus = cfgGetIntC(configmgr, ZSS_CFGNAME, &value, 6, "components", "zss", "agent",
+                             "datasets", cacheName, name);
+  if (getStatus != ZCFG_SUCCESS) {
+    zowelog(NULL, LOG_COMP_ID_MVD_SERVER, ZOWE_LOG_DEBUG,
+            "components.zss.agent.datasets.%s.%s not set, defaulting to %d\n",
+            cacheName, name, defaultValue);
+    return defaultValue;
+  }
+  return value;
+}
+
+static void installDatasetAllocCache(HttpServer *server) {
+  ConfigManager *configmgr = httpServerConfigManager(server);
+  int maxEntries = getDatasetCacheSetting(configmgr, "allocationCache", "maxEntries",
+                                          ALLOC_CACHE_DEFAULT_MAX_ENTRIES);
+  int idleSeconds = getDatasetCacheSetting(configmgr, "allocationCache", "idleSeconds",
+                                           ALLOC_CACHE_DEFAULT_IDLE_SECONDS);
+  if (maxEntries <= 0) {
+    zowelog(NULL, LOG_COMP_ID_MVD_SERVER, ZOWE_LOG_INFO, "Dataset allocation cache disabled\n");
+    return;
+  }
+  zowelog(NULL, LOG_COMP_ID_MVD_SERVER, ZOWE_LOG_DEBUG,
+          "Dataset allocation cache: maxEntries=%d, idleSeconds=%d\n", maxEntries, idleSeconds);
+  DatasetAllocCache *cache = makeDatasetAllocCache(&dynallocDatasetAllocator, maxEntries, idleSeconds);
+  if (!startDatasetAllocCacheSweeper(cache, server->base->rleAnchor)) {
+    zowelog(NULL, LOG_COMP_ID_MVD_SERVER, ZOWE_LOG_WARNING,
+            "Dataset allocation cache sweep could not be started, idle allocations are only dropped by later reads\n");
+  }
+  setDatasetAllocCache(cache);
+}
+
+static void installDatasetETagCache(HttpServer *server) {
+  ConfigManager *configmgr = httpServerConfigManager(server);
+  int maxEntries = getDatasetCacheSetting(configmgr, "eTagCache", "maxEntries",
+                                          ETAG_CACHE_DEFAULT_MAX_ENTRIES);
+  if (maxEntries <= 0) {
+    zowelog(NULL, LOG_COMP_ID_MVD_SERVER, ZOWE_LOG_INFO, "Dataset etag cache disabled\n");
+    return;
+  }
+  zowelog(NULL, LOG_COMP_ID_MVD_SERVER, ZOWE_LOG_DEBUG, "Dataset etag cache: maxEntries=%d\n", maxEntries);
+  setDatasetETagCache(makeDatasetETagCache(maxEntries));
+}
+
+static void installDatasetCSICache(HttpServer *server) {
+  ConfigManager *configmgr = httpServerConfigManager(server);
+  int maxEntries = getDatasetCacheSetting(configmgr, "csiCache", "maxEntries",
+                                          CSI_CACHE_DEFAULT_MAX_ENTRIES);
+  int maxKilobytes = getDatasetCacheSetting(configmgr, "csiCache", "maxKilobytes",
+                                            CSI_CACHE_DEFAULT_MAX_KILOBYTES);
+  int ttlSeconds = getDatasetCacheSetting(configmgr, "csiCache", "ttlSeconds",
+                                          CSI_CACHE_DEFAULT_TTL_SECONDS);
+  if (maxEntries <= 0 || maxKilobytes <= 0 || ttlSeconds <= 0) {
+    zowelog(NULL, LOG_COMP_ID_MVD_SERVER, ZOWE_LOG_INFO, "Catalog search cache disabled\n");
+    return;
+  }
+  zowelog(NULL, LOG_COMP_ID_MVD_SERVER, ZOWE_LOG_DEBUG,
+          "Catalog search cache: maxEntries=%d, maxKilobytes=%d, ttlSeconds=%d\n",
+          maxEntries, maxKilobytes, ttlSeconds);
+  setCSIQueryCache(makeCSIQueryCache(maxEntries, (int64)maxKilobytes * 1024, ttlSeconds));
+}
+
+static void installDatasetVTOCCache(HttpServer *server) {
+  ConfigManager *configmgr = httpServerConfigManager(server);
+  int maxVolumes = getDatasetCacheSetting(configmgr, "vtocCache", "maxVolumes",
+                                          VTOC_CACHE_DEFAULT_MAX_VOLUMES);
+  int maxDatasetsPerVolume = getDatasetCacheSetting(configmgr, "vtocCache", "maxDatasetsPerVolume",
+                                                    VTOC_CACHE_DEFAULT_MAX_DATASETS_PER_VOLUME);
+  int ttlSeconds = getDatasetCacheSetting(configmgr, "vtocCache", "ttlSeconds",
+                                          VTOC_CACHE_DEFAULT_TTL_SECONDS);
+  if (maxVolumes <= 0 || maxDatasetsPerVolume <= 0 || ttlSeconds <= 0) {
+    zowelog(NULL, LOG_COMP_ID_MVD_SERVER, ZOWE_LOG_INFO, "VTOC cache disabled\n");
+    return;
+  }
+  zowelog(NULL, LOG_COMP_ID_MVD_SERVER, ZOWE_LOG_DEBUG,
+          "VTOC cache: maxVolumes=%d, maxDatasetsPerVolume=%d, ttlSeconds=%d\n",
+          maxVolumes, maxDatasetsPerVolume, ttlSeconds);
+  setVTOCCache(makeVTOCCache(maxVolumes, maxDatasetsPerVolume, ttlSeconds));
+}
+
+static void installPDSDirectoryCache(HttpServer *server) {
+  ConfigManager *configmgr = httpServerConfigManager(server);
+  int maxEntries = getDatasetCacheSetting(configmgr, "directoryCache", "maxEntries",
+                                          DIRECTORY_CACHE_DEFAULT_MAX_ENTRIES);
+  int maxKilobytes = getDatasetCacheSetting(configmgr, "directoryCache", "maxKilobytes",
+                                            DIRECTORY_CACHE_DEFAULT_MAX_KILOBYTES);
+  int ttlSeconds = getDatasetCacheSetting(configmgr, "directoryCache", "ttlSeconds",
+                                          DIRECTORY_CACHE_DEFAULT_TTL_SECONDS);
+  if (maxEntries <= 0 || maxKilobytes <= 0 || ttlSeconds <= 0) {
+    zowelog(NULL, LOG_COMP_ID_MVD_SERVER, ZOWE_LOG_INFO, "PDS directory cache disabled\n");
+    return;
+  }
+  zowelog(NULL, LOG_COMP_ID_MVD_SERVER, ZOWE_LOG_DEBUG,
+          "PDS directory cache: maxEntries=%d, maxKilobytes=%d, ttlSeconds=%d\n",
+          maxEntries, maxKilobytes, ttlSeconds);
+  setPDSDirectoryCache(makePDSDirectoryCache(maxEntries, (int64)maxKilobytes * 1024, ttlSeconds));
+}
+
+static MetadataQueryCache *installMetadataQueryCache(HttpServer *server) {
+  ConfigManager *configmgr = httpServerConfigManager(server);
+  int ttlSeconds = getDatasetCacheSetting(configmgr, "hlqCache", "ttlSeconds",
+                                          HLQ_CACHE_DEFAULT_TTL_SECONDS);
+  int searchWorkers = getDatasetCacheSetting(configmgr, "hlqCache", "searchWorkers",
+                                             HLQ_CACHE_DEFAULT_SEARCH_WORKERS);
+  zowelog(NULL, LOG_COMP_ID_MVD_SERVER, ZOWE_LOG_DEBUG, "HLQ cache: ttlSeconds=%d, searchWorkers=%d\n",
+          ttlSeconds, searchWorkers);
+  MetadataQueryCache *cache = makeMetadataQueryCache(ttlSeconds, searchWorkers);
+  if (ttlSeconds > 0 && !startHLQCacheRefresher(cache->hlqCache, server->base->rleAnchor)) {
+    zowelog(NULL, LOG_COMP_ID_MVD_SERVER, ZOWE_LOG_WARNING,
+            "HLQ cache refresh could not be started, HLQs are refreshed with updateCache=true only\n");
+  }
+  return cache;
+}
+
+static void configureDatasetDigest(HttpServer *server) {
+  ConfigManager *configmgr = httpServerConfigManager(server);
+  char *hashName = NULL;
+  int getStatus = cfgGetStringC(configmgr, ZSS_CFGNAME, &hashName, 5, "components", "zss", "agent",
+                                "datasets", "eTagHash");
+  if (getStatus != ZCFG_SUCCESS || hashName == NULL) {
+    return;
+  }
+  int type = getDatasetDigestType(hashName);
+  if (type == 0) {
+    zowelog(NULL, LOG_COMP_ID_MVD_SERVER, ZOWE_LOG_WARNING,
+            "Unknown components.zss.agent.datasets.eTagHash '%s', using %s\n",
+            hashName, getDatasetDigestName(getDefaultDatasetDigestType()));
+    return;
+  }
+  zowelog(NULL, LOG_COMP_ID_MVD_SERVER, ZOWE_LOG_DEBUG, "Dataset etags hashed with %s\n", hashName);
+  setDefaultDatasetDigestType(type);
+}
+
+static void configureDatasetCopy(HttpServer *server) {
+  ConfigManager *configmgr = httpServerConfigManager(server);
+  int workers = getDatasetCacheSetting(configmgr, "copy", "workers", PDS_COPY_DEFAULT_WORKERS);
+  int jobWorkers = getDatasetCacheSetting(configmgr, "copy", "jobWorkers", COPY_JOB_DEFAULT_WORKERS);
+  int maxJobs = getDatasetCacheSetting(configmgr, "copy", "maxJobs", COPY_JOB_DEFAULT_MAX_JOBS);
+  zowelog(NULL, LOG_COMP_ID_MVD_SERVER, ZOWE_LOG_DEBUG,
+          "Dataset copy: workers=%d, jobWorkers=%d, maxJobs=%d\n", workers, jobWorkers, maxJobs);
+  setDefaultPDSCopyWorkers(workers);
+  if (jobWorkers <= 0) {
+    zowelog(NULL, LOG_COMP_ID_MVD_SERVER, ZOWE_LOG_INFO, "Dataset copy jobs disabled\n");
+    return;
+  }
+  CopyJobPool *pool = makeCopyJobPool(server->base->rleAnchor, jobWorkers, maxJobs);
+  if (pool == NULL) {
+    zowelog(NULL, LOG_COMP_ID_MVD_SERVER, ZOWE_LOG_WARNING, "Dataset copy jobs could not be started\n");
+    return;
+  }
+  setCopyJobPool(pool);
+}
+
 void installDatasetContentsService(HttpServer *server) {
   zowelog(NULL, LOG_COMP_ID_MVD_SERVER, ZOWE_LOG_INFO, ZSS_LOG_INSTALL_MSG, "dataset contents");
   zowelog(NULL, LOG_COMP_ID_MVD_SERVER, ZOWE_LOG_DEBUG2, "begin %s\n", __FUNCTION__);
@@ -225,7 +445,14 @@ void installDatasetContentsService(HttpServer *server) {
   httpService->runInSubtask = TRUE;
   httpService->doImpersonation = TRUE;
   httpService->serviceFunction = serveDatasetContents;
+  httpService->paramSpecList =
+    makeIntParamSpec("start", SERVICE_ARG_OPTIONAL, 0,0,0,0,
+      makeIntParamSpec("count", SERVICE_ARG_OPTIONAL, 0,0,0,0,
+        makeStringParamSpec("force", SERVICE_ARG_OPTIONAL, NULL)));
   registerHttpService(server, httpService);
+  configureDatasetDigest(server);
+  installDatasetAllocCache(server);
+  installDatasetETagCache(server);
 }
 
 void installDatasetCopyService(HttpServer *server) {
@@ -237,8 +464,11 @@ void installDatasetCopyService(HttpServer *server) {
   httpService->runInSubtask = TRUE;
   httpService->doImpersonation = TRUE;
   httpService->serviceFunction = serveDatasetCopy;
-  httpService->paramSpecList = makeStringParamSpec("force",SERVICE_ARG_OPTIONAL, NULL);
+  httpService->paramSpecList =
+    makeStringParamSpec("force",SERVICE_ARG_OPTIONAL,
+      makeStringParamSpec("async",SERVICE_ARG_OPTIONAL, NULL));
   registerHttpService(server, httpService);
+  configureDatasetCopy(server);
 }
 
 void installVSAMDatasetContentsService(HttpServer *server) {
@@ -250,10 +480,33 @@ void installVSAMDatasetContentsService(HttpServer *server) {
   httpService->runInSubtask = TRUE;
   httpService->doImpersonation = TRUE;
   httpService->serviceFunction = serveVSAMDatasetContents;
-  /* TODO: add VSAM params */
-  httpService->paramSpecList = makeStringParamSpec("closeAfter",SERVICE_ARG_OPTIONAL, NULL);
+  httpService->paramSpecList =
+    makeStringParamSpec("closeAfter", SERVICE_ARG_OPTIONAL,
+      makeIntParamSpec("maxRecords", SERVICE_ARG_OPTIONAL, 0,0,0,0,
+        makeIntParamSpec("maxBytes", SERVICE_ARG_OPTIONAL, 0,0,0,0,
+          makeStringParamSpec("startKey", SERVICE_ARG_OPTIONAL,
+            makeStringParamSpec("startRBA", SERVICE_ARG_OPTIONAL,
+              makeIntParamSpec("startRecord", SERVICE_ARG_OPTIONAL, 0,0,0,0,
+                makeStringParamSpec("stopKey", SERVICE_ARG_OPTIONAL,
+                  makeStringParamSpec("replace", SERVICE_ARG_OPTIONAL, NULL))))))));
+  ConfigManager *configmgr = httpServerConfigManager(server);
+  int maxEntries = getDatasetCacheSetting(configmgr, "acbPool", "maxEntries",
+                                          ACB_POOL_DEFAULT_MAX_ENTRIES);
+  int idleSeconds = getDatasetCacheSetting(configmgr, "acbPool", "idleSeconds",
+                                           ACB_POOL_DEFAULT_IDLE_SECONDS);
+  if (maxEntries <= 0) {
+    zowelog(NULL, LOG_COMP_ID_MVD_SERVER, ZOWE_LOG_INFO,
+            "VSAM ACB pool disabled, datasets are closed after every request\n");
+  } else {
+    zowelog(NULL, LOG_COMP_ID_MVD_SERVER, ZOWE_LOG_DEBUG,
+            "VSAM ACB pool: maxEntries=%d, idleSeconds=%d\n", maxEntries, idleSeconds);
+  }
   serveVSAMCache *cache = (serveVSAMCache *) safeMalloc(sizeof(serveVSAMCache), "Pointer to VSAM Cache");
-  cache->acbTable = htCreate(0x2000,stringHash,stringCompare,NULL,NULL);
+  cache->acbPool = makeACBPool(&vsamInputACBOpener, maxEntries, idleSeconds);
+  if (maxEntries > 0 && !startACBPoolSweeper(cache->acbPool, server->base->rleAnchor)) {
+    zowelog(NULL, LOG_COMP_ID_MVD_SERVER, ZOWE_LOG_WARNING,
+            "VSAM ACB pool sweep could not be started, idle ACBs are only closed by later reads\n");
+  }
   httpService->userPointer = cache;
   registerHttpService(server, httpService);
 }
@@ -278,8 +531,17 @@ void installDatasetMetadataService(HttpServer *server) {
                 makeStringParamSpec("resumeName", SERVICE_ARG_OPTIONAL,
                   makeStringParamSpec("resumeCatalogName", SERVICE_ARG_OPTIONAL,
                     makeStringParamSpec("includeUnprintable", SERVICE_ARG_OPTIONAL,
-                      makeIntParamSpec("workAreaSize", SERVICE_ARG_OPTIONAL, 0,0,0,0, NULL))))))))));
+                      makeIntParamSpec("workAreaSize", SERVICE_ARG_OPTIONAL, 0,0,0,0,
+                        makeIntParamSpec("limit", SERVICE_ARG_OPTIONAL, 0,0,0,0,
+                          makeStringParamSpec("continuation", SERVICE_ARG_OPTIONAL,
+                            makeIntParamSpec("memberLimit", SERVICE_ARG_OPTIONAL, 0,0,0,0,
+                              makeStringParamSpec("memberResumeName", SERVICE_ARG_OPTIONAL,
+                                makeStringParamSpec("includeMemberStats", SERVICE_ARG_OPTIONAL, NULL)))))))))))))));
+  httpService->userPointer = installMetadataQueryCache(server);
   registerHttpService(server, httpService);
+  installDatasetCSICache(server);
+  installDatasetVTOCCache(server);
+  installPDSDirectoryCache(server);
 }
 
 #endif /* __ZOWE_OS_ZOS */
@@ -0,0 +1,266 @@
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "zowetypes.h"
+#include "alloc.h"
+
+#include "datasetVTOCCache.h"
+
+VTOCCache *makeVTOCCache(int maxVolumes, int maxDatasetsPerVolume, int ttlSeconds) {
+  VTOCCache *cache = (VTOCCache *)safeMalloc(sizeof(VTOCCache), "VTOCCache");
+  memset(cache, 0, sizeof(VTOCCache));
+  cache->maxVolumes = maxVolumes > 0 ? maxVolumes : 1;
+  cache->maxDatasetsPerVolume = maxDatasetsPerVolume > 0 ? maxDatasetsPerVolume : 1;
+  cache->ttlSeconds = ttlSeconds > 0 ? ttlSeconds : 0;
+  int volumesSize = sizeof(VTOCVolume) * cache->maxVolumes;
+  cache->volumes = (VTOCVolume *)safeMalloc(volumesSize, "VTOCVolume table");
+  memset(cache->volumes, 0, volumesSize);
+  pthread_mutex_init(&cache->lock, NULL);
+  return cache;
+}
+
+static int compareRequests(const void *a, const void *b) {
+  const DSCBRequest *x = *(const DSCBRequest **)a;
+  const DSCBRequest *y = *(const DSCBRequest **)b;
+  int order = memcmp(x->volser, y->volser, sizeof(x->volser));
+  return order ? order : memcmp(x->name, y->name, sizeof(x->name));
+}
+
+static bool isSameVolume(const DSCBRequest *a, const DSCBRequest *b) {
+  return !memcmp(a->volser, b->volser, sizeof(a->volser));
+}
+
+static bool isSameDataset(const DSCBRequest *a, const DSCBRequest *b) {
+  return isSameVolume(a, b) && !memcmp(a->name, b->name, sizeof(a->name));
+}
+
+/* The functions below must be called with the lock held */
+
+static void emptyVolume(VTOCCache *cache, VTOCVolume *volume, time_t now) {
+  cache->stats.datasets -= volume->datasetCount;
+  volume->datasetCount = 0;
+  volume->filledTime = now;
+}
+
+static VTOCVolume *findVolume(VTOCCache *cache, const char *volser, time_t now) {
+  for (int i = 0; i < cache->volumeCount; i++) {
+    VTOCVolume *volume = &cache->volumes[i];
+    if (!memcmp(volume->volser, volser, sizeof(volume->volser))) {
+      if (now - volume->filledTime >= cache->ttlSeconds) {
+        if (volume->datasetCount > 0) {
+          cache->stats.expirations++;
+        }
+        emptyVolume(cache, volume, now);
+      }
+      volume->lastUsed = ++cache->clock;
+      return volume;
+    }
+  }
+  return NULL;
+}
+
+static VTOCVolume *addVolume(VTOCCache *cache, const char *volser, time_t now) {
+  VTOCVolume *volume = NULL;
+  if (cache->volumeCount < cache->maxVolumes) {
+    volume = &cache->volumes[cache->volumeCount++];
+    volume->datasets = (VTOCDataset *)safeMalloc(sizeof(VTOCDataset) * cache->maxDatasetsPerVolume,
+                                                 "VTOCDataset table");
+    volume->datasetCount = 0;
+  } else {
+    volume = &cache->volumes[0];
+    for (int i = 1; i < cache->volumeCount; i++) {
+      if (cache->volumes[i].lastUsed < volume->lastUsed) {
+        volume = &cache->volumes[i];
+      }
+    }
+    emptyVolume(cache, volume, now);
+    cache->stats.evictions++;
+  }
+  memcpy(volume->volser, volser, sizeof(volume->volser));
+  volume->filledTime = now;
+  volume->lastUsed = ++cache->clock;
+  return volume;
+}
+
+/* Returns the index of name in the volume, or where it would go as -1 - index */
+static int findDataset(const VTOCVolume *volume, const char *name) {
+  int low = 0;
+  int high = volume->datasetCount - 1;
+  while (low <= high) {
+    int middle = (low + high) / 2;
+    int order = memcmp(volume->datasets[middle].name, name, VTOC_CACHE_NAME_LENGTH);
+    if (order == 0) {
+      return middle;
+    } else if (order < 0) {
+      low = middle + 1;
+    } else {
+      high = middle - 1;
+    }
+  }
+  return -1 - low;
+}
+
+static void storeDataset(VTOCCache *cache, VTOCVolume *volume, const DSCBRequest *request) {
+  int index = findDataset(volume, request->name);
+  if (index < 0) {
+    if (volume->datasetCount >= cache->maxDatasetsPerVolume) {
+      return;
+    }
+    index = -1 - index;
+    memmove(&volume->datasets[index + 1], &volume->datasets[index],
+            (volume->datasetCount - index) * sizeof(VTOCDataset));
+    volume->datasetCount++;
+    cache->stats.datasets++;
+  }
+  memcpy(volume->datasets[index].name, request->name, VTOC_CACHE_NAME_LENGTH);
+  memcpy(volume->datasets[index].dscb, request->dscb, VTOC_CACHE_DSCB_SIZE);
+}
+
+static void lookupVolumeDSCBs(VTOCCache *cache, DSCBRequest **requests, int count, bool *found) {
+  pthread_mutex_lock(&cache->lock);
+  {
+    VTOCVolume *volume = findVolume(cache, requests[0]->volser, time(NULL));
+    for (int i = 0; i < count; i++) {
+      int index = volume ? findDataset(volume, requests[i]->name) : -1;
+      found[i] = (index >= 0);
+      if (found[i]) {
+        memcpy(requests[i]->dscb, volume->datasets[index].dscb, VTOC_CACHE_DSCB_SIZE);
+        requests[i]->rc = 0;
+        cache->stats.hits++;
+      } else {
+        cache->stats.misses++;
+      }
+    }
+  }
+  pthread_mutex_unlock(&cache->lock);
+}
+
+static void storeVolumeDSCBs(VTOCCache *cache, DSCBRequest **requests, int count, const bool *found,
+                             uint64 obtains, uint64 duplicates) {
+  pthread_mutex_lock(&cache->lock);
+  {
+    time_t now = time(NULL);
+    cache->stats.obtains += obtains;
+    cache->stats.duplicates += duplicates;
+    VTOCVolume *volume = NULL;
+    for (int i = 0; i < count; i++) {
+      if (found[i] || requests[i]->rc != 0) {
+        continue;
+      }
+      if (volume == NULL) {
+        volume = findVolume(cache, requests[0]->volser, now);
+        if (volume == NULL) {
+          volume = addVolume(cache, requests[0]->volser, now);
+        }
+      }
+      storeDataset(cache, volume, requests[i]);
+    }
+  }
+  pthread_mutex_unlock(&cache->lock);
+}
+
+void obtainDSCBs(VTOCCache *cache, VTOCObtain *obtain, void *userData,
+                 DSCBRequest *requests, int requestCount) {
+  if (requestCount <= 0) {
+    return;
+  }
+  DSCBRequest **sorted = (DSCBRequest **)safeMalloc(sizeof(DSCBRequest *) * requestCount,
+                                                    "DSCB requests");
+  bool *found = (bool *)safeMalloc(sizeof(bool) * requestCount, "DSCB requests found");
+  for (int i = 0; i < requestCount; i++) {
+    sorted[i] = &requests[i];
+    found[i] = false;
+  }
+  qsort(sorted, requestCount, sizeof(DSCBRequest *), compareRequests);
+
+  int start = 0;
+  while (start < requestCount) {
+    int end = start + 1;
+    while (end < requestCount && isSameVolume(sorted[start], sorted[end])) {
+      end++;
+    }
+    if (cache) {
+      lookupVolumeDSCBs(cache, &sorted[start], end - start, &found[start]);
+    }
+    uint64 obtains = 0;
+    uint64 duplicates = 0;
+    for (int i = start; i < end; i++) {
+      if (found[i]) {
+        continue;
+      }
+      if (i > start && isSameDataset(sorted[i - 1], sorted[i])) {
+        memcpy(sorted[i]->dscb, sorted[i - 1]->dscb, VTOC_CACHE_DSCB_SIZE);
+        sorted[i]->rc = sorted[i - 1]->rc;
+        found[i] = true;
+        duplicates++;
+        continue;
+      }
+      sorted[i]->rc = obtain(userData, sorted[i]->name, sorted[i]->volser, sorted[i]->dscb);
+      obtains++;
+    }
+    if (cache) {
+      storeVolumeDSCBs(cache, &sorted[start], end - start, &found[start], obtains, duplicates);
+    }
+    start = end;
+  }
+
+  safeFree((char *)found, sizeof(bool) * requestCount);
+  safeFree((char *)sorted, sizeof(DSCBRequest *) * requestCount);
+}
+
+void invalidateVTOCCacheDataset(VTOCCache *cache, const char *dsn) {
+  char name[VTOC_CACHE_NAME_LENGTH];
+  memset(name, ' ', sizeof(name));
+  for (int i = 0; i < VTOC_CACHE_NAME_LENGTH && dsn[i]; i++) {
+    name[i] = dsn[i];
+  }
+  pthread_mutex_lock(&cache->lock);
+  {
+    for (int i = 0; i < cache->volumeCount; i++) {
+      VTOCVolume *volume = &cache->volumes[i];
+      int index = findDataset(volume, name);
+      if (index >= 0) {
+        memmove(&volume->datasets[index], &volume->datasets[index + 1],
+                (volume->datasetCount - index - 1) * sizeof(VTOCDataset));
+        volume->datasetCount--;
+        cache->stats.datasets--;
+        cache->stats.invalidations++;
+      }
+    }
+  }
+  pthread_mutex_unlock(&cache->lock);
+}
+
+void getVTOCCacheStats(VTOCCache *cache, VTOCCacheStats *stats) {
+  pthread_mutex_lock(&cache->lock);
+  {
+    *stats = cache->stats;
+    stats->volumes = cache->volumeCount;
+  }
+  pthread_mutex_unlock(&cache->lock);
+}
+
+
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
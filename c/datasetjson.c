@@ -19,6 +19,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#include <time.h>
 #include <sys/stat.h>
 #include "zowetypes.h"
 #include "alloc.h"
@@ -45,6 +46,18 @@
 #include "vsam.h"
 #include "qsam.h"
 #include "icsf.h"
+#include "datasetBlockReader.h"
+#include "datasetBlockCopy.h"
+#include "datasetETagCache.h"
+#include "datasetDigest.h"
+#include "datasetRecordParser.h"
+#include "datasetRecordFormat.h"
+#include "datasetCopy.h"
+#include "datasetCopyJobs.h"
+#include "datasetCSICache.h"
+#include "datasetVTOCCache.h"
+#include "datasetDirectoryCache.h"
+#include "datasetHLQCache.h"
 
 #define INDEXED_DSCB      96
 #define LEN_THREE_BYTES   3
@@ -79,6 +92,13 @@
 #define ERROR_COPY_NOT_SUPPORTED          -18
 #define ERROR_COPYING_DATASET             -19
 
+#define COPY_JOB_STARTED                  1
+
+/* How getDatasetMetadata uses the CSI result cache */
+#define CSI_CACHE_MODE_OFF      0   /* always search, for callers that act on the result */
+#define CSI_CACHE_MODE_USE      1
+#define CSI_CACHE_MODE_REFRESH  2   /* search and store, for updateCache=true */
+
 
 static char defaultDatasetTypesAllowed[3] = {'A','D','X'};
 static char clusterTypesAllowed[3] = {'C','D','I'}; /* TODO: support 'I' type DSNs */
@@ -91,6 +111,9 @@ static int defaultVSAMCSIFieldCount = 4;
 static char vsamCSITypes[5] = {'R', 'D', 'G', 'I', 'C'};
 
 static char getRecordLengthType(char *dscb);
+static PDSDirectory *getPDSDirectory(const char *datasetName, const char *user, const char *dscb);
+static void freeCSIEntry(EntryData *entry);
+static void freeCSIEntrySet(EntryDataSet *entrySet);
 static int getMaxRecordLength(char *dscb);
 
 //Below uses CKD 3390 numbers
@@ -100,6 +123,61 @@ static int bytesPerCylinder=849960;
 
 const static int DSCB_TRACE = FALSE;
 
+static DatasetAllocCache *datasetAllocCache = NULL;
+static DatasetETagCache *datasetETagCache = NULL;
+static CopyJobPool *copyJobPool = NULL;
+static CSIQueryCache *csiQueryCache = NULL;
+static VTOCCache *vtocCache = NULL;
+static PDSDirectoryCache *pdsDirectoryCache = NULL;
+
+void setDatasetAllocCache(DatasetAllocCache *cache) {
+  datasetAllocCache = cache;
+}
+
+DatasetAllocCache *getDatasetAllocCache(void) {
+  return datasetAllocCache;
+}
+
+void setDatasetETagCache(DatasetETagCache *cache) {
+  datasetETagCache = cache;
+}
+
+DatasetETagCache *getDatasetETagCache(void) {
+  return datasetETagCache;
+}
+
+void setCopyJobPool(CopyJobPool *pool) {
+  copyJobPool = pool;
+}
+
+CopyJobPool *getCopyJobPool(void) {
+  return copyJobPool;
+}
+
+void setCSIQueryCache(CSIQueryCache *cache) {
+  csiQueryCache = cache;
+}
+
+CSIQueryCache *getCSIQueryCache(void) {
+  return csiQueryCache;
+}
+
+void setVTOCCache(VTOCCache *cache) {
+  vtocCache = cache;
+}
+
+VTOCCache *getVTOCCache(void) {
+  return vtocCache;
+}
+
+void setPDSDirectoryCache(PDSDirectoryCache *cache) {
+  pdsDirectoryCache = cache;
+}
+
+PDSDirectoryCache *getPDSDirectoryCache(void) {
+  return pdsDirectoryCache;
+}
+
 typedef struct DatasetName_tag {
   char value[44]; /* space-padded */
 } DatasetName;
@@ -122,8 +200,24 @@ static int getDSCB(DatasetName *dsName, char* dscb, int bufferSize);
 static int setDatasetAttributesForCreation(JsonObject *object, int *configsCount, TextUnit **inputTextUnit);
 int createDataset(HttpResponse* response, char* absolutePath, char* datasetAttributes, int translationLength, int* reasonCode);
 
-static int getLreclOrRespondError(HttpResponse *response, const DatasetName *dsn, const char *ddPath) {
+static void getBlockFormatFromDSCB(char *dscb, DatasetBlockFormat *format) {
+  int posOffset = 44;
+  int recfm = dscb[84 - posOffset];
+  format->recfm = getRecordLengthType(dscb);
+  format->blocked = (recfm & 0x10) ? true : false;
+  format->spanned = (format->recfm == 'V' && (recfm & 0x08)) ? true : false;
+  format->lrecl = getMaxRecordLength(dscb);
+  format->blksize = ((dscb[86 - posOffset] & 0xFF) << 8) | (dscb[87 - posOffset] & 0xFF);
+}
+
+/*
+  format is optional; when given it receives the record format details that
+  allow reading the dataset a block at a time.
+ */
+static int getLreclOrRespondError(HttpResponse *response, const DatasetName *dsn, const char *ddPath,
+                                  DatasetBlockFormat *format) {
   int lrecl = 0;
+  DatasetBlockFormat discoveredFormat = {0};
 
   FileInfo info;
   int returnCode;
@@ -154,6 +248,7 @@ static int getLreclOrRespondError(HttpResponse *response, const DatasetName *dsn
 
       lrecl = getMaxRecordLength(dscb);
       char recordType = getRecordLengthType(dscb);
+      getBlockFormatFromDSCB(dscb, &discoveredFormat);
       if (recordType == 'U'){
         fclose(in);
         respondWithError(response, HTTP_STATUS_BAD_REQUEST,"Undefined-length dataset");
@@ -176,6 +271,11 @@ static int getLreclOrRespondError(HttpResponse *response, const DatasetName *dsn
         return 0;
       }
       lrecl = fileinfo.__maxreclen;
+      discoveredFormat.recfm = fileinfo.__recfmF ? 'F' : 'V';
+      discoveredFormat.blocked = fileinfo.__recfmBlk ? true : false;
+      discoveredFormat.spanned = fileinfo.__recfmS && !fileinfo.__recfmF ? true : false;
+      discoveredFormat.lrecl = lrecl;
+      discoveredFormat.blksize = fileinfo.__blksize;
     } else {
       fclose(in);
       respondWithError(response, HTTP_STATUS_INTERNAL_SERVER_ERROR,
@@ -185,146 +285,301 @@ static int getLreclOrRespondError(HttpResponse *response, const DatasetName *dsn
   }
   fclose(in);
 
+  if (format) {
+    *format = discoveredFormat;
+  }
   return lrecl;
 }
 
+#ifdef __ZOWE_OS_ZOS
+
+/* Large reads are only used when nothing needs per-record boundaries, e.g. when
+   only the etag is wanted. Binary stream reads of a record dataset return the
+   concatenated record data, which is exactly what gets hashed record by record,
+   so both modes produce the same etag. */
+#define DATASET_HASH_BUFFER_SIZE 0x10000
+
+#define DATASET_READ_EMIT_RECORDS  0x01
+#define DATASET_READ_HASH          0x02
+#define DATASET_READ_COUNT_RECORDS 0x04
+
+#define DATASET_ETAG_MAX_HASH_LENGTH 32
+
+/* eTagRC of a read that failed or was stopped before the end of the data */
+#define DATASET_READ_ETAG_INCOMPLETE -2
+
+static void *allocDigestBatch(void) {
+  return safeMalloc(DATASET_DIGEST_BATCH_SIZE, "etag digest batch");
+}
+
+static void freeDigestBatch(void *batch) {
+  safeFree(batch, DATASET_DIGEST_BATCH_SIZE);
+}
+
+typedef int DatasetRecordConsumer(void *userData, char *record, int recordLength);
+
+typedef struct DatasetReadRange_tag {
+  int start; /* records skipped before the first one emitted */
+  int count; /* most records emitted, -1 for the rest of the dataset */
+} DatasetReadRange;
+
+typedef struct DatasetReadResult_tag {
+  int recordCount;    /* records emitted, or counted */
+  int recordsSkipped;
+  int64 byteCount;    /* record data emitted or hashed */
+  bool hasMore;       /* the range ended before the data did */
+  int eTagRC;
+  char eTag[DATASET_ETAG_MAX_HASH_LENGTH * 2 + 1]; /* hex, null-terminated */
+} DatasetReadResult;
+
 /*
- TODO this duplicates a lot of stremDataset. Thinking of putting conditionals on streamDataset writing to json stream, but then function becomes misleading.
+  Reads whole blocks and deblocks them in place. Fixed-length blocks are hashed
+  in one piece since they are just the concatenation of their records; for
+  variable-length ones only the record data is hashed, so the etag is the same
+  as for a record-at-a-time read. Records before the range are skipped a block
+  at a time where the format allows it, which saves deblocking them but not
+  reading them: every block up to the end of the range is read, so a range
+  costs the I/O of a full read that far.
  */
-static char *getDatasetETag(char *filename, int recordLength, int *rc, int *eTagReturnLength) {
-  
-#ifdef __ZOWE_OS_ZOS
-  int rcEtag = 0;
-  int eTagLength = 0;
-    
-  // Note: to allow processing of zero-length records set _EDC_ZERO_RECLEN=Y
-  int defaultSize = DATA_STREAM_BUFFER_SIZE;
-  FILE *in;
-  if (recordLength < 1){
-    recordLength = defaultSize;
-    in = fopen(filename,"rb");
-  }
-  else {
-    in = fopen(filename,"rb, type=record");
+static int readDatasetBlocks(BlockSource *source, DatasetDigest *digest, int *rcEtag,
+                             bool emitRecords, const DatasetReadRange *range,
+                             DatasetRecordConsumer *consumer, void *consumerData,
+                             DatasetReadResult *result) {
+  DatasetBlockReader *reader = makeDatasetBlockReader(source, NULL, 0);
+  bool fixed = (source->format.recfm == 'F');
+  int lrecl = source->format.lrecl;
+  int limit = (range && range->count >= 0) ? range->count : -1;
+  int rc = 0;
+  bool stopped = false;
+
+  if (range && range->start > 0) {
+    int skipRC = blockReaderSkipRecords(reader, range->start, &result->recordsSkipped);
+    if (skipRC < 0) {
+      zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "Error skipping to record %d, rc=%d\n",
+              range->start, skipRC);
+      rc = ERROR_DECODING_DATASET;
+      stopped = true;
+    }
   }
 
-  ICSFDigest digest;
-  char hash[32];
-
-  int bufferSize = recordLength+1;
-  char buffer[bufferSize];
-  int contentLength = 0;
-  int bytesRead = 0;
-  if (in) {
-    rcEtag = icsfDigestInit(&digest, ICSF_DIGEST_SHA1);
-    if (rcEtag) { //if etag generation has an error, just don't send it.
-      zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_WARNING,  "ICSF error for SHA etag init, %d\n",rcEtag);
-    } else {
-      while (!feof(in)){
-        bytesRead = fread(buffer,1,recordLength,in);
-        if (bytesRead > 0 && !ferror(in)) {
-          rcEtag = icsfDigestUpdate(&digest, buffer, bytesRead);
-          contentLength = contentLength + bytesRead;
-        } else if (bytesRead == 0 && !feof(in) && !ferror(in)) {
-          // empty record
-        } else if (ferror(in)) {
-          zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG,  "Error reading DSN=%s, rc=%d\n", filename, bytesRead);
+  while (!stopped) {
+    if (limit >= 0 && result->recordCount >= limit) {
+      /* look one record ahead so the caller can tell if anything is left */
+      int peeked = 0;
+      result->hasMore = (blockReaderSkipRecords(reader, 1, &peeked) == BLOCK_READER_RC_OK && peeked == 1);
+      break;
+    }
+    char *data = NULL;
+    int length = 0;
+    int readRC = fixed ? blockReaderNextBlock(reader, &data, &length)
+                       : blockReaderNextRecord(reader, &data, &length);
+    if (readRC == BLOCK_READER_RC_EOF) {
+      break;
+    } else if (readRC != BLOCK_READER_RC_OK) {
+      zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "Error deblocking block %d, rc=%d\n",
+              reader->blocksRead, readRC);
+      rc = ERROR_DECODING_DATASET;
+      break;
+    }
+    if (length > 0 && !*rcEtag) { *rcEtag = datasetDigestUpdate(digest, data, length); }
+    if (fixed) {
+      for (int offset = 0; offset < length; offset += lrecl) {
+        if (limit >= 0 && result->recordCount >= limit) {
+          result->hasMore = true;
+          stopped = true;
+          break;
+        }
+        result->recordCount++;
+        result->byteCount += lrecl;
+        if (emitRecords && consumer(consumerData, data + offset, lrecl)) {
+          if (!*rcEtag) { *rcEtag = DATASET_READ_ETAG_INCOMPLETE; }
+          stopped = true;
           break;
         }
       }
+    } else {
+      result->recordCount++;
+      result->byteCount += length;
+      if (emitRecords && consumer(consumerData, data, length)) {
+        if (!*rcEtag) { *rcEtag = DATASET_READ_ETAG_INCOMPLETE; }
+        stopped = true;
+      }
     }
-    fclose(in);
-    if (!rcEtag) { rcEtag = icsfDigestFinish(&digest, hash); }
-    if (rcEtag) {
-      zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_WARNING,  "ICSF error for SHA etag, %d\n",rcEtag);
-    }
-  }
-  else {
-    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "FAILED TO OPEN FILE\n");
-  }
-
-  *rc = rcEtag;
-
-  if (!rcEtag) {
-    // Convert hash text to hex.
-    eTagLength = digest.hashLength*2;
-    *eTagReturnLength = eTagLength;
-    char *eTag = safeMalloc(eTagLength+1, "datasetetag");
-    memset(eTag, '\0', eTagLength+1);
-    simpleHexPrint(eTag, hash, digest.hashLength);
-    return eTag;
   }
-
-#else /* not __ZOWE_OS_ZOS */
-
-  /* Currently nothing else has "datasets" */
-  /* TBD: Is it really necessary to provide this empty array?
-     It seems like the safest approach, not knowing anyting about the client..
-   */
-
-#endif /* not __ZOWE_OS_ZOS */
-  return NULL;
+  zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "Block read: %d blocks, %d records skipped, %d read\n",
+          reader->blocksRead, result->recordsSkipped, result->recordCount);
+  freeDatasetBlockReader(reader);
+  return rc;
 }
 
-int streamDataset(char *filename, int recordLength, jsonPrinter *jPrinter){
-#ifdef __ZOWE_OS_ZOS
+/*
+  Single pass over a sequential dataset or member: every block of data read is
+  hashed for the etag and, when DATASET_READ_EMIT_RECORDS is set, handed to the
+  consumer one record at a time. A consumer returning non-zero stops the read.
+  When format is given and the dataset is FB or VB the data is read a block at
+  a time, otherwise the C runtime hands out one record per fread.
+  DATASET_READ_COUNT_RECORDS makes a hash-only read report the record count too.
+  range is optional; a ranged read never produces an etag, as it does not see
+  the whole dataset. Neither does a read that fails or that the consumer stops,
+  which leaves eTagRC non-zero.
+  Returns 0 on success, ERROR_OPENING_DATASET or ERROR_DECODING_DATASET.
+ */
+static int readDataset(const char *filename, int recordLength, const DatasetBlockFormat *format,
+                       const DatasetReadRange *range, int flags,
+                       DatasetRecordConsumer *consumer, void *consumerData,
+                       DatasetReadResult *result) {
   // Note: to allow processing of zero-length records set _EDC_ZERO_RECLEN=Y
-  int defaultSize = DATA_STREAM_BUFFER_SIZE;
-  FILE *in;
-  if (recordLength < 1){
-    recordLength = defaultSize;
-    in = fopen(filename,"rb");
-  }
-  else {
-    in = fopen(filename,"rb, type=record");
+  bool emitRecords = (flags & DATASET_READ_EMIT_RECORDS) && consumer != NULL;
+  bool hash = (flags & DATASET_READ_HASH) && range == NULL;
+  bool fixedFormat = (format != NULL && format->recfm == 'F' && format->lrecl > 0);
+  /* FB record counts follow from the byte count, so they don't need record reads */
+  bool countFromBytes = (flags & DATASET_READ_COUNT_RECORDS) && fixedFormat && !emitRecords;
+  bool needRecords = emitRecords || ((flags & DATASET_READ_COUNT_RECORDS) && !countFromBytes);
+
+  memset(result, 0, sizeof(DatasetReadResult));
+  result->eTagRC = -1;
+
+  BlockSource *blockSource = NULL;
+  FILE *in = NULL;
+  int readSize = 0;
+  if (needRecords && format != NULL && isBlockReadableFormat(format)) {
+    blockSource = openDatasetBlockSource(filename, format);
+  }
+  if (blockSource == NULL) {
+    if (needRecords && recordLength > 0) {
+      readSize = recordLength;
+      in = fopen(filename, "rb, type=record");
+    } else {
+      readSize = emitRecords ? DATA_STREAM_BUFFER_SIZE : DATASET_HASH_BUFFER_SIZE;
+      in = fopen(filename, "rb");
+    }
+    if (in == NULL) {
+      zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "FAILED TO OPEN FILE\n");
+      return ERROR_OPENING_DATASET;
+    }
   }
 
-  int rcEtag;
-  ICSFDigest digest;
-  char hash[32];
-
-  int bufferSize = recordLength+1;
-  char buffer[bufferSize];
-  jsonStartArray(jPrinter,"records");
-  int contentLength = 0;
-  int bytesRead = 0;
-  if (in) {
-    rcEtag = icsfDigestInit(&digest, ICSF_DIGEST_SHA1);
+  /* records are collected into large batches before they are hashed */
+  DatasetDigest digest;
+  char *digestBatch = NULL;
+  int rcEtag = -1;
+  if (hash) {
+    digestBatch = allocDigestBatch();
+    rcEtag = datasetDigestInit(&digest, 0, digestBatch, DATASET_DIGEST_BATCH_SIZE);
     if (rcEtag) { //if etag generation has an error, just don't send it.
-      zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_WARNING,  "ICSF error for SHA etag init, %d\n",rcEtag);
-    }
-    while (!feof(in)){
-      bytesRead = fread(buffer,1,recordLength,in);
-      if (bytesRead > 0 && !ferror(in)) {
-        if (!rcEtag) { rcEtag = icsfDigestUpdate(&digest, buffer, bytesRead); }
-        jsonAddUnterminatedString(jPrinter, NULL, buffer, bytesRead);
-        contentLength = contentLength + bytesRead;
-      } else if (bytesRead == 0 && !feof(in) && !ferror(in)) {
-        // empty record
-        jsonAddString(jPrinter, NULL, "");
-      } else if (ferror(in)) {
-        zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG,  "Error reading DSN=%s, rc=%d\n", filename, bytesRead);
+      zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_WARNING, "Error for %s etag init, %d\n",
+              getDatasetDigestName(digest.type), rcEtag);
+    }
+  }
+
+  int rc = 0;
+  if (blockSource) {
+    rc = readDatasetBlocks(blockSource, &digest, &rcEtag, emitRecords, range,
+                           consumer, consumerData, result);
+    closeBlockSource(blockSource);
+  } else {
+    int toSkip = range ? range->start : 0;
+    int limit = (range && range->count >= 0) ? range->count : -1;
+    int bufferSize = readSize + 1;
+    char *buffer = safeMalloc(bufferSize, "dataset read buffer");
+    while (!feof(in)) {
+      int bytesRead = fread(buffer, 1, readSize, in);
+      if (ferror(in)) {
+        zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "Error reading DSN=%s, rc=%d\n", filename, bytesRead);
+        rc = ERROR_DECODING_DATASET;
+        break;
+      } else if (bytesRead == 0 && feof(in)) {
+        break;
+      }
+      /* bytesRead == 0 without eof is an empty record */
+      if (result->recordsSkipped < toSkip) {
+        result->recordsSkipped++;
+        continue;
+      }
+      if (limit >= 0 && result->recordCount >= limit) {
+        result->hasMore = true;
+        break;
+      }
+      if (bytesRead > 0 && !rcEtag) { rcEtag = datasetDigestUpdate(&digest, buffer, bytesRead); }
+      result->byteCount += bytesRead;
+      if (needRecords) {
+        result->recordCount++;
+      }
+      if (emitRecords && consumer(consumerData, buffer, bytesRead)) {
+        if (!rcEtag) { rcEtag = DATASET_READ_ETAG_INCOMPLETE; }
         break;
       }
     }
+    safeFree(buffer, bufferSize);
     fclose(in);
-    if (!rcEtag) { rcEtag = icsfDigestFinish(&digest, hash); }
+    if (countFromBytes) {
+      result->recordCount = (int)(result->byteCount / format->lrecl);
+    }
   }
-  else {
-      zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "FAILED TO OPEN FILE\n");
+
+  if (hash) {
+    /* the hash of part of the data is no etag */
+    if (rc && !rcEtag) { rcEtag = DATASET_READ_ETAG_INCOMPLETE; }
+    if (!rcEtag) { rcEtag = datasetDigestFinishHex(&digest, result->eTag); }
+    if (rcEtag) {
+      zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_WARNING, "Error for %s etag, %d\n",
+              getDatasetDigestName(digest.type), rcEtag);
+    }
+    result->eTagRC = rcEtag;
+    freeDigestBatch(digestBatch);
+  }
+  return rc;
+}
+
+static int addRecordToJSON(void *userData, char *record, int recordLength) {
+  jsonPrinter *jPrinter = (jsonPrinter *)userData;
+  if (recordLength > 0) {
+    jsonAddUnterminatedString(jPrinter, NULL, record, recordLength);
+  } else {
+    jsonAddString(jPrinter, NULL, "");
   }
+  return 0;
+}
+
+/*
+  range is optional. eTag, when not NULL, holds the etag if the caller knows it
+  already, from the etag cache, or is empty. An unranged read hashes what it
+  streams unless the etag is known, and leaves it in eTag. A ranged read skips
+  the records before it and does not see the whole dataset, so it only reports
+  an etag that was known; hashing the whole dataset for it would cost the full
+  read that the range is there to avoid.
+ */
+static int streamDatasetWithFormat(char *filename, int recordLength, const DatasetBlockFormat *format,
+                                   const DatasetReadRange *range, char *eTag, jsonPrinter *jPrinter) {
+  DatasetReadResult result;
+  bool eTagKnown = (eTag != NULL && eTag[0] != '\0');
 
+  jsonStartArray(jPrinter,"records");
+  int rc = readDataset(filename, recordLength, format, range,
+                       DATASET_READ_EMIT_RECORDS | (eTagKnown ? 0 : DATASET_READ_HASH),
+                       addRecordToJSON, jPrinter, &result);
   jsonEndArray(jPrinter);
 
-  if (!rcEtag) {
-    // Convert hash text to hex.
-    int eTagLength = digest.hashLength*2;
-    char eTag[eTagLength+1];
-    memset(eTag, '\0', eTagLength+1);
-    simpleHexPrint(eTag, hash, digest.hashLength);
+  if (eTagKnown) {
     jsonAddString(jPrinter, "etag", eTag);
+  } else if (rc == 0 && !result.eTagRC) {
+    jsonAddString(jPrinter, "etag", result.eTag);
+    if (eTag) {
+      strcpy(eTag, result.eTag);
+    }
   }
+  if (range) {
+    jsonAddInt(jPrinter, "start", range->start);
+    jsonAddBoolean(jPrinter, "hasMore", result.hasMore);
+  }
+  return (int)result.byteCount;
+}
+
+#endif /* __ZOWE_OS_ZOS */
 
+int streamDataset(char *filename, int recordLength, jsonPrinter *jPrinter){
+#ifdef __ZOWE_OS_ZOS
+  int contentLength = streamDatasetWithFormat(filename, recordLength, NULL, NULL, NULL, jPrinter);
 #else /* not __ZOWE_OS_ZOS */
 
   /* Currently nothing else has "datasets" */
@@ -338,87 +593,284 @@ int streamDataset(char *filename, int recordLength, jsonPrinter *jPrinter){
   return contentLength;
 }
 
-int streamVSAMDataset(HttpResponse* response, char *acb, int maxRecordLength, int maxRecords, int maxBytes,
-                      int keyLoc, int keyLen, jsonPrinter *jPrinter) {
 #ifdef __ZOWE_OS_ZOS
-  int defaultSize = DATA_STREAM_BUFFER_SIZE;
+#define VSAM_MAX_KEY_LENGTH 255
 
-  int returnCode = 0;
-  int reasonCode = 0;
-  RPLCommon *rpl = NULL;
-
-  if (acb) {
-    rpl = (RPLCommon *)(acb+RPL_COMMON_OFFSET+8);
-  } else {
-    /* TODO: should never happen, but regardless, close out the JSON before this error so it doesn't look weird? */
-    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "We were not passed an ACB.\n");
-    /* respondWithError(response, HTTP_STATUS_INTERNAL_SERVER_ERROR,"Missing ACB"); should really return this */
-    return 8;
-  }
+/*
+  The part of a VSAM dataset that is streamed. Records are read from where the
+  ACB is positioned until maxRecords or maxBytes, when not 0, would be
+  exceeded, or until the key of a KSDS record sorts after stopKey, compared
+  over stopKeyLength bytes. The first record is always returned, however big,
+  so that every page makes progress.
+ */
+typedef struct VSAMReadRange_tag {
+  int type;
+  int maxRecords;
+  int maxBytes;
+  char *stopKey;
+  int stopKeyLength;
+} VSAMReadRange;
+
+/* A record to position at: the start of a page, or the record a page stopped
+   in front of, which was read but not returned */
+typedef struct VSAMReadPosition_tag {
+  bool found;
+  bool endOfRange;              /* the record is past the stop key */
+  char key[VSAM_MAX_KEY_LENGTH];  /* KSDS */
+  int keyLength;
+  unsigned int rba;             /* ESDS */
+  int record;                   /* RRDS */
+} VSAMReadPosition;
+
+/* Called with each record streamed and its key: the key of a KSDS, the RBA of
+   an ESDS or LDS, or the relative record number of an RRDS. Returns non-zero
+   to stop. */
+typedef int VSAMRecordHandler(void *userData, const char *key, int keyLength,
+                              const char *record, int recordLength);
+
+/* Returns the number of bytes streamed, or -1 when a record was bigger than
+   the catalog says records can be */
+static int streamVSAMRecords(char *acb, const VSAMReadRange *range, int keyLoc, int keyLen,
+                             VSAMReadPosition *next, VSAMRecordHandler *handler, void *userData) {
+  memset(next, 0, sizeof(VSAMReadPosition));
+  RPLCommon *rpl = (RPLCommon *)(acb+RPL_COMMON_OFFSET+8);
   int bufferSize = rpl->bufLen + 1;
-  int keyBufferSize = rpl->keyLen ? rpl->keyLen + 1 : 4;
+  int keyBufferSize = (keyLen > 4 ? keyLen : 4) + 1;
   char *buffer = safeMalloc(bufferSize, "VSAM buffer");
   char *keyBuffer = safeMalloc(keyBufferSize, "VSAM key buffer");
   memset(buffer,0,bufferSize);
   memset(keyBuffer,0,keyBufferSize);
-  jsonStartArray(jPrinter,"records");
 
   int contentLength = 0;
-  int encodedLength = 0;
-  int encodedKeyLength = 0;
-  char *encodedRecord = NULL;
-  char *encodedKey = NULL;
+  int recordCount = 0;
   int bytesRead = 0;
-  int rbaFound = 0;
+  unsigned int rbaFound = 0;
+  int recordFound = 0;
   int status = 0;
 
-  /* TODO: limit the bytes or records returned if those values are set */
   while (!(rpl->status)) {
     status = getRecord(acb, buffer, &bytesRead);
-    /* TODO: if the user enters a parm to skip the first record, we can call continue in this loop after getRecord, but before JSON gets sent */
     if (bytesRead > bufferSize) {
       zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "CRITICAL ERROR: Catalog was wrong about maximum record size.\n");
-      jsonAddString(jPrinter, NULL, "_ERROR: Catalog Error. Record found was too large.");
-      jsonEndArray(jPrinter);
+      contentLength = -1;
+      break;
+    }
+    if (rpl->status && (rpl->feedback & 0xFF) == 0x04) {
+      zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "eof found after RBA %u\n", rbaFound);
+      break;
+    } else if (rpl->status) {
+      zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "Read with error: ACB=%08x, rc=%d, rplRC = %02x%06x\n", acb, status, rpl->status, rpl->feedback);
+      break;
     }
     memset(buffer+bytesRead,0,bufferSize-bytesRead);
-    if (rpl->keyLen) {
-      memcpy(keyBuffer, buffer+keyLoc, keyLen);
-      keyBuffer[keyLen] = 0;
-    } else {
-      rbaFound = *(int *)((rpl->rba)+4);
-      zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "rbaFound = %d\n", rbaFound);
-      memcpy(keyBuffer, &rbaFound, 4);
+    int keyLength = 4;
+    switch (range->type) {
+      case VSAM_TYPE_KSDS:
+        memcpy(keyBuffer, buffer+keyLoc, keyLen);
+        keyLength = keyLen;
+        break;
+      case VSAM_TYPE_RRDS:
+        /* a sequential GET returns the relative record number in the argument */
+        memcpy(&recordFound, rpl->arg, 4);
+        memcpy(keyBuffer, &recordFound, 4);
+        break;
+      default:
+        rbaFound = *(unsigned int *)((rpl->rba)+4);
+        memcpy(keyBuffer, &rbaFound, 4);
+        break;
     }
-    if (!bytesRead && rpl->status) {
-      zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "Read 0 bytes with error: ACB=%08x, rc=%d, rplRC = %0x%06x\n", acb, status, rpl->status, rpl->feedback);
+    keyBuffer[keyLength] = 0;
+
+    bool pastStop = (range->type == VSAM_TYPE_KSDS && range->stopKey != NULL &&
+                     memcmp(keyBuffer, range->stopKey,
+                            range->stopKeyLength < keyLen ? range->stopKeyLength : keyLen) > 0);
+    bool full = ((range->maxRecords > 0 && recordCount >= range->maxRecords) ||
+                 (range->maxBytes > 0 && recordCount > 0 && contentLength + bytesRead > range->maxBytes));
+    if (pastStop || full) {
+      next->found = true;
+      next->endOfRange = pastStop;
+      memcpy(next->key, keyBuffer, keyLength);
+      next->keyLength = keyLength;
+      next->rba = rbaFound;
+      next->record = recordFound;
       break;
-    } else if (rpl->status && (rpl->feedback & 0xFF) == 0x04) { /* TODO: extra eof info to pass into json? */
-      zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "eof found after RBA %d\n", rbaFound);
-      /* TODO: I suggest we remove our hashtable entry, close the ACB, and free their relative memories here - but confirm this with team first. */
+    }
+
+    contentLength = contentLength + bytesRead;
+    recordCount++;
+    if (handler(userData, keyBuffer, keyLength, buffer, bytesRead)) {
       break;
-    } else {
-      contentLength = contentLength + bytesRead;
-      if (rpl->keyLen) {
-        zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "found (\"%s\",\"%s\") Total bytes = %d.\n", keyBuffer, buffer, contentLength);
-      } else{
-        zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "found (0x%08x,\"%s\") Total bytes = %d.\n", *(int *)keyBuffer, buffer, contentLength);
-      }
-      encodedRecord = encodeBase64(NULL, buffer, bytesRead, &encodedLength, 1);
-      encodedKey = encodeBase64(NULL, keyBuffer, keyLen ? keyLen : 4, &encodedKeyLength, 1);
-      jsonStartObject(jPrinter, NULL);
-      jsonAddString(jPrinter, "key", encodedKey);
-      jsonAddString(jPrinter, "record", encodedRecord);
-      jsonEndObject(jPrinter);
-      safeFree(encodedRecord, encodedLength);
-      safeFree(encodedKey, encodedKeyLength);
     }
-    if (rpl->status) zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "New Error: ACB=%08x, rc=%d, rplRC = %02x%06x\n", acb, status, rpl->status, rpl->feedback);
   }
+  zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "streamed %d VSAM records, %d bytes\n", recordCount, contentLength);
 
-  jsonEndArray(jPrinter);
   safeFree(buffer, bufferSize);
   safeFree(keyBuffer, keyBufferSize);
+  return contentLength;
+}
+
+/* {"key":<base64>,"record":<base64>} */
+static int addVSAMRecordToJSON(void *userData, const char *key, int keyLength,
+                               const char *record, int recordLength) {
+  jsonPrinter *jPrinter = (jsonPrinter *)userData;
+  int encodedLength = 0;
+  int encodedKeyLength = 0;
+  char *encodedRecord = encodeBase64(NULL, (char *)record, recordLength, &encodedLength, 1);
+  char *encodedKey = encodeBase64(NULL, (char *)key, keyLength, &encodedKeyLength, 1);
+  jsonStartObject(jPrinter, NULL);
+  jsonAddString(jPrinter, "key", encodedKey);
+  jsonAddString(jPrinter, "record", encodedRecord);
+  jsonEndObject(jPrinter);
+  safeFree(encodedRecord, encodedLength);
+  safeFree(encodedKey, encodedKeyLength);
+  return 0;
+}
+
+static int streamVSAMRecordsAsJSON(char *acb, const VSAMReadRange *range, int keyLoc, int keyLen,
+                                   VSAMReadPosition *next, jsonPrinter *jPrinter) {
+  jsonStartArray(jPrinter,"records");
+  int contentLength = streamVSAMRecords(acb, range, keyLoc, keyLen, next, addVSAMRecordToJSON, jPrinter);
+  if (contentLength < 0) {
+    jsonAddString(jPrinter, NULL, "_ERROR: Catalog Error. Record found was too large.");
+  }
+  jsonEndArray(jPrinter);
+  return contentLength;
+}
+
+/*
+  application/octet-stream VSAM records are frames of a big-endian halfword key
+  length, the key, a big-endian fullword record length and the record, with
+  the same keys as JSON has base64 encoded. Responses end with a frame of key
+  length VSAM_FRAME_END whose record is the key of the record the next page
+  starts at, empty when there is none, which startKey takes base64 encoded and
+  startRBA and startRecord take as a number. Frames are staged in a buffer and
+  sent a chunk per buffer.
+ */
+#define VSAM_FRAME_BUFFER_SIZE    0x10000
+#define VSAM_FRAME_KEY_PREFIX     2
+#define VSAM_FRAME_RECORD_PREFIX  4
+#define VSAM_FRAME_HEADER_LENGTH  (VSAM_FRAME_KEY_PREFIX + VSAM_FRAME_RECORD_PREFIX)
+#define VSAM_FRAME_END            0xFFFF
+
+typedef struct VSAMFrameStream_tag {
+  ChunkedOutputStream *out;
+  char *buffer;
+  int bufferSize;
+  int used;
+} VSAMFrameStream;
+
+static void flushVSAMFrameStream(VSAMFrameStream *stream) {
+  if (stream->used > 0) {
+    writeBytes(stream->out, stream->buffer, stream->used, NO_TRANSLATE);
+    stream->used = 0;
+  }
+}
+
+static void addVSAMFrameBytes(VSAMFrameStream *stream, const char *data, int length) {
+  if (stream->used + length > stream->bufferSize) {
+    flushVSAMFrameStream(stream);
+  }
+  if (length > stream->bufferSize) {
+    writeBytes(stream->out, (char *)data, length, NO_TRANSLATE);
+  } else {
+    memcpy(stream->buffer + stream->used, data, length);
+    stream->used += length;
+  }
+}
+
+static void addVSAMFrame(VSAMFrameStream *stream, int keyLength, const char *key,
+                         const char *record, int recordLength) {
+  unsigned char keyPrefix[VSAM_FRAME_KEY_PREFIX];
+  unsigned char recordPrefix[VSAM_FRAME_RECORD_PREFIX];
+  keyPrefix[0] = (keyLength >> 8) & 0xFF;
+  keyPrefix[1] = keyLength & 0xFF;
+  recordPrefix[0] = (recordLength >> 24) & 0xFF;
+  recordPrefix[1] = (recordLength >> 16) & 0xFF;
+  recordPrefix[2] = (recordLength >> 8) & 0xFF;
+  recordPrefix[3] = recordLength & 0xFF;
+  addVSAMFrameBytes(stream, (char *)keyPrefix, VSAM_FRAME_KEY_PREFIX);
+  if (keyLength != VSAM_FRAME_END) {
+    addVSAMFrameBytes(stream, key, keyLength);
+  }
+  addVSAMFrameBytes(stream, (char *)recordPrefix, VSAM_FRAME_RECORD_PREFIX);
+  addVSAMFrameBytes(stream, record, recordLength);
+}
+
+static int addVSAMRecordToFrameStream(void *userData, const char *key, int keyLength,
+                                      const char *record, int recordLength) {
+  addVSAMFrame((VSAMFrameStream *)userData, keyLength, key, record, recordLength);
+  return 0;
+}
+
+/* The ends of a frame that splitVSAMFrames found */
+typedef struct VSAMFrame_tag {
+  const char *key;
+  int keyLength;
+  const char *record;
+  int recordLength;
+} VSAMFrame;
+
+typedef int VSAMFrameHandler(void *userData, const VSAMFrame *frame, int index);
+
+/* Returns what the handler returned, or -1 with *badIndex set when a frame
+   runs past the end of the body. An end frame, as reads send, ends the body. */
+static int splitVSAMFrames(const char *body, int length,
+                           VSAMFrameHandler *handler, void *userData, int *badIndex) {
+  const unsigned char *data = (const unsigned char *)body;
+  int index = 0;
+  int position = 0;
+  while (position < length) {
+    *badIndex = index;
+    if (length - position < VSAM_FRAME_KEY_PREFIX) {
+      return -1;
+    }
+    int keyLength = (data[position] << 8) | data[position + 1];
+    if (keyLength == VSAM_FRAME_END) {
+      return 0;
+    }
+    position += VSAM_FRAME_KEY_PREFIX;
+    if (keyLength > length - position ||
+        length - position - keyLength < VSAM_FRAME_RECORD_PREFIX) {
+      return -1;
+    }
+    VSAMFrame frame;
+    frame.key = body + position;
+    frame.keyLength = keyLength;
+    position += keyLength;
+    unsigned int recordLength = ((unsigned int)data[position] << 24) | (data[position + 1] << 16) |
+                                (data[position + 2] << 8) | data[position + 3];
+    position += VSAM_FRAME_RECORD_PREFIX;
+    if (recordLength > (unsigned int)(length - position)) {
+      return -1;
+    }
+    frame.record = body + position;
+    frame.recordLength = (int)recordLength;
+    position += frame.recordLength;
+    int rc = handler(userData, &frame, index++);
+    if (rc) {
+      return rc;
+    }
+  }
+  return 0;
+}
+#endif /* __ZOWE_OS_ZOS */
+
+/* Streams at most maxRecords records and maxBytes bytes, 0 meaning no limit,
+   from where the ACB is positioned */
+int streamVSAMDataset(HttpResponse* response, char *acb, int maxRecordLength, int maxRecords, int maxBytes,
+                      int keyLoc, int keyLen, jsonPrinter *jPrinter) {
+#ifdef __ZOWE_OS_ZOS
+  if (!acb) {
+    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "We were not passed an ACB.\n");
+    return 8;
+  }
+  RPLCommon *rpl = (RPLCommon *)(acb+RPL_COMMON_OFFSET+8);
+  VSAMReadRange range = {0};
+  range.type = (rpl->keyLen && keyLen) ? VSAM_TYPE_KSDS : VSAM_TYPE_ESDS;
+  range.maxRecords = maxRecords;
+  range.maxBytes = maxBytes;
+  VSAMReadPosition next;
+  int contentLength = streamVSAMRecordsAsJSON(acb, &range, keyLoc, keyLen, &next, jPrinter);
 
 #else /* not __ZOWE_OS_ZOS */
 
@@ -781,16 +1233,14 @@ static int obtainDSCB1(const char *dsname, unsigned int dsnameLength,
 }
 
 #ifdef __ZOWE_OS_ZOS
-void addDetailedDatasetMetadata(char *datasetName, int nameLength,
-                                char *volser, int volserLength,
-                                jsonPrinter *jPrinter) {
+/* VTOCObtain for the listings' DSCB lookups */
+static int obtainListedDSCB(void *userData, const char *dsname, const char *volser, char *dscb) {
+  return obtainDSCB1(dsname, VTOC_CACHE_NAME_LENGTH, volser, VTOC_CACHE_VOLSER_LENGTH, dscb);
+}
 
+static void addDetailsFromObtainedDSCB(char *datasetName, int rc, char *dscb,
+                                       jsonPrinter *jPrinter) {
   int isPDS = FALSE;
-  zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "Going to check dataset %s attributes\n",datasetName);
-  char dscb[INDEXED_DSCB] = {0};
-  int rc = obtainDSCB1(datasetName, nameLength,
-                       volser, volserLength,
-                       dscb);
   if (rc == 0){
     if (DSCB_TRACE){
       zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "DSCB for %s found\n",datasetName);
@@ -804,32 +1254,218 @@ void addDetailedDatasetMetadata(char *datasetName, int nameLength,
     jsonAddString(jPrinter,"error",buffer);
   }
 }
-#endif /* __ZOWE_OS_ZOS */
 
-#ifdef __ZOWE_OS_ZOS
-void addMemberedDatasetMetadata(char *datasetName, int nameLength,
+void addDetailedDatasetMetadata(char *datasetName, int nameLength,
                                 char *volser, int volserLength,
-                                char *memberQuery, int memberLength,
-                                jsonPrinter *jPrinter,
-                                int includeUnprintable) {
+                                jsonPrinter *jPrinter) {
 
-  int isPDS = FALSE;
+  zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "Going to check dataset %s attributes\n",datasetName);
   char dscb[INDEXED_DSCB] = {0};
   int rc = obtainDSCB1(datasetName, nameLength,
                        volser, volserLength,
                        dscb);
+  addDetailsFromObtainedDSCB(datasetName, rc, dscb, jPrinter);
+}
+#endif /* __ZOWE_OS_ZOS */
 
-  if (rc != 0) {
-    char buffer[100];
-    sprintf(buffer, "Type 1 or 8 DSCB for dataset %s not found", datasetName);
-    jsonAddString(jPrinter, "error", buffer);
-    return;
+#ifdef __ZOWE_OS_ZOS
+/* Member names are written with the bytes below X'40' percent encoded, into
+   encoded, which has room for 25 characters. Returns false for a name with
+   such bytes when they are not to be included. */
+static bool encodeMemberName(const char *memberName, int includeUnprintable, char *encoded) {
+  static const char hexDigits[] = "0123456789abcdef";
+  int namePos = 0;
+  for (int j = 0; j < 8; j++) {
+    unsigned char c = (unsigned char)memberName[j];
+    if (c < 0x40) {
+      if (includeUnprintable == FALSE) {
+        return false;
+      }
+      encoded[namePos++] = '%';
+      encoded[namePos++] = hexDigits[c >> 4];
+      encoded[namePos++] = hexDigits[c & 0xF];
+    } else {
+      encoded[namePos++] = c;
+    }
   }
+  encoded[namePos] = '\0';
+  return true;
+}
 
-  /* Use the DSCB to determine if it's
-   * a PDS or not, then free the
-   * memory.
-   */
+#define PDS_DIRECTORY_BLOCK_SIZE          256
+#define PDS_DIRECTORY_ENTRY_FIXED_LENGTH  12  /* name, TTR and the C byte */
+#define PDS_DIRECTORY_USER_DATA_HALFWORDS 0x1F
+#define PDS_DIRECTORY_USER_DATA_TTRS      0x60  /* load modules keep TTRs in the user data */
+
+/* The ISPF statistics kept in the user data of a member's directory entry */
+#define ISPF_STATS_LENGTH           30
+#define ISPF_STATS_EXTENDED_LENGTH  40
+#define ISPF_STATS_FLAG_SCLM        0x80
+#define ISPF_STATS_FLAG_EXTENDED    0x20
+
+typedef struct ISPFStatistics_tag {
+  int version;
+  int modification;
+  bool sclm;
+  int createdYear, createdMonth, createdDay;
+  int modifiedYear, modifiedMonth, modifiedDay;
+  int modifiedHour, modifiedMinute, modifiedSecond;
+  int lines;
+  int initialLines;
+  int modifiedLines;
+  char user[9];
+} ISPFStatistics;
+
+/* Unpacks length bytes of packed decimal digits, without a sign. Returns -1
+   when a nibble is not a digit. */
+static int unpackDigits(const unsigned char *packed, int length) {
+  int value = 0;
+  for (int i = 0; i < length; i++) {
+    int high = packed[i] >> 4;
+    int low = packed[i] & 0xF;
+    if (high > 9 || low > 9) {
+      return -1;
+    }
+    value = value * 100 + high * 10 + low;
+  }
+  return value;
+}
+
+/* A date packed as 0CYYDDDF, C being the century after 1900 */
+static bool unpackJulianDate(const unsigned char *packed, int *year, int *month, int *day) {
+  static const int monthDays[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+  int century = unpackDigits(packed, 1);
+  int yearInCentury = unpackDigits(packed + 1, 1);
+  int dayTens = unpackDigits(packed + 2, 1);
+  int dayUnits = packed[3] >> 4;
+  if (century < 0 || yearInCentury < 0 || dayTens < 0 || dayUnits > 9 || (packed[3] & 0xF) != 0xF) {
+    return false;
+  }
+  int dayOfYear = dayTens * 10 + dayUnits;
+  *year = 1900 + century * 100 + yearInCentury;
+  bool leapYear = (*year % 4 == 0 && *year % 100 != 0) || *year % 400 == 0;
+  if (dayOfYear < 1 || dayOfYear > (leapYear ? 366 : 365)) {
+    return false;
+  }
+  int m = 0;
+  while (dayOfYear > monthDays[m] + (m == 1 && leapYear)) {
+    dayOfYear -= monthDays[m] + (m == 1 && leapYear);
+    m++;
+  }
+  *month = m + 1;
+  *day = dayOfYear;
+  return true;
+}
+
+static int getHalfword(const unsigned char *data) {
+  return (data[0] << 8) | data[1];
+}
+
+static int getFullword(const unsigned char *data) {
+  return (data[0] << 24) | (data[1] << 16) | (data[2] << 8) | data[3];
+}
+
+/*
+  Decodes the ISPF statistics from a cached directory entry, which holds the
+  TTR, the C byte and the user data. Returns false for members without them,
+  such as load modules or members saved with statistics off.
+ */
+static bool decodeISPFStatistics(const PDSMemberEntry *member, ISPFStatistics *stats) {
+  const unsigned char *entry = (const unsigned char *)member->data;
+  if (member->dataLength < 4) {
+    return false;
+  }
+  unsigned char c = entry[3];
+  int userDataLength = (c & PDS_DIRECTORY_USER_DATA_HALFWORDS) * 2;
+  if ((c & PDS_DIRECTORY_USER_DATA_TTRS) || userDataLength < ISPF_STATS_LENGTH ||
+      member->dataLength < 4 + userDataLength) {
+    return false;
+  }
+  const unsigned char *data = entry + 4;
+  bool extended = (data[2] & ISPF_STATS_FLAG_EXTENDED) && userDataLength >= ISPF_STATS_EXTENDED_LENGTH;
+  memset(stats, 0, sizeof(ISPFStatistics));
+  stats->version = data[0];
+  stats->modification = data[1];
+  stats->sclm = (data[2] & ISPF_STATS_FLAG_SCLM) != 0;
+  stats->modifiedSecond = unpackDigits(data + 3, 1);
+  stats->modifiedHour = unpackDigits(data + 12, 1);
+  stats->modifiedMinute = unpackDigits(data + 13, 1);
+  if (stats->modifiedSecond < 0 || stats->modifiedSecond > 59 ||
+      stats->modifiedHour < 0 || stats->modifiedHour > 23 ||
+      stats->modifiedMinute < 0 || stats->modifiedMinute > 59 ||
+      !unpackJulianDate(data + 4, &stats->createdYear, &stats->createdMonth, &stats->createdDay) ||
+      !unpackJulianDate(data + 8, &stats->modifiedYear, &stats->modifiedMonth, &stats->modifiedDay)) {
+    return false;
+  }
+  if (extended) {
+    stats->lines = getFullword(data + 28);
+    stats->initialLines = getFullword(data + 32);
+    stats->modifiedLines = getFullword(data + 36);
+  } else {
+    stats->lines = getHalfword(data + 14);
+    stats->initialLines = getHalfword(data + 16);
+    stats->modifiedLines = getHalfword(data + 18);
+  }
+  int userLength = 8;
+  while (userLength > 0 && (data[20 + userLength - 1] == ' ' || data[20 + userLength - 1] == 0)) {
+    userLength--;
+  }
+  memcpy(stats->user, data + 20, userLength);
+  stats->user[userLength] = '\0';
+  return true;
+}
+
+static void addISPFStatistics(jsonPrinter *jPrinter, const PDSMemberEntry *member) {
+  ISPFStatistics stats;
+  if (!decodeISPFStatistics(member, &stats)) {
+    return;
+  }
+  char buffer[24];
+  jsonStartObject(jPrinter, "stats");
+  {
+    snprintf(buffer, sizeof(buffer), "%02d.%02d", stats.version, stats.modification);
+    jsonAddString(jPrinter, "version", buffer);
+    snprintf(buffer, sizeof(buffer), "%04d-%02d-%02d",
+             stats.createdYear, stats.createdMonth, stats.createdDay);
+    jsonAddString(jPrinter, "created", buffer);
+    snprintf(buffer, sizeof(buffer), "%04d-%02d-%02dT%02d:%02d:%02d",
+             stats.modifiedYear, stats.modifiedMonth, stats.modifiedDay,
+             stats.modifiedHour, stats.modifiedMinute, stats.modifiedSecond);
+    jsonAddString(jPrinter, "modified", buffer);
+    jsonAddInt(jPrinter, "lines", stats.lines);
+    jsonAddInt(jPrinter, "initialLines", stats.initialLines);
+    jsonAddInt(jPrinter, "modifiedLines", stats.modifiedLines);
+    jsonAddString(jPrinter, "user", stats.user);
+    jsonAddBoolean(jPrinter, "sclm", stats.sclm);
+  }
+  jsonEndObject(jPrinter);
+}
+
+/*
+  Lists the members matching memberQuery, from resumeMember on when it is not
+  NULL, and at most memberLimit of them when it is not 0. Only the members
+  starting with the query's literal prefix are looked at. The ISPF statistics
+  come from the same cached directory entries, so they cost no extra reads.
+ */
+static void addMembersOfObtainedDataset(char *datasetName, int rc, char *dscb,
+                                        char *memberQuery, int memberLength,
+                                        jsonPrinter *jPrinter,
+                                        int includeUnprintable, int includeStats,
+                                        const char *user,
+                                        const char *resumeMember, int memberLimit) {
+
+  int isPDS = FALSE;
+  if (rc != 0) {
+    char buffer[100];
+    sprintf(buffer, "Type 1 or 8 DSCB for dataset %s not found", datasetName);
+    jsonAddString(jPrinter, "error", buffer);
+    return;
+  }
+
+  /* Use the DSCB to determine if it's
+   * a PDS or not, then free the
+   * memory.
+   */
   isPDS = isPartionedDataset(dscb);
 
   /* If it's not a PDS, we exit. */
@@ -840,52 +1476,67 @@ void addMemberedDatasetMetadata(char *datasetName, int nameLength,
 
   char *theQuery = (memberLength < 1) ? "*":memberQuery;
   if (memberLength < 1){ memberLength = 1;}
-  StringList *memberList = getPDSMembers(datasetName);
-  int memberCount = stringListLength(memberList);
-  zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "--PDS %s has %d members\n",datasetName,memberCount);
+  PDSDirectory *directory = getPDSDirectory(datasetName, user, dscb);
+  if (directory == NULL) {
+    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "--PDS %.44s directory could not be read\n",datasetName);
+    return;
+  }
+  int memberCount = directory->memberCount;
+  zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "--PDS %.44s has %d members\n",datasetName,memberCount);
   if (memberCount > 0){
+    int prefixLength = 0;
+    while (prefixLength < memberLength && theQuery[prefixLength] != '*' && theQuery[prefixLength] != '%') {
+      prefixLength++;
+    }
+    int first = 0, end = 0;
+    findPDSMemberRange(directory, theQuery, prefixLength, resumeMember, &first, &end);
+    int written = 0;
+    bool hasMore = false;
+    char resumeName[25];
     jsonStartArray(jPrinter,"members");
-    StringListElt *stringElement = firstStringListElt(memberList);
-    for (int i = 0; i < memberCount; i++){
-      char *memberName = stringElement->string;
-      if (matchWithWildcards(theQuery,memberLength,memberName,8,0)) {
-        char percentName[24];
-        int namePos = 0;
-        int containsUnprintable = FALSE;
-        for (int j = 0; j < 8; j++) {
-          if (memberName[j] < 0x40){
-            containsUnprintable = TRUE;
-            if (includeUnprintable == FALSE){
-              break;
-            }
-            zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "Member pos=%d has hex of 0x%x, will change.\n",j,memberName[j]);
-            zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "Member name: %s, percent name:%s\n",memberName,percentName);
-            sprintf(&percentName[namePos],"%%%2.2x",memberName[j]);
-            zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "After: percentName: %s\n",percentName);
-            namePos = namePos+3;
-          }
-          else {
-            percentName[namePos] = memberName[j];
-            namePos++;
-          }
-        }
-
-        if (containsUnprintable == FALSE || includeUnprintable == TRUE){
-          percentName[namePos] = '\0';
-
-          jsonStartObject(jPrinter,NULL);
-          {
-            jsonAddString(jPrinter,"name",percentName);
-          }
-          jsonEndObject(jPrinter);
-
+    for (int i = first; i < end; i++){
+      PDSMemberEntry *member = &directory->members[i];
+      char percentName[25];
+      if (!matchWithWildcards(theQuery,memberLength,member->name,8,0) ||
+          !encodeMemberName(member->name, includeUnprintable, percentName)) {
+        continue;
+      }
+      if (memberLimit > 0 && written == memberLimit) {
+        hasMore = true;
+        strcpy(resumeName, percentName);
+        break;
+      }
+      jsonStartObject(jPrinter,NULL);
+      {
+        jsonAddString(jPrinter,"name",percentName);
+        if (includeStats) {
+          addISPFStatistics(jPrinter, member);
         }
       }
-      stringElement = stringElement->next;
+      jsonEndObject(jPrinter);
+      written++;
     }
     jsonEndArray(jPrinter);
+    if (hasMore) {
+      jsonAddBoolean(jPrinter, "membersHasMore", true);
+      jsonAddString(jPrinter, "memberResumeName", resumeName);
+    }
   }
-  SLHFree(memberList->slh);
+  releasePDSDirectory(pdsDirectoryCache, directory);
+}
+
+void addMemberedDatasetMetadata(char *datasetName, int nameLength,
+                                char *volser, int volserLength,
+                                char *memberQuery, int memberLength,
+                                jsonPrinter *jPrinter,
+                                int includeUnprintable, int includeStats) {
+
+  char dscb[INDEXED_DSCB] = {0};
+  int rc = obtainDSCB1(datasetName, nameLength,
+                       volser, volserLength,
+                       dscb);
+  addMembersOfObtainedDataset(datasetName, rc, dscb, memberQuery, memberLength,
+                              jPrinter, includeUnprintable, includeStats, NULL, NULL, 0);
 }
 #endif /* __ZOWE_OS_ZOS */
 
@@ -1055,17 +1706,281 @@ static void getDYNALLOCErrorCodeAndMsg(int rc, int sysRC, int sysRSN,
 #define IS_DAMEMBER_EMPTY($member) \
   (!memcmp(&($member), &(DynallocMemberName){"        "}, sizeof($member)))
 
-static void updateDatasetWithJSONInternal(HttpResponse* response,
-                                          const char *datasetPath, /* backward compatibility */
-                                          const DatasetName *dsn,
-                                          const DDName *ddName,
-                                          JsonObject *json) {
+/* DISP=SHR allocation for reading. When the allocation cache is set, the DD
+   may be one kept from an earlier request of the same user, and
+   *cachedAllocation must be handed back through unallocateDatasetForRead. */
+static int allocateDatasetForRead(HttpRequest *request,
+                                  DynallocDatasetName *daDsn,
+                                  DynallocMemberName *daMember,
+                                  DynallocDDName *daDDname,
+                                  DatasetAllocation **cachedAllocation,
+                                  int *daSysRC, int *daSysRSN) {
+  *cachedAllocation = NULL;
+  if (datasetAllocCache == NULL) {
+    return dynallocAllocDataset(
+        daDsn,
+        IS_DAMEMBER_EMPTY(*daMember) ? NULL : daMember,
+        daDDname,
+        DYNALLOC_DISP_SHR,
+        DYNALLOC_ALLOC_FLAG_NO_CONVERSION | DYNALLOC_ALLOC_FLAG_NO_MOUNT,
+        daSysRC, daSysRSN
+    );
+  }
+  int daRC = RC_DYNALLOC_OK;
+  *cachedAllocation = acquireDatasetAllocation(datasetAllocCache, request->username,
+                                               daDsn->name, daMember->name,
+                                               &daRC, daSysRC, daSysRSN);
+  if (*cachedAllocation == NULL) {
+    return daRC;
+  }
+  memcpy(daDDname->name, (*cachedAllocation)->ddName, sizeof(daDDname->name));
+  return RC_DYNALLOC_OK;
+}
 
-  char ddPath[16];
-  snprintf(ddPath, sizeof(ddPath), "DD:%8.8s", ddName->value);
+static int unallocateDatasetForRead(DynallocDDName *daDDname,
+                                    DatasetAllocation *cachedAllocation,
+                                    int *daSysRC, int *daSysRSN) {
+  if (cachedAllocation) {
+    releaseDatasetAllocation(datasetAllocCache, cachedAllocation);
+    return RC_DYNALLOC_OK;
+  }
+  return dynallocUnallocDatasetByDDName(daDDname, DYNALLOC_UNALLOC_FLAG_NONE,
+                                        daSysRC, daSysRSN);
+}
+
+/* Cached SHR allocations would hold the ENQ that writers and deletes need */
+static void invalidateCachedAllocations(const DatasetName *dsn) {
+  if (datasetAllocCache) {
+    invalidateDatasetAllocations(datasetAllocCache, dsn->value);
+  }
+}
+
+/* For datasets that were created or deleted, so listings show them at once */
+static void invalidateCachedListings(const DatasetName *dsn) {
+  if (csiQueryCache) {
+    invalidateCSIQueryResults(csiQueryCache, dsn->value);
+  }
+  if (vtocCache) {
+    invalidateVTOCCacheDataset(vtocCache, dsn->value);
+  }
+}
+
+/* Called with each directory entry, in collating order, and its length.
+   Returns false to stop reading. */
+typedef bool PDSDirectoryVisitor(void *userData, char *entry, int entryLength);
+
+/* Reads the directory of a PDS or PDSE, returning false when it could not be
+   opened */
+static bool readPDSDirectory(const DatasetName *dsn, PDSDirectoryVisitor *visitor, void *userData) {
+  int dsnLength = sizeof(dsn->value);
+  while (dsnLength > 0 && dsn->value[dsnLength - 1] == ' ') {
+    dsnLength--;
+  }
+  char directoryPath[DATASET_MEMBER_MAXLEN + 1];
+  snprintf(directoryPath, sizeof(directoryPath), "//\'%.*s\'", dsnLength, dsn->value);
+  FILE *directory = fopen(directoryPath, "rb, type=record, recfm=U");
+  if (directory == NULL) {
+    return false;
+  }
+  static const char lastEntryName[8] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+  char block[PDS_DIRECTORY_BLOCK_SIZE];
+  bool done = false;
+  while (!done && fread(block, 1, sizeof(block), directory) == sizeof(block)) {
+    int usedLength = ((unsigned char)block[0] << 8) | (unsigned char)block[1];
+    if (usedLength > sizeof(block)) {
+      break;
+    }
+    int position = 2;
+    while (position + PDS_DIRECTORY_ENTRY_FIXED_LENGTH <= usedLength) {
+      char *entry = block + position;
+      /* entries are in collating order, X'FF..FF' marks the end */
+      if (!memcmp(entry, lastEntryName, sizeof(lastEntryName))) {
+        done = true;
+        break;
+      }
+      int userDataLength = (entry[11] & PDS_DIRECTORY_USER_DATA_HALFWORDS) * 2;
+      int entryLength = PDS_DIRECTORY_ENTRY_FIXED_LENGTH + userDataLength;
+      if (!visitor(userData, entry, entryLength)) {
+        done = true;
+        break;
+      }
+      position += entryLength;
+    }
+  }
+  fclose(directory);
+  return true;
+}
+
+typedef struct MemberIndicatorSearch_tag {
+  const DatasetMemberName *member;
+  DatasetChangeIndicators *indicators;
+  bool found;
+} MemberIndicatorSearch;
+
+static bool findMemberIndicators(void *userData, char *entry, int entryLength) {
+  MemberIndicatorSearch *search = (MemberIndicatorSearch *)userData;
+  const DatasetMemberName *member = search->member;
+  int order = memcmp(entry, member->value, sizeof(member->value));
+  if (order == 0) {
+    search->indicators->length = entryLength - sizeof(member->value);
+    memcpy(search->indicators->data, entry + sizeof(member->value), search->indicators->length);
+    search->found = true;
+  }
+  return order < 0;
+}
+
+/* The member's directory entry past its name: TTR, C byte and user data, which
+   holds the ISPF statistics when there are any. A rewritten member always gets
+   a new TTR, so this changes whenever the content does. Only members have such
+   an entry; sequential datasets are not cached. */
+static bool getMemberChangeIndicators(const DatasetName *dsn, const DatasetMemberName *member,
+                                      DatasetChangeIndicators *indicators) {
+  if (IS_DAMEMBER_EMPTY(*member)) {
+    return false;
+  }
+  MemberIndicatorSearch search = {.member = member, .indicators = indicators, .found = false};
+  return readPDSDirectory(dsn, findMemberIndicators, &search) && search.found;
+}
+
+static bool addDirectoryEntry(void *userData, char *entry, int entryLength) {
+  PDSDirectory *directory = (PDSDirectory *)userData;
+  addPDSMember(directory, entry, entry + DIRECTORY_CACHE_MEMBER_LENGTH,
+               entryLength - DIRECTORY_CACHE_MEMBER_LENGTH);
+  return true;
+}
+
+/* The DSCB fields that change when members are written to a PDS: the last
+   used track and its remaining space, the number of extents, the flags and
+   the creation and last referenced dates. A member deleted or renamed outside
+   ZSS changes none of them, as STOW only rewrites a directory block; the
+   cache's ttlSeconds bounds how long such a list is served. Offsets are from
+   the start of the DSCB, which the 96 bytes obtained begin 44 bytes into. */
+static void getDirectoryChangeIndicators(const char *dscb, DatasetChangeIndicators *indicators) {
+  static const struct { int offset; int length; } fields[] = {
+    {98, 3}, /* DS1LSTAR */
+    {101, 2}, /* DS1TRBAL */
+    {59, 1}, /* DS1NOEPV */
+    {93, 1}, /* DS1IND */
+    {53, 3}, /* DS1CREDT */
+    {75, 3}  /* DS1REFD */
+  };
+  int posOffset = 44;
+  indicators->length = 0;
+  for (int i = 0; i < (int)(sizeof(fields) / sizeof(fields[0])); i++) {
+    memcpy(indicators->data + indicators->length, dscb + fields[i].offset - posOffset, fields[i].length);
+    indicators->length += fields[i].length;
+  }
+}
+
+/* The directory of a PDS, from the cache when it did not change since it was
+   read for user. Directories are only cached for a user. Returns a reference
+   the caller releases, or NULL when the directory could not be read. */
+static PDSDirectory *getPDSDirectory(const char *datasetName, const char *user, const char *dscb) {
+  DatasetChangeIndicators indicators;
+  getDirectoryChangeIndicators(dscb, &indicators);
+  PDSDirectoryCache *cache = user ? pdsDirectoryCache : NULL;
+  if (cache) {
+    PDSDirectory *cached = lookupPDSDirectory(cache, datasetName, user, &indicators);
+    if (cached) {
+      return cached;
+    }
+  }
+  DatasetName dsn;
+  memcpy(dsn.value, datasetName, sizeof(dsn.value));
+  PDSDirectory *directory = makePDSDirectory(dsn.value, user, &indicators, 0);
+  if (!readPDSDirectory(&dsn, addDirectoryEntry, directory)) {
+    releasePDSDirectory(NULL, directory);
+    return NULL;
+  }
+  if (cache) {
+    storePDSDirectory(cache, directory);
+  }
+  return directory;
+}
+
+/* Member lists show members created or deleted through ZSS at once */
+static void invalidateCachedDirectory(const DatasetName *dsn) {
+  if (pdsDirectoryCache) {
+    invalidatePDSDirectory(pdsDirectoryCache, dsn->value);
+  }
+}
+
+static void invalidateCachedETags(const DatasetName *dsn, const DatasetMemberName *member) {
+  if (datasetETagCache) {
+    invalidateDatasetETag(datasetETagCache, dsn->value,
+                          IS_DAMEMBER_EMPTY(*member) ? NULL : member->value);
+  }
+}
+
+/*
+  The etag of a member as the etag cache has it, so a read can report it
+  without hashing. The directory entry is taken before the member is read, so
+  an etag computed by the read can be stored against it afterwards; a change
+  made while reading then makes the stored etag miss rather than lie.
+ */
+typedef struct CachedETag_tag {
+  bool cacheable;
+  DatasetChangeIndicators indicators;
+  char eTag[ETAG_CACHE_MAX_ETAG_LENGTH + 1];   /* empty when not cached */
+} CachedETag;
+
+static void lookupCachedETag(const DatasetName *dsn, const DatasetMemberName *member,
+                             CachedETag *cached) {
+  memset(cached, 0, sizeof(CachedETag));
+  cached->cacheable = datasetETagCache && getMemberChangeIndicators(dsn, member, &cached->indicators);
+  if (cached->cacheable &&
+      !lookupDatasetETag(datasetETagCache, dsn->value, member->value, &cached->indicators, cached->eTag)) {
+    cached->eTag[0] = '\0';
+  }
+}
+
+static void storeCachedETag(const DatasetName *dsn, const DatasetMemberName *member,
+                            const CachedETag *cached, const char *eTag) {
+  if (cached->cacheable && cached->eTag[0] == '\0' && eTag[0] != '\0') {
+    storeDatasetETag(datasetETagCache, dsn->value, member->value, &cached->indicators, eTag);
+  }
+}
+
+/* Longest string the body may hold: a record of the largest LRECL in 4-byte
+   UTF-8 fits, which leaves room for trailing blanks on most records too. */
+#define DATASET_WRITE_MAX_STRING 0x20000
+
+#define RAW_BODY_UTF8_LF    0x0A
+#define RAW_BODY_UTF8_CR    0x0D
+#define RAW_BODY_RDW_LENGTH 4
+
+/* "etag", matched against the body before it is converted */
+static const char ETAG_PROPERTY_UTF8[] = {0x65, 0x74, 0x61, 0x67, 0x00};
+
+typedef struct DatasetWriteFormat_tag {
+  int maxRecordLength;
+  bool isFixed;
+} DatasetWriteFormat;
+
+/* Both passes over the body go through this. The first only validates, the
+   second has out set and writes. */
+typedef struct DatasetRecordWriter_tag {
+  int mode;                 /* DATASET_CONTENT_MODE_* the body is in */
+  DatasetWriteFormat format;
+  FILE *out;
+  char *converted;          /* the current record in the native code page */
+  int convertedSize;
+  char *record;             /* the current record when it has to be padded */
+  DatasetDigest digest;
+  int digestRC;
+  int recordCount;
+  bool hasETag;
+  char eTag[128];
+  int errorStatus;
+  char errorMessage[1024];
+} DatasetRecordWriter;
+
+static bool getDatasetWriteFormat(HttpResponse *response,
+                                  const char *datasetPath, /* backward compatibility */
+                                  const DatasetName *dsn,
+                                  const DatasetMemberName *member,
+                                  DatasetWriteFormat *format) {
 
-  JsonArray *recordArray = jsonObjectGetArray(json,"records");
-  int recordCount = jsonArrayGetCount(recordArray);
   int maxRecordLength = 80;
   int isFixed = FALSE;
 
@@ -1088,21 +2003,10 @@ static void updateDatasetWithJSONInternal(HttpResponse* response,
       bool isPds = false;
       if (!isSupportedWriteDsorg(dscb, &isPds)) {
         respondWithError(response, HTTP_STATUS_BAD_REQUEST,"Unsupported dataset type");
-        return;
-      } else if (isPds) {
-        bool isMember = false;
-        int memberStart=44;
-        int memberEnd=memberStart+8;
-        for (int i = memberStart; i < memberEnd; i++){
-          if (*(dsn->value+i) != 0x40){
-            isMember = true;
-            break;
-          }
-        }
-        if (!isMember){
-          respondWithError(response, HTTP_STATUS_BAD_REQUEST, "Overwrite of PDS not supported");
-          return;
-        }
+        return false;
+      } else if (isPds && IS_DAMEMBER_EMPTY(*member)) {
+        respondWithError(response, HTTP_STATUS_BAD_REQUEST, "Overwrite of PDS not supported");
+        return false;
       }
       
       maxRecordLength = getMaxRecordLength(dscb);
@@ -1111,7 +2015,7 @@ static void updateDatasetWithJSONInternal(HttpResponse* response,
         isFixed = TRUE;
       } else if (recordType == 'U') {
         respondWithError(response, HTTP_STATUS_BAD_REQUEST,"Undefined-length dataset");
-        return;
+        return false;
       }
     }
   }
@@ -1122,7 +2026,7 @@ static void updateDatasetWithJSONInternal(HttpResponse* response,
     FILE *datasetRead = fopen(datasetPath, "rb, recfm=*, type=record");
     if (datasetRead == NULL) {
       respondWithError(response,HTTP_STATUS_NOT_FOUND,"File could not be opened or does not exist");
-      return;
+      return false;
     }
 
     int returnCode = fldata(datasetRead,filenameOutput,&fileinfo);
@@ -1137,7 +2041,7 @@ static void updateDatasetWithJSONInternal(HttpResponse* response,
       if (fileinfo.__dsorgVSAM || fileinfo.__dsorgHFS || fileinfo.__dsorgHiper) {
         respondWithError(response, HTTP_STATUS_BAD_REQUEST, "Dataset type not supported");
         fclose(datasetRead);
-        return;
+        return false;
       }
       if (fileinfo.__maxreclen){
         maxRecordLength = fileinfo.__maxreclen;
@@ -1145,108 +2049,384 @@ static void updateDatasetWithJSONInternal(HttpResponse* response,
       else {
         respondWithError(response,HTTP_STATUS_INTERNAL_SERVER_ERROR,"Could not discover record length");
         fclose(datasetRead);
-        return;
+        return false;
       }
       if (fileinfo.__recfmF) {
         isFixed = TRUE;
       } else if (fileinfo.__recfmU) {
         respondWithError(response, HTTP_STATUS_BAD_REQUEST,"Undefined-length dataset");
         fclose(datasetRead);
-        return;
+        return false;
       }
     }
     else {
       respondWithError(response,HTTP_STATUS_INTERNAL_SERVER_ERROR,"Could not read dataset information");
       fclose(datasetRead);
-      return;
+      return false;
     }
     fclose(datasetRead);
   }
   /*end dataset type check*/
 
+  format->maxRecordLength = maxRecordLength;
+  format->isFixed = isFixed;
+  return true;
+}
+
+static int setRecordWriterError(DatasetRecordWriter *writer, int status, const char *formatString, ...) {
+  va_list args;
+  va_start(args, formatString);
+  vsnprintf(writer->errorMessage, sizeof(writer->errorMessage), formatString, args);
+  va_end(args);
+  writer->errorStatus = status;
+  return status;
+}
 
-  /*record length validation*/
-  for ( int i = 0; i < recordCount; i++) {
-    Json *item = jsonArrayGetItem(recordArray,i);
-    if (jsonIsString(item) == TRUE) {
-      char *jsonString = jsonAsString(item);
-      int recordLength = strlen(jsonString);
-      if (recordLength > maxRecordLength) {
-        for (int j = recordLength; j > maxRecordLength-1; j--){
-          if (jsonString[j] > 0x40){
-            zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "Invalid record for dataset, recordLength=%d but max for dataset is %d\n", recordLength, maxRecordLength);
-            char errorMessage[1024];
-            int errorLength = sprintf(errorMessage,"Record #%d with contents \"%s\" is longer than the max record length of %d",i+1,jsonString,maxRecordLength);
-            errorMessage[errorLength] = '\0';
-            respondWithError(response, HTTP_STATUS_BAD_REQUEST,errorMessage);
-            return;
-          } 
-        }
-        recordLength = maxRecordLength;
-      }
-      if (isFixed && recordLength < maxRecordLength) {
-        zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "UPDATE DATASET: record given for fixed datset less than maxLength=%d, len=%d, data:%s\n",maxRecordLength,recordLength,jsonString);
-      }
+/* The record in the native code page. Binary bodies already are, so their
+   records are used where they are. */
+static const char *getNativeRecord(DatasetRecordWriter *writer, const char *value, int length,
+                                   int *nativeLength) {
+  int reasonCode = 0;
+  *nativeLength = 0;
+  if (writer->mode == DATASET_CONTENT_MODE_BINARY) {
+    *nativeLength = length;
+    return value;
+  }
+  if (length == 0) {
+    return writer->converted;
+  }
+  /* SBCS output is never longer than the UTF-8 it comes from */
+  if (length > writer->convertedSize ||
+      convertCharset((char *)value, length, CCSID_UTF_8, CHARSET_OUTPUT_USE_BUFFER,
+                     &writer->converted, writer->convertedSize, NATIVE_CODEPAGE,
+                     NULL, nativeLength, &reasonCode)) {
+    return NULL;
+  }
+  return writer->converted;
+}
+
+static int captureRecordsETag(void *userData, const char *name, const char *value, int length) {
+  DatasetRecordWriter *writer = userData;
+  if (strcmp(name, ETAG_PROPERTY_UTF8)) {
+    return 0;
+  }
+  char *eTag = writer->eTag;
+  int eTagLength = 0;
+  int reasonCode = 0;
+  /* a longer one cannot match anyway, and still fails to once truncated */
+  if (length >= sizeof(writer->eTag)) {
+    length = sizeof(writer->eTag) - 1;
+  }
+  if (length && convertCharset((char *)value, length, CCSID_UTF_8, CHARSET_OUTPUT_USE_BUFFER,
+                               &eTag, sizeof(writer->eTag) - 1, NATIVE_CODEPAGE,
+                               NULL, &eTagLength, &reasonCode)) {
+    return setRecordWriterError(writer, HTTP_STATUS_INTERNAL_SERVER_ERROR,
+                                "Could not translate character set to EBCDIC");
+  }
+  writer->eTag[eTagLength] = '\0';
+  writer->hasETag = true;
+  return 0;
+}
+
+/*record length validation*/
+static int validateRecord(void *userData, const char *value, int length, int index) {
+  DatasetRecordWriter *writer = userData;
+  int maxRecordLength = writer->format.maxRecordLength;
+  int recordLength = 0;
+  const char *record = getNativeRecord(writer, value, length, &recordLength);
+  if (record == NULL) {
+    if (length > writer->convertedSize) {
+      return setRecordWriterError(writer, HTTP_STATUS_BAD_REQUEST,
+                                  "Record #%d is longer than the max record length of %d",
+                                  index + 1, maxRecordLength);
     }
-    else {
-      zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "Incorrectly formatted array!\n");
+    return setRecordWriterError(writer, HTTP_STATUS_INTERNAL_SERVER_ERROR,
+                                "Could not translate character set to EBCDIC");
+  }
+  if (writer->mode == DATASET_CONTENT_MODE_BINARY && recordLength > maxRecordLength) {
+    return setRecordWriterError(writer, HTTP_STATUS_BAD_REQUEST,
+                                "Record #%d of %d bytes is longer than the max record length of %d",
+                                index + 1, recordLength, maxRecordLength);
+  }
+  /* what is past the record length may only be blanks, which are dropped */
+  if (findDatasetRecordOverflow(record, recordLength, maxRecordLength) >= 0) {
+    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "Invalid record for dataset, recordLength=%d but max for dataset is %d\n", recordLength, maxRecordLength);
+    return setRecordWriterError(writer, HTTP_STATUS_BAD_REQUEST,
+                                "Record #%d with contents \"%.*s\" is longer than the max record length of %d",
+                                index + 1, recordLength, record, maxRecordLength);
+  }
+  if (writer->format.isFixed && recordLength < maxRecordLength) {
+    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "UPDATE DATASET: record given for fixed datset less than maxLength=%d, len=%d\n",maxRecordLength,recordLength);
+  }
+  writer->recordCount++;
+  return 0;
+}
+
+static int writeRecord(void *userData, const char *value, int length, int index) {
+  DatasetRecordWriter *writer = userData;
+  int maxRecordLength = writer->format.maxRecordLength;
+  int recordLength = 0;
+  const char *record = getNativeRecord(writer, value, length, &recordLength);
+  if (record == NULL) {
+    return setRecordWriterError(writer, HTTP_STATUS_INTERNAL_SERVER_ERROR,
+                                "Could not translate character set to EBCDIC");
+  }
+  /* binary records are padded with zeros rather than blanks */
+  char pad = (writer->mode == DATASET_CONTENT_MODE_BINARY) ? 0x00 : ' ';
+  if (recordLength == 0) { //this is a hack, which will be removed as we move away from fwrite
+    record = &pad;
+    recordLength = 1;
+  }
+  /* trim, and for fixed records pad; only a padded record is copied */
+  int len = 0;
+  record = formatDatasetRecord(record, recordLength, maxRecordLength, writer->format.isFixed,
+                               pad, writer->record, &len);
+  int bytesWritten = fwrite(record, 1, len, writer->out);
+  if (bytesWritten < len && ferror(writer->out)) {
+    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "Error writing to dataset, rc=%d\n", bytesWritten);
+    return setRecordWriterError(writer, HTTP_STATUS_INTERNAL_SERVER_ERROR, "Error writing to dataset");
+  }
+  writer->recordCount++;
+  if (!writer->digestRC) {
+    writer->digestRC = datasetDigestUpdate(&writer->digest, record, bytesWritten);
+  }
+  return 0;
+}
+
+/* text/plain: UTF-8 lines ended by LF or CRLF, where the last line does not
+   need one. Returns what the handler returned, which stops the split. */
+static int splitTextRecords(const char *body, int length,
+                            JsonRecordHandler *handler, void *userData) {
+  int index = 0;
+  int position = 0;
+  while (position < length) {
+    const char *lineStart = body + position;
+    const char *lineEnd = memchr(lineStart, RAW_BODY_UTF8_LF, length - position);
+    int lineLength = lineEnd ? (int)(lineEnd - lineStart) : length - position;
+    position += lineLength + (lineEnd ? 1 : 0);
+    if (lineLength > 0 && lineStart[lineLength - 1] == RAW_BODY_UTF8_CR) {
+      lineLength--;
+    }
+    int rc = handler(userData, lineStart, lineLength, index++);
+    if (rc) {
+      return rc;
+    }
+  }
+  return 0;
+}
+
+/* application/octet-stream: records each behind an RDW, as binary reads send
+   them. Returns what the handler returned, or -1 with *badIndex set when an
+   RDW does not frame a record of the body. */
+static int splitRDWRecords(const char *body, int length,
+                           JsonRecordHandler *handler, void *userData, int *badIndex) {
+  const unsigned char *data = (const unsigned char *)body;
+  int index = 0;
+  int position = 0;
+  while (position < length) {
+    if (length - position < RAW_BODY_RDW_LENGTH) {
+      *badIndex = index;
+      return -1;
+    }
+    int rdwLength = (data[position] << 8) | data[position + 1];
+    if (rdwLength < RAW_BODY_RDW_LENGTH || rdwLength > length - position ||
+        data[position + 2] || data[position + 3]) {
+      *badIndex = index;
+      return -1;
+    }
+    int rc = handler(userData, body + position + RAW_BODY_RDW_LENGTH,
+                     rdwLength - RAW_BODY_RDW_LENGTH, index++);
+    if (rc) {
+      return rc;
+    }
+    position += rdwLength;
+  }
+  return 0;
+}
+
+static bool splitRawRecordsOrRespondError(HttpResponse *response, DatasetRecordWriter *writer,
+                                          JsonRecordHandler *recordHandler) {
+  HttpRequest *request = response->request;
+  int badIndex = 0;
+  int rc = (writer->mode == DATASET_CONTENT_MODE_BINARY) ?
+      splitRDWRecords(request->contentBody, request->contentLength, recordHandler, writer, &badIndex) :
+      splitTextRecords(request->contentBody, request->contentLength, recordHandler, writer);
+  if (rc == 0) {
+    return true;
+  } else if (rc < 0) {
+    char errorMessage[128];
+    snprintf(errorMessage, sizeof(errorMessage), "Record #%d does not have a valid RDW", badIndex + 1);
+    respondWithError(response, HTTP_STATUS_BAD_REQUEST, errorMessage);
+  } else {
+    respondWithError(response, writer->errorStatus, writer->errorMessage);
+  }
+  return false;
+}
+
+static bool parseRecordsOrRespondError(HttpResponse *response, DatasetRecordWriter *writer,
+                                       JsonRecordHandler *recordHandler) {
+  HttpRequest *request = response->request;
+  writer->recordCount = 0;
+  if (writer->mode != DATASET_CONTENT_MODE_JSON) {
+    return splitRawRecordsOrRespondError(response, writer, recordHandler);
+  }
+
+  JsonRecordParser parser;
+  initJsonRecordParser(&parser, DATASET_WRITE_MAX_STRING, recordHandler, captureRecordsETag, writer);
+  writer->hasETag = false;
+
+  zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "UPDATE DATASET: parsing records dataLength=0x%x\n", request->contentLength);
+  int rc = jsonRecordParserFeed(&parser, request->contentBody, request->contentLength);
+  if (!rc) {
+    rc = jsonRecordParserFinish(&parser);
+  }
+  bool inRecords = parser.inRecords;
+  int recordIndex = parser.recordIndex;
+  int errorIndex = parser.errorIndex;
+  int64 errorOffset = parser.errorOffset;
+  termJsonRecordParser(&parser);
+
+  switch (rc) {
+  case RECORD_PARSER_RC_OK:
+    return true;
+  case RECORD_PARSER_RC_HANDLER:
+    respondWithError(response, writer->errorStatus, writer->errorMessage);
+    return false;
+  case RECORD_PARSER_RC_NOT_A_STRING: {
+    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "Incorrectly formatted array!\n");
+    char errorMessage[1024];
+    snprintf(errorMessage, sizeof(errorMessage), "Array position %d is not a string, but must be for record updating", errorIndex);
+    respondWithError(response, HTTP_STATUS_BAD_REQUEST, errorMessage);
+    return false;
+  }
+  case RECORD_PARSER_RC_TOO_LONG:
+    if (inRecords) {
       char errorMessage[1024];
-      int errorLength = sprintf(errorMessage,"Array position %d is not a string, but must be for record updating",i);
-      errorMessage[errorLength] = '\0';
-      respondWithError(response, HTTP_STATUS_BAD_REQUEST,errorMessage);
-      return;
+      snprintf(errorMessage, sizeof(errorMessage), "Record #%d is longer than the max record length of %d",
+               recordIndex + 1, writer->format.maxRecordLength);
+      respondWithError(response, HTTP_STATUS_BAD_REQUEST, errorMessage);
+      return false;
+    }
+    break;
+  case RECORD_PARSER_RC_NOT_AN_OBJECT:
+    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "UPDATE DATASET: body was not a JSON object\n");
+    respondWithError(response, HTTP_STATUS_BAD_REQUEST, "POST body must be a JSON object");
+    return false;
+  case RECORD_PARSER_RC_DUPLICATE_KEY:
+    respondWithError(response, HTTP_STATUS_BAD_REQUEST, "POST body has a member more than once");
+    return false;
+  case RECORD_PARSER_RC_TOO_MANY_KEYS:
+    respondWithError(response, HTTP_STATUS_BAD_REQUEST, "POST body has too many members");
+    return false;
+  }
+  zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "UPDATE DATASET: body was not JSON! rc=%d, offset=%lld\n",
+          rc, errorOffset);
+  respondWithError(response, HTTP_STATUS_BAD_REQUEST,"POST body could not be parsed as JSON format");
+  return false;
+}
+
+/* Member names for writing a member aside and for the old copy while the new
+   one is renamed in. They come from the DD name, which is unique while this
+   request holds the dataset. */
+static void getWorkMemberPath(const DatasetName *dsn, const DDName *ddName, const char *prefix,
+                              DatasetMemberName *member, char *path, int pathSize) {
+  int dsnLength = sizeof(dsn->value);
+  while (dsnLength > 0 && dsn->value[dsnLength - 1] == ' ') {
+    dsnLength--;
+  }
+  int ddLength = sizeof(ddName->value);
+  while (ddLength > 0 && ddName->value[ddLength - 1] == ' ') {
+    ddLength--;
+  }
+  char name[sizeof(member->value) + 1];
+  int nameLength = snprintf(name, sizeof(name), "%s%.*s", prefix,
+                            ddLength > 3 ? ddLength - 3 : 0, ddName->value + 3);
+  memset(member->value, ' ', sizeof(member->value));
+  memcpy(member->value, name, nameLength);
+  snprintf(path, pathSize, "//\'%.*s(%s)\'", dsnLength, dsn->value, name);
+}
+
+/* The new member only replaces the old one once it is complete, so a failure
+   part way leaves the old content in place. */
+static bool replaceMember(const char *datasetPath, const char *workPath, const char *backupPath) {
+  bool hadMember = (rename(datasetPath, backupPath) == 0);
+  if (rename(workPath, datasetPath) != 0) {
+    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_WARNING, "Could not rename %s to %s\n", workPath, datasetPath);
+    if (hadMember && rename(backupPath, datasetPath) != 0) {
+      zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_SEVERE, "Could not restore %s from %s\n", datasetPath, backupPath);
     }
+    remove(workPath);
+    return false;
+  }
+  if (hadMember) {
+    remove(backupPath);
   }
-  /*passed record length check and type check*/
+  return true;
+}
 
-  FILE *outDataset = fopen(datasetPath, "wb, recfm=*, type=record");
+static void writeDatasetRecords(HttpResponse* response,
+                                const char *datasetPath, /* backward compatibility */
+                                const DatasetName *dsn,
+                                const DatasetMemberName *member,
+                                const DDName *ddName,
+                                DatasetRecordWriter *writer) {
+
+  bool isMember = !IS_DAMEMBER_EMPTY(*member);
+  char workPath[DATASET_MEMBER_MAXLEN + 1];
+  char backupPath[DATASET_MEMBER_MAXLEN + 1];
+  DatasetMemberName workMember, backupMember;
+  const char *outPath = datasetPath;
+  if (isMember) {
+    getWorkMemberPath(dsn, ddName, "$ZT", &workMember, workPath, sizeof(workPath));
+    getWorkMemberPath(dsn, ddName, "$ZB", &backupMember, backupPath, sizeof(backupPath));
+    outPath = workPath;
+  }
+
+  FILE *outDataset = fopen(outPath, "wb, recfm=*, type=record");
   if (outDataset == NULL) {
     respondWithError(response,HTTP_STATUS_NOT_FOUND,"File could not be opened or does not exist");
     return;
   }
 
-  int bytesWritten = 0;
-  int recordsWritten = 0;
-  char recordBuffer[maxRecordLength+1];
+  int maxRecordLength = writer->format.maxRecordLength;
+  writer->out = outDataset;
+  writer->record = safeMalloc(maxRecordLength, "datasetWriteRecord");
 
-  ICSFDigest digest;
-  char hash[32];
+  char eTag[DATASET_DIGEST_MAX_HEX_LENGTH + 1] = {0};
+  char *digestBatch = allocDigestBatch();
 
-  int rcEtag = icsfDigestInit(&digest, ICSF_DIGEST_SHA1);
-  if (rcEtag) { //if etag generation has an error, just don't send it.
-    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_WARNING,  "ICSF error for SHA etag init for write, %d\n",rcEtag);
+  writer->digestRC = datasetDigestInit(&writer->digest, 0, digestBatch, DATASET_DIGEST_BATCH_SIZE);
+  if (writer->digestRC) { //if etag generation has an error, just don't send it.
+    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_WARNING,  "Error for %s etag init for write, %d\n",
+            getDatasetDigestName(writer->digest.type), writer->digestRC);
   }
 
-  for (int i = 0; i < recordCount; i++) {
-    char *record = jsonArrayGetString(recordArray,i);
-    int recordLength = strlen(record);
-    if (recordLength == 0) { //this is a hack, which will be removed as we move away from fwrite
-      record = " ";
-      recordLength = 1;
-    }
-    int len;
-    if (isFixed) {
-      // pad with spaces/or trim if needed
-      len = snprintf (recordBuffer, sizeof(recordBuffer), "%-*s", maxRecordLength, record);
-    } else {
-      // trim if needed
-      len = snprintf (recordBuffer, sizeof(recordBuffer), "%s", record);
-    }
-    bytesWritten = fwrite(recordBuffer,1,len,outDataset);
-    recordsWritten++;
-    if (bytesWritten < 0 && ferror(outDataset)){
-      zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "Error writing to dataset, rc=%d\n", bytesWritten);
-      respondWithError(response,HTTP_STATUS_INTERNAL_SERVER_ERROR,"Error writing to dataset");
-      fclose(outDataset);
-      break;
-    } else if (!rcEtag) {
-      rcEtag = icsfDigestUpdate(&digest, recordBuffer, bytesWritten);
+  bool writeFailed = !parseRecordsOrRespondError(response, writer, writeRecord);
+  int rcEtag = writer->digestRC;
+  if (!rcEtag) { rcEtag = datasetDigestFinishHex(&writer->digest, eTag); }
+  if (rcEtag) {
+    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_WARNING,  "Error for %s etag, %d\n",
+            getDatasetDigestName(writer->digest.type), rcEtag);
+  }
+  freeDigestBatch(digestBatch);
+  safeFree(writer->record, maxRecordLength);
+  writer->record = NULL;
+  writer->out = NULL;
+
+  if (fclose(outDataset) != 0 && !writeFailed) {
+    respondWithError(response,HTTP_STATUS_INTERNAL_SERVER_ERROR,"Error writing to dataset");
+    writeFailed = true;
+  }
+  if (isMember) {
+    if (writeFailed) {
+      remove(workPath);
+    } else if (!replaceMember(datasetPath, workPath, backupPath)) {
+      respondWithError(response,HTTP_STATUS_INTERNAL_SERVER_ERROR,"Could not replace member with the records written");
+      writeFailed = true;
     }
   }
-  
-  if (!rcEtag) { rcEtag = icsfDigestFinish(&digest, hash); }
-  if (rcEtag) {
-    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_WARNING,  "ICSF error for SHA etag, %d\n",rcEtag);
+  if (writeFailed) {
+    return;
   }
 
   /*success!*/
@@ -1258,27 +2438,32 @@ static void updateDatasetWithJSONInternal(HttpResponse* response,
   jsonStart(p);
 
   char msgBuffer[128];
-  snprintf(msgBuffer, sizeof(msgBuffer), "Updated dataset %s with %d records", datasetPath, recordsWritten);
+  snprintf(msgBuffer, sizeof(msgBuffer), "Updated dataset %s with %d records", datasetPath, writer->recordCount);
   jsonAddString(p, "msg", msgBuffer);
 
   if (!rcEtag) {
-    // Convert hash text to hex.
-    int eTagLength = digest.hashLength*2;
-    char eTag[eTagLength+1];
-    memset(eTag, '\0', eTagLength);
-    int len = digest.hashLength;
-    simpleHexPrint(eTag, hash, digest.hashLength);
     jsonAddString(p, "etag", eTag);
   }
   jsonEnd(p);
 
   finishResponse(response);
 
-  fclose(outDataset);
+  /* what was just written is what the next etag check will be against */
+  if (!rcEtag && datasetETagCache) {
+    DatasetChangeIndicators indicators;
+    if (getMemberChangeIndicators(dsn, member, &indicators)) {
+      storeDatasetETag(datasetETagCache, dsn->value, member->value, &indicators, eTag);
+    }
+  }
 }
 
-static void updateDatasetWithJSON(HttpResponse *response, JsonObject *json, char *datasetPath,
-                                  const char *lastEtag, bool force) {
+/* The body is parsed twice without building it as a JSON document: once to
+   check every record against the dataset, and only when all of them fit a
+   second time to write them. Records are converted one at a time into a
+   buffer reused for the whole body. Text and binary bodies are split into
+   records the same way, by lines or by RDWs. */
+static void updateDatasetWithRecords(HttpResponse *response, char *datasetPath, int mode,
+                                     const char *headerEtag, bool force) {
 
   HttpRequest *request = response->request;
 
@@ -1287,8 +2472,9 @@ static void updateDatasetWithJSON(HttpResponse *response, JsonObject *json, char
     return;
   }
 
-  if (!lastEtag && !force) {
-    respondWithError(response, HTTP_STATUS_BAD_REQUEST, "No etag given");
+  if (mode == DATASET_CONTENT_MODE_JSON &&
+      (!request->contentBody || request->contentLength <= 0)) {
+    respondWithError(response, HTTP_STATUS_BAD_REQUEST, "POST body could not be parsed as JSON format");
     return;
   }
 
@@ -1302,6 +2488,8 @@ static void updateDatasetWithJSON(HttpResponse *response, JsonObject *json, char
   memcpy(daMember.name, memberName.value, sizeof(daMember.name));
   DynallocDDName daDDname = {.name = "????????"};
 
+  invalidateCachedAllocations(&dsn);
+  invalidateCachedDirectory(&dsn);
   int daRC = RC_DYNALLOC_OK, daSysRC = 0, daSysRSN = 0;
   daRC = dynallocAllocDataset(
       &daDsn,
@@ -1337,27 +2525,53 @@ static void updateDatasetWithJSON(HttpResponse *response, JsonObject *json, char
   char ddPath[16];
   snprintf(ddPath, sizeof(ddPath), "DD:%8.8s", ddName.value);
 
-  int eTagRC = 0;
-  if (!force) { //do not write dataset if current contents do not match contents client expected, unless forced
-    int eTagReturnLength = 0;
-    int lrecl = getLreclOrRespondError(response, &dsn, ddPath);
-    if (lrecl) {
-      char *eTag = getDatasetETag(ddPath, lrecl, &eTagRC, &eTagReturnLength);
-      zowelog(NULL, LOG_COMP_DATASERVICE, ZOWE_LOG_INFO, "Given etag=%s, current etag=%s\n",lastEtag, eTag);
-      if (!eTag) {
-        respondWithError(response, HTTP_STATUS_INTERNAL_SERVER_ERROR, "Could not generate etag");
-      } else if (strcmp(eTag, lastEtag)) {
-        respondWithError(response, HTTP_STATUS_BAD_REQUEST, "Provided etag did not match system etag. To write, read the dataset again and resolve the difference, then retry.");
-        safeFree(eTag,eTagReturnLength+1);
-      } else {
-        safeFree(eTag,eTagReturnLength+1);
-        updateDatasetWithJSONInternal(response, datasetPath, &dsn, &ddName, json);
+  DatasetRecordWriter *writer = (DatasetRecordWriter*)safeMalloc(sizeof(DatasetRecordWriter), "DatasetRecordWriter");
+  memset(writer, 0, sizeof(DatasetRecordWriter));
+  writer->mode = mode;
+  writer->convertedSize = DATASET_WRITE_MAX_STRING;
+  writer->converted = safeMalloc(writer->convertedSize, "datasetWriteConvert");
+
+  if (getDatasetWriteFormat(response, datasetPath, &dsn, &memberName, &writer->format) &&
+      parseRecordsOrRespondError(response, writer, validateRecord)) {
+    /*passed record length check and type check*/
+    const char *lastEtag = writer->hasETag ? writer->eTag : headerEtag;
+    int eTagRC = 0;
+    if (!lastEtag && !force) {
+      respondWithError(response, HTTP_STATUS_BAD_REQUEST, "No etag given");
+    } else if (!force) { //do not write dataset if current contents do not match contents client expected, unless forced
+      int lrecl = getLreclOrRespondError(response, &dsn, ddPath, NULL);
+      if (lrecl) {
+        DatasetReadResult current = {0};
+        DatasetChangeIndicators indicators;
+        /* taken before hashing, so a change made while reading cannot be cached as current */
+        bool cacheable = datasetETagCache && getMemberChangeIndicators(&dsn, &memberName, &indicators);
+        if (cacheable && lookupDatasetETag(datasetETagCache, dsn.value, memberName.value,
+                                           &indicators, current.eTag)) {
+          zowelog(NULL, LOG_COMP_DATASERVICE, ZOWE_LOG_DEBUG, "etag for update taken from cache\n");
+        } else {
+          readDataset(ddPath, lrecl, NULL, NULL, DATASET_READ_HASH, NULL, NULL, &current);
+          if (cacheable && !current.eTagRC) {
+            storeDatasetETag(datasetETagCache, dsn.value, memberName.value, &indicators, current.eTag);
+          }
+        }
+        eTagRC = current.eTagRC;
+        zowelog(NULL, LOG_COMP_DATASERVICE, ZOWE_LOG_INFO, "Given etag=%s, current etag=%s\n",lastEtag, eTagRC ? "" : current.eTag);
+        if (eTagRC) {
+          respondWithError(response, HTTP_STATUS_INTERNAL_SERVER_ERROR, "Could not generate etag");
+        } else if (strcmp(current.eTag, lastEtag)) {
+          respondWithError(response, HTTP_STATUS_BAD_REQUEST, "Provided etag did not match system etag. To write, read the dataset again and resolve the difference, then retry.");
+        } else {
+          writeDatasetRecords(response, datasetPath, &dsn, &memberName, &ddName, writer);
+        }
       }
+    } else {
+      writeDatasetRecords(response, datasetPath, &dsn, &memberName, &ddName, writer);
     }
-  } else {
-    updateDatasetWithJSONInternal(response, datasetPath, &dsn, &ddName, json);
   }
 
+  safeFree(writer->converted, writer->convertedSize);
+  safeFree((char*)writer, sizeof(DatasetRecordWriter));
+
   daRC = dynallocUnallocDatasetByDDName(&daDDname, DYNALLOC_UNALLOC_FLAG_NONE,
                                         &daSysRC, &daSysRSN);
   if (daRC != RC_DYNALLOC_OK) {
@@ -1370,99 +2584,6 @@ static void updateDatasetWithJSON(HttpResponse *response, JsonObject *json, char
 
 #endif /* __ZOWE_OS_ZOS */
 
-#ifdef __ZOWE_OS_ZOS
-/* TODO: this has not yet been tested with real, live JSON */
-static void updateVSAMDatasetWithJSON(HttpResponse *response, JsonObject *json, char *dsn, hashtable *acbTable) {
-  JsonArray *recordArray = jsonObjectGetArray(json,"records");
-  int recordCount = jsonArrayGetCount(recordArray);
-  char *username = response->request->username;
-  int maxRecordLength = 80;
-  /*ACEE *newACEE;
-  int impersonationBegan = startZOSImpersonation(username,&newACEE);
-  if (!impersonationBegan) {
-    respondWithError(response,HTTP_STATUS_INTERNAL_SERVER_ERROR,"Failed privilege check");
-    endZOSImpersonation(&newACEE);
-    return;
-  }*/
-  char dsnUidPair[44+8+1];
-  memset(dsnUidPair, ' ', 44+8);
-  memcpy(dsnUidPair, dsn, 44);
-  memcpy(dsnUidPair+44, username, 8);
-  StatefulACB *state = (StatefulACB *)htGet(acbTable, dsnUidPair);
-  char *outACB = state ? state->acb : NULL;
-  zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "htGet on \"%s\" returned 0x%0x\n", dsnUidPair, outACB);
-
-  if (outACB == NULL) { /* TODO: openACB for output */
-    /* TODO: open CSI to find relevant fields if ACB needs to be opened. */
-  }
-  RPLCommon *rpl = (RPLCommon *)(outACB+RPL_COMMON_OFFSET+8);
-  maxRecordLength = rpl->bufLen;
-
-  /* Time to check the JSON for errors while parsing it into a readable format */
-  /* TODO: However you wish to format the JSON to easily be read later is your choice.  Below is an unfinished, theoretical approach. */
-  for ( int i = 0; i < recordCount; i++) {
-    Json *item = jsonArrayGetItem(recordArray,i);
-    if (jsonIsString(item) == TRUE) {
-      /* TODO: find and B64 decrypt the (key,record) pairs and write them as a block of chars */
-      char *jsonString = jsonAsString(item); /* TODO: should be looking at a "str:str" or "str: str" value here? */
-      int recordLength = strlen(jsonString); /* TODO: more correctly calculate the recordLength AND keyLength */
-      if (recordLength > maxRecordLength) { /* TODO: check recordLength AND keyLength (rpl->keyLen for keyLength) */
-        zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "Invalid record for dataset, recordLength=%d but max for dataset is %d\n",recordLength,maxRecordLength);
-        char errorMessage[1024];
-        int errorLength = sprintf(errorMessage,"Record #%d with contents \"%s\" is longer than the max record length of %d",i+1,jsonString,maxRecordLength);
-        errorMessage[errorLength] = '\0';
-        respondWithError(response, HTTP_STATUS_BAD_REQUEST,errorMessage);
-        return;
-      }
-    } else {
-      zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "Incorrectly formatted array!\n");
-      char errorMessage[1024];
-      int errorLength = sprintf(errorMessage,"Array position %d is not a string, but must be for record updating",i);
-      errorMessage[errorLength] = '\0';
-      respondWithError(response, HTTP_STATUS_BAD_REQUEST,errorMessage);
-      return;
-    }
-  }
-  /* Passed JSON check */
-
-  /* TODO: parse all of the user request parms here.  Currently, the only planned one is "replace". */
-  int update = 0;
-  /* TODO: make sure RPL is correctly formatted.  If it is not, add a modRPL call similar to the one in respondWithVSAMDataset() */
-  /* TODO: the only user parm we need to add to the RPL's list is RPL_OPTCD_UPD (replace) here */
-
-  int recordsWritten = 0;
-  int recordLength = 0;
-  char *lastKey;
-  char *tempRecord = safeMalloc(maxRecordLength, "Temporary Record Bufer"); /* TODO: does it make sense to SLHAlloc this instead? */
-  for (int i = 0; i < recordCount; i++) {
-    /* TODO: note that non-KSDS uses a pointer to the ? */
-    /* TODO: get Key before storing */
-    char *key = jsonArrayGetString(recordArray,i); /* TODO: get key AND record here */
-    char *record; /* TODO: correctly parse the record, minding your decided format from the above loop. */
-    /* TODO: point to the key, based on which type of dataset it is.  See pointByXXX functions in respondWithVSAMDataset() for example syntax */
-    if (update) {
-      getRecord(outACB, tempRecord, &recordLength); /* in VSAM, we need to GET for update before we can write over a record with a later PUT for update */
-    }
-    putRecord(outACB, record, recordLength);
-    if (rpl->status) {
-      zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "Error writing to dataset, rc=%02x%06x\n",rpl->status,rpl->feedback);
-      respondWithError(response,HTTP_STATUS_INTERNAL_SERVER_ERROR,"Error writing to dataset");
-      break;
-    }
-    recordsWritten++;
-    lastKey = key; /* TODO: we are keeping this so the caller knows where we left off */
-  }
-  /*success!*/
-  safeFree(tempRecord, maxRecordLength);
-
-  char successMessage[1024];
-  int successMessageLength = sprintf(successMessage,"Updated dataset %s with %d records",dsn,recordsWritten); /* TODO: Note last key */
-  successMessage[successMessageLength] = '\0';
-  respondWithError(response,HTTP_STATUS_OK,successMessage); /*why do we call it respondWithError if we can use successful messages too*/
-  /*endZOSImpersonation(&newACEE);*/
-}
-#endif /* __ZOWE_OS_ZOS */
-
 #ifndef NATIVE_CODEPAGE
 #define NATIVE_CODEPAGE CCSID_EBCDIC_1047
 #endif
@@ -1541,8 +2662,9 @@ static int getMaxRecordLength(char *dscb){
 
 void updateDataset(HttpResponse* response, char* absolutePath, int jsonMode) {
 #ifdef __ZOWE_OS_ZOS
-  if (jsonMode != TRUE) { /*TODO add support for updating files with raw bytes instead of JSON*/
-    respondWithError(response, HTTP_STATUS_BAD_REQUEST,"Cannot update file without JSON formatted record request");
+  if (jsonMode != DATASET_CONTENT_MODE_JSON && jsonMode != DATASET_CONTENT_MODE_TEXT &&
+      jsonMode != DATASET_CONTENT_MODE_BINARY) {
+    respondWithError(response, HTTP_STATUS_BAD_REQUEST,"Cannot update file without JSON, text or binary record request");
     return;
   }
 
@@ -1550,66 +2672,22 @@ void updateDataset(HttpResponse* response, char* absolutePath, int jsonMode) {
   char *forceParam =  getQueryParam(response->request, "force");
   bool force = (forceParam != NULL && !strcmp(forceParam,"true"));
 
-  FileInfo info;
-  int returnCode;
-  int reasonCode;
-
-  char *contentBody = response->request->contentBody;
-  int bodyLength = strlen(contentBody);
-
-  char *convertedBody = safeMalloc(bodyLength*4,"writeDatasetConvert");
-  int conversionBufferLength = bodyLength*4;
-  int translationLength;
-  int outCCSID = NATIVE_CODEPAGE;
-
-  returnCode = convertCharset(contentBody,
-                              bodyLength,
-                              CCSID_UTF_8,
-                              CHARSET_OUTPUT_USE_BUFFER,
-                              &convertedBody,
-                              conversionBufferLength,
-                              outCCSID,
-                              NULL,
-                              &translationLength,
-                              &reasonCode);
-
-  if(returnCode == 0) {  
-    int blockSize = 0x10000;
-    int maxBlockCount = (translationLength*4)/blockSize;
-    if (!maxBlockCount){
-      maxBlockCount = 0x10;
-    }
-    ShortLivedHeap *slh = makeShortLivedHeap(blockSize,maxBlockCount);
-    char errorBuffer[2048];
-    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "UPDATE DATASET: before JSON parse dataLength=0x%x\n",bodyLength);
-    Json *json = jsonParseUnterminatedString(slh, 
-                                             convertedBody, translationLength,
-                                             errorBuffer, sizeof(errorBuffer));
-    if (json) {
-      if (jsonIsObject(json)) {
-        JsonObject *jsonObject = jsonAsObject(json);
-        char *etag = jsonObjectGetString(jsonObject,"etag");
-        if (!etag) {
-          HttpHeader *etagHeader = getHeader(request, "etag");
-          if (etagHeader) {
-            etag = etagHeader->nativeValue;
-          }
-        }
-        updateDatasetWithJSON(response, jsonObject, absolutePath, etag, force);
-      } else{
-        zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "*** INTERNAL ERROR *** message is JSON, but not an object\n");
-      }
+  /* an "etag" in a JSON body takes precedence, but that is only known once
+     it has been parsed */
+  char *etag = NULL;
+  HttpHeader *etagHeader = getHeader(request, "etag");
+  if (etagHeader) {
+    etag = etagHeader->nativeValue;
+    /* raw reads return the etag as a quoted HTTP entity tag */
+    int etagLength = strlen(etag);
+    if (etagLength >= 2 && etag[0] == '"' && etag[etagLength - 1] == '"') {
+      char *unquoted = SLHAlloc(request->slh, etagLength - 1);
+      memcpy(unquoted, etag + 1, etagLength - 2);
+      unquoted[etagLength - 2] = '\0';
+      etag = unquoted;
     }
-    else {
-      zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "UPDATE DATASET: body was not JSON!\n");
-      respondWithError(response, HTTP_STATUS_BAD_REQUEST,"POST body could not be parsed as JSON format");      
-    }
-    SLHFree(slh);
-  }
-  else {
-    respondWithError(response,HTTP_STATUS_INTERNAL_SERVER_ERROR,"Could not translate character set to EBCDIC");    
   }
-  safeFree(convertedBody,conversionBufferLength);
+  updateDatasetWithRecords(response, absolutePath, jsonMode, etag, force);
 #endif /* __ZOWE_OS_ZOS */
 }
 
@@ -1637,6 +2715,9 @@ int deleteDatasetOrMember(HttpResponse* response, char* absolutePath, char* resp
     return ERROR_VSAM_DATASET_DETECTED;
   }
 
+  invalidateCachedAllocations(&datasetName);
+  invalidateCachedETags(&datasetName, &memberName);
+  invalidateCachedDirectory(&datasetName);
   int daReturnCode = RC_DYNALLOC_OK, daSysReturnCode = 0, daSysReasonCode = 0;
   daReturnCode = dynallocAllocDataset(
               &daDatasetName,
@@ -1679,6 +2760,7 @@ int deleteDatasetOrMember(HttpResponse* response, char* absolutePath, char* resp
                                  "r", responseMessage, responseCode);
       return ERROR_DEALLOCATING_DATASET;
     }  
+    invalidateCachedListings(&datasetName);
   }
   else {
     char dsNameNullTerm[DATASET_NAME_LEN + 1] = {0};
@@ -1861,7 +2943,7 @@ char getCSIType(char* absolutePath) {
   return '';
 }
 
-void deleteVSAMDataset(HttpResponse* response, char* absolutePath) {
+void deleteVSAMDataset(HttpResponse* response, char* absolutePath, ACBPool *acbPool) {
 #ifdef __ZOWE_OS_ZOS
   HttpRequest *request = response->request;
   
@@ -1890,11 +2972,19 @@ void deleteVSAMDataset(HttpResponse* response, char* absolutePath) {
       dsName[i] = toupper(dsName[i]);
     }
   }
-    
+
+  /* a pooled ACB, whoever it was opened for, would keep the cluster allocated */
+  char paddedDSN[ACB_POOL_DSN_LENGTH + 1];
+  snprintf(paddedDSN, sizeof(paddedDSN), "%-44.44s", dsName);
+  invalidateACBPool(acbPool, paddedDSN);
+
   int rc = deleteCluster(dsName);
   char responseMessage[128];
 
   if (rc == 0) {
+    if (csiQueryCache) {
+      invalidateCSIQueryResults(csiQueryCache, dsName);
+    }
     snprintf(responseMessage, sizeof(responseMessage), "VSAM dataset %s was successfully deleted", dsName);
     jsonPrinter *p = respondWithJsonPrinter(response);
     setResponseStatus(response, 200, "OK");
@@ -1924,64 +3014,350 @@ void deleteVSAMDataset(HttpResponse* response, char* absolutePath) {
 }
 
 
-void updateVSAMDataset(HttpResponse* response, char* absolutePath, hashtable *acbTable, int jsonMode) {
 #ifdef __ZOWE_OS_ZOS
-  if (jsonMode != TRUE) {
-    respondWithError(response, HTTP_STATUS_BAD_REQUEST,"Cannot update file without JSON formatted record request");
+
+#define RAW_STREAM_BUFFER_SIZE  0x10000
+#define RAW_STREAM_EBCDIC_LF    0x25
+#define RAW_STREAM_RDW_LENGTH   4
+/* EBCDIC SBCS to UTF-8 needs at most 3 bytes per character */
+#define RAW_STREAM_UTF8_EXPANSION 3
+
+/*
+  Records are staged in a buffer and sent as one chunk per buffer, so a chunk
+  holds many records regardless of LRECL. In text mode the staged EBCDIC is
+  converted to UTF-8 at flush time, one conversion per chunk.
+  position is the offset in the response representation of the next record;
+  bytes outside of firstByte..lastByte are dropped for byte ranges, which are
+  only offered in binary mode where the representation is not converted.
+ */
+typedef struct RawDatasetStream_tag {
+  ChunkedOutputStream *out;
+  int mode;
+  char *buffer;
+  int bufferSize;
+  int used;
+  char *conversionBuffer;
+  int conversionBufferSize;
+  int64 position;
+  int64 firstByte;
+  int64 lastByte;   /* -1 for no limit */
+  int rc;
+} RawDatasetStream;
+
+static void flushRawDatasetStream(RawDatasetStream *stream) {
+  if (stream->used == 0 || stream->rc) {
+    stream->used = 0;
     return;
   }
+  if (stream->mode == DATASET_CONTENT_MODE_TEXT) {
+    int translationLength = 0;
+    int reasonCode = 0;
+    int rc = convertCharset(stream->buffer, stream->used, NATIVE_CODEPAGE,
+                            CHARSET_OUTPUT_USE_BUFFER, &stream->conversionBuffer,
+                            stream->conversionBufferSize, CCSID_UTF_8,
+                            NULL, &translationLength, &reasonCode);
+    if (rc) {
+      zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_WARNING,
+              "Raw dataset stream conversion failed, rc=%d, rsn=%d\n", rc, reasonCode);
+      stream->rc = rc;
+    } else {
+      writeBytes(stream->out, stream->conversionBuffer, translationLength, NO_TRANSLATE);
+    }
+  } else {
+    writeBytes(stream->out, stream->buffer, stream->used, NO_TRANSLATE);
+  }
+  stream->used = 0;
+}
 
-  HttpRequest *request = response->request;
-
-  int returnCode;
-  int reasonCode;
+static int addRecordToRawStream(void *userData, char *record, int recordLength) {
+  RawDatasetStream *stream = (RawDatasetStream *)userData;
+  int needed = recordLength + (stream->mode == DATASET_CONTENT_MODE_BINARY ? RAW_STREAM_RDW_LENGTH : 1);
+  int64 recordStart = stream->position;
+  stream->position += needed;
+  if (stream->position <= stream->firstByte) {
+    return stream->rc;
+  }
+  if (stream->lastByte >= 0 && recordStart > stream->lastByte) {
+    return 1;
+  }
+  if (stream->used + needed > stream->bufferSize) {
+    flushRawDatasetStream(stream);
+  }
+  char *next = stream->buffer + stream->used;
+  if (stream->mode == DATASET_CONTENT_MODE_BINARY) {
+    int rdwLength = recordLength + RAW_STREAM_RDW_LENGTH;
+    next[0] = (rdwLength >> 8) & 0xFF;
+    next[1] = rdwLength & 0xFF;
+    next[2] = 0;
+    next[3] = 0;
+    memcpy(next + RAW_STREAM_RDW_LENGTH, record, recordLength);
+  } else {
+    memcpy(next, record, recordLength);
+    next[recordLength] = RAW_STREAM_EBCDIC_LF;
+  }
+  int from = (stream->firstByte > recordStart) ? (int)(stream->firstByte - recordStart) : 0;
+  int to = needed;
+  if (stream->lastByte >= 0 && stream->lastByte < stream->position - 1) {
+    to = (int)(stream->lastByte - recordStart + 1);
+  }
+  if (from > 0) {
+    memmove(next, next + from, to - from);
+  }
+  stream->used += to - from;
+  if (stream->lastByte >= 0 && stream->position > stream->lastByte) {
+    return 1;
+  }
+  return stream->rc;
+}
 
-  char *contentBody = response->request->contentBody;
-  int bodyLength = strlen(contentBody);
+typedef struct DatasetContentRange_tag {
+  bool inBytes;       /* unit is bytes rather than records */
+  int64 first;        /* -1 for a suffix range */
+  int64 last;         /* -1 when open-ended */
+  int64 suffixLength;
+} DatasetContentRange;
 
-  char *convertedBody = safeMalloc(bodyLength*4,"writeDatasetConvert");
-  int conversionBufferLength = bodyLength*4;
-  int translationLength;
-  int outCCSID = NATIVE_CODEPAGE;
+/*
+  Accepts a single "records=" or "bytes=" range of the forms a-b, a- or -n.
+  Multiple ranges are not supported, the header is then ignored as RFC 7233
+  allows.
+ */
+static bool parseDatasetRangeHeader(const char *value, DatasetContentRange *range) {
+  memset(range, 0, sizeof(DatasetContentRange));
+  const char *spec = NULL;
+  if (!strncmp(value, "records=", strlen("records="))) {
+    spec = value + strlen("records=");
+  } else if (!strncmp(value, "bytes=", strlen("bytes="))) {
+    spec = value + strlen("bytes=");
+    range->inBytes = true;
+  } else {
+    return false;
+  }
+  if (strchr(spec, ',')) {
+    return false;
+  }
+  char *end = NULL;
+  if (*spec == '-') {
+    range->first = -1;
+    range->last = -1;
+    range->suffixLength = strtoll(spec + 1, &end, 10);
+    return (end != spec + 1 && *end == '\0' && range->suffixLength > 0);
+  }
+  range->first = strtoll(spec, &end, 10);
+  if (end == spec || *end != '-' || range->first < 0) {
+    return false;
+  }
+  spec = end + 1;
+  if (*spec == '\0') {
+    range->last = -1;
+    return true;
+  }
+  range->last = strtoll(spec, &end, 10);
+  return (end != spec && *end == '\0' && range->last >= range->first);
+}
 
-  returnCode = convertCharset(contentBody,
-                              bodyLength,
-                              CCSID_UTF_8,
-                              CHARSET_OUTPUT_USE_BUFFER,
-                              &convertedBody,
-                              conversionBufferLength,
-                              outCCSID,
-                              NULL,
-                              &translationLength,
-                              &reasonCode);
+/* If-Range only lets the Range through when the client's entity tag is current */
+static bool isIfRangeCurrent(HttpRequest *request, const DatasetReadResult *hashResult) {
+  HttpHeader *ifRange = getHeader(request, "If-Range");
+  if (ifRange == NULL || ifRange->nativeValue == NULL) {
+    return true;
+  }
+  if (hashResult->eTagRC) {
+    return false;
+  }
+  char *value = ifRange->nativeValue;
+  int length = strlen(value);
+  if (length >= 2 && value[0] == '"' && value[length - 1] == '"') {
+    value++;
+    length -= 2;
+  }
+  return (length == strlen(hashResult->eTag) && !memcmp(value, hashResult->eTag, length));
+}
 
-  if(returnCode == 0) {
+static void respondWithRangeNotSatisfiable(HttpResponse *response, bool inBytes, int64 total) {
+  char contentRange[64];
+  snprintf(contentRange, sizeof(contentRange), "%s */%lld", inBytes ? "bytes" : "records", total);
+  setResponseStatus(response, 416, "Range Not Satisfiable");
+  addStringHeader(response, "Server", "jdmfws");
+  addStringHeader(response, "Content-Range", contentRange);
+  addIntHeader(response, "Content-Length", 0);
+  writeHeader(response);
+  finishResponse(response);
+}
 
-    ShortLivedHeap *slh = makeShortLivedHeap(0x10000,0x10);
-    char errorBuffer[2048];
-    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "UPDATE DATASET: before JSON parse dataLength=0x%x\n",bodyLength);
-    Json *json = jsonParseUnterminatedString(slh,
-                                             convertedBody, translationLength,
-                                             errorBuffer, sizeof(errorBuffer));
-    if (json) {
-      if (jsonIsObject(json)){
-        updateVSAMDatasetWithJSON(response, jsonAsObject(json), absolutePath, acbTable);
-      } else{
-        zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "*** INTERNAL ERROR *** message is JSON, but not an object\n");
-      }
+/*
+  Streams the records without JSON framing. The etag goes into the response
+  header, which has to be written before the body, so it is only sent when it
+  is known up front: from the etag cache, or from the counting pass of a Range
+  request. A read of the whole dataset hashes what it streams instead, and
+  stores the etag in the cache for the next request.
+  A Range header of records=, or bytes= in binary mode, answers 206 with just
+  that part. Its totals and the 416 check need the whole dataset counted, which
+  is the one case that reads it twice. Byte ranges skip whole records on FB
+  data; on VB data the records before the range are read and dropped.
+  queryRange (?start=&count=) applies when there is no Range header.
+ */
+static void respondWithRawDataset(HttpResponse *response, const char *datasetPath,
+                                  const DatasetName *dsn, const DatasetMemberName *member,
+                                  char *ddPath, int lrecl, const DatasetBlockFormat *format,
+                                  const DatasetReadRange *queryRange, int mode) {
+  HttpRequest *request = response->request;
+  CachedETag cachedETag;
+  lookupCachedETag(dsn, member, &cachedETag);
+
+  RawDatasetStream stream = {0};
+  stream.mode = mode;
+  stream.lastByte = -1;
+
+  DatasetReadRange recordRange = {0, -1};
+  if (queryRange) {
+    recordRange = *queryRange;
+  }
+  DatasetReadResult hashResult = {0};
+  hashResult.eTagRC = -1;
+  if (cachedETag.eTag[0]) {
+    strcpy(hashResult.eTag, cachedETag.eTag);
+    hashResult.eTagRC = 0;
+  }
+  bool partial = false;
+  DatasetContentRange requested;
+  int64 first = 0, last = 0, total = 0;
+  HttpHeader *rangeHeader = getHeader(request, "Range");
+  bool rangeUsable = (rangeHeader && rangeHeader->nativeValue &&
+                      parseDatasetRangeHeader(rangeHeader->nativeValue, &requested) &&
+                      (!requested.inBytes || mode == DATASET_CONTENT_MODE_BINARY));
+  if (rangeUsable) {
+    bool eTagCached = !hashResult.eTagRC;
+    int countRC = readDataset(ddPath, lrecl, format, NULL,
+                              DATASET_READ_COUNT_RECORDS | (eTagCached ? 0 : DATASET_READ_HASH),
+                              NULL, NULL, &hashResult);
+    if (countRC) {
+      respondWithError(response, HTTP_STATUS_INTERNAL_SERVER_ERROR, "Could not read dataset");
+      return;
     }
-    else {
-      zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "UPDATE DATASET: body was not JSON!\n");
-      respondWithError(response, HTTP_STATUS_BAD_REQUEST,"POST body could not be parsed as JSON format");
+    if (eTagCached) {
+      strcpy(hashResult.eTag, cachedETag.eTag);
+      hashResult.eTagRC = 0;
+    } else if (!hashResult.eTagRC) {
+      storeCachedETag(dsn, member, &cachedETag, hashResult.eTag);
     }
-    SLHFree(slh);
+  }
+  if (rangeUsable && isIfRangeCurrent(request, &hashResult)) {
+    int64 totalRecords = hashResult.recordCount;
+    /* size of the binary representation; text ranges are in records only */
+    int64 totalBytes = hashResult.byteCount + totalRecords * RAW_STREAM_RDW_LENGTH;
+    total = requested.inBytes ? totalBytes : totalRecords;
+    if (requested.first < 0) {
+      first = requested.suffixLength < total ? total - requested.suffixLength : 0;
+      last = total - 1;
+    } else {
+      first = requested.first;
+      last = (requested.last < 0 || requested.last >= total) ? total - 1 : requested.last;
+    }
+    if (first >= total) {
+      respondWithRangeNotSatisfiable(response, requested.inBytes, total);
+      return;
+    }
+    partial = true;
+    if (requested.inBytes) {
+      recordRange.count = -1;
+      recordRange.start = 0;
+      if (format->recfm == 'F' && lrecl > 0) {
+        /* every record has the same size, so whole records can be skipped */
+        int recordSize = lrecl + RAW_STREAM_RDW_LENGTH;
+        recordRange.start = (int)(first / recordSize);
+        stream.position = (int64)recordRange.start * recordSize;
+      }
+      stream.firstByte = first;
+      stream.lastByte = last;
+    } else {
+      recordRange.start = (int)first;
+      recordRange.count = (int)(last - first + 1);
+    }
+  }
+
+  if (partial) {
+    char contentRange[80];
+    snprintf(contentRange, sizeof(contentRange), "%s %lld-%lld/%lld",
+             requested.inBytes ? "bytes" : "records", first, last, total);
+    setResponseStatus(response, 206, "Partial Content");
+    addStringHeader(response, "Content-Range", contentRange);
   } else {
-    respondWithError(response,HTTP_STATUS_INTERNAL_SERVER_ERROR,"Could not translate character set to EBCDIC");
+    setResponseStatus(response, 200, "OK");
   }
-  safeFree(convertedBody,conversionBufferLength);
-#endif /* __ZOWE_OS_ZOS */
+  if (mode == DATASET_CONTENT_MODE_TEXT) {
+    setContentType(response, "text/plain; charset=UTF-8");
+    addStringHeader(response, "Accept-Ranges", "records");
+  } else {
+    setContentType(response, "application/octet-stream");
+    addStringHeader(response, "Accept-Ranges", "records, bytes");
+  }
+  addStringHeader(response, "Server", "jdmfws");
+  addStringHeader(response, "Transfer-Encoding", "chunked");
+  addStringHeader(response, "Cache-control", "no-store");
+  addStringHeader(response, "Pragma", "no-cache");
+  if (!hashResult.eTagRC) {
+    char eTagHeader[sizeof(hashResult.eTag) + 2];
+    snprintf(eTagHeader, sizeof(eTagHeader), "\"%s\"", hashResult.eTag);
+    addStringHeader(response, "ETag", eTagHeader);
+  }
+  writeHeader(response);
+
+  zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "Streaming raw data for %s, mode=%d, start=%d, count=%d\n",
+          datasetPath, mode, recordRange.start, recordRange.count);
+
+  stream.out = makeChunkedOutputStreamInternal(response);
+  stream.bufferSize = RAW_STREAM_BUFFER_SIZE;
+  stream.buffer = safeMalloc(stream.bufferSize, "raw dataset stream");
+  if (mode == DATASET_CONTENT_MODE_TEXT) {
+    stream.conversionBufferSize = stream.bufferSize * RAW_STREAM_UTF8_EXPANSION;
+    stream.conversionBuffer = safeMalloc(stream.conversionBufferSize, "raw dataset stream conversion");
+  }
+
+  DatasetReadResult result;
+  bool ranged = (recordRange.start > 0 || recordRange.count >= 0);
+  bool hash = (!ranged && !partial && hashResult.eTagRC);
+  int readRC = readDataset(ddPath, lrecl, format, ranged ? &recordRange : NULL,
+                           DATASET_READ_EMIT_RECORDS | (hash ? DATASET_READ_HASH : 0),
+                           addRecordToRawStream, &stream, &result);
+  flushRawDatasetStream(&stream);
+  if (hash && readRC == 0 && !result.eTagRC && !stream.rc) {
+    storeCachedETag(dsn, member, &cachedETag, result.eTag);
+  }
+
+  finishChunkedOutput(stream.out, NO_TRANSLATE);
+  safeFree(stream.buffer, stream.bufferSize);
+  if (stream.conversionBuffer) {
+    safeFree(stream.conversionBuffer, stream.conversionBufferSize);
+  }
+  finishResponse(response);
 }
 
+/*
+  ?start= and ?count= select a run of records. Returns false after responding
+  with an error when they are not usable; *range is NULL when neither is given.
+ */
+static bool getQueryRecordRangeOrRespondError(HttpResponse *response, DatasetReadRange *storage,
+                                              DatasetReadRange **range) {
+  HttpRequest *request = response->request;
+  HttpRequestParam *startParam = getCheckedParam(request, "start");
+  HttpRequestParam *countParam = getCheckedParam(request, "count");
+  *range = NULL;
+  if (startParam == NULL && countParam == NULL) {
+    return true;
+  }
+  storage->start = startParam ? startParam->intValue : 0;
+  storage->count = countParam ? countParam->intValue : -1;
+  if (storage->start < 0 || (countParam && storage->count < 0)) {
+    respondWithError(response, HTTP_STATUS_BAD_REQUEST, "start and count must not be negative");
+    return false;
+  }
+  *range = storage;
+  return true;
+}
+
+#endif /* __ZOWE_OS_ZOS */
+
 /*
   write = openSAM(name,OPEN_CLOSE_OUTPUT,TRUE,recfm,lrecl,blksize);
   read = openSAM(name,OPEN_CLOSE_INPUT,TRUE,recfm,lrecl,blksize);
@@ -1991,18 +3367,32 @@ void updateVSAMDataset(HttpResponse* response, char* absolutePath, hashtable *ac
 static void respondWithDatasetInternal(HttpResponse* response,
                                        const char *datasetPath,
                                        const DatasetName *dsn,
-                                       const DDName *ddName) {
+                                       const DatasetMemberName *member,
+                                       const DDName *ddName,
+                                       int mode) {
 #ifdef __ZOWE_OS_ZOS
   HttpRequest *request = response->request;
 
   char ddPath[16];
   snprintf(ddPath, sizeof(ddPath), "DD:%8.8s", ddName->value);
 
-  int lrecl = getLreclOrRespondError(response, dsn, ddPath);
+  DatasetBlockFormat format;
+  int lrecl = getLreclOrRespondError(response, dsn, ddPath, &format);
   if (!lrecl) {
     return;
   }
 
+  DatasetReadRange rangeStorage;
+  DatasetReadRange *range = NULL;
+  if (!getQueryRecordRangeOrRespondError(response, &rangeStorage, &range)) {
+    return;
+  }
+
+  if (mode == DATASET_CONTENT_MODE_TEXT || mode == DATASET_CONTENT_MODE_BINARY) {
+    respondWithRawDataset(response, datasetPath, dsn, member, ddPath, lrecl, &format, range, mode);
+    return;
+  }
+
   jsonPrinter *jPrinter = respondWithJsonPrinter(response);
   setResponseStatus(response, 200, "OK");
   setDefaultJSONRESTHeaders(response);
@@ -2012,9 +3402,14 @@ static void respondWithDatasetInternal(HttpResponse* response,
   if (lrecl){
     zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "Streaming data for %s\n", datasetPath);
 
+    CachedETag cachedETag;
+    lookupCachedETag(dsn, member, &cachedETag);
+    char eTag[sizeof(cachedETag.eTag)];
+    strcpy(eTag, cachedETag.eTag);
     jsonStart(jPrinter);
-    int status = streamDataset(ddPath, lrecl, jPrinter);
+    streamDatasetWithFormat(ddPath, lrecl, &format, range, eTag, jPrinter);
     jsonEnd(jPrinter);
+    storeCachedETag(dsn, member, &cachedETag, eTag);
   }
   finishResponse(response);
 #endif /* __ZOWE_OS_ZOS */
@@ -2037,16 +3432,11 @@ void respondWithDataset(HttpResponse* response, char* absolutePath, int jsonMode
   memcpy(daDsn.name, dsn.value, sizeof(daDsn.name));
   memcpy(daMember.name, memberName.value, sizeof(daMember.name));
   DynallocDDName daDDname = {.name = "????????"};
+  DatasetAllocation *cachedAllocation = NULL;
 
   int daRC = RC_DYNALLOC_OK, daSysRC = 0, daSysRSN = 0;
-  daRC = dynallocAllocDataset(
-      &daDsn,
-      IS_DAMEMBER_EMPTY(daMember) ? NULL : &daMember,
-      &daDDname,
-      DYNALLOC_DISP_SHR,
-      DYNALLOC_ALLOC_FLAG_NO_CONVERSION | DYNALLOC_ALLOC_FLAG_NO_MOUNT,
-      &daSysRC, &daSysRSN
-  );
+  daRC = allocateDatasetForRead(request, &daDsn, &daMember, &daDDname,
+                                &cachedAllocation, &daSysRC, &daSysRSN);
 
   if (daRC != RC_DYNALLOC_OK) {
     zowelog(NULL, LOG_COMP_DATASERVICE, ZOWE_LOG_DEBUG,
@@ -2069,10 +3459,10 @@ void respondWithDataset(HttpResponse* response, char* absolutePath, int jsonMode
 
   DDName ddName;
   memcpy(&ddName.value, &daDDname.name, sizeof(ddName.value));
-  respondWithDatasetInternal(response, absolutePath, &dsn, &ddName);
+  respondWithDatasetInternal(response, absolutePath, &dsn, &memberName, &ddName, jsonMode);
 
-  daRC = dynallocUnallocDatasetByDDName(&daDDname, DYNALLOC_UNALLOC_FLAG_NONE,
-                                        &daSysRC, &daSysRSN);
+  daRC = unallocateDatasetForRead(&daDDname, cachedAllocation,
+                                  &daSysRC, &daSysRSN);
   if (daRC != RC_DYNALLOC_OK) {
     zowelog(NULL, LOG_COMP_DATASERVICE, ZOWE_LOG_DEBUG,
             "error: ds unalloc dsn=\'%44.44s\', member=\'%8.8s\', dd=\'%8.8s\',"
@@ -2087,287 +3477,1002 @@ void respondWithDataset(HttpResponse* response, char* absolutePath, int jsonMode
 #define CSI_VSAMTYPE_VRRDS 0x0001
 #define CSI_VSAMTYPE_CLOER 0x0020 /* Error on last close - stats may be inaccurate */
 
-/* In development - this is hardcoded for now */
-void respondWithVSAMDataset(HttpResponse* response, char* absolutePath, hashtable *acbTable, int jsonMode) {
 #ifdef __ZOWE_OS_ZOS
-  zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "begin %s\n", __FUNCTION__);
-  HttpRequest *request = response->request;
+static int getVSAMType(unsigned int vsamType) {
+  if (vsamType & CSI_VSAMTYPE_KSDS) {
+    return VSAM_TYPE_KSDS;
+  } else if (vsamType & (CSI_VSAMTYPE_RRDS | CSI_VSAMTYPE_VRRDS)) {
+    return VSAM_TYPE_RRDS;
+  } else if (vsamType & CSI_VSAMTYPE_LDS) {
+    return VSAM_TYPE_LDS;
+  }
+  return VSAM_TYPE_ESDS; /* assume ESDS otherwise */
+}
 
-  HttpRequestParam *closeParam = getCheckedParam(request,"closeAfter");
-  char *closeArg = (closeParam ? closeParam->stringValue : NULL);
-  int closeAfter = (closeArg != NULL && !strcmp(closeArg,"true"));
+static int getVSAMRPLOptions(int type) {
+  switch (type) {
+    case VSAM_TYPE_KSDS:
+    case VSAM_TYPE_RRDS:
+      return RPL_OPTCD_KEY | RPL_OPTCD_SEQ;
+    case VSAM_TYPE_LDS:
+      return RPL_OPTCD_CNV | RPL_OPTCD_SEQ;
+    default:
+      return RPL_OPTCD_ADR | RPL_OPTCD_SEQ;
+  }
+}
 
-  int returnCode;
-  int reasonCode;
-  char dsn[45] = "";
-  int rplParms = 0;
-  memcpy(dsn, absolutePath, 44);
-  if (strlen(absolutePath) <= 44) {
-    memset(dsn + strlen(absolutePath), ' ', 44 - strlen(absolutePath));
-    dsn[44] = 0;
-  } else {
-    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "DSN of size %d is too large.\n", strlen(absolutePath));
-    respondWithError(response, HTTP_STATUS_BAD_REQUEST, "Dataset Name must be 44 bytes of less");
-    return;
+/* Keys are passed base64 encoded, as records return them. A key shorter than
+   the dataset's is a generic key. */
+static bool decodeVSAMKey(char *encoded, char *key, int *keyLength, int maxLength) {
+  char decoded[VSAM_MAX_KEY_LENGTH + 3];
+  if (encoded == NULL || strlen(encoded) < 1 || strlen(encoded) > (VSAM_MAX_KEY_LENGTH + 2) / 3 * 4) {
+    return false;
   }
-  char *username = response->request->username;
+  int length = decodeBase64(encoded, decoded);
+  if (length < 1 || length > maxLength) {
+    return false;
+  }
+  memcpy(key, decoded, length);
+  *keyLength = length;
+  return true;
+}
 
-  int          maxRecords = 0;
-  int          maxBytes = 0;
-  /* TODO: parse out the parms from the HttpRequest* request */
-
-  unsigned int vsamType       = 0;
-  unsigned int ciSize         = 0;
-  unsigned int maxlrecl       = 0;
-  unsigned int maxbuffer      = 0;
-  unsigned int keyLoc         = 0;
-  unsigned int keyLen         = 0;
-  char         dsnCluster[45] = "";
-  char         dsnData[45]    = "";
-
-  /* TODO: We should not need to do this on every call - only if the ACB needs to be opened */
-  /* TODO: How to access the CSI in cases where the entry is archived? Is this possible? */
-  csi_parmblock * __ptr32 returnParms = (csi_parmblock* __ptr32)safeMalloc31(sizeof(csi_parmblock),"CSI ParmBlock");
-  EntryDataSet *entrySet = returnEntries(dsn, clusterTypesAllowed, clusterTypesCount, 0, defaultVSAMCSIFields, defaultVSAMCSIFieldCount, NULL, NULL, returnParms);
-  EntryData *entry = entrySet->entries[0];
-  if (entry){
-    if (entry->type == 'I') { /* TODO: how do we want to handle INDEX datasets?  Some editors use */
-      /* TODO: free the entire entrySet, then call CSI again */
-    }
-    if (entry->type == 'C') {
-      unsigned short *fieldLengthArray = ((unsigned short *)((char*)entry+sizeof(EntryData)));
-      char *fieldValueStart = (char*)entry+sizeof(EntryData)+defaultVSAMCSIFieldCount*sizeof(short);
-      for (int j=0; j<defaultVSAMCSIFieldCount; j++){
-        /* zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "j = %d: '%s' (%d)\n", j, defaultVSAMCSIFields[j], fieldLengthArray[j]); */
-        if (!strcmp(defaultVSAMCSIFields[j],"ASSOC   ") && fieldLengthArray[j]){
-          zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "DATA     = '%44.44s' [%c]\n", fieldValueStart+1, *fieldValueStart);
-          memcpy(dsnData,fieldValueStart+1,44);
-          /* Is there a use to storing the index component, located here in the case of KSDS? */
-          break;
-        }
-        fieldValueStart += fieldLengthArray[j];
-      }
-      for (int i = 0; i < entrySet->length; i++){
-        EntryData *currentEntry = entrySet->entries[i];
-        int fieldDataLength = currentEntry->data.fieldInfoHeader.totalLength;
-        int entrySize = sizeof(EntryData)+fieldDataLength-4;
-        memset((char*)(currentEntry),0,entrySize);
-        safeFree((char*)(currentEntry),entrySize);
-      }
-      memset((char*)(entrySet->entries),0,sizeof(EntryData*)*entrySet->length);
-      safeFree((char*)(entrySet->entries),sizeof(EntryData*)*entrySet->size);
-      memset((char*)entrySet,0,sizeof(EntryDataSet));
-      safeFree((char*)entrySet,sizeof(EntryDataSet));
-
-      EntryDataSet *entrySet = returnEntries(dsnData, clusterTypesAllowed, clusterTypesCount, 0, defaultVSAMCSIFields, defaultVSAMCSIFieldCount, NULL, NULL, returnParms);
-      entry = entrySet->entries[0];
-    } else if (entry->type != 'D') {
-      safeFree31((char*)returnParms,sizeof(csi_parmblock));
-      for (int i = 0; i < entrySet->length; i++){
-        EntryData *currentEntry = entrySet->entries[i];
-        if (!(entrySet->entries)) break;
-        int fieldDataLength = currentEntry->data.fieldInfoHeader.totalLength;
-        int entrySize = sizeof(EntryData)+fieldDataLength-4;
-        safeFree((char*)(currentEntry),entrySize);
-      }
-      safeFree((char*)(entrySet->entries),sizeof(EntryData*)*entrySet->length);
-      safeFree((char*)entrySet,sizeof(EntryDataSet));
-      respondWithError(response, HTTP_STATUS_BAD_REQUEST,"Not Found in Catalog");
-      return;
-    }
+/* Positions the ACB so that the next sequential GET returns the record at
+   position, or for a KSDS the first one at or after the key */
+static int pointToVSAMPosition(StatefulACB *state, const VSAMReadPosition *position) {
+  switch (state->type) {
+    case VSAM_TYPE_KSDS:
+      memcpy(state->argPtr.key, position->key, position->keyLength);
+      return pointByKey(state->acb, state->argPtr.key, position->keyLength);
+    case VSAM_TYPE_ESDS:
+      state->argPtr.rba = position->rba;
+      return pointByRBA(state->acb, &(state->argPtr.rba));
+    case VSAM_TYPE_LDS:
+      state->argPtr.ci = position->rba;
+      return pointByCI(state->acb, &(state->argPtr.ci));
+    case VSAM_TYPE_RRDS:
+      state->argPtr.record = position->record;
+      return pointByRecord(state->acb, &(state->argPtr.record));
+  }
+  return 8;
+}
 
-    if (entry->type == 'D') {
-      memcpy(dsnData, entry->name, 44);
-      unsigned short *fieldLengthArray = ((unsigned short *)((char*)entry+sizeof(EntryData)));
-      char *fieldValueStart = (char*)entry+sizeof(EntryData)+defaultVSAMCSIFieldCount*sizeof(short);
-      for (int j=0; j<defaultVSAMCSIFieldCount; j++){
-        zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "j = %d: '%s' (%d)\n", j, defaultVSAMCSIFields[j], fieldLengthArray[j]);
-        if (!strcmp(defaultVSAMCSIFields[j],"VSAMTYPE") && fieldLengthArray[j]){
-          memcpy(&vsamType,fieldValueStart,2);
-          vsamType >>= (sizeof(int) * 8 - 16);  /* in case of weird int sizes */
-        }
-        if (!strcmp(defaultVSAMCSIFields[j],"ASSOC   ") && fieldLengthArray[j]){
-          zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "CLUSTER  = '%44.44s' [%c]\n", fieldValueStart+1, *fieldValueStart);
-          memcpy(dsnCluster,fieldValueStart+1,44);
-        }
-        if (!strcmp(defaultVSAMCSIFields[j],"AMDCIREC") && fieldLengthArray[j]){
-          memcpy(&ciSize,fieldValueStart,4);
-          ciSize >>= (sizeof(int) * 8 - 32);  /* in case of weird int sizes */
-          memcpy(&maxlrecl,fieldValueStart+4,4);
-          maxlrecl >>= (sizeof(int) * 8 - 32);  /* in case of weird int sizes */
-        }
-        if (!strcmp(defaultVSAMCSIFields[j],"AMDKEY  ") && fieldLengthArray[j]){
-          memcpy(&keyLoc,fieldValueStart,2);
-          keyLoc >>= (sizeof(int) * 8 - 16);  /* in case of weird int sizes */
-          memcpy(&keyLen,fieldValueStart+2,2);
-          keyLen >>= (sizeof(int) * 8 - 16);  /* in case of weird int sizes */
-        }
-        fieldValueStart += fieldLengthArray[j];
-      }
+/* Where the next page starts, in the parameter that takes it */
+static void addVSAMResumePosition(jsonPrinter *jPrinter, int type, const VSAMReadPosition *next) {
+  char rba[16];
+  switch (type) {
+    case VSAM_TYPE_KSDS: {
+      int encodedLength = 0;
+      char *encodedKey = encodeBase64(NULL, (char *)next->key, next->keyLength, &encodedLength, 1);
+      jsonAddString(jPrinter, "resumeKey", encodedKey);
+      safeFree(encodedKey, encodedLength);
+      break;
     }
-  } else {
-    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "Catalog Entry not found for \"%s\"\n", dsn);
-    respondWithError(response, HTTP_STATUS_BAD_REQUEST,"Not Found in Catalog");
-    return;
-  } /* end Catalog Search */
-  zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "vsamType = 0x%0x, ciSize = %d, maxlrecl = %d, keyLoc = %d, keyLen = %d\n", vsamType, ciSize, maxlrecl, keyLoc, keyLen);
+    case VSAM_TYPE_RRDS:
+      jsonAddInt(jPrinter, "resumeRecord", next->record);
+      break;
+    default:
+      snprintf(rba, sizeof(rba), "%u", next->rba);
+      jsonAddString(jPrinter, "resumeRBA", rba);
+      break;
+  }
+}
 
-  safeFree31((char*)returnParms,sizeof(csi_parmblock));
-  for (int i = 0; i < entrySet->length; i++){
-    EntryData *currentEntry = entrySet->entries[i];
-    if (!(entrySet->entries)) break;
-    if (currentEntry == (EntryData *)0x000a0000) {
-      zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "... how did this happen:\n");
-      dumpbuffer((char *)entrySet, 1000);
-    }
-    int fieldDataLength = currentEntry->data.fieldInfoHeader.totalLength;
-    int entrySize = sizeof(EntryData)+fieldDataLength-4;
-    safeFree((char*)(currentEntry),entrySize);
+/* The key of the end frame: a KSDS key, or a big-endian RBA or record number */
+static int getVSAMResumeKey(int type, const VSAMReadPosition *next, char *key) {
+  unsigned int value = 0;
+  switch (type) {
+    case VSAM_TYPE_KSDS:
+      memcpy(key, next->key, next->keyLength);
+      return next->keyLength;
+    case VSAM_TYPE_RRDS:
+      value = (unsigned int)next->record;
+      break;
+    default:
+      value = next->rba;
+      break;
   }
-  safeFree((char*)(entrySet->entries),sizeof(EntryData*)*entrySet->size);
-  safeFree((char*)entrySet,sizeof(EntryDataSet));
+  key[0] = (value >> 24) & 0xFF;
+  key[1] = (value >> 16) & 0xFF;
+  key[2] = (value >> 8) & 0xFF;
+  key[3] = value & 0xFF;
+  return 4;
+}
 
-  char *dsnUidPair = safeMalloc(44+8+1, "DSN,UID Pair Entry");  /* TODO: plug this leak for each time it is htPut below. */
-  memset(dsnUidPair, ' ', 44+8);                                /* TODO:  we will want to free it when the ACB closes.   */
-  memcpy(dsnUidPair, dsnData, 44);
-  memcpy(dsnUidPair+44, username, 8);
-  StatefulACB *state = (StatefulACB *)htGet(acbTable, dsnUidPair);
-  char *inACB = state ? state->acb : NULL;
-  int searchArg = 0;
-  void *argPtr = NULL;
-
-  if (inACB) { /* an ACB exists */
-    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "ACB found at 0x%0x\n", inACB);
-    /* TODO: if opened for output, close and reopen for input by preserving existing macrf, rpl, maxrecl parms. Reset arg. */
-    /* TODO: if the user submits a start key parm, this is where it should be entered */
-    switch (state->type) {
-      case VSAM_TYPE_KSDS:
-        argPtr = state->argPtr.key;
-        break;
-      case VSAM_TYPE_ESDS:
-        argPtr = &(state->argPtr.rba);
-        break;
-      case VSAM_TYPE_LDS:
-        argPtr = &(state->argPtr.ci);
-        break;
-      case VSAM_TYPE_RRDS:
-        argPtr = &(state->argPtr.record);
-        break;
-    }
-    safeFree(dsnUidPair, 44+8+1);
-  } else { /* need to open an ACB */
-    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "about to dynalloc a DD to %s\n", dsn);
-    DynallocInputParms inputParms;
-    memcpy(inputParms.dsName, dsn, DATASET_NAME_LEN);
-    memcpy(inputParms.ddName, "MVD00000", DD_NAME_LEN);
-    inputParms.disposition = DISP_SHARE;
-    char ddname[9] = "MVD00000";
-    returnCode = dynallocDataset(&inputParms, &reasonCode);
+/* Error codes of vsamInputACBOpener */
+#define VSAM_OPEN_NOT_CATALOGED   1
+#define VSAM_OPEN_NO_DD           2
+#define VSAM_OPEN_NOT_OPENED      3
+#define VSAM_OPEN_NOT_POSITIONED  4
+#define VSAM_OPEN_NOT_WRITABLE    5
 
-    int ddNumber = 1;
-    while (reasonCode==0x4100000 && ddNumber < 100000) {
-      sprintf(inputParms.ddName, "MVD%05d", ddNumber);
-      sprintf(ddname, "MVD%05d", ddNumber);
-      returnCode = dynallocDataset(&inputParms, &reasonCode);
-      ddNumber++;
+static void freeVSAMEntrySet(EntryDataSet *entrySet) {
+  for (int i = 0; i < entrySet->length; i++) {
+    freeCSIEntry(entrySet->entries[i]);
+  }
+  freeCSIEntrySet(entrySet);
+}
+
+static void decodeVSAMAttributes(EntryData *entry, VSAMAttributes *attributes) {
+  memcpy(attributes->dataName, entry->name, 44);
+  unsigned short *fieldLengthArray = ((unsigned short *)((char*)entry+sizeof(EntryData)));
+  char *fieldValueStart = (char*)entry+sizeof(EntryData)+defaultVSAMCSIFieldCount*sizeof(short);
+  for (int j=0; j<defaultVSAMCSIFieldCount; j++){
+    if (!strcmp(defaultVSAMCSIFields[j],"VSAMTYPE") && fieldLengthArray[j]){
+      attributes->vsamType = getHalfword((unsigned char *)fieldValueStart);
     }
-    if (returnCode) {
-      zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "Dynalloc RC = %d, reasonCode = %x\n", returnCode, reasonCode);
-      respondWithError(response, HTTP_STATUS_INTERNAL_SERVER_ERROR, "Unable to allocate a DD for ACB");
-      return;
+    if (!strcmp(defaultVSAMCSIFields[j],"ASSOC   ") && fieldLengthArray[j]){
+      zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "CLUSTER  = '%44.44s' [%c]\n", fieldValueStart+1, *fieldValueStart);
+      memcpy(attributes->clusterName,fieldValueStart+1,44);
     }
-
-    int macrfParms = 0;
-    maxbuffer = maxlrecl;
-    state = (StatefulACB *)safeMalloc(sizeof(StatefulACB), "Stateful ACB Entry");
-    if (vsamType & CSI_VSAMTYPE_KSDS) {
-      macrfParms = ACB_MACRF_KEY | ACB_MACRF_SEQ | ACB_MACRF_IN;
-      rplParms = RPL_OPTCD_KEY | RPL_OPTCD_SEQ;
-      state->type = VSAM_TYPE_KSDS;
-    } else if (vsamType & (CSI_VSAMTYPE_RRDS | CSI_VSAMTYPE_VRRDS)) {
-      macrfParms = ACB_MACRF_SEQ | ACB_MACRF_IN;
-      rplParms = RPL_OPTCD_KEY | RPL_OPTCD_SEQ;
-      state->type = VSAM_TYPE_RRDS;
-    } else if (vsamType & CSI_VSAMTYPE_LDS) {
-      macrfParms = ACB_MACRF_CNV | ACB_MACRF_SEQ | ACB_MACRF_IN;
-      rplParms = RPL_OPTCD_CNV | RPL_OPTCD_SEQ;
-      state->type = VSAM_TYPE_LDS;
-      maxbuffer = ciSize;
-    } else { /* assume ESDS otherwise */
-      macrfParms = ACB_MACRF_ADR | ACB_MACRF_SEQ | ACB_MACRF_IN;
-      rplParms = RPL_OPTCD_ADR | RPL_OPTCD_SEQ;
-      state->type = VSAM_TYPE_ESDS;
-    }
-    inACB = openACB(ddname, ACB_MODE_INPUT, macrfParms, 0, rplParms, maxlrecl, maxbuffer);
-    if (!inACB) {
-      /* Failed to open ACB! */
-      /* TODO: free the few things that we created above that will leak */
-      respondWithError(response, HTTP_STATUS_INTERNAL_SERVER_ERROR,"ACB Not Opened");
-      return;
+    if (!strcmp(defaultVSAMCSIFields[j],"AMDCIREC") && fieldLengthArray[j]){
+      attributes->ciSize = getFullword((unsigned char *)fieldValueStart);
+      attributes->maxlrecl = getFullword((unsigned char *)fieldValueStart+4);
     }
-    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "ACB for %s opened at %08x\n", ddname, inACB);
-    /* TODO: if the user submits a start key parm, enter it in the point function calls below */
-    state->acb = inACB;
-    switch (state->type) {
-      case VSAM_TYPE_KSDS:
-        state->argPtr.key = (char *)safeMalloc(keyLen+1, "Stateful ACB Key Buffer");
-        memset(state->argPtr.key, 0, keyLen+1);
-        argPtr = state->argPtr.key;
-        /* returnCode = pointByKey(inACB, (char *)argPtr, keyLen); TODO: add only when the user provides a known key */
-        break;
-      case VSAM_TYPE_ESDS:
-        state->argPtr.rba = 0;
-        argPtr = &(state->argPtr.rba);
-        returnCode = pointByRBA(inACB, argPtr);
-        break;
-      case VSAM_TYPE_LDS:
-        state->argPtr.ci = 0;
-        argPtr = &(state->argPtr.ci);
-        returnCode = pointByCI(inACB, argPtr);
-        break;
-      case VSAM_TYPE_RRDS:
-        state->argPtr.record = 1;
-        argPtr = &(state->argPtr.record);
-        returnCode = pointByRecord(inACB, argPtr);
+    if (!strcmp(defaultVSAMCSIFields[j],"AMDKEY  ") && fieldLengthArray[j]){
+      attributes->keyLoc = getHalfword((unsigned char *)fieldValueStart);
+      attributes->keyLen = getHalfword((unsigned char *)fieldValueStart+2);
+    }
+    fieldValueStart += fieldLengthArray[j];
+  }
+}
+
+/* TODO: How to access the CSI in cases where the entry is archived? Is this possible? */
+static int lookupVSAMAttributes(void *userData, const char *dsn, VSAMAttributes *attributes) {
+  memset(attributes, 0, sizeof(VSAMAttributes));
+  char name[45];
+  memcpy(name, dsn, 44);
+  name[44] = 0;
+  csi_parmblock * __ptr32 returnParms = (csi_parmblock* __ptr32)safeMalloc31(sizeof(csi_parmblock),"CSI ParmBlock");
+  EntryDataSet *entrySet = returnEntries(name, clusterTypesAllowed, clusterTypesCount, 0, defaultVSAMCSIFields, defaultVSAMCSIFieldCount, NULL, NULL, returnParms);
+  EntryData *entry = entrySet->length > 0 ? entrySet->entries[0] : NULL;
+  if (entry && entry->type == 'C') {
+    /* a cluster is read through its data component, the first one associated */
+    char dataName[45] = "";
+    unsigned short *fieldLengthArray = ((unsigned short *)((char*)entry+sizeof(EntryData)));
+    char *fieldValueStart = (char*)entry+sizeof(EntryData)+defaultVSAMCSIFieldCount*sizeof(short);
+    for (int j=0; j<defaultVSAMCSIFieldCount; j++){
+      if (!strcmp(defaultVSAMCSIFields[j],"ASSOC   ") && fieldLengthArray[j]){
+        zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "DATA     = '%44.44s' [%c]\n", fieldValueStart+1, *fieldValueStart);
+        memcpy(dataName,fieldValueStart+1,44);
         break;
+      }
+      fieldValueStart += fieldLengthArray[j];
     }
+    freeVSAMEntrySet(entrySet);
+    entrySet = returnEntries(dataName, clusterTypesAllowed, clusterTypesCount, 0, defaultVSAMCSIFields, defaultVSAMCSIFieldCount, NULL, NULL, returnParms);
+    entry = entrySet->length > 0 ? entrySet->entries[0] : NULL;
+  }
+  int rc = 0;
+  /* TODO: how do we want to handle INDEX datasets? */
+  if (entry && entry->type == 'D') {
+    decodeVSAMAttributes(entry, attributes);
+    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "vsamType = 0x%0x, ciSize = %d, maxlrecl = %d, keyLoc = %d, keyLen = %d\n",
+            attributes->vsamType, attributes->ciSize, attributes->maxlrecl, attributes->keyLoc, attributes->keyLen);
+  } else {
+    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "Catalog Entry not found for \"%s\"\n", name);
+    rc = VSAM_OPEN_NOT_CATALOGED;
+  }
+  freeVSAMEntrySet(entrySet);
+  safeFree31((char*)returnParms,sizeof(csi_parmblock));
+  return rc;
+}
 
-    if (returnCode) {
-      zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "point failed with RC = %08x\n", returnCode);
-      /* TODO: free the few things that we created above that will otherwise leak */
+static void unallocateVSAMDD(const char *ddName) {
+  DynallocInputParms inputParms;
+  memset(&inputParms, 0, sizeof(DynallocInputParms));
+  memcpy(inputParms.ddName, ddName, DD_NAME_LEN);
+  int reasonCode = 0;
+  int returnCode = unallocDataset(&inputParms, &reasonCode);
+  if (returnCode) {
+    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "Unalloc of %8.8s RC = %d, reasonCode = %x\n", ddName, returnCode, reasonCode);
+  }
+}
+
+static void closeVSAMForInput(void *userData, StatefulACB *state, const char *ddName) {
+  zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "closing ACB at 0x%0x, DD %8.8s\n", state->acb, ddName);
+  closeACB(state->acb, ACB_MODE_INPUT);
+  if (state->type == VSAM_TYPE_KSDS && state->argPtr.key) {
+    safeFree(state->argPtr.key, VSAM_MAX_KEY_LENGTH+1);
+  }
+  unallocateVSAMDD(ddName);
+}
+
+/* Allocates dsn, space padded, DISP=SHR to the first free MVDnnnnn DD,
+   which is returned in ddname */
+static int allocateVSAMDD(const char *dsn, char *ddname) {
+  zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "about to dynalloc a DD to %44.44s\n", dsn);
+  int returnCode = 0;
+  int reasonCode = 0;
+  DynallocInputParms inputParms;
+  memset(&inputParms, 0, sizeof(DynallocInputParms));
+  memcpy(inputParms.dsName, dsn, DATASET_NAME_LEN);
+  memcpy(inputParms.ddName, "MVD00000", DD_NAME_LEN);
+  inputParms.disposition = DISP_SHARE;
+  strcpy(ddname, "MVD00000");
+  returnCode = dynallocDataset(&inputParms, &reasonCode);
+
+  int ddNumber = 1;
+  while (reasonCode==0x4100000 && ddNumber < 100000) {
+    sprintf(inputParms.ddName, "MVD%05d", ddNumber);
+    sprintf(ddname, "MVD%05d", ddNumber);
+    returnCode = dynallocDataset(&inputParms, &reasonCode);
+    ddNumber++;
+  }
+  if (returnCode) {
+    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "Dynalloc RC = %d, reasonCode = %x\n", returnCode, reasonCode);
+    return VSAM_OPEN_NO_DD;
+  }
+  return 0;
+}
+
+static int openVSAMForInput(void *userData, PooledACB *entry) {
+  const VSAMAttributes *attributes = &entry->attributes;
+  char ddname[9];
+  int returnCode = allocateVSAMDD(entry->dsn, ddname);
+  if (returnCode) {
+    return returnCode;
+  }
+
+  StatefulACB *state = &entry->state;
+  int type = getVSAMType(attributes->vsamType);
+  int macrfParms = 0;
+  unsigned int maxbuffer = attributes->maxlrecl;
+  switch (type) {
+    case VSAM_TYPE_KSDS:
+      macrfParms = ACB_MACRF_KEY | ACB_MACRF_SEQ | ACB_MACRF_IN;
+      break;
+    case VSAM_TYPE_RRDS:
+      macrfParms = ACB_MACRF_SEQ | ACB_MACRF_IN;
+      break;
+    case VSAM_TYPE_LDS:
+      macrfParms = ACB_MACRF_CNV | ACB_MACRF_SEQ | ACB_MACRF_IN;
+      maxbuffer = attributes->ciSize;
+      break;
+    default:
+      macrfParms = ACB_MACRF_ADR | ACB_MACRF_SEQ | ACB_MACRF_IN;
+      break;
+  }
+  char *inACB = openACB(ddname, ACB_MODE_INPUT, macrfParms, 0, getVSAMRPLOptions(type),
+                        attributes->maxlrecl, maxbuffer);
+  if (!inACB) {
+    unallocateVSAMDD(ddname);
+    return VSAM_OPEN_NOT_OPENED;
+  }
+  zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "ACB for %s opened at %08x\n", ddname, inACB);
+  state->acb = inACB;
+  state->type = type;
+  memcpy(entry->ddName, ddname, ACB_POOL_DDNAME_LENGTH);
+  switch (type) {
+    case VSAM_TYPE_KSDS:
+      state->argPtr.key = (char *)safeMalloc(VSAM_MAX_KEY_LENGTH+1, "Stateful ACB Key Buffer");
+      memset(state->argPtr.key, 0, VSAM_MAX_KEY_LENGTH+1);
+      break;
+    case VSAM_TYPE_ESDS:
+      state->argPtr.rba = 0;
+      returnCode = pointByRBA(inACB, &(state->argPtr.rba));
+      break;
+    case VSAM_TYPE_LDS:
+      state->argPtr.ci = 0;
+      returnCode = pointByCI(inACB, &(state->argPtr.ci));
+      break;
+    case VSAM_TYPE_RRDS:
+      state->argPtr.record = 1;
+      returnCode = pointByRecord(inACB, &(state->argPtr.record));
+      break;
+  }
+  if (returnCode) {
+    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "point failed with RC = %08x\n", returnCode);
+    closeVSAMForInput(userData, state, ddname);
+    return VSAM_OPEN_NOT_POSITIONED;
+  }
+  return 0;
+}
+
+const ACBOpener vsamInputACBOpener = {
+  .lookup = lookupVSAMAttributes,
+  .open = openVSAMForInput,
+  .close = closeVSAMForInput,
+  .userData = NULL
+};
+
+static void respondWithVSAMOpenError(HttpResponse *response, int rc) {
+  switch (rc) {
+    case VSAM_OPEN_NOT_CATALOGED:
+      respondWithError(response, HTTP_STATUS_BAD_REQUEST, "Not Found in Catalog");
+      break;
+    case VSAM_OPEN_NO_DD:
+      respondWithError(response, HTTP_STATUS_INTERNAL_SERVER_ERROR, "Unable to allocate a DD for ACB");
+      break;
+    case VSAM_OPEN_NOT_OPENED:
+      respondWithError(response, HTTP_STATUS_INTERNAL_SERVER_ERROR, "ACB Not Opened");
+      break;
+    case VSAM_OPEN_NOT_WRITABLE:
+      respondWithError(response, HTTP_STATUS_BAD_REQUEST, "Linear datasets cannot be written by record");
+      break;
+    default:
       respondWithError(response, HTTP_STATUS_INTERNAL_SERVER_ERROR, "Could not POINT to the designated search argument.");
+      break;
+  }
+}
+
+/*
+  VSAM writes go through an ACB of their own, opened for output for the
+  request, and records are PUT straight from the request body as it is split.
+  KSDS records given in ascending key order are inserted in one sequential
+  string, which VSAM buffers and writes out a CI at a time; the others are PUT
+  directly. With replace, a record that exists is read for update and
+  replaced, and one that does not is inserted. What VSAM has buffered is
+  written out when the ACB is closed at the end of the request. The response
+  tells the key of the last record written, so that a load that
+  failed can be resumed after it.
+ */
+
+/* RPL feedback codes of logical errors */
+#define VSAM_ERROR_DUPLICATE_KEY  0x08
+#define VSAM_ERROR_SEQUENCE       0x0C
+#define VSAM_ERROR_NOT_FOUND      0x10
+#define VSAM_ERROR_NO_SPACE       0x1C
+#define VSAM_ERROR_RECORD_LENGTH  0x6C
+
+typedef struct VSAMWriter_tag {
+  char dsn[ACB_POOL_DSN_LENGTH + 1];
+  VSAMAttributes attributes;
+  int type;
+  char ddName[9];
+  char *acb;
+  int rplOptions;                       /* as last set, -1 after an open */
+  bool replace;
+  char *updateBuffer;
+  char argument[VSAM_MAX_KEY_LENGTH];   /* the key, RBA or RRN the RPL points at */
+  char lastKey[VSAM_MAX_KEY_LENGTH];    /* of the last record written, as frames have it */
+  int lastKeyLength;
+  int recordsWritten;
+  int recordsReplaced;
+  int failedIndex;                      /* of the record that failed, -1 for none */
+  int errorStatus;                      /* 0 until a record fails */
+  char errorMessage[160];
+} VSAMWriter;
+
+static int getBigEndianFullword(const char *data) {
+  const unsigned char *bytes = (const unsigned char *)data;
+  return (int)(((unsigned int)bytes[0] << 24) | (bytes[1] << 16) | (bytes[2] << 8) | bytes[3]);
+}
+
+static void setBigEndianFullword(char *data, unsigned int value) {
+  data[0] = (value >> 24) & 0xFF;
+  data[1] = (value >> 16) & 0xFF;
+  data[2] = (value >> 8) & 0xFF;
+  data[3] = value & 0xFF;
+}
+
+static int openVSAMWriterACB(VSAMWriter *writer) {
+  int macrfParms = ACB_MACRF_SEQ | ACB_MACRF_DIR | ACB_MACRF_OUT;
+  macrfParms |= (writer->type == VSAM_TYPE_ESDS) ? ACB_MACRF_ADR : ACB_MACRF_KEY;
+  unsigned int maxlrecl = writer->attributes.maxlrecl;
+  writer->acb = openACB(writer->ddName, ACB_MODE_OUTPUT, macrfParms, 0,
+                        getVSAMRPLOptions(writer->type), maxlrecl, maxlrecl);
+  writer->rplOptions = -1;
+  if (!writer->acb) {
+    return VSAM_OPEN_NOT_OPENED;
+  }
+  zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "ACB for %s opened for output at %08x\n", writer->ddName, writer->acb);
+  return 0;
+}
+
+/* Returns 0 or a VSAM_OPEN_* code */
+static int beginVSAMWrite(VSAMWriter *writer, const char *dsn, bool replace) {
+  memset(writer, 0, sizeof(VSAMWriter));
+  memcpy(writer->dsn, dsn, ACB_POOL_DSN_LENGTH);
+  writer->replace = replace;
+  writer->failedIndex = -1;
+  int rc = lookupVSAMAttributes(NULL, dsn, &writer->attributes);
+  if (rc) {
+    return rc;
+  }
+  writer->type = getVSAMType(writer->attributes.vsamType);
+  if (writer->type == VSAM_TYPE_LDS) {
+    return VSAM_OPEN_NOT_WRITABLE;
+  }
+  rc = allocateVSAMDD(writer->dsn, writer->ddName);
+  if (rc) {
+    return rc;
+  }
+  rc = openVSAMWriterACB(writer);
+  if (rc) {
+    unallocateVSAMDD(writer->ddName);
+    return rc;
+  }
+  if (replace) {
+    writer->updateBuffer = safeMalloc(writer->attributes.maxlrecl, "VSAM update buffer");
+  }
+  return 0;
+}
+
+static void endVSAMWrite(VSAMWriter *writer) {
+  if (writer->acb) {
+    closeACB(writer->acb, ACB_MODE_OUTPUT);
+    writer->acb = NULL;
+  }
+  unallocateVSAMDD(writer->ddName);
+  if (writer->updateBuffer) {
+    safeFree(writer->updateBuffer, writer->attributes.maxlrecl);
+    writer->updateBuffer = NULL;
+  }
+}
+
+static int failVSAMWrite(VSAMWriter *writer, int index, int status, const char *formatString, ...) {
+  writer->failedIndex = index;
+  writer->errorStatus = status;
+  va_list argPointer;
+  va_start(argPointer, formatString);
+  vsnprintf(writer->errorMessage, sizeof(writer->errorMessage), formatString, argPointer);
+  va_end(argPointer);
+  return 1;
+}
+
+static int failVSAMRequest(VSAMWriter *writer, int index, RPLCommon *rpl) {
+  int code = rpl->feedback & 0xFF;
+  zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "Error writing to dataset, rc=%02x%06x\n", rpl->status, rpl->feedback);
+  switch (code) {
+    case VSAM_ERROR_DUPLICATE_KEY:
+      return failVSAMWrite(writer, index, 409, "Record #%d has the key of a record that exists", index + 1);
+    case VSAM_ERROR_NOT_FOUND:
+      return failVSAMWrite(writer, index, HTTP_STATUS_NOT_FOUND, "Record #%d replaces a record that does not exist", index + 1);
+    case VSAM_ERROR_RECORD_LENGTH:
+      return failVSAMWrite(writer, index, HTTP_STATUS_BAD_REQUEST, "Record #%d does not have a length the dataset takes", index + 1);
+    case VSAM_ERROR_NO_SPACE:
+      return failVSAMWrite(writer, index, HTTP_STATUS_INTERNAL_SERVER_ERROR, "No space left in the dataset for record #%d", index + 1);
+    default:
+      return failVSAMWrite(writer, index, HTTP_STATUS_INTERNAL_SERVER_ERROR,
+                           "Error writing record #%d to dataset, rc=%02x%06x", index + 1, rpl->status, rpl->feedback);
+  }
+}
+
+/* The RPL keeps pointing at writer->argument, so it is only changed along
+   with the options */
+static void setVSAMWriteOptions(VSAMWriter *writer, int options) {
+  if (options == writer->rplOptions) {
+    return;
+  }
+  RPLCommon *rpl = (RPLCommon *)(writer->acb+RPL_COMMON_OFFSET+8);
+  int argumentLength = (writer->type == VSAM_TYPE_KSDS) ? writer->attributes.keyLen : 4;
+  modRPL(writer->acb, rpl->rplType, argumentLength, rpl->workArea, writer->argument,
+         options, rpl->optcd2, rpl->nextRPL, rpl->recLen, rpl->bufLen);
+  writer->rplOptions = options;
+}
+
+/* A VSAMFrameHandler. Returns 1 after failing the write. */
+static int writeVSAMFrame(void *userData, const VSAMFrame *frame, int index) {
+  VSAMWriter *writer = (VSAMWriter *)userData;
+  const VSAMAttributes *attributes = &writer->attributes;
+  RPLCommon *rpl = (RPLCommon *)(writer->acb+RPL_COMMON_OFFSET+8);
+  char *record = (char *)frame->record;
+  int recordLength = frame->recordLength;
+  if (recordLength < 1 || recordLength > attributes->maxlrecl) {
+    return failVSAMWrite(writer, index, HTTP_STATUS_BAD_REQUEST,
+                         "Record #%d is %d bytes, but must be 1 to %d", index + 1, recordLength, attributes->maxlrecl);
+  }
+
+  /* the key as frames have it, and the argument VSAM takes */
+  char key[VSAM_MAX_KEY_LENGTH];
+  int keyLength = 4;
+  int addressing = RPL_OPTCD_KEY;
+  switch (writer->type) {
+    case VSAM_TYPE_KSDS:
+      keyLength = attributes->keyLen;
+      if (recordLength < attributes->keyLoc + keyLength) {
+        return failVSAMWrite(writer, index, HTTP_STATUS_BAD_REQUEST, "Record #%d ends before its key", index + 1);
+      }
+      if (frame->keyLength > 0 &&
+          (frame->keyLength != keyLength || memcmp(frame->key, record + attributes->keyLoc, keyLength))) {
+        return failVSAMWrite(writer, index, HTTP_STATUS_BAD_REQUEST, "Record #%d does not have the key given for it", index + 1);
+      }
+      memcpy(key, record + attributes->keyLoc, keyLength);
+      memcpy(writer->argument, key, keyLength);
+      break;
+    case VSAM_TYPE_RRDS: {
+      if (frame->keyLength != 4 || getBigEndianFullword(frame->key) < 1) {
+        return failVSAMWrite(writer, index, HTTP_STATUS_BAD_REQUEST,
+                             "Record #%d needs its relative record number as a 4 byte key", index + 1);
+      }
+      memcpy(key, frame->key, 4);
+      int recordNumber = getBigEndianFullword(key);
+      memcpy(writer->argument, &recordNumber, 4);
+      break;
+    }
+    default: /* ESDS: VSAM assigns the RBA of records added */
+      addressing = RPL_OPTCD_ADR;
+      if (writer->replace) {
+        if (frame->keyLength != 4) {
+          return failVSAMWrite(writer, index, HTTP_STATUS_BAD_REQUEST,
+                               "Record #%d needs the RBA it replaces as a 4 byte key", index + 1);
+        }
+        unsigned int rba = (unsigned int)getBigEndianFullword(frame->key);
+        memcpy(writer->argument, &rba, 4);
+      }
+      break;
+  }
+
+  bool replaced = false;
+  if (writer->replace) {
+    int bytesRead = 0;
+    setVSAMWriteOptions(writer, addressing | RPL_OPTCD_DIR | RPL_OPTCD_UPD);
+    getRecord(writer->acb, writer->updateBuffer, &bytesRead);
+    if (rpl->status == 0) {
+      /* a PUT for update replaces the record just read */
+      putRecord(writer->acb, record, recordLength);
+      replaced = true;
+    } else if ((rpl->feedback & 0xFF) != VSAM_ERROR_NOT_FOUND || writer->type == VSAM_TYPE_ESDS) {
+      return failVSAMRequest(writer, index, rpl);
+    }
+  }
+  if (!replaced) {
+    switch (writer->type) {
+      case VSAM_TYPE_KSDS: {
+        bool ascending = (writer->recordsWritten > 0 &&
+                          memcmp(key, writer->lastKey, keyLength) > 0);
+        setVSAMWriteOptions(writer, RPL_OPTCD_KEY | (ascending ? RPL_OPTCD_SEQ : RPL_OPTCD_DIR));
+        putRecord(writer->acb, record, recordLength);
+        if (ascending && rpl->status && (rpl->feedback & 0xFF) == VSAM_ERROR_SEQUENCE) {
+          setVSAMWriteOptions(writer, RPL_OPTCD_KEY | RPL_OPTCD_DIR);
+          putRecord(writer->acb, record, recordLength);
+        }
+        break;
+      }
+      case VSAM_TYPE_RRDS:
+        setVSAMWriteOptions(writer, RPL_OPTCD_KEY | RPL_OPTCD_DIR);
+        putRecord(writer->acb, record, recordLength);
+        break;
+      default:
+        setVSAMWriteOptions(writer, RPL_OPTCD_ADR | RPL_OPTCD_SEQ);
+        putRecord(writer->acb, record, recordLength);
+        break;
+    }
+  }
+  if (rpl->status) {
+    return failVSAMRequest(writer, index, rpl);
+  }
+
+  if (writer->type == VSAM_TYPE_ESDS) {
+    setBigEndianFullword(key, *(unsigned int *)((rpl->rba)+4));
+  }
+  memcpy(writer->lastKey, key, keyLength);
+  writer->lastKeyLength = keyLength;
+  writer->recordsWritten++;
+  if (replaced) {
+    writer->recordsReplaced++;
+  }
+  return 0;
+}
+
+static void respondWithVSAMWriteResult(HttpResponse *response, const VSAMWriter *writer) {
+  jsonPrinter *out = respondWithJsonPrinter(response);
+  switch (writer->errorStatus) {
+    case 0:
+      setResponseStatus(response, HTTP_STATUS_OK, "OK");
+      break;
+    case HTTP_STATUS_BAD_REQUEST:
+      setResponseStatus(response, HTTP_STATUS_BAD_REQUEST, "Bad Request");
+      break;
+    case HTTP_STATUS_NOT_FOUND:
+      setResponseStatus(response, HTTP_STATUS_NOT_FOUND, "Not Found");
+      break;
+    case 409:
+      setResponseStatus(response, 409, "Conflict");
+      break;
+    default:
+      setResponseStatus(response, HTTP_STATUS_INTERNAL_SERVER_ERROR, "Internal Server Error");
+      break;
+  }
+  setDefaultJSONRESTHeaders(response);
+  writeHeader(response);
+  jsonStart(out);
+  if (writer->errorStatus) {
+    jsonAddString(out, "error", (char *)writer->errorMessage);
+    jsonAddInt(out, "failedRecord", writer->failedIndex + 1);
+  }
+  jsonAddInt(out, "recordsWritten", writer->recordsWritten);
+  jsonAddInt(out, "recordsReplaced", writer->recordsReplaced);
+  if (writer->recordsWritten > 0) {
+    /* in the form reads take it to start from */
+    if (writer->type == VSAM_TYPE_KSDS) {
+      int encodedLength = 0;
+      char *encodedKey = encodeBase64(NULL, (char *)writer->lastKey, writer->lastKeyLength, &encodedLength, 1);
+      jsonAddString(out, "lastKey", encodedKey);
+      safeFree(encodedKey, encodedLength);
+    } else if (writer->type == VSAM_TYPE_RRDS) {
+      jsonAddInt(out, "lastRecord", getBigEndianFullword(writer->lastKey));
+    } else {
+      char rba[16];
+      snprintf(rba, sizeof(rba), "%u", (unsigned int)getBigEndianFullword(writer->lastKey));
+      jsonAddString(out, "lastRBA", rba);
+    }
+  }
+  jsonEnd(out);
+  finishResponse(response);
+}
+
+/* Closes the writer and responds. Reads of the dataset through pooled ACBs
+   opened before the write would not see what was written. */
+static void finishVSAMWrite(HttpResponse *response, VSAMWriter *writer, ACBPool *acbPool) {
+  endVSAMWrite(writer);
+  if (writer->recordsWritten > 0) {
+    invalidateACBPool(acbPool, writer->dsn);
+  }
+  zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "Wrote %d records to %s, %d replaced\n",
+          writer->recordsWritten, writer->dsn, writer->recordsReplaced);
+  respondWithVSAMWriteResult(response, writer);
+}
+
+/* "key" and "record", matched against the body before it is converted */
+static const char VSAM_KEY_FIELD_UTF8[]    = {0x6B, 0x65, 0x79, 0x00};
+static const char VSAM_RECORD_FIELD_UTF8[] = {0x72, 0x65, 0x63, 0x6F, 0x72, 0x64, 0x00};
+static const char *VSAM_JSON_FIELDS[] = {VSAM_KEY_FIELD_UTF8, VSAM_RECORD_FIELD_UTF8};
+#define VSAM_JSON_FIELD_KEY    0
+#define VSAM_JSON_FIELD_RECORD 1
+
+#define BASE64_LENGTH(decodedLength) (((decodedLength) + 2) / 3 * 4)
+
+typedef struct VSAMJSONRecords_tag {
+  VSAMWriter *writer;
+  char *record;                         /* decoded */
+  int recordSize;
+} VSAMJSONRecords;
+
+static int getUTF8Base64Value(unsigned char c) {
+  if (c >= 0x41 && c <= 0x5A) {
+    return c - 0x41;
+  } else if (c >= 0x61 && c <= 0x7A) {
+    return c - 0x61 + 26;
+  } else if (c >= 0x30 && c <= 0x39) {
+    return c - 0x30 + 52;
+  } else if (c == 0x2B) {
+    return 62;
+  } else if (c == 0x2F) {
+    return 63;
+  }
+  return -1;
+}
+
+/* Decodes length bytes of UTF-8 base64, as the parser hands them over, into
+   decoded, which must hold length / 4 * 3. Returns the decoded length or -1. */
+static int decodeUTF8Base64(const char *encoded, int length, char *decoded) {
+  const unsigned char *input = (const unsigned char *)encoded;
+  if (length % 4) {
+    return -1;
+  }
+  int decodedLength = 0;
+  for (int i = 0; i < length; i += 4) {
+    int padding = 0;
+    unsigned int group = 0;
+    for (int j = 0; j < 4; j++) {
+      int value = getUTF8Base64Value(input[i + j]);
+      if (input[i + j] == 0x3D && i + 4 == length && j >= 2 && (j == 3 || input[i + 3] == 0x3D)) {
+        value = 0;
+        padding++;
+      } else if (value < 0 || padding) {
+        return -1;
+      }
+      group = (group << 6) | value;
+    }
+    decoded[decodedLength++] = (group >> 16) & 0xFF;
+    if (padding < 2) {
+      decoded[decodedLength++] = (group >> 8) & 0xFF;
+    }
+    if (padding < 1) {
+      decoded[decodedLength++] = group & 0xFF;
+    }
+  }
+  return decodedLength;
+}
+
+/* A JsonRecordFieldsHandler. Returns 1 after failing the write. */
+static int writeVSAMJSONRecord(void *userData, const char **values, const int *lengths, int index) {
+  VSAMJSONRecords *records = (VSAMJSONRecords *)userData;
+  const char *encodedRecord = values[VSAM_JSON_FIELD_RECORD];
+  const char *encodedKey = values[VSAM_JSON_FIELD_KEY];
+  char key[VSAM_MAX_KEY_LENGTH + 3];
+  VSAMFrame frame = {0};
+  if (encodedRecord != NULL) {
+    frame.recordLength = decodeUTF8Base64(encodedRecord, lengths[VSAM_JSON_FIELD_RECORD], records->record);
+  }
+  if (encodedKey != NULL) {
+    frame.keyLength = (lengths[VSAM_JSON_FIELD_KEY] <= BASE64_LENGTH(VSAM_MAX_KEY_LENGTH)) ?
+        decodeUTF8Base64(encodedKey, lengths[VSAM_JSON_FIELD_KEY], key) : -1;
+  }
+  if (encodedRecord == NULL || frame.recordLength < 0 ||
+      frame.keyLength < 0 || frame.keyLength > VSAM_MAX_KEY_LENGTH) {
+    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "Incorrectly formatted array!\n");
+    return failVSAMWrite(records->writer, index, HTTP_STATUS_BAD_REQUEST,
+                         "Record #%d must be an object with a base64 record and optionally a base64 key", index + 1);
+  }
+  frame.record = records->record;
+  frame.key = key;
+  return writeVSAMFrame(records->writer, &frame, index);
+}
+
+/* {"records":[{"key":<base64>,"record":<base64>},...]}, as reads return them.
+   The key can be left out where VSAM assigns it, or takes it from the record.
+   Records are written as the body is parsed, as with frames. */
+static void updateVSAMDatasetWithJSON(HttpResponse *response, VSAMWriter *writer) {
+  HttpRequest *request = response->request;
+  int maxRecordLength = writer->attributes.maxlrecl;
+  VSAMJSONRecords records = {0};
+  records.writer = writer;
+  records.recordSize = BASE64_LENGTH(maxRecordLength) / 4 * 3;
+  records.record = safeMalloc(records.recordSize, "VSAM JSON record");
+
+  JsonRecordParser parser;
+  initJsonRecordParser(&parser, BASE64_LENGTH(maxRecordLength), NULL, NULL, &records);
+  setJsonRecordParserFields(&parser, VSAM_JSON_FIELDS, 2, writeVSAMJSONRecord);
+  zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "UPDATE DATASET: parsing VSAM records dataLength=0x%x\n",
+          request->contentLength);
+  int rc = jsonRecordParserFeed(&parser, request->contentBody, request->contentLength);
+  if (!rc) {
+    rc = jsonRecordParserFinish(&parser);
+  }
+  switch (rc) {
+    case RECORD_PARSER_RC_OK:
+      if (!parser.hasRecords) {
+        failVSAMWrite(writer, -1, HTTP_STATUS_BAD_REQUEST, "No records array given");
+      }
+      break;
+    case RECORD_PARSER_RC_HANDLER:
+      /* the record failed the write */
+      break;
+    case RECORD_PARSER_RC_NOT_A_STRING:
+      failVSAMWrite(writer, parser.errorIndex, HTTP_STATUS_BAD_REQUEST,
+                    "Record #%d must be an object with a base64 record and optionally a base64 key",
+                    parser.errorIndex + 1);
+      break;
+    case RECORD_PARSER_RC_TOO_LONG:
+      if (parser.inRecords) {
+        failVSAMWrite(writer, parser.recordIndex, HTTP_STATUS_BAD_REQUEST,
+                      "Record #%d is longer than the max record length of %d", parser.recordIndex + 1, maxRecordLength);
+        break;
+      }
+      failVSAMWrite(writer, -1, HTTP_STATUS_BAD_REQUEST, "POST body could not be parsed as JSON format");
+      break;
+    case RECORD_PARSER_RC_DUPLICATE_KEY:
+      if (parser.errorIndex >= 0) {
+        failVSAMWrite(writer, parser.errorIndex, HTTP_STATUS_BAD_REQUEST,
+                      "Record #%d has a field more than once", parser.errorIndex + 1);
+      } else {
+        failVSAMWrite(writer, -1, HTTP_STATUS_BAD_REQUEST, "POST body has a member more than once");
+      }
+      break;
+    case RECORD_PARSER_RC_NOT_AN_OBJECT:
+      failVSAMWrite(writer, -1, HTTP_STATUS_BAD_REQUEST, "POST body must be a JSON object");
+      break;
+    default:
+      zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "UPDATE DATASET: body was not JSON! rc=%d, offset=%lld\n",
+              rc, parser.errorOffset);
+      failVSAMWrite(writer, -1, HTTP_STATUS_BAD_REQUEST, "POST body could not be parsed as JSON format");
+      break;
+  }
+  termJsonRecordParser(&parser);
+  safeFree(records.record, records.recordSize);
+}
+
+/* application/octet-stream: the frames reads send, written from the body
+   where they are as it is split */
+static void updateVSAMDatasetWithFrames(HttpResponse *response, VSAMWriter *writer) {
+  HttpRequest *request = response->request;
+  int badIndex = 0;
+  int rc = splitVSAMFrames(request->contentBody, request->contentLength, writeVSAMFrame, writer, &badIndex);
+  if (rc < 0) {
+    failVSAMWrite(writer, badIndex, HTTP_STATUS_BAD_REQUEST, "Record #%d is not a valid frame", badIndex + 1);
+  }
+}
+
+#endif /* __ZOWE_OS_ZOS */
+
+void respondWithVSAMDataset(HttpResponse* response, char* absolutePath, ACBPool *acbPool, int jsonMode) {
+#ifdef __ZOWE_OS_ZOS
+  zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "begin %s\n", __FUNCTION__);
+  HttpRequest *request = response->request;
+
+  HttpRequestParam *closeParam = getCheckedParam(request,"closeAfter");
+  char *closeArg = (closeParam ? closeParam->stringValue : NULL);
+  int closeAfter = (closeArg != NULL && !strcmp(closeArg,"true"));
+
+  /* pages: where to start, when to stop and how much to return */
+  HttpRequestParam *maxRecordsParam = getCheckedParam(request,"maxRecords");
+  HttpRequestParam *maxBytesParam = getCheckedParam(request,"maxBytes");
+  HttpRequestParam *startKeyParam = getCheckedParam(request,"startKey");
+  HttpRequestParam *startRBAParam = getCheckedParam(request,"startRBA");
+  HttpRequestParam *startRecordParam = getCheckedParam(request,"startRecord");
+  HttpRequestParam *stopKeyParam = getCheckedParam(request,"stopKey");
+  int maxRecords = (maxRecordsParam ? maxRecordsParam->intValue : 0);
+  int maxBytes = (maxBytesParam ? maxBytesParam->intValue : 0);
+  if (maxRecords < 0 || maxBytes < 0) {
+    respondWithError(response, HTTP_STATUS_BAD_REQUEST, "maxRecords and maxBytes cannot be negative");
+    return;
+  }
+  if ((startKeyParam != NULL) + (startRBAParam != NULL) + (startRecordParam != NULL) > 1) {
+    respondWithError(response, HTTP_STATUS_BAD_REQUEST,
+                     "Only one of startKey, startRBA and startRecord can be given");
+    return;
+  }
+
+  int returnCode;
+  char dsn[45] = "";
+  int rplParms = 0;
+  memcpy(dsn, absolutePath, 44);
+  if (strlen(absolutePath) <= 44) {
+    memset(dsn + strlen(absolutePath), ' ', 44 - strlen(absolutePath));
+    dsn[44] = 0;
+  } else {
+    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "DSN of size %d is too large.\n", strlen(absolutePath));
+    respondWithError(response, HTTP_STATUS_BAD_REQUEST, "Dataset Name must be 44 bytes of less");
+    return;
+  }
+  char *username = response->request->username;
+
+  /* the catalog is only searched when the dataset is not open for the user yet */
+  PooledACB *pooled = acquirePooledACB(acbPool, username, dsn, &returnCode);
+  if (pooled == NULL) {
+    respondWithVSAMOpenError(response, returnCode);
+    return;
+  }
+  StatefulACB *state = &pooled->state;
+  char *inACB = state->acb;
+  unsigned int keyLoc = pooled->attributes.keyLoc;
+  unsigned int keyLen = pooled->attributes.keyLen;
+  int type = state->type;
+  zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "ACB for %s at 0x%0x\n", dsn, inACB);
+
+  VSAMReadRange range = {0};
+  range.type = type;
+  range.maxRecords = maxRecords;
+  range.maxBytes = maxBytes;
+  char stopKey[VSAM_MAX_KEY_LENGTH];
+  VSAMReadPosition start = {0};
+  const char *rangeError = NULL;
+  if ((startKeyParam != NULL || stopKeyParam != NULL) && type != VSAM_TYPE_KSDS) {
+    rangeError = "startKey and stopKey apply to a KSDS only";
+  } else if (startRBAParam != NULL && type != VSAM_TYPE_ESDS && type != VSAM_TYPE_LDS) {
+    rangeError = "startRBA applies to an ESDS or LDS only";
+  } else if (startRecordParam != NULL && type != VSAM_TYPE_RRDS) {
+    rangeError = "startRecord applies to an RRDS only";
+  } else if (startKeyParam != NULL) {
+    if (decodeVSAMKey(startKeyParam->stringValue, start.key, &start.keyLength, keyLen)) {
+      start.found = true;
+    } else {
+      rangeError = "Invalid start key";
+    }
+  } else if (startRBAParam != NULL) {
+    char *end = NULL;
+    unsigned long rba = startRBAParam->stringValue ? strtoul(startRBAParam->stringValue, &end, 10) : 0;
+    if (end == NULL || end == startRBAParam->stringValue || *end != '\0' || rba > 0xFFFFFFFFul) {
+      rangeError = "Invalid start RBA";
+    } else {
+      start.rba = (unsigned int)rba;
+      start.found = true;
+    }
+  } else if (startRecordParam != NULL) {
+    if (startRecordParam->intValue < 1) {
+      rangeError = "Invalid start record";
+    } else {
+      start.record = startRecordParam->intValue;
+      start.found = true;
+    }
+  }
+  if (rangeError == NULL && stopKeyParam != NULL) {
+    if (decodeVSAMKey(stopKeyParam->stringValue, stopKey, &range.stopKeyLength, keyLen)) {
+      range.stopKey = stopKey;
+    } else {
+      rangeError = "Invalid stop key";
+    }
+  }
+  if (rangeError) {
+    releasePooledACB(acbPool, pooled, false);
+    respondWithError(response, HTTP_STATUS_BAD_REQUEST, (char *)rangeError);
+    return;
+  }
+  rplParms = getVSAMRPLOptions(type);
+
+  if (start.found) {
+    returnCode = pointToVSAMPosition(state, &start);
+    if (returnCode) {
+      zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "point to start failed with RC = %08x\n", returnCode);
+      releasePooledACB(acbPool, pooled, false);
+      respondWithError(response, HTTP_STATUS_BAD_REQUEST, "Could not POINT to the start position.");
       return;
     }
-    htPut(acbTable, dsnUidPair, state);
-  } /* end Open */
+  }
 
   RPLCommon *inRPL = (RPLCommon *) (inACB+RPL_COMMON_OFFSET+8);
   /* TODO: if the user submits a backwards parm, this is where it should be added to rplParms RPL_OPTCD_BWD here */
   modRPL(inACB, inRPL->rplType, inRPL->keyLen, inRPL->workArea, inRPL->arg,
          rplParms, inRPL->optcd2, inRPL->nextRPL, inRPL->recLen, inRPL->bufLen);
 
-  jsonPrinter *jPrinter = respondWithJsonPrinter(response);
-  setResponseStatus(response, 200, "OK");
-  setDefaultJSONRESTHeaders(response); 
+  VSAMReadPosition next;
+  if (jsonMode == DATASET_CONTENT_MODE_BINARY) {
+    setResponseStatus(response, 200, "OK");
+    setContentType(response, "application/octet-stream");
+    addStringHeader(response, "Server", "jdmfws");
+    addStringHeader(response, "Transfer-Encoding", "chunked");
+    addStringHeader(response, "Cache-control", "no-store");
+    addStringHeader(response, "Pragma", "no-cache");
+    writeHeader(response);
 
-  writeHeader(response);
+    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "Streaming frames for %s\n", absolutePath);
+    VSAMFrameStream stream = {0};
+    stream.out = makeChunkedOutputStreamInternal(response);
+    stream.bufferSize = VSAM_FRAME_BUFFER_SIZE;
+    stream.buffer = safeMalloc(stream.bufferSize, "VSAM frame stream");
+    returnCode = streamVSAMRecords(inACB, &range, keyLoc, keyLen, &next,
+                                   addVSAMRecordToFrameStream, &stream);
+    char resumeKey[VSAM_MAX_KEY_LENGTH];
+    int resumeKeyLength = (next.found && !next.endOfRange) ?
+        getVSAMResumeKey(type, &next, resumeKey) : 0;
+    addVSAMFrame(&stream, VSAM_FRAME_END, NULL, resumeKey, resumeKeyLength);
+    flushVSAMFrameStream(&stream);
+    finishChunkedOutput(stream.out, NO_TRANSLATE);
+    safeFree(stream.buffer, stream.bufferSize);
+  } else {
+    jsonPrinter *jPrinter = respondWithJsonPrinter(response);
+    setResponseStatus(response, 200, "OK");
+    setDefaultJSONRESTHeaders(response);
 
-  zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "Streaming data for %s\n", absolutePath);
-  jsonStart(jPrinter);
-  /* TODO: if the user submits parms that limit the length of the returned data, modifying the below maxRecords or maxBytes will be needed */
-  returnCode = streamVSAMDataset(response, inACB, maxlrecl, maxRecords, maxBytes, keyLoc, keyLen, jPrinter);
+    writeHeader(response);
+
+    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "Streaming data for %s\n", absolutePath);
+    jsonStart(jPrinter);
+    returnCode = streamVSAMRecordsAsJSON(inACB, &range, keyLoc, keyLen, &next, jPrinter);
+    bool hasMore = next.found && !next.endOfRange;
+    jsonAddBoolean(jPrinter, "hasMore", hasMore);
+    if (hasMore) {
+      addVSAMResumePosition(jPrinter, type, &next);
+    }
+    jsonEnd(jPrinter);
+  }
   zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "Dataset bytesRead = %d\n", returnCode);
-  jsonEnd(jPrinter);
-  dumpbuffer((char *)state, sizeof(StatefulACB));
 
   finishResponse(response);
-  if (closeAfter == TRUE){
-    closeACB(inACB,ACB_MODE_INPUT);
-    htRemove(acbTable,dsnUidPair);
-    safeFree(dsnUidPair, 44+8+1);
-    safeFree((char*)state,sizeof(StatefulACB));
-  } 
+  if (closeAfter != TRUE && next.found) {
+    /* the record the page stopped in front of was read, so a request without
+       a start position carries on from it */
+    returnCode = pointToVSAMPosition(state, &next);
+    if (returnCode) {
+      zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "point to next record failed with RC = %08x\n", returnCode);
+    }
+  }
+  releasePooledACB(acbPool, pooled, closeAfter == TRUE);
+
+#endif /* __ZOWE_OS_ZOS */
+}
+
+void updateVSAMDataset(HttpResponse* response, char* absolutePath, ACBPool *acbPool, int jsonMode) {
+#ifdef __ZOWE_OS_ZOS
+  if (jsonMode != DATASET_CONTENT_MODE_JSON && jsonMode != DATASET_CONTENT_MODE_BINARY) {
+    respondWithError(response, HTTP_STATUS_BAD_REQUEST,"Cannot update file without JSON or application/octet-stream formatted record request");
+    return;
+  }
+  if (strlen(absolutePath) > 44) {
+    respondWithError(response, HTTP_STATUS_BAD_REQUEST, "Dataset Name must be 44 bytes of less");
+    return;
+  }
+  char dsn[45];
+  snprintf(dsn, sizeof(dsn), "%-44.44s", absolutePath);
+  HttpRequestParam *replaceParam = getCheckedParam(response->request, "replace");
+  bool replace = (replaceParam != NULL && replaceParam->stringValue != NULL &&
+                  !strcmp(replaceParam->stringValue, "true"));
 
+  VSAMWriter writer;
+  int openRC = beginVSAMWrite(&writer, dsn, replace);
+  if (openRC) {
+    respondWithVSAMOpenError(response, openRC);
+    return;
+  }
+  if (jsonMode == DATASET_CONTENT_MODE_BINARY) {
+    updateVSAMDatasetWithFrames(response, &writer);
+  } else {
+    updateVSAMDatasetWithJSON(response, &writer);
+  }
+  finishVSAMWrite(response, &writer, acbPool);
 #endif /* __ZOWE_OS_ZOS */
 }
 
@@ -2484,7 +4589,7 @@ int setAttrForDSCopyAndRespondIfError(HttpResponse *response, JsonBuffer *buffer
   return isPDS;
 }
 
-void getTargetDsnRecordInfo(char* targetDataset, char** recordFormat, int* recordLength) {
+void getTargetDsnRecordInfo(char* targetDataset, char* recordFormat, int* recordLength) {
 
   DatasetName targetDsnName;
   DatasetMemberName targetMemName;
@@ -2496,12 +4601,9 @@ void getTargetDsnRecordInfo(char* targetDataset, char** recordFormat, int* recor
   jsonStart(jPrinter);
 
   // To get the attributes for target dataset
-  getDatasetMetadata(&targetDsnName, &targetMemName, targetDataset, "true", "true", defaultDatasetTypesAllowed, "true", 0, NULL, NULL, "", NULL, jPrinter);
+  getDatasetMetadata(&targetDsnName, &targetMemName, targetDataset, "true", "true", defaultDatasetTypesAllowed, "true", 0, NULL, NULL, "", NULL, jPrinter, CSI_CACHE_MODE_OFF, NULL);
   jsonEnd(jPrinter);
 
-  int targetRecLen = 0;
-  char* recFormat = NULL;
-
   ShortLivedHeap *slh = makeShortLivedHeap(0x10000,0x10);
   char errorBuffer[2048];
   Json *json = jsonParseUnterminatedString(slh,
@@ -2520,9 +4622,12 @@ void getTargetDsnRecordInfo(char* targetDataset, char** recordFormat, int* recor
         // Get dsorg object
         JsonObject *dsOrg = jsonObjectGetObject(jsonDatasetObject,"dsorg");
         *recordLength = jsonObjectGetNumber(dsOrg,"maxRecordLen");
-        // Get recfm object
+        // Get recfm object, the string lives in the slh freed below
         JsonObject *recfm = jsonObjectGetObject(jsonDatasetObject,"recfm");
-        *recordFormat = jsonObjectGetString(recfm,"recordLength");
+        char *recordLengthType = jsonObjectGetString(recfm,"recordLength");
+        if (recordLengthType) {
+          *recordFormat = recordLengthType[0];
+        }
       }
     }
   }
@@ -2530,112 +4635,302 @@ void getTargetDsnRecordInfo(char* targetDataset, char** recordFormat, int* recor
   SLHFree(slh);
 }
 
-int streamDatasetForCopyAndRespond(HttpResponse *response, char *sourceDataset, int sourceRecordLen, char *targetDataset, bool isTargetMember, char* msgBuffer, char* eTag) {
+/* From the DSCB when it can be had, otherwise from the dataset metadata, which
+   gives no BLKSIZE and so rules out block reads and writes */
+static void getTargetBlockFormat(char *targetDataset, DatasetBlockFormat *format) {
+  memset(format, 0, sizeof(DatasetBlockFormat));
+  DatasetName dsn;
+  DatasetMemberName memberName;
+  extractDatasetAndMemberName(targetDataset, &dsn, &memberName);
 
-  FILE *inDataset = fopen(sourceDataset,"rb, type=record");
+  Volser volser;
+  memset(&volser.value, ' ', sizeof(volser.value));
+  if (!getVolserForDataset(&dsn, &volser)) {
+    char dscb[INDEXED_DSCB] = {0};
+    if (obtainDSCB1(dsn.value, sizeof(dsn.value), volser.value, sizeof(volser.value), dscb) == 0) {
+      getBlockFormatFromDSCB(dscb, format);
+      return;
+    }
+  }
+  format->recfm = 'V';
+  getTargetDsnRecordInfo(targetDataset, &format->recfm, &format->lrecl);
+}
 
-  char responseMessage[100];
-  int responseCode = 0;
-  int rc = 0;
+#define COPY_PROGRESS_RECORD_INTERVAL 1000
 
-  if (inDataset == NULL) {
-    rc = deleteDatasetOrMember(response, targetDataset, responseMessage, &responseCode);
-    respondWithError(response,HTTP_STATUS_NOT_FOUND,"Source dataset could not be opened or does not exist");
-    return ERROR_OPENING_DATASET;
-  }
+/*
+  For when either side cannot be handled a block at a time: one fread and one
+  fwrite per record, through a buffer big enough for both LRECLs.
+ */
+static int copyDatasetRecordByRecord(FILE *inDataset, FILE *outDataset, int sourceRecordLen,
+                                     const DatasetBlockFormat *targetFormat,
+                                     DatasetDigest *digest, int *rcEtag,
+                                     DatasetCopyProgressHandler *progress, void *progressData,
+                                     DatasetCopyResult *result) {
+  bool fixed = (targetFormat->recfm == 'F');
+  int targetRecordLen = targetFormat->lrecl;
+  int bufferSize = (sourceRecordLen > targetRecordLen ? sourceRecordLen : targetRecordLen) + 1;
+  char *buffer = safeMalloc(bufferSize, "copy record");
+  int rc = BLOCK_COPY_RC_OK;
 
-  FILE *outDataset = fopen(targetDataset, "wb, recfm=*, type=record");
+  while (!feof(inDataset)){
+    int bytesRead = fread(buffer,1,sourceRecordLen,inDataset);
 
-  if (outDataset == NULL) {
-    rc = deleteDatasetOrMember(response, targetDataset, responseMessage, &responseCode);
-    respondWithError(response,HTTP_STATUS_NOT_FOUND,"Target dataset could not be opened or does not exist");
-    fclose(inDataset);
-    return ERROR_OPENING_DATASET;
-  }
+    if (bytesRead > 0 && !ferror(inDataset)) {
+      if (bytesRead > targetRecordLen) {
+        rc = BLOCK_COPY_RC_TOO_LONG;
+        break;
+      }
+      // Right-pad the record with spaces if necessary
+      int length = bytesRead;
+      if (fixed && length < targetRecordLen) {
+        memset(buffer + length, 0x40, targetRecordLen - length);
+        length = targetRecordLen;
+      }
+      int bytesWritten = fwrite(buffer,1,length,outDataset);
 
-  ICSFDigest digest;
-  char hash[32];
+      if ((bytesWritten < 0 && ferror(outDataset)) || ((bytesWritten != length) && targetFormat->recfm != 'V')){
+        zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "Copy Failed. Error writing to the dataset, rc=%d\n", bytesWritten);
+        rc = BLOCK_COPY_RC_WRITE_ERROR;
+        break;
+      } else if (!*rcEtag) {
+        *rcEtag = datasetDigestUpdate(digest, buffer, bytesWritten);
+      }
+      result->records++;
+      result->bytes += bytesWritten;
+      if (progress && (result->records % COPY_PROGRESS_RECORD_INTERVAL) == 0) {
+        progress(progressData, result);
+      }
+    } else if (ferror(inDataset)) {
+      zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG,  "Error reading record, rc=%d\n", bytesRead);
+      rc = BLOCK_COPY_RC_READ_ERROR;
+      break;
+    }
+  }
+  safeFree(buffer, bufferSize);
+  return rc;
+}
 
-  int rcEtag = icsfDigestInit(&digest, ICSF_DIGEST_SHA1);
-  if (rcEtag) { //if etag generation has an error, just don't send it.
-    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_WARNING,  "ICSF error for SHA etag init for write, %d\n",rcEtag);
+/*
+  Copies fixed-length sources through a BlockSource and a BlockSink when both
+  datasets can be opened that way, which moves whole blocks when their RECFM
+  and LRECL match, and record by record otherwise. Variable-length sources are
+  always copied with the record loop, as tests/datasetBlockCopyBench.c finds
+  the block path no faster for them. Nothing is sent here, so that the copy can run
+  for a request or for a copy job: on failure *errorStatus and *errorMessage
+  say what to tell the caller, and the target is left for the caller to
+  delete. progress, which may be NULL, is also called once with the totals.
+ */
+static int copyDatasetContents(char *sourceDataset, const DatasetBlockFormat *sourceFormat,
+                               char *targetDataset, bool isTargetMember,
+                               DatasetCopyProgressHandler *progress, void *progressData,
+                               DatasetCopyResult *result, char *eTag,
+                               int *errorStatus, const char **errorMessage) {
+  int sourceRecordLen = sourceFormat->lrecl;
+  memset(result, 0, sizeof(DatasetCopyResult));
+
+  DatasetBlockFormat targetFormat;
+  getTargetBlockFormat(targetDataset, &targetFormat);
+
+  if (isTargetMember) {
+    if (targetFormat.lrecl < sourceRecordLen) {
+      *errorStatus = HTTP_STATUS_INTERNAL_SERVER_ERROR;
+      *errorMessage = "Cannot copy dataset. Record length for target dataset is shorter than the source";
+      return ERROR_COPYING_DATASET;
+    }
   }
 
-  int targetRecordLen = 0;
-  char* recFormat = NULL;
+  DatasetName targetName;
+  DatasetMemberName targetMemberName;
+  extractDatasetAndMemberName(targetDataset, &targetName, &targetMemberName);
+  invalidateCachedAllocations(&targetName);
+  invalidateCachedDirectory(&targetName);
 
-  getTargetDsnRecordInfo(targetDataset, &recFormat, &targetRecordLen);
+  BlockSource *blockSource = NULL;
+  BlockSink *blockSink = NULL;
+#ifdef __ZOWE_OS_ZOS
+  if (sourceFormat->recfm == 'F' &&
+      isBlockReadableFormat(sourceFormat) && isBlockReadableFormat(&targetFormat)) {
+    blockSource = openDatasetBlockSource(sourceDataset, sourceFormat);
+    blockSink = blockSource ? openDatasetBlockSink(targetDataset, &targetFormat) : NULL;
+    if (blockSink == NULL) {
+      closeBlockSource(blockSource);
+      blockSource = NULL;
+    }
+  }
+#endif
 
-  if(isTargetMember) {
-    if(targetRecordLen < sourceRecordLen) {
+  FILE *inDataset = NULL;
+  FILE *outDataset = NULL;
+  if (blockSink == NULL) {
+    inDataset = fopen(sourceDataset,"rb, type=record");
+    if (inDataset == NULL) {
+      *errorStatus = HTTP_STATUS_NOT_FOUND;
+      *errorMessage = "Source dataset could not be opened or does not exist";
+      return ERROR_OPENING_DATASET;
+    }
+    outDataset = fopen(targetDataset, "wb, recfm=*, type=record");
+    if (outDataset == NULL) {
       fclose(inDataset);
-      fclose(outDataset);
-      respondWithError(response, HTTP_STATUS_INTERNAL_SERVER_ERROR, "Cannot copy dataset. Record length for target dataset is shorter than the source");
-      rc = deleteDatasetOrMember(response, targetDataset, responseMessage, &responseCode);
-      return ERROR_COPYING_DATASET;
+      *errorStatus = HTTP_STATUS_NOT_FOUND;
+      *errorMessage = "Target dataset could not be opened or does not exist";
+      return ERROR_OPENING_DATASET;
     }
   }
 
-  // int bufferSize = sourceRecordLen+1;
-  int bufferSize = targetRecordLen+1;
-  char buffer[bufferSize];
-  int bytesRead = 0;
-  int bytesWritten = 0;
-  int recordsWritten = 0;
+  DatasetDigest digest;
+  char *digestBatch = allocDigestBatch();
 
-  while (!feof(inDataset)){
-    bytesRead = fread(buffer,1,sourceRecordLen,inDataset);
+  int rcEtag = datasetDigestInit(&digest, 0, digestBatch, DATASET_DIGEST_BATCH_SIZE);
+  if (rcEtag) { //if etag generation has an error, just don't send it.
+    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_WARNING,  "Error for %s etag init for write, %d\n",
+            getDatasetDigestName(digest.type), rcEtag);
+  }
 
-    if (bytesRead > 0 && !ferror(inDataset)) {
-      // Right-pad the record with spaces if necessary
-      if ((bytesRead < targetRecordLen) && !strcmp(recFormat, "F")) {
-        memset(buffer + bytesRead, 0x40, targetRecordLen - bytesRead);
-        bytesRead = targetRecordLen; // Update the number of bytes read
-      }
-      bytesWritten = fwrite(buffer,1,bytesRead,outDataset);
+  int copyRC = 0;
+  if (blockSink) {
+    DatasetBlockReader *reader = makeDatasetBlockReader(blockSource, NULL, 0);
+    copyRC = copyDatasetBlocks(reader, blockSink, 0, 0x40, &digest, &rcEtag,
+                               progress, progressData, result);
+    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG,
+            "Copied %d records in %d blocks, blockMode=%d, rc=%d readRC=%d\n",
+            result->records, result->blocks, result->blockMode, copyRC, result->readRC);
+    freeDatasetBlockReader(reader);
+    closeBlockSource(blockSource);
+    if (closeBlockSink(blockSink) && copyRC == BLOCK_COPY_RC_OK) {
+      copyRC = BLOCK_COPY_RC_WRITE_ERROR;
+    }
+  } else {
+    copyRC = copyDatasetRecordByRecord(inDataset, outDataset, sourceRecordLen, &targetFormat,
+                                       &digest, &rcEtag, progress, progressData, result);
+    fclose(inDataset);
+    fclose(outDataset);
+  }
+  if (progress) {
+    progress(progressData, result);
+  }
 
-      if ((bytesWritten < 0 && ferror(outDataset)) || ((bytesWritten != bytesRead) && strcmp(recFormat, "V"))){
-        zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "Copy Failed. Error writing to the dataset, rc=%d\n", bytesWritten);
-        fclose(inDataset);
-        fclose(outDataset);
-        respondWithError(response,HTTP_STATUS_INTERNAL_SERVER_ERROR,"Copy Failed. Error writing to dataset");
-        rc = deleteDatasetOrMember(response, targetDataset, responseMessage, &responseCode);
-        return ERROR_COPYING_DATASET;
-      } else if (!rcEtag) {
-        rcEtag = icsfDigestUpdate(&digest, buffer, bytesWritten);
-      }
-      recordsWritten++;
-    } else if (ferror(inDataset)) {
-      fclose(inDataset);
-      fclose(outDataset);
-      respondWithError(response,HTTP_STATUS_INTERNAL_SERVER_ERROR,"Copy Failed. Error writing to the dataset");
-      rc = deleteDatasetOrMember(response, targetDataset, responseMessage, &responseCode);
-      zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG,  "Error reading DSN=%s, rc=%d\n", sourceDataset, bytesRead);
-      return ERROR_COPYING_DATASET;
+  if (copyRC != BLOCK_COPY_RC_OK) {
+    *errorStatus = HTTP_STATUS_INTERNAL_SERVER_ERROR;
+    if (copyRC == BLOCK_COPY_RC_TOO_LONG) {
+      *errorMessage = "Cannot copy dataset. Record length for target dataset is shorter than the source";
+    } else if (copyRC == BLOCK_COPY_RC_READ_ERROR) {
+      zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG,  "Error reading DSN=%s\n", sourceDataset);
+      *errorMessage = "Copy Failed. Error reading from the source dataset";
+    } else {
+      *errorMessage = "Copy Failed. Error writing to dataset";
     }
+    freeDigestBatch(digestBatch);
+    return ERROR_COPYING_DATASET;
   }
-  if (!rcEtag) { rcEtag = icsfDigestFinish(&digest, hash); }
+
+  if (!rcEtag) { rcEtag = datasetDigestFinishHex(&digest, eTag); }
   if (rcEtag) {
-    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_WARNING,  "ICSF error for SHA etag, %d\n",rcEtag);
+    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_WARNING,  "Error for %s etag, %d\n",
+            getDatasetDigestName(digest.type), rcEtag);
+    eTag[0] = '\0';
   }
+  freeDigestBatch(digestBatch);
+  return 0;
+}
 
-  sprintf(msgBuffer, "Pasted dataset %s with %d records", targetDataset, recordsWritten);
+int streamDatasetForCopyAndRespond(HttpResponse *response, char *sourceDataset, const DatasetBlockFormat *sourceFormat,
+                                   char *targetDataset, bool isTargetMember, char* msgBuffer, char* eTag) {
+  char responseMessage[100];
+  int responseCode = 0;
+  DatasetCopyResult result;
+  int errorStatus = 0;
+  const char *errorMessage = NULL;
 
-  if (!rcEtag) {
-    // Convert hash text to hex.
-    int eTagLength = digest.hashLength*2;
-    memset(eTag, '\0', eTagLength);
-    int len = digest.hashLength;
-    simpleHexPrint(eTag, hash, digest.hashLength);
+  int rc = copyDatasetContents(sourceDataset, sourceFormat, targetDataset, isTargetMember,
+                               NULL, NULL, &result, eTag, &errorStatus, &errorMessage);
+  if (rc) {
+    respondWithError(response, errorStatus, (char *)errorMessage);
+    deleteDatasetOrMember(response, targetDataset, responseMessage, &responseCode);
+    return rc;
   }
 
-  fclose(inDataset);
-  fclose(outDataset);
+  sprintf(msgBuffer, "Pasted dataset %s with %d records", targetDataset, result.records);
+  return 0;
+}
 
+typedef struct SequentialCopyJob_tag {
+  DynallocDDName daDDname;
+  DatasetAllocation *cachedAllocation;
+  char ddPath[16];
+  DatasetBlockFormat format;
+  bool isTargetMember;
+} SequentialCopyJob;
+
+static void reportSequentialCopyProgress(void *userData, const DatasetCopyResult *result) {
+  CopyJobProgress progress = {0};
+  progress.recordsCopied = result->records;
+  progress.bytesCopied = result->bytes;
+  setCopyJobProgress((CopyJob *)userData, &progress);
+}
+
+static int runSequentialCopyJob(CopyJob *job, char *message, char *eTag) {
+  SequentialCopyJob *copy = (SequentialCopyJob *)job->userData;
+  DatasetCopyResult result;
+  int errorStatus = 0;
+  const char *errorMessage = NULL;
+
+  int rc = copyDatasetContents(copy->ddPath, &copy->format, job->status.target, copy->isTargetMember,
+                               reportSequentialCopyProgress, job, &result, eTag,
+                               &errorStatus, &errorMessage);
+  if (rc) {
+    char responseMessage[100];
+    int responseCode = 0;
+    deleteDatasetOrMember(NULL, job->status.target, responseMessage, &responseCode);
+    snprintf(message, COPY_JOB_MESSAGE_LENGTH, "%s", errorMessage);
+    return rc;
+  }
+  snprintf(message, COPY_JOB_MESSAGE_LENGTH, "Pasted dataset %s with %d records",
+           job->status.target, result.records);
+  return 0;
+}
+
+static void cleanUpSequentialCopyJob(CopyJob *job) {
+  SequentialCopyJob *copy = (SequentialCopyJob *)job->userData;
+  int daSysRC = 0, daSysRSN = 0;
+  int daRC = unallocateDatasetForRead(&copy->daDDname, copy->cachedAllocation,
+                                      &daSysRC, &daSysRSN);
+  if (daRC != RC_DYNALLOC_OK) {
+    zowelog(NULL, LOG_COMP_DATASERVICE, ZOWE_LOG_DEBUG,
+            "error: ds unalloc dd=\'%8.8s\', rc=%d sysRC=%d, sysRSN=0x%08X (copy job)\n",
+            copy->daDDname.name, daRC, daSysRC, daSysRSN);
+  }
+  safeFree((char *)copy, sizeof(SequentialCopyJob));
+}
+
+/* Answers 202 with the job id, or 429 when there is no room for the job, in
+   which case it has been cleaned up and -1 is returned */
+static int submitCopyJobAndRespond(HttpResponse *response, CopyJob *job,
+                                   char *sourceDataset, char *targetDataset) {
+  int jobId = submitCopyJob(copyJobPool, job);
+  if (jobId < 0) {
+    respondWithError(response, HTTP_STATUS_TOO_MANY_REQUESTS,
+                     "Too many copies are in progress, retry later");
+    return -1;
+  }
+  jsonPrinter *p = respondWithJsonPrinter(response);
+  setResponseStatus(response, 202, "Accepted");
+  setDefaultJSONRESTHeaders(response);
+  writeHeader(response);
+  jsonStart(p);
+  char msg[160];
+  snprintf(msg, sizeof(msg), "Copying %s to %s", sourceDataset, targetDataset);
+  jsonAddString(p, "msg", msg);
+  jsonAddInt(p, "jobId", jobId);
+  jsonEnd(p);
+  finishResponse(response);
   return 0;
 }
 
-int readWriteToDatasetAndRespond(HttpResponse *response, char* sourceDataset, char* targetDataset, bool isTargetMember, char* msgBuffer, char* etag) {
+/* With async the copy is left to a copy job once the source is allocated, and
+   COPY_JOB_STARTED is returned when that has been answered */
+int readWriteToDatasetAndRespond(HttpResponse *response, char* sourceDataset, char* targetDataset, bool isTargetMember, char* msgBuffer, char* etag, bool async) {
+  HttpRequest *request = response->request;
   DatasetName dsn;
   DatasetMemberName memberName;
   extractDatasetAndMemberName(sourceDataset, &dsn, &memberName);
@@ -2645,16 +4940,11 @@ int readWriteToDatasetAndRespond(HttpResponse *response, char* sourceDataset, ch
   memcpy(daDsn.name, dsn.value, sizeof(daDsn.name));
   memcpy(daMember.name, memberName.value, sizeof(daMember.name));
   DynallocDDName daDDname = {.name = "????????"};
+  DatasetAllocation *cachedAllocation = NULL;
 
   int daRC = RC_DYNALLOC_OK, daSysRC = 0, daSysRSN = 0;
-  daRC = dynallocAllocDataset(
-      &daDsn,
-      IS_DAMEMBER_EMPTY(daMember) ? NULL : &daMember,
-      &daDDname,
-      DYNALLOC_DISP_SHR,
-      DYNALLOC_ALLOC_FLAG_NO_CONVERSION | DYNALLOC_ALLOC_FLAG_NO_MOUNT,
-      &daSysRC, &daSysRSN
-  );
+  daRC = allocateDatasetForRead(request, &daDsn, &daMember, &daDDname,
+                                &cachedAllocation, &daSysRC, &daSysRSN);
 
   char responseMessage[100];
   int responseCode = 0;
@@ -2687,10 +4977,11 @@ int readWriteToDatasetAndRespond(HttpResponse *response, char* sourceDataset, ch
   char ddPath[16];
   snprintf(ddPath, sizeof(ddPath), "DD:%8.8s", ddName.value);
 
-  int lrecl = getLreclOrRespondError(response, &dsn, ddPath);
+  DatasetBlockFormat format = {0};
+  int lrecl = getLreclOrRespondError(response, &dsn, ddPath, &format);
   if (!lrecl) {
-    daRC = dynallocUnallocDatasetByDDName(&daDDname, DYNALLOC_UNALLOC_FLAG_NONE,
-                                        &daSysRC, &daSysRSN);
+    daRC = unallocateDatasetForRead(&daDDname, cachedAllocation,
+                                  &daSysRC, &daSysRSN);
     if (daRC != RC_DYNALLOC_OK) {
       zowelog(NULL, LOG_COMP_DATASERVICE, ZOWE_LOG_DEBUG,
             "error: ds unalloc dsn=\'%44.44s\', member=\'%8.8s\', dd=\'%8.8s\',"
@@ -2703,9 +4994,26 @@ int readWriteToDatasetAndRespond(HttpResponse *response, char* sourceDataset, ch
     return ERROR_COPYING_DATASET;
   }
 
-  rc = streamDatasetForCopyAndRespond(response, ddPath, lrecl, targetDataset, isTargetMember, msgBuffer, etag);
-  daRC = dynallocUnallocDatasetByDDName(&daDDname, DYNALLOC_UNALLOC_FLAG_NONE,
-                                        &daSysRC, &daSysRSN);
+  if (async) {
+    SequentialCopyJob *copy = (SequentialCopyJob *)safeMalloc(sizeof(SequentialCopyJob), "SequentialCopyJob");
+    memset(copy, 0, sizeof(SequentialCopyJob));
+    copy->daDDname = daDDname;
+    copy->cachedAllocation = cachedAllocation;
+    memcpy(copy->ddPath, ddPath, sizeof(copy->ddPath));
+    copy->format = format;
+    copy->isTargetMember = isTargetMember;
+    CopyJob *job = makeCopyJob(request->username, sourceDataset, targetDataset,
+                               runSequentialCopyJob, cleanUpSequentialCopyJob, copy);
+    if (submitCopyJobAndRespond(response, job, sourceDataset, targetDataset)) {
+      rc = deleteDatasetOrMember(response, targetDataset, responseMessage, &responseCode);
+      return ERROR_COPYING_DATASET;
+    }
+    return COPY_JOB_STARTED;
+  }
+
+  rc = streamDatasetForCopyAndRespond(response, ddPath, &format, targetDataset, isTargetMember, msgBuffer, etag);
+  daRC = unallocateDatasetForRead(&daDDname, cachedAllocation,
+                                  &daSysRC, &daSysRSN);
   if (daRC != RC_DYNALLOC_OK) {
     zowelog(NULL, LOG_COMP_DATASERVICE, ZOWE_LOG_DEBUG,
             "error: ds unalloc dsn=\'%44.44s\', member=\'%8.8s\', dd=\'%8.8s\',"
@@ -2746,7 +5054,7 @@ int checkIfDatasetExistsAndRespond(HttpResponse* response, char* dataset, bool i
   jsonStart(jPrinter);
 
    // To get the attributes for target dataset
-  getDatasetMetadata(&dsnName, &memName, dataset, "true", NULL, defaultDatasetTypesAllowed, NULL, 0, NULL, NULL, "", NULL, jPrinter);
+  getDatasetMetadata(&dsnName, &memName, dataset, "true", NULL, defaultDatasetTypesAllowed, NULL, 0, NULL, NULL, "", NULL, jPrinter, CSI_CACHE_MODE_OFF, NULL);
   jsonEnd(jPrinter);
 
   ShortLivedHeap *slh = makeShortLivedHeap(0x10000,0x10);
@@ -2775,7 +5083,7 @@ int checkIfDatasetExistsAndRespond(HttpResponse* response, char* dataset, bool i
   return 0;
 }
 
-void pasteAsDatasetMember(HttpResponse *response, char* sourceDataset, char* targetDataset) {
+void pasteAsDatasetMember(HttpResponse *response, char* sourceDataset, char* targetDataset, bool async) {
   bool isTargetMember = true;
 
   int reasonCode = 0;
@@ -2787,8 +5095,8 @@ void pasteAsDatasetMember(HttpResponse *response, char* sourceDataset, char* tar
   char msgBuffer[128];
   char etag[128];
 
-  rc = readWriteToDatasetAndRespond(response, sourceDataset, targetDataset, isTargetMember, msgBuffer, etag);
-  if(rc >= 0) {
+  rc = readWriteToDatasetAndRespond(response, sourceDataset, targetDataset, isTargetMember, msgBuffer, etag, async);
+  if(rc == 0) {
     jsonPrinter *p = respondWithJsonPrinter(response);
     setResponseStatus(response, 201, "Successfully Copied Dataset");
     setDefaultJSONRESTHeaders(response);
@@ -2804,91 +5112,260 @@ void pasteAsDatasetMember(HttpResponse *response, char* sourceDataset, char* tar
   return;
 }
 
-void pastePDSDirectory(HttpResponse *response, JsonBuffer *buffer, char* sourceDataset, char* targetDataset) {
-  ShortLivedHeap *slh = makeShortLivedHeap(0x10000,0x10);
-  char errorBuffer[2048];
-  char newMemberName[44];
-  char sourceMemberName[44];
-  Json *json = jsonParseUnterminatedString(slh,
-                                             buffer->data, buffer->len,
-                                             errorBuffer, sizeof(errorBuffer));
-  // Format for target and source dataset is : //'DATASETNAME'.
-  // To remove the preceding //'
-  char* tarDataset = targetDataset+3;
-  size_t targetLen = strlen(tarDataset);
+static bool allocateForPDSCopy(HttpResponse *response, const char *datasetPath, int disp,
+                               DynallocDatasetName *daDsn, DynallocDDName *daDDname) {
+  DatasetName dsn;
+  DatasetMemberName memberName;
+  extractDatasetAndMemberName(datasetPath, &dsn, &memberName);
+  memcpy(daDsn->name, dsn.value, sizeof(daDsn->name));
+  memcpy(daDDname->name, "????????", sizeof(daDDname->name));
+  DynallocMemberName daMember;
+  memset(daMember.name, ' ', sizeof(daMember.name));
 
-  char* srcDataset = sourceDataset+3;
-  size_t sourceLen = strlen(srcDataset);
+  if (disp == DYNALLOC_DISP_OLD) {
+    invalidateCachedAllocations(&dsn);
+  }
+  int daSysRC = 0, daSysRSN = 0;
+  int daRC = dynallocAllocDataset(daDsn, NULL, daDDname, disp,
+                                  DYNALLOC_ALLOC_FLAG_NO_CONVERSION | DYNALLOC_ALLOC_FLAG_NO_MOUNT,
+                                  &daSysRC, &daSysRSN);
+  if (daRC != RC_DYNALLOC_OK) {
+    zowelog(NULL, LOG_COMP_DATASERVICE, ZOWE_LOG_DEBUG,
+            "error: ds alloc dsn=\'%44.44s\', dd=\'%8.8s\',"
+            " rc=%d sysRC=%d, sysRSN=0x%08X (copy)\n",
+            daDsn->name, daDDname->name, daRC, daSysRC, daSysRSN);
+    char responseMessage[100];
+    int responseCode = 0;
+    getDYNALLOCErrorCodeAndMsg(daRC, daSysRC, daSysRSN, daDsn, &daMember,
+                               disp == DYNALLOC_DISP_OLD ? "w" : "r", responseMessage, &responseCode);
+    respondWithMessage(response, responseCode, responseMessage);
+    return false;
+  }
+  return true;
+}
 
-  // To remove the last '
-  char updatedTargetDataset[targetLen];
-  strncpy(updatedTargetDataset, tarDataset, targetLen - 1);
-  updatedTargetDataset[targetLen - 1] = '\0';
+static void unallocateForPDSCopy(DynallocDatasetName *daDsn, DynallocDDName *daDDname) {
+  int daSysRC = 0, daSysRSN = 0;
+  int daRC = dynallocUnallocDatasetByDDName(daDDname, DYNALLOC_UNALLOC_FLAG_NONE,
+                                            &daSysRC, &daSysRSN);
+  if (daRC != RC_DYNALLOC_OK) {
+    zowelog(NULL, LOG_COMP_DATASERVICE, ZOWE_LOG_DEBUG,
+            "error: ds unalloc dsn=\'%44.44s\', dd=\'%8.8s\',"
+            " rc=%d sysRC=%d, sysRSN=0x%08X (copy)\n",
+            daDsn->name, daDDname->name, daRC, daSysRC, daSysRSN);
+  }
+}
 
-  char updatedSourceDataset[sourceLen];
-  strncpy(updatedSourceDataset, srcDataset, sourceLen - 1);
-  updatedSourceDataset[sourceLen - 1] = '\0';
+static const char *getPDSCopyMemberError(const PDSCopyMember *member) {
+  if (member->state == PDS_COPY_MEMBER_SKIPPED) {
+    return "Not copied after an earlier member failed";
+  }
+  return member->error ? member->error : "Not copied";
+}
 
-  if (json) {
-    if (jsonIsObject(json)){
-      JsonObject *jsonObject = jsonAsObject(json);
-      // Get dataset array
-      JsonArray *datasetArray = jsonObjectGetArray(jsonObject,"datasets");
-      int i = 0;
-      Json *element = jsonArrayGetItem(datasetArray,i);
-      if(element && jsonIsObject(element)) {
-        JsonObject *jsonDatasetObject = jsonAsObject(element);
-        // Get members array
-        JsonArray *membersArray = jsonObjectGetArray(jsonDatasetObject,"members");
-        int memCount = jsonArrayGetCount(membersArray);
-        for(int j=0; j<memCount; j++) {
-          Json *memberObject = jsonArrayGetItem(membersArray,j);
-          if(memberObject && jsonIsObject(memberObject)) {
-            JsonObject *jsonMemberObject = jsonAsObject(memberObject);
-            char* memName = jsonObjectGetString(jsonMemberObject,"name");
-            // memset(newMemberName, '\0', sizeof(newMemberName));
-            sprintf(newMemberName, "//'%s(%s)'", updatedTargetDataset, memName);
-            sprintf(sourceMemberName, "//'%s(%s)'", updatedSourceDataset, memName);
-
-            int reasonCode = 0;
-            int rc = createDataset(response, newMemberName, NULL, 0, &reasonCode);
-            if(rc != 0) {
-              SLHFree(slh);
-              return;
-            }
+static void getPDSCopyMessage(const PDSCopyProgress *progress, int failed, char *targetDataset,
+                              char *msg, int msgSize) {
+  if (failed) {
+    snprintf(msg, msgSize, "Copy Failed. %d of %d members of %s were not pasted",
+             failed, progress->membersTotal, targetDataset);
+  } else {
+    snprintf(msg, msgSize, "Pasted dataset %s", targetDataset);
+  }
+}
 
-            char msgBuffer[128];
-            char etag[128];
+static void respondWithPDSCopyResult(HttpResponse *response, PDSCopy *copy, int failed,
+                                     char *targetDataset) {
+  PDSCopyProgress progress;
+  getPDSCopyProgress(copy, &progress);
+
+  jsonPrinter *p = respondWithJsonPrinter(response);
+  if (failed) {
+    setResponseStatus(response, HTTP_STATUS_INTERNAL_SERVER_ERROR, "Copy Failed");
+  } else {
+    setResponseStatus(response, 201, "Successfully Copied Dataset");
+  }
+  setDefaultJSONRESTHeaders(response);
+  writeHeader(response);
+  jsonStart(p);
+
+  char msg[128];
+  getPDSCopyMessage(&progress, failed, targetDataset, msg, sizeof(msg));
+  jsonAddString(p, "msg", msg);
+  jsonAddInt(p, "members", progress.membersCopied);
+  jsonAddInt64(p, "records", progress.recordsCopied);
+  jsonAddInt64(p, "bytes", progress.bytesCopied);
+  if (failed) {
+    jsonStartArray(p, "failed");
+    for (int i = 0; i < copy->memberCount; i++) {
+      PDSCopyMember *member = &copy->members[i];
+      if (member->state == PDS_COPY_MEMBER_COPIED) {
+        continue;
+      }
+      jsonStartObject(p, NULL);
+      jsonAddString(p, "name", member->name);
+      jsonAddString(p, "error", (char *)getPDSCopyMemberError(member));
+      jsonEndObject(p);
+    }
+    jsonEndArray(p);
+  }
+  jsonEnd(p);
+  finishResponse(response);
+}
+
+typedef struct PDSCopyJob_tag {
+  PDSCopy *copy;
+  DynallocDatasetName daSourceDsn;
+  DynallocDDName daSourceDD;
+  DynallocDatasetName daTargetDsn;
+  DynallocDDName daTargetDD;
+} PDSCopyJob;
+
+static void readPDSCopyJobProgress(CopyJob *job, CopyJobProgress *progress) {
+  PDSCopyJob *pdsJob = (PDSCopyJob *)job->userData;
+  PDSCopyProgress copyProgress;
+  getPDSCopyProgress(pdsJob->copy, &copyProgress);
+  progress->membersTotal = copyProgress.membersTotal;
+  progress->membersCopied = copyProgress.membersCopied;
+  progress->membersFailed = copyProgress.membersFailed;
+  progress->recordsCopied = copyProgress.recordsCopied;
+  progress->bytesCopied = copyProgress.bytesCopied;
+}
+
+static int runPDSCopyJob(CopyJob *job, char *message, char *eTag) {
+  PDSCopy *copy = ((PDSCopyJob *)job->userData)->copy;
+  int failed = runPDSCopy(copy);
+  for (int i = 0; i < copy->memberCount && failed; i++) {
+    PDSCopyMember *member = &copy->members[i];
+    if (member->state != PDS_COPY_MEMBER_COPIED) {
+      addCopyJobFailure(job, member->name, getPDSCopyMemberError(member));
+    }
+  }
+  PDSCopyProgress progress;
+  getPDSCopyProgress(copy, &progress);
+  getPDSCopyMessage(&progress, failed, job->status.target, message, COPY_JOB_MESSAGE_LENGTH);
+  return failed ? ERROR_COPYING_DATASET : 0;
+}
+
+static void cleanUpPDSCopyJob(CopyJob *job) {
+  PDSCopyJob *pdsJob = (PDSCopyJob *)job->userData;
+  freePDSCopy(pdsJob->copy);
+  unallocateForPDSCopy(&pdsJob->daTargetDsn, &pdsJob->daTargetDD);
+  unallocateForPDSCopy(&pdsJob->daSourceDsn, &pdsJob->daSourceDD);
+  safeFree((char *)pdsJob, sizeof(PDSCopyJob));
+}
+
+/*
+  Copies every member with a PDSCopy: both datasets are allocated once here
+  and the members are opened through the DDs, read ahead by a pool of readers
+  and written in order on this thread, or on a copy job's with async. The
+  target was created with the source's attributes, so its LRECL and RECFM are
+  the ones in buffer.
+ */
+void pastePDSDirectory(HttpResponse *response, JsonBuffer *buffer, char* sourceDataset, char* targetDataset, bool async) {
+  ShortLivedHeap *slh = makeShortLivedHeap(0x10000,0x10);
+  char errorBuffer[2048];
+  Json *json = jsonParseUnterminatedString(slh,
+                                             buffer->data, buffer->len,
+                                             errorBuffer, sizeof(errorBuffer));
+  JsonObject *jsonDatasetObject = NULL;
+  if (json && jsonIsObject(json)) {
+    // Get dataset array
+    JsonArray *datasetArray = jsonObjectGetArray(jsonAsObject(json),"datasets");
+    Json *element = jsonArrayGetItem(datasetArray,0);
+    if (element && jsonIsObject(element)) {
+      jsonDatasetObject = jsonAsObject(element);
+    }
+  }
+  if (jsonDatasetObject == NULL) {
+    respondWithError(response, HTTP_STATUS_INTERNAL_SERVER_ERROR, "Could not read source dataset attributes");
+    SLHFree(slh);
+    return;
+  }
 
-            rc = readWriteToDatasetAndRespond(response, sourceMemberName, newMemberName, false, msgBuffer, etag);
-            if(rc < 0) {
-              SLHFree(slh);
-              return;
-            }
-          }
-        }
-        jsonPrinter *p = respondWithJsonPrinter(response);
-        setResponseStatus(response, 201, "Successfully Copied Dataset");
-        setDefaultJSONRESTHeaders(response);
-        writeHeader(response);
-        jsonStart(p);
+  JsonObject *dsOrg = jsonObjectGetObject(jsonDatasetObject,"dsorg");
+  JsonObject *recfm = jsonObjectGetObject(jsonDatasetObject,"recfm");
+  int lrecl = dsOrg ? jsonObjectGetNumber(dsOrg,"maxRecordLen") : 0;
+  char *recordLength = recfm ? jsonObjectGetString(recfm,"recordLength") : NULL;
+
+  // Get members array
+  JsonArray *membersArray = jsonObjectGetArray(jsonDatasetObject,"members");
+  int memCount = membersArray ? jsonArrayGetCount(membersArray) : 0;
+  const char **memberNames = (const char **)SLHAlloc(slh, (memCount + 1) * sizeof(char *));
+  int nameCount = 0;
+  for (int j = 0; j < memCount; j++) {
+    Json *memberObject = jsonArrayGetItem(membersArray,j);
+    if (memberObject && jsonIsObject(memberObject)) {
+      char *memName = jsonObjectGetString(jsonAsObject(memberObject),"name");
+      if (memName) {
+        memberNames[nameCount++] = memName;
+      }
+    }
+  }
 
-        char msg[128];
-        sprintf(msg, "Pasted dataset %s", targetDataset);
-        jsonAddString(p, "msg", msg);
+  DynallocDatasetName daSourceDsn, daTargetDsn;
+  DynallocDDName daSourceDD, daTargetDD;
+  if (!allocateForPDSCopy(response, sourceDataset, DYNALLOC_DISP_SHR, &daSourceDsn, &daSourceDD)) {
+    SLHFree(slh);
+    return;
+  }
+  if (!allocateForPDSCopy(response, targetDataset, DYNALLOC_DISP_OLD, &daTargetDsn, &daTargetDD)) {
+    unallocateForPDSCopy(&daSourceDsn, &daSourceDD);
+    SLHFree(slh);
+    return;
+  }
 
-        jsonEnd(p);
-        finishResponse(response);
-      }
+  char sourcePattern[PDS_COPY_PATH_LENGTH];
+  char targetPattern[PDS_COPY_PATH_LENGTH];
+  snprintf(sourcePattern, sizeof(sourcePattern), "DD:%.8s(%%s)", daSourceDD.name);
+  snprintf(targetPattern, sizeof(targetPattern), "DD:%.8s(%%s)", daTargetDD.name);
+
+  bool isFixed = recordLength && recordLength[0] == 'F';
+  PDSCopy *copy = makePDSCopy(response->request->username, sourcePattern, targetPattern,
+                              lrecl, lrecl, isFixed, memberNames, nameCount, -1);
+  if (copy == NULL) {
+    respondWithError(response, HTTP_STATUS_INTERNAL_SERVER_ERROR, "Could not discover record length");
+  } else if (async) {
+    /* the copy job owns the allocations from here on */
+    PDSCopyJob *pdsJob = (PDSCopyJob *)safeMalloc(sizeof(PDSCopyJob), "PDSCopyJob");
+    pdsJob->copy = copy;
+    pdsJob->daSourceDsn = daSourceDsn;
+    pdsJob->daSourceDD = daSourceDD;
+    pdsJob->daTargetDsn = daTargetDsn;
+    pdsJob->daTargetDD = daTargetDD;
+    CopyJob *job = makeCopyJob(response->request->username, sourceDataset, targetDataset,
+                               runPDSCopyJob, cleanUpPDSCopyJob, pdsJob);
+    job->readProgress = readPDSCopyJobProgress;
+    if (submitCopyJobAndRespond(response, job, sourceDataset, targetDataset)) {
+      /* the rejected job has freed the allocations; drop the empty target
+         so that a retry can create it again */
+      char responseMessage[100];
+      int responseCode = 0;
+      deleteDatasetOrMember(response, targetDataset, responseMessage, &responseCode);
     }
+    SLHFree(slh);
+    return;
+  } else {
+    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "Pasting %d members of %s with %d readers\n",
+            nameCount, sourceDataset, copy->workerCount);
+    int failed = runPDSCopy(copy);
+    respondWithPDSCopyResult(response, copy, failed, targetDataset);
+    freePDSCopy(copy);
   }
+
+  unallocateForPDSCopy(&daTargetDsn, &daTargetDD);
+  unallocateForPDSCopy(&daSourceDsn, &daSourceDD);
   SLHFree(slh);
 }
 
-void copyDatasetAndRespond(HttpResponse *response, char* sourceDataset, char* targetDataset) {
+void copyDatasetAndRespond(HttpResponse *response, char* sourceDataset, char* targetDataset, bool async) {
   #ifdef __ZOWE_OS_ZOS
   HttpRequest *request = response->request;
 
+  if (async && copyJobPool == NULL) {
+    respondWithError(response, HTTP_STATUS_BAD_REQUEST, "Copy jobs are not enabled");
+    return;
+  }
+
   if (sourceDataset == NULL || strlen(sourceDataset) < 1){
     respondWithError(response,HTTP_STATUS_BAD_REQUEST,"No source dataset name given");
     return;
@@ -2964,7 +5441,7 @@ void copyDatasetAndRespond(HttpResponse *response, char* sourceDataset, char* ta
   jsonStart(jPrinter);
 
   // To get the attributes for source dataset
-  getDatasetMetadata(&sourceDsnName, &sourceMemName, sourceDataset, "true", "true", defaultDatasetTypesAllowed, "true", 0, NULL, NULL, "", NULL, jPrinter);
+  getDatasetMetadata(&sourceDsnName, &sourceMemName, sourceDataset, "true", "true", defaultDatasetTypesAllowed, "true", 0, NULL, NULL, "", NULL, jPrinter, CSI_CACHE_MODE_OFF, NULL);
   jsonEnd(jPrinter);
 
   // To set attributes for target dataset
@@ -2987,7 +5464,7 @@ void copyDatasetAndRespond(HttpResponse *response, char* sourceDataset, char* ta
       return;
     } else if(targetDsnExists == 1) {
       safeFree((char*)datasetAttrBuffer, datasetAttrBuffer->size);
-      return pasteAsDatasetMember(response, sourceDataset, targetDataset);
+      return pasteAsDatasetMember(response, sourceDataset, targetDataset, async);
     }
   }
 
@@ -3002,7 +5479,7 @@ void copyDatasetAndRespond(HttpResponse *response, char* sourceDataset, char* ta
   if(isPDS == 1) {
     // Paste the entire PDS(E) directory
     if(isTargetMemberEmpty) {
-      pastePDSDirectory(response, datasetAttrBuffer, sourceDataset, targetDataset);
+      pastePDSDirectory(response, datasetAttrBuffer, sourceDataset, targetDataset, async);
       safeFree((char*)datasetAttrBuffer, datasetAttrBuffer->size);
       return;
     } else {
@@ -3017,9 +5494,9 @@ void copyDatasetAndRespond(HttpResponse *response, char* sourceDataset, char* ta
   char msgBuffer[128];
   char etag[128];
 
-  rc = readWriteToDatasetAndRespond(response, sourceDataset, targetDataset, isTargetMember, msgBuffer, etag);
+  rc = readWriteToDatasetAndRespond(response, sourceDataset, targetDataset, isTargetMember, msgBuffer, etag, async);
 
-  if(rc >= 0) {
+  if(rc == 0) {
     jsonPrinter *p = respondWithJsonPrinter(response);
     setResponseStatus(response, 201, "Successfully Copied Dataset");
     setDefaultJSONRESTHeaders(response);
@@ -3036,15 +5513,465 @@ void copyDatasetAndRespond(HttpResponse *response, char* sourceDataset, char* ta
   #endif /* __ZOWE_OS_ZOS */
 }
 
-getDatasetMetadata(const DatasetName *dsnName, DatasetMemberName *memName, char* datasetOrMember, char* addQualifiersArg, char* detailArg, char* typesArg, char* listMembersArg, int workAreaSizeArg, char* migratedArg, char *resumeNameArg, char *unprintableArg, char *resumeCatalogNameArg, jsonPrinter *jPrinter) {
+void respondWithCopyJob(HttpResponse *response, char *jobId) {
+  HttpRequest *request = response->request;
+  char *end = NULL;
+  long id = jobId ? strtol(jobId, &end, 10) : 0;
+  CopyJobStatus *status = (CopyJobStatus *)SLHAlloc(response->slh, sizeof(CopyJobStatus));
+  if (copyJobPool == NULL || jobId == end || *end != '\0' || id <= 0 ||
+      !getCopyJobStatus(copyJobPool, (int)id, request->username, status)) {
+    respondWithError(response, HTTP_STATUS_NOT_FOUND, "Copy job not found");
+    return;
+  }
+
+  time_t now = time(NULL);
+  int elapsedSeconds = 0;
+  if (status->startTime) {
+    elapsedSeconds = (int)((status->endTime ? status->endTime : now) - status->startTime);
+  }
+  int64 bytesPerSecond = elapsedSeconds > 0 ? status->progress.bytesCopied / elapsedSeconds
+                                            : status->progress.bytesCopied;
+
+  jsonPrinter *p = respondWithJsonPrinter(response);
+  setResponseStatus(response, HTTP_STATUS_OK, "OK");
+  setDefaultJSONRESTHeaders(response);
+  writeHeader(response);
+  jsonStart(p);
+  jsonAddInt(p, "jobId", status->id);
+  jsonAddString(p, "state", (char *)getCopyJobStateName(status->state));
+  jsonAddString(p, "source", status->source);
+  jsonAddString(p, "target", status->target);
+  if (status->message[0]) {
+    jsonAddString(p, "msg", status->message);
+  }
+  if (status->eTag[0]) {
+    jsonAddString(p, "etag", status->eTag);
+  }
+  jsonAddInt64(p, "recordsCopied", status->progress.recordsCopied);
+  jsonAddInt64(p, "bytesCopied", status->progress.bytesCopied);
+  if (status->progress.membersTotal) {
+    jsonAddInt(p, "membersTotal", status->progress.membersTotal);
+    jsonAddInt(p, "membersDone", status->progress.membersCopied + status->progress.membersFailed);
+    jsonAddInt(p, "membersFailed", status->progress.membersFailed);
+  }
+  jsonAddInt(p, "elapsedSeconds", elapsedSeconds);
+  jsonAddInt64(p, "bytesPerSecond", bytesPerSecond);
+  if (status->failureCount) {
+    int kept = status->failureCount < COPY_JOB_MAX_FAILURES ? status->failureCount : COPY_JOB_MAX_FAILURES;
+    jsonStartArray(p, "failed");
+    for (int i = 0; i < kept; i++) {
+      jsonStartObject(p, NULL);
+      jsonAddString(p, "name", status->failures[i].name);
+      jsonAddString(p, "error", status->failures[i].error);
+      jsonEndObject(p);
+    }
+    jsonEndArray(p);
+  }
+  jsonEnd(p);
+  finishResponse(response);
+}
+
 #ifdef __ZOWE_OS_ZOS
-  int dsnLen = strlen(datasetOrMember);
-  int lParenIndex = indexOf(datasetOrMember, dsnLen, '(', 0);
-  int rParenIndex = indexOf(datasetOrMember, dsnLen, ')', 0);
-  int memberNameLength = (unsigned int)rParenIndex  - (unsigned int)lParenIndex -1;
-  int datasetTypeCount = (typesArg == NULL) ? 3 : strlen(typesArg);
-  int includeUnprintable = !strcmp(unprintableArg, "true") ? TRUE : FALSE;
+static void makeCSIQueryKey(CSIQueryKey *key, const char *user, char *pattern,
+                            char *types, int typeCount, int workAreaSize,
+                            char *resumeName, char *resumeCatalogName) {
+  memset(key, 0, sizeof(CSIQueryKey));
+  snprintf(key->user, sizeof(key->user), "%s", user ? user : "");
+  snprintf(key->pattern, sizeof(key->pattern), "%s", pattern);
+  snprintf(key->types, sizeof(key->types), "%.*s", types ? typeCount : 0, types ? types : "");
+  key->workAreaSize = workAreaSize;
+  snprintf(key->resumeName, sizeof(key->resumeName), "%s", resumeName ? resumeName : "");
+  snprintf(key->resumeCatalogName, sizeof(key->resumeCatalogName), "%s",
+           resumeCatalogName ? resumeCatalogName : "");
+}
+
+static void freeCSIEntry(EntryData *entry) {
+  int fieldDataLength = entry->data.fieldInfoHeader.totalLength;
+  int entrySize = sizeof(EntryData)+fieldDataLength-4; /* -4 for the fact that the length is 4 from end of EntryData */
+  safeFree((char*)(entry),entrySize);
+}
+
+static void freeCSIEntrySet(EntryDataSet *entrySet) {
+  safeFree((char*)(entrySet->entries),sizeof(EntryData*)*entrySet->size);
+  safeFree((char*)entrySet,sizeof(EntryDataSet));
+}
+
+/* Keeps what the listing needs of a CSI work area entry */
+static void decodeCSIEntry(EntryData *entry, char **csiFields, int fieldCount,
+                           CSIDatasetEntry *decoded) {
+  memset(decoded, 0, sizeof(CSIDatasetEntry));
+  memcpy(decoded->name, entry->name, sizeof(decoded->name));
+  decoded->type = entry->type;
+  char type = entry->type;
+  if (type == 'A' || type == 'B' || type == 'D' || type == 'H'){
+    unsigned short *fieldLengthArray = ((unsigned short *)((char*)entry+sizeof(EntryData)));
+    char *fieldValueStart = (char*)entry+sizeof(EntryData)+fieldCount*sizeof(short);
+    for (int j=0; j<fieldCount; j++){
+      if (!strcmp(csiFields[j],"VOLSER  ") && fieldLengthArray[j]){
+        memcpy(decoded->volser, fieldValueStart, CSI_CACHE_VOLSER_LENGTH);
+        decoded->hasVolser = true;
+        break;
+      }
+      fieldValueStart += fieldLengthArray[j];
+    }
+  }
+}
+
+/* A catalog entry of the CSI work area starts with CSICFLG, and its CSICRETN
+   holds the module, reason and return code of a catalog that failed */
+#define CSI_CATALOG_ENTRY_TYPE  '0'
+#define CSI_CATALOG_FLAG_ERROR  0x10  /* CSICERR */
+#define CSI_RETURN_INFO_OFFSET  46    /* CSICRETN */
+
+/* true when the search returned nothing or the CSI reported a catalog that
+   could not be searched, so the entries are not all there is. *rc and
+   *reason are the CSI's. */
+static bool isCSISearchFailed(EntryDataSet *entrySet, int *rc, int *reason) {
+  *rc = 0;
+  *reason = 0;
+  if (entrySet == NULL) {
+    *rc = 8;
+    return true;
+  }
+  for (int i = 0; i < entrySet->length; i++) {
+    const unsigned char *entry = (const unsigned char *)entrySet->entries[i];
+    if (entry == NULL || entrySet->entries[i]->type != CSI_CATALOG_ENTRY_TYPE) {
+      continue;
+    }
+    if (entry[0] & CSI_CATALOG_FLAG_ERROR) {
+      *reason = entry[CSI_RETURN_INFO_OFFSET + 2];
+      *rc = entry[CSI_RETURN_INFO_OFFSET + 3];
+      return true;
+    }
+  }
+  return false;
+}
+
+/* Runs the CSI search and keeps what the listing needs of each entry, in a
+   result that can be cached. Returns NULL when a catalog could not be
+   searched, so that a partial or empty result is never cached. */
+static CSIQueryResult *searchCatalog(const CSIQueryKey *key, char *pattern,
+                                     char *typesArg, int datasetTypeCount, int workAreaSizeArg,
+                                     char *resumeNameArg, char *resumeCatalogNameArg) {
+  int fieldCount = defaultCSIFieldCount;
+  char **csiFields = defaultCSIFields;
+  csi_parmblock * __ptr32 returnParms = (csi_parmblock* __ptr32)safeMalloc31(sizeof(csi_parmblock),"CSI ParmBlock");
+  EntryDataSet *entrySet = returnEntries(pattern, typesArg, datasetTypeCount, workAreaSizeArg, csiFields, fieldCount, resumeNameArg, resumeCatalogNameArg, returnParms);
+  int csiRC = 0, csiReason = 0;
+  if (isCSISearchFailed(entrySet, &csiRC, &csiReason)) {
+    zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_WARNING,
+            "Catalog search for %s failed, rc=%d reason=%d\n", pattern, csiRC, csiReason);
+    safeFree31((char*)returnParms,sizeof(csi_parmblock));
+    if (entrySet) {
+      for (int i = 0; i < entrySet->length; i++) {
+        if (entrySet->entries[i]) {
+          freeCSIEntry(entrySet->entries[i]);
+        }
+      }
+      freeCSIEntrySet(entrySet);
+    }
+    return NULL;
+  }
+
+  CSIQueryResult *result = makeCSIQueryResult(key, entrySet->length);
+  result->hasMore = (returnParms->is_resume == 'Y');
+  memcpy(result->resumeName, returnParms->resume_name, sizeof(result->resumeName));
+  memcpy(result->resumeCatalogName, returnParms->catalog_name, sizeof(result->resumeCatalogName));
+  int count = 0;
+  for (int i = 0; i < entrySet->length; i++){
+    EntryData *entry = entrySet->entries[i];
+    if (entry == NULL) {
+      continue;
+    }
+    decodeCSIEntry(entry, csiFields, fieldCount, &result->entries[count++]);
+    freeCSIEntry(entry);
+  }
+  result->entryCount = count;
+  safeFree31((char*)returnParms,sizeof(csi_parmblock));
+  freeCSIEntrySet(entrySet);
+  return result;
+}
+
+/* What to write about each dataset of a listing */
+typedef struct DatasetListOptions_tag {
+  int detail;
+  int listMembers;
+  int includeMigrated;
+  int includeUnprintable;
+  int includeMemberStats;
+  char *memberName;
+  int memberNameLength;
+  const char *user;             /* NULL when the member directories are not cached */
+  int memberLimit;              /* 0 lists all the members */
+  bool hasMemberResumeName;
+  char memberResumeName[8];     /* space padded */
+} DatasetListOptions;
+
+static bool isMigratedVolser(const CSIDatasetEntry *entry) {
+  return entry->hasVolser && (!memcmp(entry->volser, "MIGRAT", CSI_CACHE_VOLSER_LENGTH) ||
+                              !memcmp(entry->volser, "ARCIVE", CSI_CACHE_VOLSER_LENGTH));
+}
+
+/* dscbRequest holds the DSCB looked up for the entry when it needs one */
+static void addListedDataset(jsonPrinter *jPrinter, CSIDatasetEntry *entry,
+                             const DatasetListOptions *options, DSCBRequest *dscbRequest) {
+  char volser[7];
+  int isMigrated = FALSE;
+  jsonStartObject(jPrinter, NULL);
+  int datasetNameLength = sizeof(entry->name);
+  char *datasetName = entry->name;
+  jsonAddUnterminatedString(jPrinter, "name", datasetName, datasetNameLength);
+  jsonAddUnterminatedString(jPrinter, "csiEntryType", &entry->type, 1);
+  int volserLength = 0;
+  memset(volser, 0, sizeof(volser));
+  if (entry->hasVolser) {
+    volserLength = 6; /* may contain spaces */
+    memcpy(volser,entry->volser,volserLength);
+    jsonAddString(jPrinter,"volser",volser);
+    if (!strcmp(volser,"MIGRAT") || !strcmp(volser,"ARCIVE")){
+      isMigrated = TRUE;
+    }
+  }
+
+  if (options->detail){
+    if (!isMigrated || options->includeMigrated){
+      zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG, "Going to check dataset %.44s attributes\n",datasetName);
+      addDetailsFromObtainedDSCB(datasetName, dscbRequest->rc, dscbRequest->dscb, jPrinter);
+    }
+  }
+  if (options->listMembers) {
+    if (!isMigrated || options->includeMigrated){
+      addMembersOfObtainedDataset(datasetName, dscbRequest->rc, dscbRequest->dscb,
+                                  options->memberName, options->memberNameLength,
+                                  jPrinter, options->includeUnprintable,
+                                  options->includeMemberStats, options->user,
+                                  options->hasMemberResumeName ? options->memberResumeName : NULL,
+                                  options->memberLimit);
+    }
+  }
+  jsonEndObject(jPrinter);
+}
+
+/* Writes out the entries, with the DSCBs the details and member lists need
+   looked up together beforehand */
+static void addListedDatasets(jsonPrinter *jPrinter, CSIDatasetEntry *entries, int entryCount,
+                              const DatasetListOptions *options) {
+  DSCBRequest *requests = NULL;
+  int requestCount = 0;
+  if ((options->detail || options->listMembers) && entryCount > 0) {
+    requests = (DSCBRequest *)safeMalloc(sizeof(DSCBRequest) * entryCount, "DSCB requests");
+    for (int i = 0; i < entryCount; i++) {
+      CSIDatasetEntry *entry = &entries[i];
+      if (isMigratedVolser(entry) && !options->includeMigrated) {
+        continue;
+      }
+      DSCBRequest *request = &requests[requestCount++];
+      memcpy(request->name, entry->name, sizeof(request->name));
+      memset(request->volser, ' ', sizeof(request->volser));
+      if (entry->hasVolser) {
+        memcpy(request->volser, entry->volser, sizeof(request->volser));
+      }
+      request->rc = 0;
+    }
+    obtainDSCBs(vtocCache, obtainListedDSCB, NULL, requests, requestCount);
+  }
+  int requestIndex = 0;
+  for (int i = 0; i < entryCount; i++) {
+    CSIDatasetEntry *entry = &entries[i];
+    DSCBRequest *request = NULL;
+    if (requests && (!isMigratedVolser(entry) || options->includeMigrated)) {
+      request = &requests[requestIndex++];
+    }
+    addListedDataset(jPrinter, entry, options, request);
+  }
+  if (requests) {
+    safeFree((char *)requests, sizeof(DSCBRequest) * entryCount);
+  }
+}
+
+/*
+  Where a streamed listing stopped. CSI only resumes a search at the start of
+  a work area, so this is the resume position the stopping page was searched
+  from and the number of entries of that page already written. The hash of the
+  pattern, types and work area size makes sure the token is only used for the
+  search that made it, as those decide where the pages start.
+ */
+typedef struct DatasetListPosition_tag {
+  char resumeName[CSI_CACHE_NAME_LENGTH + 1];        /* empty for the first page */
+  char resumeCatalogName[CSI_CACHE_NAME_LENGTH + 1];
+  int skip;
+  unsigned int searchHash;
+} DatasetListPosition;
+
+#define DATASET_LIST_DEFAULT_LIMIT 1000
+#define DATASET_LIST_MAX_LIMIT     100000
+
+#define DATASET_LIST_TOKEN_VERSION '1'
+#define DATASET_LIST_TOKEN_LENGTH (1 + 8 + 8 + 4 * CSI_CACHE_NAME_LENGTH)
+
+static unsigned int hashDatasetListSearch(const char *pattern, const char *types, int typeCount,
+                                          int workAreaSize) {
+  unsigned int hash = 2166136261u;
+  for (const char *c = pattern; *c; c++) {
+    hash = (hash ^ (unsigned char)*c) * 16777619u;
+  }
+  for (int i = 0; i < typeCount; i++) {
+    hash = (hash ^ (unsigned char)types[i]) * 16777619u;
+  }
+  return (hash ^ (unsigned int)workAreaSize) * 16777619u;
+}
+
+static char *addHexBytes(char *out, const char *bytes, int length) {
+  static const char hexDigits[] = "0123456789abcdef";
+  for (int i = 0; i < length; i++) {
+    unsigned char byte = (unsigned char)bytes[i];
+    *out++ = hexDigits[byte >> 4];
+    *out++ = hexDigits[byte & 0xF];
+  }
+  return out;
+}
+
+static int hexDigitValue(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  } else if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  return -1;
+}
+
+static bool readHexBytes(const char *in, char *bytes, int length) {
+  for (int i = 0; i < length; i++) {
+    int high = hexDigitValue(in[2 * i]);
+    int low = hexDigitValue(in[2 * i + 1]);
+    if (high < 0 || low < 0) {
+      return false;
+    }
+    bytes[i] = (char)(high << 4 | low);
+  }
+  return true;
+}
+
+/* token must have room for DATASET_LIST_TOKEN_LENGTH + 1 characters */
+static void encodeDatasetListToken(const DatasetListPosition *position, char *token) {
+  char *out = token;
+  *out++ = DATASET_LIST_TOKEN_VERSION;
+  out += sprintf(out, "%08x%08x", (unsigned int)position->skip, position->searchHash);
+  out = addHexBytes(out, position->resumeName, CSI_CACHE_NAME_LENGTH);
+  out = addHexBytes(out, position->resumeCatalogName, CSI_CACHE_NAME_LENGTH);
+  *out = '\0';
+}
+
+static bool decodeDatasetListToken(const char *token, DatasetListPosition *position) {
+  memset(position, 0, sizeof(DatasetListPosition));
+  if (strlen(token) != DATASET_LIST_TOKEN_LENGTH || token[0] != DATASET_LIST_TOKEN_VERSION) {
+    return false;
+  }
+  unsigned char number[4];
+  const char *in = token + 1;
+  if (!readHexBytes(in, (char *)number, 4)) {
+    return false;
+  }
+  position->skip = (int)((unsigned int)number[0] << 24 | number[1] << 16 | number[2] << 8 | number[3]);
+  if (!readHexBytes(in + 8, (char *)number, 4)) {
+    return false;
+  }
+  position->searchHash = (unsigned int)number[0] << 24 | number[1] << 16 | number[2] << 8 | number[3];
+  if (!readHexBytes(in + 16, position->resumeName, CSI_CACHE_NAME_LENGTH) ||
+      !readHexBytes(in + 16 + 2 * CSI_CACHE_NAME_LENGTH, position->resumeCatalogName,
+                    CSI_CACHE_NAME_LENGTH)) {
+    return false;
+  }
+  return position->skip >= 0;
+}
+
+/*
+  Lists up to limit datasets from position, searching the catalog one work
+  area at a time and writing out each page as soon as it is decoded, so that
+  the server holds no more than a work area of the listing however many
+  datasets match. The CSI entries are freed as they are decoded, the DSCBs of
+  a page are looked up together, and the pages are not cached.
+ */
+static void streamDatasetList(char *pattern, char *types, int typeCount, int workAreaSize,
+                              const DatasetListOptions *options, int limit,
+                              const DatasetListPosition *start, jsonPrinter *jPrinter) {
+  int fieldCount = defaultCSIFieldCount;
+  char **csiFields = defaultCSIFields;
+  DatasetListPosition page = *start;
+  DatasetListPosition next;
+  bool hasMore = false;
+  int written = 0;
+  csi_parmblock * __ptr32 returnParms = (csi_parmblock* __ptr32)safeMalloc31(sizeof(csi_parmblock),"CSI ParmBlock");
+
+  jsonStartArray(jPrinter, "datasets");
+  while (true) {
+    bool isResume = (page.resumeName[0] != '\0');
+    memset(returnParms, 0, sizeof(csi_parmblock));
+    EntryDataSet *entrySet = returnEntries(pattern, types, typeCount, workAreaSize, csiFields, fieldCount,
+                                           isResume ? page.resumeName : NULL,
+                                           isResume ? page.resumeCatalogName : NULL, returnParms);
+    bool stopped = false;
+    int index = 0;
+    int pageSize = sizeof(CSIDatasetEntry) * entrySet->length;
+    CSIDatasetEntry *pageEntries = (pageSize > 0) ? (CSIDatasetEntry *)safeMalloc(pageSize, "Listed datasets")
+                                                  : NULL;
+    int pageCount = 0;
+    for (int i = 0; i < entrySet->length; i++) {
+      EntryData *entry = entrySet->entries[i];
+      if (entry == NULL) {
+        continue;
+      }
+      if (!stopped && index >= page.skip) {
+        if (written == limit) {
+          next = page;
+          next.skip = index;
+          stopped = true;
+        } else {
+          decodeCSIEntry(entry, csiFields, fieldCount, &pageEntries[pageCount++]);
+          written++;
+        }
+      }
+      index++;
+      freeCSIEntry(entry);
+    }
+    freeCSIEntrySet(entrySet);
+    addListedDatasets(jPrinter, pageEntries, pageCount, options);
+    if (pageEntries) {
+      safeFree((char *)pageEntries, pageSize);
+    }
+    if (stopped) {
+      hasMore = true;
+      break;
+    }
+    if (returnParms->is_resume != 'Y') {
+      break;
+    }
+    memset(&page, 0, sizeof(DatasetListPosition));
+    memcpy(page.resumeName, returnParms->resume_name, CSI_CACHE_NAME_LENGTH);
+    memcpy(page.resumeCatalogName, returnParms->catalog_name, CSI_CACHE_NAME_LENGTH);
+    page.searchHash = start->searchHash;
+    if (written == limit) {
+      next = page;
+      hasMore = true;
+      break;
+    }
+  }
+  jsonEndArray(jPrinter);
+  safeFree31((char*)returnParms,sizeof(csi_parmblock));
 
+  jsonAddInt(jPrinter, "returned", written);
+  jsonAddBoolean(jPrinter, "hasMore", hasMore);
+  if (hasMore) {
+    char token[DATASET_LIST_TOKEN_LENGTH + 1];
+    encodeDatasetListToken(&next, token);
+    jsonAddString(jPrinter, "continuation", token);
+  }
+}
+
+/* Adds ".**" to the dataset name when asked to, and fills pattern, which has
+   room for 45 characters, with the name to search for */
+static void makeDatasetListPattern(DatasetName *dsnName, int dsnLen, char *addQualifiersArg,
+                                   char *pattern) {
   if(addQualifiersArg != NULL) {
     int addQualifiers = !strcmp(addQualifiersArg, "true");
     #define DSN_MAX_LEN 44
@@ -3064,88 +5991,88 @@ getDatasetMetadata(const DatasetName *dsnName, DatasetMemberName *memName, char*
     #undef DSN_MAX_LEN
   }
 
-  int fieldCount = defaultCSIFieldCount;
-  char **csiFields = defaultCSIFields;
-  char dsnNameNullTerm[45] = {0};
-  memcpy(dsnNameNullTerm, dsnName->value, sizeof(dsnName->value));
-  nullTerminate(dsnNameNullTerm, sizeof(dsnNameNullTerm) - 1);
-  csi_parmblock * __ptr32 returnParms = (csi_parmblock* __ptr32)safeMalloc31(sizeof(csi_parmblock),"CSI ParmBlock");
-  EntryDataSet *entrySet = returnEntries(dsnNameNullTerm, typesArg, datasetTypeCount, workAreaSizeArg, csiFields, fieldCount, resumeNameArg, resumeCatalogNameArg, returnParms);
-  char *resumeName = returnParms->resume_name;
-  char *catalogName = returnParms->catalog_name;
-  int isResume = (returnParms->is_resume == 'Y');
+  memset(pattern, 0, 45);
+  memcpy(pattern, dsnName->value, sizeof(dsnName->value));
+  nullTerminate(pattern, 44);
+}
 
-  char volser[7];
-  memset(volser,0,7);
+static void makeDatasetListOptions(DatasetMemberName *memName, char *datasetOrMember,
+                                   char *detailArg, char *listMembersArg, char *migratedArg,
+                                   char *unprintableArg, char *memberStatsArg, const char *user,
+                                   DatasetListOptions *options) {
+  memset(options, 0, sizeof(DatasetListOptions));
+  options->user = user;
+  int dsnLen = strlen(datasetOrMember);
+  int lParenIndex = indexOf(datasetOrMember, dsnLen, '(', 0);
+  int rParenIndex = indexOf(datasetOrMember, dsnLen, ')', 0);
+  options->memberName = memName->value;
+  options->memberNameLength = (unsigned int)rParenIndex  - (unsigned int)lParenIndex -1;
+  options->listMembers = (listMembersArg && !strcmp(listMembersArg,"true")) || (lParenIndex > 0);
+  options->detail = (detailArg && !strcmp(detailArg, "true"));
+  options->includeMigrated = (migratedArg && !strcmp(migratedArg, "true"));
+  options->includeUnprintable = (unprintableArg && !strcmp(unprintableArg, "true")) ? TRUE : FALSE;
+  options->includeMemberStats = (memberStatsArg && !strcmp(memberStatsArg, "true")) ? TRUE : FALSE;
+}
+#endif /* __ZOWE_OS_ZOS */
 
-  {
-    jsonAddInt(jPrinter,"hasMore",isResume);
-    if (isResume) {
-      jsonAddUnterminatedString(jPrinter,"resumeName",resumeName,44);
-      jsonAddUnterminatedString(jPrinter,"resumeCatalogName",catalogName,44);
+#ifdef __ZOWE_OS_ZOS
+static void addDatasetList(char *pattern, char *typesArg, int datasetTypeCount, int workAreaSizeArg,
+                           char *resumeNameArg, char *resumeCatalogNameArg,
+                           const DatasetListOptions *options, int csiCacheMode, const char *user,
+                           jsonPrinter *jPrinter) {
+  CSIQueryCache *cache = (csiCacheMode != CSI_CACHE_MODE_OFF) ? csiQueryCache : NULL;
+  CSIQueryKey key;
+  CSIQueryResult *result = NULL;
+  if (cache) {
+    makeCSIQueryKey(&key, user, pattern, typesArg, datasetTypeCount, workAreaSizeArg,
+                    resumeNameArg, resumeCatalogNameArg);
+    if (csiCacheMode == CSI_CACHE_MODE_USE) {
+      result = lookupCSIQueryResult(cache, &key);
     }
-    jsonStartArray(jPrinter,"datasets");
-    for (int i = 0; i < entrySet->length; i++){
-      EntryData *entry = entrySet->entries[i];
-
-      if (entry) {
-        int fieldDataLength = entry->data.fieldInfoHeader.totalLength;
-        int entrySize = sizeof(EntryData)+fieldDataLength-4; /* -4 for the fact that the length is 4 from end of EntryData */
-        int isMigrated = FALSE;
-        jsonStartObject(jPrinter, NULL);
-        int datasetNameLength = sizeof(entry->name);
-        char *datasetName = entry->name;
-        jsonAddUnterminatedString(jPrinter, "name", datasetName, datasetNameLength);
-        jsonAddUnterminatedString(jPrinter, "csiEntryType", &entry->type, 1);
-        int volserLength = 0;
-        memset(volser, 0, sizeof(volser));
-        char type = entry->type;
-        if (type == 'A' || type == 'B' || type == 'D' || type == 'H'){
-          char *fieldData = (char*)entry+sizeof(EntryData);
-          unsigned short *fieldLengthArray = ((unsigned short *)((char*)entry+sizeof(EntryData)));
-          char *fieldValueStart = (char*)entry+sizeof(EntryData)+fieldCount*sizeof(short);
-          for (int j=0; j<fieldCount; j++){
-            if (!strcmp(csiFields[j],"VOLSER  ") && fieldLengthArray[j]){
-              volserLength = 6; /* may contain spaces */
-              memcpy(volser,fieldValueStart,volserLength);
-              jsonAddString(jPrinter,"volser",volser);
-              if (!strcmp(volser,"MIGRAT") || !strcmp(volser,"ARCIVE")){
-                isMigrated = TRUE;
-              }
-              break;
-            }
-            fieldValueStart += fieldLengthArray[j];
-          }
-        }
-
-        int shouldListMembers = !strcmp(listMembersArg,"true") || (lParenIndex > 0);
-        int detail = !strcmp(detailArg, "true");
+  } else {
+    memset(&key, 0, sizeof(CSIQueryKey));
+  }
+  if (result == NULL) {
+    result = searchCatalog(&key, pattern, typesArg, datasetTypeCount, workAreaSizeArg,
+                           resumeNameArg, resumeCatalogNameArg);
+    if (result == NULL) {
+      jsonAddString(jPrinter, "error", "Catalog search failed");
+      jsonStartArray(jPrinter, "datasets");
+      jsonEndArray(jPrinter);
+      return;
+    }
+    if (cache) {
+      storeCSIQueryResult(cache, result);
+    }
+  }
 
-        if (detail){
-          if (!isMigrated || !strcmp(migratedArg, "true")){
-            addDetailedDatasetMetadata(datasetName, datasetNameLength,
-                                       volser, volserLength,
-                                       jPrinter);
-          }
-        }
-        if (shouldListMembers) {
-          if (!isMigrated || !strcmp(migratedArg, "true")){
-            addMemberedDatasetMetadata(datasetName, datasetNameLength,
-                                       volser, volserLength,
-                                       memName->value, memberNameLength,
-                                       jPrinter, includeUnprintable);
-          }
-        }
-        jsonEndObject(jPrinter);
-        safeFree((char*)(entry),entrySize);
-      }
+  {
+    jsonAddInt(jPrinter,"hasMore",result->hasMore);
+    if (result->hasMore) {
+      jsonAddUnterminatedString(jPrinter,"resumeName",result->resumeName,44);
+      jsonAddUnterminatedString(jPrinter,"resumeCatalogName",result->resumeCatalogName,44);
     }
+    jsonStartArray(jPrinter,"datasets");
+    addListedDatasets(jPrinter, result->entries, result->entryCount, options);
     jsonEndArray(jPrinter);
   }
-  safeFree31((char*)returnParms,sizeof(csi_parmblock));
-  safeFree((char*)(entrySet->entries),sizeof(EntryData*)*entrySet->size);
-  safeFree((char*)entrySet,sizeof(EntryDataSet));
+  releaseCSIQueryResult(cache, result);
+}
+#endif /* __ZOWE_OS_ZOS */
+
+getDatasetMetadata(const DatasetName *dsnName, DatasetMemberName *memName, char* datasetOrMember, char* addQualifiersArg, char* detailArg, char* typesArg, char* listMembersArg, int workAreaSizeArg, char* migratedArg, char *resumeNameArg, char *unprintableArg, char *resumeCatalogNameArg, jsonPrinter *jPrinter, int csiCacheMode, const char *user) {
+#ifdef __ZOWE_OS_ZOS
+  int dsnLen = strlen(datasetOrMember);
+  int datasetTypeCount = (typesArg == NULL) ? 3 : strlen(typesArg);
+  DatasetListOptions options;
+  makeDatasetListOptions(memName, datasetOrMember, detailArg, listMembersArg, migratedArg,
+                         unprintableArg, NULL, user, &options);
 
+  char dsnNameNullTerm[45];
+  makeDatasetListPattern((DatasetName *)dsnName, dsnLen, addQualifiersArg, dsnNameNullTerm);
+
+  addDatasetList(dsnNameNullTerm, typesArg, datasetTypeCount, workAreaSizeArg,
+                 resumeNameArg, resumeCatalogNameArg, &options, csiCacheMode, user, jPrinter);
 #endif /* __ZOWE_OS_ZOS */
 }
 
@@ -3196,12 +6123,49 @@ void respondWithDatasetMetadata(HttpResponse *response) {
   HttpRequestParam *unprintableParam = getCheckedParam(request,"includeUnprintable");
   char *unprintableArg = (unprintableParam ? unprintableParam->stringValue : "");
 
+  HttpRequestParam *memberStatsParam = getCheckedParam(request,"includeMemberStats");
+  char *memberStatsArg = (memberStatsParam ? memberStatsParam->stringValue : NULL);
+
   HttpRequestParam *resumeNameParam = getCheckedParam(request,"resumeName");
   char *resumeNameArg = (resumeNameParam ? resumeNameParam->stringValue : NULL);
 
   HttpRequestParam *resumeCatalogNameParam = getCheckedParam(request,"resumeCatalogName");
   char *resumeCatalogNameArg = (resumeCatalogNameParam ? resumeCatalogNameParam->stringValue : NULL);
 
+  HttpRequestParam *updateCacheParam = getCheckedParam(request,"updateCache");
+  int updateCache = (updateCacheParam && updateCacheParam->stringValue &&
+                     !strcmp(updateCacheParam->stringValue, "true"));
+
+  /* a limit or a continuation token asks for the listing to be streamed and
+     paged by the server */
+  HttpRequestParam *limitParam = getCheckedParam(request,"limit");
+  HttpRequestParam *continuationParam = getCheckedParam(request,"continuation");
+  int streamed = (limitParam != NULL || continuationParam != NULL);
+  int limit = (limitParam ? limitParam->intValue : DATASET_LIST_DEFAULT_LIMIT);
+  if (limit < 1 || limit > DATASET_LIST_MAX_LIMIT) {
+    respondWithError(response, HTTP_STATUS_BAD_REQUEST, "Limit out of range");
+    return;
+  }
+  if (streamed && (resumeNameArg != NULL || resumeCatalogNameArg != NULL)) {
+    respondWithError(response, HTTP_STATUS_BAD_REQUEST,
+                     "Resume names cannot be used with limit or continuation");
+    return;
+  }
+
+  /* member lists are paged per dataset */
+  HttpRequestParam *memberLimitParam = getCheckedParam(request,"memberLimit");
+  int memberLimit = (memberLimitParam ? memberLimitParam->intValue : 0);
+  if (memberLimit < 0) {
+    respondWithError(response, HTTP_STATUS_BAD_REQUEST, "Member limit out of range");
+    return;
+  }
+  HttpRequestParam *memberResumeNameParam = getCheckedParam(request,"memberResumeName");
+  char *memberResumeNameArg = (memberResumeNameParam ? memberResumeNameParam->stringValue : NULL);
+  if (memberResumeNameArg != NULL && (strlen(memberResumeNameArg) < 1 || strlen(memberResumeNameArg) > 8)) {
+    respondWithError(response, HTTP_STATUS_BAD_REQUEST, "Malformed member resume name");
+    return;
+  }
+
   if (resumeNameArg != NULL) {
     if (strlen(resumeNameArg) > 44) {
       respondWithError(response, HTTP_STATUS_BAD_REQUEST,"Malformed resume dataset name");
@@ -3225,6 +6189,31 @@ void respondWithDatasetMetadata(HttpResponse *response) {
     }
   }
 
+  DatasetListOptions options;
+  makeDatasetListOptions(&memName, datasetOrMember, detailArg, listMembersArg, migratedArg,
+                         unprintableArg, memberStatsArg, username, &options);
+  options.memberLimit = memberLimit;
+  if (memberResumeNameArg != NULL) {
+    options.hasMemberResumeName = true;
+    memset(options.memberResumeName, ' ', sizeof(options.memberResumeName));
+    memcpy(options.memberResumeName, memberResumeNameArg, strlen(memberResumeNameArg));
+  }
+  char pattern[45];
+  makeDatasetListPattern(&dsnName, strlen(datasetOrMember), addQualifiersArg, pattern);
+  int typeCount = (typesParam ? strlen(typesArg) : sizeof(defaultDatasetTypesAllowed));
+  DatasetListPosition position;
+  if (streamed) {
+    unsigned int searchHash = hashDatasetListSearch(pattern, typesArg, typeCount, workAreaSizeArg);
+    if (continuationParam == NULL) {
+      memset(&position, 0, sizeof(DatasetListPosition));
+      position.searchHash = searchHash;
+    } else if (!decodeDatasetListToken(continuationParam->stringValue, &position) ||
+               position.searchHash != searchHash) {
+      respondWithError(response, HTTP_STATUS_BAD_REQUEST, "Invalid continuation token");
+      return;
+    }
+  }
+
   jsonPrinter *jPrinter = respondWithJsonPrinter(response);
   setResponseStatus(response, 200, "OK");
   setDefaultJSONRESTHeaders(response);
@@ -3234,7 +6223,14 @@ void respondWithDatasetMetadata(HttpResponse *response) {
   jsonAddString(jPrinter,"_objectType","com.rs.mvd.base.dataset.metadata");
   jsonAddString(jPrinter,"_metadataVersion","1.1");
 
-  getDatasetMetadata(&dsnName, &memName, datasetOrMember, addQualifiersArg, detailArg, typesArg, listMembersArg, workAreaSizeArg, migratedArg, resumeNameArg, unprintableArg, resumeCatalogNameArg, jPrinter);
+  if (streamed) {
+    streamDatasetList(pattern, typesArg, typeCount, workAreaSizeArg, &options, limit, &position,
+                      jPrinter);
+  } else {
+    addDatasetList(pattern, typesArg, typeCount, workAreaSizeArg, resumeNameArg, resumeCatalogNameArg,
+                   &options, updateCache ? CSI_CACHE_MODE_REFRESH : CSI_CACHE_MODE_USE, username,
+                   jPrinter);
+  }
 
   jsonEnd(jPrinter);
   finishResponse(response);
@@ -3242,108 +6238,114 @@ void respondWithDatasetMetadata(HttpResponse *response) {
 #endif /* __ZOWE_OS_ZOS */
 }
 
-static const char hlqFirstChar[29] = {'A','B','C','D','E','F','G','H','I','J','K','L','M','N','O','P','Q','R','S','T','U','V','W','X','Y','Z','$','@','#'};
+#ifdef __ZOWE_OS_ZOS
+/* HLQSearch for the metadata service's HLQCache. Searches for a user run
+   through startImpersonating without a password, like copy threads. */
+static CSIQueryResult *searchHLQBucket(void *userData, const char *user, char firstChar,
+                                       const char *types, int workAreaSize) {
+  char pattern[3] = {firstChar, '*', '\0'};
+  CSIQueryKey key;
+  makeCSIQueryKey(&key, user, pattern, (char *)types, strlen(types), workAreaSize, NULL, NULL);
+  if (user) {
+    if (user[0] == '\0' || !startImpersonating((char *)user, NULL)) {
+      zowelog(NULL, LOG_COMP_RESTDATASET, ZOWE_LOG_DEBUG,
+              "HLQ search of '%c' could not run as '%s'\n", firstChar, user);
+      return NULL;
+    }
+  }
+  CSIQueryResult *result = searchCatalog(&key, pattern, (char *)types, strlen(types), workAreaSize,
+                                         NULL, NULL);
+  if (user) {
+    endImpersonating((char *)user, NULL);
+  }
+  return result;
+}
+#endif /* __ZOWE_OS_ZOS */
+
+MetadataQueryCache *makeMetadataQueryCache(int ttlSeconds, int searchWorkers) {
+#ifdef __ZOWE_OS_ZOS
+  MetadataQueryCache *metadataQueryCache = (MetadataQueryCache*)safeMalloc(sizeof(MetadataQueryCache),"Pointer to metadata cache");
+  metadataQueryCache->hlqCache = makeHLQCache(searchHLQBucket, NULL, ttlSeconds, searchWorkers);
+  return metadataQueryCache;
+#else
+  return NULL;
+#endif /* __ZOWE_OS_ZOS */
+}
 
 void respondWithHLQNames(HttpResponse *response, MetadataQueryCache *metadataQueryCache) {
 #ifdef __ZOWE_OS_ZOS
   HttpRequest *request = response->request;
-  setResponseStatus(response, 200, "OK");
-  setDefaultJSONRESTHeaders(response);
-  jsonPrinter *jPrinter = respondWithJsonPrinter(response);
-  writeHeader(response);
-  EntryDataSet *hlqSet;
-  csi_parmblock * __ptr32 * __ptr32 returnParmsArray;
-  char **csiFields = defaultCSIFields;
-  int fieldCount = defaultCSIFieldCount;
+  HLQCache *hlqCache = metadataQueryCache->hlqCache;
 
   HttpRequestParam *cacheParam = getCheckedParam(request,"updateCache");
   char *cacheArg = (cacheParam ? cacheParam->stringValue : NULL);
 
   int updateCache = (cacheArg != NULL && !strcmp(cacheArg,"true"));
 
-  if (metadataQueryCache->cachedHLQSet && updateCache==FALSE){
-    hlqSet = metadataQueryCache->cachedHLQSet;
-    returnParmsArray = metadataQueryCache->cachedCSIParmblocks;
+  HttpRequestParam *typesParam = getCheckedParam(request,"types");
+  char types[CSI_CACHE_TYPES_LENGTH + 1];
+  if (typesParam) {
+    snprintf(types, sizeof(types), "%s", typesParam->stringValue);
+  } else {
+    snprintf(types, sizeof(types), "%.*s", (int)sizeof(defaultDatasetTypesAllowed), defaultDatasetTypesAllowed);
   }
-  else{
-    if (metadataQueryCache->cachedHLQSet != NULL){
-      EntryData **entries = metadataQueryCache->cachedHLQSet->entries;
-      for (int i = 0; i < metadataQueryCache->cachedHLQSet->length; i++){
-        EntryData *entry = entries[i];
-        int fieldDataLength = entry->data.fieldInfoHeader.totalLength;
-        int entrySize = sizeof(EntryData)+fieldDataLength-4; /* -4 for the fact that the length is 4 from end of EntryData */
-        safeFree((char*)entries[i],entrySize);
-        safeFree((char*)metadataQueryCache->cachedCSIParmblocks[i],sizeof(csi_parmblock));
-      }
-      safeFree((char*)metadataQueryCache->cachedHLQSet->entries,sizeof(EntryData*)*(metadataQueryCache->cachedHLQSet->length));
-      safeFree((char*)metadataQueryCache->cachedHLQSet,sizeof(EntryDataSet));
-    }
-    HttpRequestParam *typesParam = getCheckedParam(request,"types");
-    char *typesArg = (typesParam ? typesParam->stringValue : defaultDatasetTypesAllowed);
-    int datasetTypeCount = (typesArg == NULL) ? 3 : strlen(typesArg);
 
-    HttpRequestParam *workAreaSizeParam = getCheckedParam(request,"workAreaSize");
-    int workAreaSizeArg = (workAreaSizeParam ? workAreaSizeParam->intValue : 0);
+  HttpRequestParam *workAreaSizeParam = getCheckedParam(request,"workAreaSize");
+  int workAreaSizeArg = (workAreaSizeParam ? workAreaSizeParam->intValue : 0);
 
-    returnParmsArray = (csi_parmblock* __ptr32 * __ptr32)safeMalloc31(29*sizeof(csi_parmblock* __ptr32),"CSI Parm Results");
-    hlqSet = getHLQs(typesArg, datasetTypeCount, workAreaSizeArg, csiFields, fieldCount, returnParmsArray);
+  /* the buckets stay valid while they are written out, whatever refreshes
+     publish meanwhile */
+  HLQSnapshot snapshot;
+  if (updateCache ||
+      !acquireHLQSnapshot(hlqCache, request->username, types, workAreaSizeArg, &snapshot)) {
+    rebuildHLQCache(hlqCache, request->username, types, workAreaSizeArg, &snapshot);
   }
+
+  setResponseStatus(response, 200, "OK");
+  setDefaultJSONRESTHeaders(response);
+  jsonPrinter *jPrinter = respondWithJsonPrinter(response);
+  writeHeader(response);
   jsonStart(jPrinter);
   {
     char letterOrSymbol[2];
     letterOrSymbol[1] = '\0';
     jsonStartArray(jPrinter,"csiResults");
-    for (int i = 0; i < 29; i++){
-      strncpy(letterOrSymbol,hlqFirstChar+i,1);
+    for (int i = 0; i < HLQ_CACHE_BUCKET_COUNT; i++){
+      letterOrSymbol[0] = hlqCacheFirstChars[i];
       jsonStartObject(jPrinter,NULL);
       jsonAddString(jPrinter, "name", letterOrSymbol);
-      csi_parmblock *returnParms = returnParmsArray[i];
-      int isResume = (returnParms->is_resume == 'Y');
+      CSIQueryResult *bucket = snapshot.buckets[i];
+      int isResume = (bucket && bucket->hasMore);
       jsonAddInt(jPrinter,"hasMore",isResume);
       if (isResume){
-        jsonAddUnterminatedString(jPrinter,"resumeName",returnParms->resume_name,sizeof(returnParms->resume_name));
-        jsonAddUnterminatedString(jPrinter,"resumeCatalogName",returnParms->catalog_name,sizeof(returnParms->catalog_name));
+        jsonAddUnterminatedString(jPrinter,"resumeName",bucket->resumeName,sizeof(bucket->resumeName));
+        jsonAddUnterminatedString(jPrinter,"resumeCatalogName",bucket->resumeCatalogName,sizeof(bucket->resumeCatalogName));
       }
       jsonEndObject(jPrinter);
     }
     jsonEndArray(jPrinter);
 
     jsonStartArray(jPrinter,"datasets");
-    fflush(stdout);
-    for (int i = 0; i < hlqSet->length;i++){
-      EntryData *entry = hlqSet->entries[i];
-      if (entry) {
-        int fieldDataLength = entry->data.fieldInfoHeader.totalLength;
-        int entrySize = sizeof(EntryData)+fieldDataLength-4; /* -4 for the fact that the length is 4 from end of EntryData */
+    for (int i = 0; i < HLQ_CACHE_BUCKET_COUNT; i++){
+      CSIQueryResult *bucket = snapshot.buckets[i];
+      for (int j = 0; bucket && j < bucket->entryCount; j++){
+        CSIDatasetEntry *entry = &bucket->entries[j];
         if (isBlanks(entry->name, 0, sizeof(entry->name))){
           continue;
         }
         jsonStartObject(jPrinter, NULL);
         jsonAddUnterminatedString(jPrinter, "name", entry->name, sizeof(entry->name));
         jsonAddUnterminatedString(jPrinter, "type", &entry->type, 1);
-        char type = entry->type;
-        if (type == 'A' || type == 'B' || type == 'D' || type == 'H'){
-          int fieldDataLength = entry->data.fieldInfoHeader.totalLength;
-          char *fieldData = (char*)entry+sizeof(EntryData);
-          unsigned short *fieldLengthArray = ((unsigned short *)((char*)entry+sizeof(EntryData)));
-          char *fieldValueStart = (char*)entry+sizeof(EntryData)+fieldCount*sizeof(short);
-          for (int j=0; j<fieldCount; j++){
-            if (!strcmp(csiFields[j],"VOLSER  ") && fieldLengthArray[j]){
-              jsonAddUnterminatedString(jPrinter,"VOLSER",fieldValueStart,fieldLengthArray[j]);
-              break;
-            }
-            fieldValueStart += fieldLengthArray[j];
-          }
+        if (entry->hasVolser){
+          jsonAddUnterminatedString(jPrinter,"VOLSER",entry->volser,CSI_CACHE_VOLSER_LENGTH);
         }
-
         jsonEndObject(jPrinter);
       }
     }
     jsonEndArray(jPrinter);
   }
   jsonEnd(jPrinter);
-  metadataQueryCache->cachedHLQSet = hlqSet;
-  metadataQueryCache->cachedCSIParmblocks = returnParmsArray;
+  releaseHLQSnapshot(hlqCache, &snapshot);
   finishResponse(response);     
 #endif /* __ZOWE_OS_ZOS */
 }
@@ -3641,6 +6643,8 @@ int createDatasetMember(HttpResponse* response, DatasetName* datasetName, char*
             return ERROR_CLOSING_DATASET;
           }
         }
+        invalidateCachedAllocations(datasetName);
+        invalidateCachedDirectory(datasetName);
         FILE* newMember = fopen(absolutePath, "w");
         if (!newMember){
           respondWithJsonError(response, "Bad dataset name", 400, "Bad Request");
@@ -3738,9 +6742,11 @@ int createDataset(HttpResponse* response, char* absolutePath, char* datasetAttri
             daDatasetName.name, daDDName.name, daRC, returnCode, *reasonCode);
     respondWithError(response, HTTP_STATUS_INTERNAL_SERVER_ERROR, "Unable to deallocate DDNAME");
     SLHFree(slh);
+    invalidateCachedListings(&datasetName);
     return ERROR_DEALLOCATING_DATASET;
   }
   SLHFree(slh);
+  invalidateCachedListings(&datasetName);
   return 0;
   #endif
 }
@@ -42,6 +42,7 @@
 #include "configmgr.h"
 #include "serverStatusService.h"
 #include "zss.h"
+#include "datasetjson.h"
 
 #ifdef __ZOWE_OS_ZOS
 
@@ -115,6 +116,11 @@ static int respondWithServerRoutes(HttpResponse *response, bool allowFullAccess)
   jsonAddString(out, "rel", "services");
   jsonAddString(out, "type", "GET");
   jsonEndObject(out);
+  jsonStartObject(out, NULL);
+  jsonAddString(out, "href", "/server/agent/caches");
+  jsonAddString(out, "rel", "caches");
+  jsonAddString(out, "type", "GET");
+  jsonEndObject(out);
   jsonEndArray(out);
   jsonEnd(out);
   finishResponse(response);
@@ -237,6 +243,157 @@ static int respondWithServices(HttpResponse *response, HttpServer *server) {
   return 0;
 }
 
+static void addDatasetAllocCacheStats(jsonPrinter *out, DatasetAllocCache *cache) {
+  jsonStartObject(out, "allocationCache");
+  jsonAddBoolean(out, "enabled", cache != NULL);
+  if (cache) {
+    DatasetAllocCacheStats stats;
+    getDatasetAllocCacheStats(cache, &stats);
+    jsonAddInt(out, "entries", stats.entries);
+    jsonAddInt64(out, "hits", stats.hits);
+    jsonAddInt64(out, "misses", stats.misses);
+    jsonAddInt64(out, "evictions", stats.evictions);
+    jsonAddInt64(out, "invalidations", stats.invalidations);
+  }
+  jsonEndObject(out);
+}
+
+static void addDatasetETagCacheStats(jsonPrinter *out, DatasetETagCache *cache) {
+  jsonStartObject(out, "eTagCache");
+  jsonAddBoolean(out, "enabled", cache != NULL);
+  if (cache) {
+    DatasetETagCacheStats stats;
+    getDatasetETagCacheStats(cache, &stats);
+    jsonAddInt(out, "entries", stats.entries);
+    jsonAddInt64(out, "hits", stats.hits);
+    jsonAddInt64(out, "misses", stats.misses);
+    jsonAddInt64(out, "stores", stats.stores);
+    jsonAddInt64(out, "invalidations", stats.invalidations);
+  }
+  jsonEndObject(out);
+}
+
+static void addCSIQueryCacheStats(jsonPrinter *out, CSIQueryCache *cache) {
+  jsonStartObject(out, "csiCache");
+  jsonAddBoolean(out, "enabled", cache != NULL);
+  if (cache) {
+    CSIQueryCacheStats stats;
+    getCSIQueryCacheStats(cache, &stats);
+    jsonAddInt(out, "entries", stats.entries);
+    jsonAddInt64(out, "bytes", stats.bytes);
+    jsonAddInt64(out, "hits", stats.hits);
+    jsonAddInt64(out, "misses", stats.misses);
+    jsonAddInt64(out, "stores", stats.stores);
+    jsonAddInt64(out, "evictions", stats.evictions);
+    jsonAddInt64(out, "expirations", stats.expirations);
+    jsonAddInt64(out, "invalidations", stats.invalidations);
+  }
+  jsonEndObject(out);
+}
+
+static void addVTOCCacheStats(jsonPrinter *out, VTOCCache *cache) {
+  jsonStartObject(out, "vtocCache");
+  jsonAddBoolean(out, "enabled", cache != NULL);
+  if (cache) {
+    VTOCCacheStats stats;
+    getVTOCCacheStats(cache, &stats);
+    jsonAddInt(out, "volumes", stats.volumes);
+    jsonAddInt(out, "datasets", stats.datasets);
+    jsonAddInt64(out, "hits", stats.hits);
+    jsonAddInt64(out, "misses", stats.misses);
+    jsonAddInt64(out, "obtains", stats.obtains);
+    jsonAddInt64(out, "duplicates", stats.duplicates);
+    jsonAddInt64(out, "evictions", stats.evictions);
+    jsonAddInt64(out, "expirations", stats.expirations);
+    jsonAddInt64(out, "invalidations", stats.invalidations);
+  }
+  jsonEndObject(out);
+}
+
+static void addPDSDirectoryCacheStats(jsonPrinter *out, PDSDirectoryCache *cache) {
+  jsonStartObject(out, "directoryCache");
+  jsonAddBoolean(out, "enabled", cache != NULL);
+  if (cache) {
+    PDSDirectoryCacheStats stats;
+    getPDSDirectoryCacheStats(cache, &stats);
+    jsonAddInt(out, "entries", stats.entries);
+    jsonAddInt64(out, "bytes", stats.bytes);
+    jsonAddInt64(out, "hits", stats.hits);
+    jsonAddInt64(out, "misses", stats.misses);
+    jsonAddInt64(out, "changes", stats.changes);
+    jsonAddInt64(out, "stores", stats.stores);
+    jsonAddInt64(out, "evictions", stats.evictions);
+    jsonAddInt64(out, "expirations", stats.expirations);
+    jsonAddInt64(out, "invalidations", stats.invalidations);
+  }
+  jsonEndObject(out);
+}
+
+static void addHLQCacheStats(jsonPrinter *out, HttpServer *server) {
+  HttpService *service = server->config->serviceList;
+  while (service && strcmp(service->name, "datasetMetadata")) {
+    service = service->next;
+  }
+  MetadataQueryCache *metadataQueryCache = service ? (MetadataQueryCache *)service->userPointer : NULL;
+  jsonStartObject(out, "hlqCache");
+  jsonAddBoolean(out, "enabled", metadataQueryCache != NULL);
+  if (metadataQueryCache) {
+    HLQCacheStats stats;
+    getHLQCacheStats(metadataQueryCache->hlqCache, &stats);
+    jsonAddInt64(out, "hits", stats.hits);
+    jsonAddInt64(out, "staleHits", stats.staleHits);
+    jsonAddInt64(out, "misses", stats.misses);
+    jsonAddInt64(out, "refreshes", stats.refreshes);
+    jsonAddInt64(out, "refreshFailures", stats.refreshFailures);
+    jsonAddInt(out, "pendingRefreshes", stats.pendingRefreshes);
+  }
+  jsonEndObject(out);
+}
+
+static void addACBPoolStats(jsonPrinter *out, HttpServer *server) {
+  HttpService *service = server->config->serviceList;
+  while (service && strcmp(service->name, "VSAMdatasetContents")) {
+    service = service->next;
+  }
+  serveVSAMCache *vsamCache = service ? (serveVSAMCache *)service->userPointer : NULL;
+  jsonStartObject(out, "acbPool");
+  jsonAddBoolean(out, "enabled", vsamCache != NULL && vsamCache->acbPool->maxEntries > 0);
+  if (vsamCache) {
+    ACBPoolStats stats;
+    getACBPoolStats(vsamCache->acbPool, &stats);
+    jsonAddInt64(out, "opensAvoided", stats.opensAvoided);
+    jsonAddInt64(out, "opens", stats.opens);
+    jsonAddInt64(out, "openFailures", stats.openFailures);
+    jsonAddInt64(out, "evictions", stats.evictions);
+    jsonAddInt64(out, "idleCloses", stats.idleCloses);
+    jsonAddInt64(out, "closes", stats.closes);
+    jsonAddInt64(out, "invalidations", stats.invalidations);
+    jsonAddInt(out, "entries", stats.entries);
+    jsonAddInt(out, "inUse", stats.inUse);
+  }
+  jsonEndObject(out);
+}
+
+static int respondWithCaches(HttpResponse *response) {
+  jsonPrinter *out = respondWithJsonPrinter(response);
+  setResponseStatus(response, 200, "OK");
+  setDefaultJSONRESTHeaders(response);
+  writeHeader(response);
+  jsonStart(out);
+  jsonStartObject(out, "datasets");
+  addDatasetAllocCacheStats(out, getDatasetAllocCache());
+  addDatasetETagCacheStats(out, getDatasetETagCache());
+  addCSIQueryCacheStats(out, getCSIQueryCache());
+  addVTOCCacheStats(out, getVTOCCache());
+  addPDSDirectoryCacheStats(out, getPDSDirectoryCache());
+  addHLQCacheStats(out, httpResponseServer(response));
+  addACBPoolStats(out, httpResponseServer(response));
+  jsonEndObject(out);
+  jsonEnd(out);
+  finishResponse(response);
+  return 0;
+}
+
 static bool statusEndPointRequireAuthAndRBAC(const char *endpoint) {
   return !strcmp(endpoint, "config") ||
          !strcmp(endpoint, "log") ||
@@ -290,6 +447,8 @@ static int serveStatus(HttpService *service, HttpResponse *response) {
       return respondWithServerEnvironment(response, context, configmgr, allowFullAccess);
     } else if (!strcmp(l1, "services")) {
       return respondWithServices(response, server);
+    } else if (!strcmp(l1, "caches")) {
+      return respondWithCaches(response);
     } else {
       respondWithJsonError(response, "Invalid path", 400, "Bad Request");
       return -1;
@@ -0,0 +1,156 @@
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
+
+#ifndef __DATASET_ACB_POOL__
+#define __DATASET_ACB_POOL__ 1
+
+#include <stdbool.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "zowetypes.h"
+#include "scheduling.h"
+
+/*
+  Keeps VSAM datasets open between requests, so that a client paging through
+  a cluster does not pay for a catalog search, an allocation and an OPEN on
+  every page, and carries on from where its last page stopped.
+
+  ACBs are pooled per user and dataset, together with the catalog attributes
+  they were opened with. Requests for the same user and dataset share the
+  open ACB by taking turns: an entry is held by one request at a time from
+  acquire to release, as its RPL keeps a single position. An entry in use is
+  never closed; idle ones are closed once they have not been used for
+  idleSeconds, or when the least recently used one makes room for a new one.
+  When every entry is in use, a new ACB is opened for the request alone and
+  closed when it is released.
+
+  How datasets are looked up and opened is left to an ACBOpener, so the policy
+  can run against a fake opener off-platform.
+ */
+
+#define ACB_POOL_DSN_LENGTH     44
+#define ACB_POOL_USER_LENGTH    16
+#define ACB_POOL_DDNAME_LENGTH  8
+
+#define ACB_POOL_DEFAULT_MAX_ENTRIES  16
+#define ACB_POOL_DEFAULT_IDLE_SECONDS 60
+
+typedef struct StatefulACB_tag {
+  char *acb; /* contains 8-byte plist */
+#define VSAM_TYPE_KSDS  1
+#define VSAM_TYPE_ESDS  2
+#define VSAM_TYPE_LDS   3
+#define VSAM_TYPE_RRDS  4
+  int type;
+  union {
+    char *key;
+    int rba;
+    int ci;
+    int record;
+  } argPtr;
+} StatefulACB;
+
+/* What the catalog says about a cluster's data component */
+typedef struct VSAMAttributes_tag {
+  char dataName[ACB_POOL_DSN_LENGTH];
+  char clusterName[ACB_POOL_DSN_LENGTH];
+  unsigned int vsamType;                        /* VSAMTYPE */
+  unsigned int ciSize;                          /* AMDCIREC */
+  unsigned int maxlrecl;                        /* AMDCIREC */
+  unsigned int keyLoc;                          /* AMDKEY */
+  unsigned int keyLen;                          /* AMDKEY */
+} VSAMAttributes;
+
+typedef struct PooledACB_tag {
+  char user[ACB_POOL_USER_LENGTH + 1];
+  char dsn[ACB_POOL_DSN_LENGTH];                /* as requested, space padded */
+  VSAMAttributes attributes;
+  StatefulACB state;
+  char ddName[ACB_POOL_DDNAME_LENGTH];
+  int refCount;
+  time_t lastUsed;
+  bool valid;
+  bool cached;   /* false for ACBs that did not fit and are closed on release */
+  bool stale;    /* to be closed on last release */
+  pthread_mutex_t useLock;
+} PooledACB;
+
+typedef struct ACBOpener_tag {
+  /* Looks dsn, space padded, up in the catalog. Returns 0 or the opener's
+     error code. */
+  int (*lookup)(void *userData, const char *dsn, VSAMAttributes *attributes);
+  /* Allocates and opens entry's dataset for input, with its attributes,
+     setting the state and DD name of entry. Returns 0 or the opener's error
+     code. */
+  int (*open)(void *userData, PooledACB *entry);
+  void (*close)(void *userData, StatefulACB *state, const char *ddName);
+  void *userData;
+} ACBOpener;
+
+typedef struct ACBPoolStats_tag {
+  uint64 opensAvoided;
+  uint64 opens;
+  uint64 openFailures;
+  uint64 evictions;
+  uint64 idleCloses;
+  uint64 closes;
+  uint64 invalidations;
+  int entries;
+  int inUse;
+} ACBPoolStats;
+
+typedef struct ACBPool_tag {
+  pthread_mutex_t lock;
+  ACBOpener opener;
+  int maxEntries;
+  int idleSeconds;
+  PooledACB *entries;
+  ACBPoolStats stats;
+} ACBPool;
+
+ACBPool *makeACBPool(const ACBOpener *opener, int maxEntries, int idleSeconds);
+
+/*
+  Returns the open ACB of dsn for user, opening it when none is pooled, or
+  NULL with *rc set by the opener. Waits while another request uses the ACB.
+  Every successful acquire must be paired with releasePooledACB.
+ */
+PooledACB *acquirePooledACB(ACBPool *pool, const char *user, const char *dsn, int *rc);
+
+/* close has the ACB closed once nobody else uses it */
+void releasePooledACB(ACBPool *pool, PooledACB *entry, bool close);
+
+/* Closes the ACBs of dsn, for every user, once nobody uses them, so that
+   reads after a write see what was written */
+void invalidateACBPool(ACBPool *pool, const char *dsn);
+
+/* Closes the entries that have been idle for idleSeconds */
+void sweepACBPool(ACBPool *pool);
+
+/* Starts an RLE task that sweeps the pool every idleSeconds, so that idle
+   ACBs are closed and their datasets freed also when no more reads come in.
+   Returns false for a pool without entries or when the task is not started. */
+bool startACBPoolSweeper(ACBPool *pool, RLEAnchor *anchor);
+
+void getACBPoolStats(ACBPool *pool, ACBPoolStats *stats);
+
+#endif
+
+
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
@@ -0,0 +1,125 @@
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
+
+#ifndef __DATASET_ALLOC_CACHE__
+#define __DATASET_ALLOC_CACHE__ 1
+
+#include <stdbool.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "zowetypes.h"
+#include "scheduling.h"
+
+/*
+  Keeps DISP=SHR allocations of datasets and members around between requests,
+  so that clients re-reading the same member do not pay for an allocation and
+  unallocation every time.
+
+  Entries are keyed by user, dataset and member, so an allocation made for one
+  user is never handed to another. An entry in use is never unallocated; idle
+  ones are unallocated once they have not been used for idleSeconds, or when
+  room is needed for a new one. As long as an entry is cached the address
+  space holds the SHR ENQ on the dataset, so anything that needs the dataset
+  exclusively (writes, deletes) must call invalidateDatasetAllocations first.
+
+  How datasets are allocated is left to a DatasetAllocator, so the policy can
+  run against a fake allocator off-platform.
+ */
+
+#define ALLOC_CACHE_DSN_LENGTH    44
+#define ALLOC_CACHE_MEMBER_LENGTH 8
+#define ALLOC_CACHE_DDNAME_LENGTH 8
+#define ALLOC_CACHE_USER_LENGTH   16
+
+#define ALLOC_CACHE_DEFAULT_MAX_ENTRIES  32
+#define ALLOC_CACHE_DEFAULT_IDLE_SECONDS 10
+
+typedef struct DatasetAllocator_tag {
+  /* dsn and member are space padded, member is all blanks for none. ddName
+     receives the allocated DD name. Returns 0 or the allocator's error code. */
+  int (*allocate)(void *userData, const char *dsn, const char *member, char *ddName,
+                  int *sysRC, int *sysRSN);
+  int (*unallocate)(void *userData, const char *ddName, int *sysRC, int *sysRSN);
+  void *userData;
+} DatasetAllocator;
+
+typedef struct DatasetAllocation_tag {
+  char user[ALLOC_CACHE_USER_LENGTH + 1];
+  char dsn[ALLOC_CACHE_DSN_LENGTH];
+  char member[ALLOC_CACHE_MEMBER_LENGTH];
+  char ddName[ALLOC_CACHE_DDNAME_LENGTH];
+  int refCount;
+  time_t lastUsed;
+  bool valid;
+  bool cached;   /* false for allocations that did not fit and are dropped on release */
+  bool stale;    /* invalidated while in use, unallocated on last release */
+} DatasetAllocation;
+
+typedef struct DatasetAllocCacheStats_tag {
+  uint64 hits;
+  uint64 misses;
+  uint64 evictions;
+  uint64 invalidations;
+  int entries;
+} DatasetAllocCacheStats;
+
+typedef struct DatasetAllocCache_tag {
+  pthread_mutex_t lock;
+  DatasetAllocator allocator;
+  int maxEntries;
+  int idleSeconds;
+  DatasetAllocation *entries;
+  DatasetAllocCacheStats stats;
+} DatasetAllocCache;
+
+DatasetAllocCache *makeDatasetAllocCache(const DatasetAllocator *allocator,
+                                         int maxEntries, int idleSeconds);
+void freeDatasetAllocCache(DatasetAllocCache *cache);
+
+/*
+  Returns the allocation for user, dsn and member, allocating it if there is no
+  cached one, or NULL with *rc, *sysRC and *sysRSN set by the allocator. Every
+  successful acquire must be paired with releaseDatasetAllocation.
+ */
+DatasetAllocation *acquireDatasetAllocation(DatasetAllocCache *cache, const char *user,
+                                            const char *dsn, const char *member,
+                                            int *rc, int *sysRC, int *sysRSN);
+void releaseDatasetAllocation(DatasetAllocCache *cache, DatasetAllocation *allocation);
+
+/* Drops every cached allocation of dsn, for all members and users */
+void invalidateDatasetAllocations(DatasetAllocCache *cache, const char *dsn);
+
+/* Unallocates the entries that have been idle for idleSeconds */
+void sweepDatasetAllocCache(DatasetAllocCache *cache);
+
+/* Starts an RLE task that sweeps the cache every idleSeconds, so that idle
+   allocations give up their ENQs also when no more reads come in */
+bool startDatasetAllocCacheSweeper(DatasetAllocCache *cache, RLEAnchor *anchor);
+
+void getDatasetAllocCacheStats(DatasetAllocCache *cache, DatasetAllocCacheStats *stats);
+
+#ifdef __ZOWE_OS_ZOS
+/* DISP=SHR allocations through SVC 99 */
+extern const DatasetAllocator dynallocDatasetAllocator;
+#endif
+
+#endif
+
+
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
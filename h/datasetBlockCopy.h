@@ -0,0 +1,101 @@
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
+
+#ifndef __DATASET_BLOCK_COPY__
+#define __DATASET_BLOCK_COPY__ 1
+
+#include <stdbool.h>
+
+#include "zowetypes.h"
+#include "datasetBlockReader.h"
+#include "datasetDigest.h"
+
+/*
+  Copies a dataset from a BlockSource to a BlockSink.
+
+  When the source and target have the same RECFM and LRECL nothing about the
+  records has to change, so fixed-length data moves a whole block per read and
+  per write, and variable-length records are handed from the source block to
+  the target without being copied. Only when the attributes differ is each
+  record fitted to the target LRECL, padding fixed-length records.
+
+  On z/OS the dataset sink writes fixed-length targets as a byte stream, which
+  the runtime cuts into LRECL records and reblocks to the target's BLKSIZE, and
+  variable-length targets a record at a time. The file sink writes a dataset
+  image, the counterpart of the file BlockSource, so that copies can be run
+  off-platform.
+ */
+
+#define BLOCK_COPY_RC_OK            0
+#define BLOCK_COPY_RC_READ_ERROR    1  /* readRC is the block reader's */
+#define BLOCK_COPY_RC_WRITE_ERROR   2
+#define BLOCK_COPY_RC_TOO_LONG      3  /* a record is over the target LRECL */
+
+#define BLOCK_COPY_FLAG_RECORDS     0x01 /* reformat records even when attributes match */
+
+typedef struct BlockSink_tag BlockSink;
+
+struct BlockSink_tag {
+  /* data is the concatenation of whole records of a fixed-length target */
+  int (*writeBlock)(BlockSink *sink, const char *data, int length);
+  int (*writeRecord)(BlockSink *sink, const char *record, int length);
+  /* returns non-zero when buffered data could not be written */
+  int (*close)(BlockSink *sink);
+  void *handle;
+  char *buffer;                 /* blocks being built by the file sink */
+  int bufferLength;
+  int bufferSize;
+  DatasetBlockFormat format;
+};
+
+typedef struct DatasetCopyResult_tag {
+  bool blockMode;
+  int blocks;
+  int records;
+  int64 bytes;
+  int readRC;
+} DatasetCopyResult;
+
+/* Called as the copy goes, after each block read, with the totals so far */
+typedef void DatasetCopyProgressHandler(void *userData, const DatasetCopyResult *result);
+
+/* true when records can go from source to target as they are */
+bool isBlockCopyFormat(const DatasetBlockFormat *source, const DatasetBlockFormat *target);
+
+#ifdef __ZOWE_OS_ZOS
+BlockSink *openDatasetBlockSink(const char *filename, const DatasetBlockFormat *format);
+#endif
+BlockSink *openFileBlockSink(const char *path, const DatasetBlockFormat *format);
+/* Returns what the sink's close returned */
+int closeBlockSink(BlockSink *sink);
+
+/*
+  Blocks are read into the reader's arena, which is the only buffer used when
+  the attributes match. Short records going to a fixed-length target are
+  padded with padByte. digest may be NULL; when given it is updated with
+  everything written as long as *digestRC stays 0. progress may be NULL.
+ */
+int copyDatasetBlocks(DatasetBlockReader *reader, BlockSink *sink, int flags, char padByte,
+                      DatasetDigest *digest, int *digestRC,
+                      DatasetCopyProgressHandler *progress, void *progressData,
+                      DatasetCopyResult *result);
+
+#endif
+
+
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
@@ -0,0 +1,116 @@
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
+
+#ifndef __DATASET_BLOCK_READER__
+#define __DATASET_BLOCK_READER__ 1
+
+#include <stdbool.h>
+
+/*
+  Reads sequential datasets and members one physical block at a time and splits
+  the blocks into logical records in user space, instead of asking the C runtime
+  for one record per fread.
+
+  Where the blocks come from is abstracted by BlockSource. On z/OS the source is
+  the dataset itself opened with RECFM=U, so that every read returns a whole
+  block. The file source reads a dataset image laid out the same way (FB blocks
+  of BLKSIZE bytes, VB blocks prefixed by their BDW) from any file, so the
+  deblocking can be exercised off-platform.
+ */
+
+#define BLOCK_READER_MAX_BLOCK_SIZE 32760
+
+#define BLOCK_READER_RC_OK         0
+#define BLOCK_READER_RC_EOF        1
+#define BLOCK_READER_RC_IO_ERROR   -1
+#define BLOCK_READER_RC_BAD_BLOCK  -2
+#define BLOCK_READER_RC_BAD_FORMAT -3
+
+typedef struct DatasetBlockFormat_tag {
+  char recfm;       /* 'F', 'V' or 'U' */
+  bool blocked;
+  bool spanned;
+  int lrecl;
+  int blksize;
+} DatasetBlockFormat;
+
+typedef struct BlockSource_tag BlockSource;
+
+struct BlockSource_tag {
+  /* Returns the length of the block read into buffer, 0 at end of data,
+     or a negative BLOCK_READER_RC_* value. */
+  int (*readBlock)(BlockSource *source, char *buffer, int bufferSize);
+  void (*close)(BlockSource *source);
+  void *handle;
+  DatasetBlockFormat format;
+};
+
+typedef struct DatasetBlockReader_tag {
+  BlockSource *source;
+  char *arena;
+  int arenaSize;
+  bool ownsArena;
+  int blockLength;  /* bytes of the current block in the arena */
+  int offset;       /* next unread byte of the current block */
+  int blocksRead;
+  int recordsRead;
+} DatasetBlockReader;
+
+/* true when records of this format can be recovered from whole blocks */
+bool isBlockReadableFormat(const DatasetBlockFormat *format);
+
+#ifdef __ZOWE_OS_ZOS
+BlockSource *openDatasetBlockSource(const char *filename, const DatasetBlockFormat *format);
+#endif
+BlockSource *openFileBlockSource(const char *path, const DatasetBlockFormat *format);
+void closeBlockSource(BlockSource *source);
+
+/*
+  The arena holds one block at a time and is reused for every block. Pass NULL
+  to have the reader allocate one sized for the source's BLKSIZE; a caller
+  supplied arena must be at least that big.
+ */
+DatasetBlockReader *makeDatasetBlockReader(BlockSource *source, char *arena, int arenaSize);
+void freeDatasetBlockReader(DatasetBlockReader *reader);
+
+/*
+  Points *record into the arena at the next logical record. The record stays
+  valid until the next call. Returns BLOCK_READER_RC_OK, BLOCK_READER_RC_EOF or
+  a negative error code.
+ */
+int blockReaderNextRecord(DatasetBlockReader *reader, char **record, int *recordLength);
+
+/*
+  Moves past up to count records without handing them out. Whole FB blocks are
+  skipped by their record count and VB blocks by walking the RDWs, so skipped
+  data is never copied or decoded. *skipped receives the number of records
+  actually skipped, which is less than count only at end of data.
+ */
+int blockReaderSkipRecords(DatasetBlockReader *reader, int count, int *skipped);
+
+/*
+  Makes the next block available as a whole through *block without splitting it
+  into records. Only meaningful for fixed-length formats, where the block is the
+  concatenation of its records.
+ */
+int blockReaderNextBlock(DatasetBlockReader *reader, char **block, int *blockLength);
+
+#endif
+
+
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
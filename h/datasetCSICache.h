@@ -0,0 +1,136 @@
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
+
+#ifndef __DATASET_CSI_CACHE__
+#define __DATASET_CSI_CACHE__ 1
+
+#include <stdbool.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "zowetypes.h"
+
+/*
+  Keeps the results of catalog searches, so that browsing the same patterns
+  over and over does not run a CSI search for every request.
+
+  A result is what a search returned for a user, a pattern, the entry types
+  asked for, the work area size and the resume position, i.e. one page of a
+  search. Only the name, type and volser of each entry are kept, which is all
+  the listing needs from the catalog. Results are dropped once they are
+  ttlSeconds old, when room is needed for newer ones, either by count or by
+  the bytes they take, and when a dataset their pattern may match is created
+  or deleted through ZSS. Changes made outside ZSS show up after ttlSeconds.
+
+  Results are reference counted, so that one can be written out without
+  holding the lock while another request drops it from the cache.
+ */
+
+#define CSI_CACHE_PATTERN_LENGTH  44
+#define CSI_CACHE_NAME_LENGTH     44
+#define CSI_CACHE_TYPES_LENGTH    16
+#define CSI_CACHE_USER_LENGTH     16
+#define CSI_CACHE_VOLSER_LENGTH   6
+
+#define CSI_CACHE_DEFAULT_MAX_ENTRIES   128
+#define CSI_CACHE_DEFAULT_MAX_KILOBYTES 4096
+#define CSI_CACHE_DEFAULT_TTL_SECONDS   30
+
+/* Strings are NUL terminated, resume names are empty for the first page */
+typedef struct CSIQueryKey_tag {
+  char user[CSI_CACHE_USER_LENGTH + 1];
+  char pattern[CSI_CACHE_PATTERN_LENGTH + 1];
+  char types[CSI_CACHE_TYPES_LENGTH + 1];
+  int workAreaSize;
+  char resumeName[CSI_CACHE_NAME_LENGTH + 1];
+  char resumeCatalogName[CSI_CACHE_NAME_LENGTH + 1];
+} CSIQueryKey;
+
+typedef struct CSIDatasetEntry_tag {
+  char name[CSI_CACHE_NAME_LENGTH];             /* space padded */
+  char type;
+  bool hasVolser;
+  char volser[CSI_CACHE_VOLSER_LENGTH + 1];
+} CSIDatasetEntry;
+
+typedef struct CSIQueryResult_tag {
+  CSIQueryKey key;
+  bool hasMore;
+  char resumeName[CSI_CACHE_NAME_LENGTH];       /* as CSI returned them */
+  char resumeCatalogName[CSI_CACHE_NAME_LENGTH];
+  int entryCount;
+  CSIDatasetEntry *entries;                     /* in the same storage as the result */
+  int size;                                     /* bytes, which the cache accounts for */
+  int refCount;
+  bool cached;
+  time_t storedTime;
+  uint64 lastUsed;
+} CSIQueryResult;
+
+typedef struct CSIQueryCacheStats_tag {
+  uint64 hits;
+  uint64 misses;
+  uint64 stores;
+  uint64 evictions;
+  uint64 expirations;
+  uint64 invalidations;
+  int entries;
+  int64 bytes;
+} CSIQueryCacheStats;
+
+typedef struct CSIQueryCache_tag {
+  pthread_mutex_t lock;
+  int maxEntries;
+  int64 maxBytes;
+  int ttlSeconds;
+  CSIQueryResult **results;
+  int resultCount;
+  int64 bytesUsed;
+  uint64 clock;
+  CSIQueryCacheStats stats;
+} CSIQueryCache;
+
+CSIQueryCache *makeCSIQueryCache(int maxEntries, int64 maxBytes, int ttlSeconds);
+void freeCSIQueryCache(CSIQueryCache *cache);
+
+/* Room for entryCount entries, with entryCount left for the caller to set to
+   the number filled in. The caller holds the only reference. */
+CSIQueryResult *makeCSIQueryResult(const CSIQueryKey *key, int entryCount);
+
+/* Returns a result that is not ttlSeconds old with a reference the caller
+   must release, or NULL */
+CSIQueryResult *lookupCSIQueryResult(CSIQueryCache *cache, const CSIQueryKey *key);
+
+/* Adds the result to the cache, replacing any for the same key. The caller
+   keeps its reference. Results bigger than the cache are not kept. */
+void storeCSIQueryResult(CSIQueryCache *cache, CSIQueryResult *result);
+
+/* cache may be NULL for results that were never stored */
+void releaseCSIQueryResult(CSIQueryCache *cache, CSIQueryResult *result);
+
+/* Drops every result whose pattern could match dsn, which is space padded or
+   NUL terminated: those whose pattern, up to its first wildcard, is a prefix
+   of dsn */
+void invalidateCSIQueryResults(CSIQueryCache *cache, const char *dsn);
+
+void getCSIQueryCacheStats(CSIQueryCache *cache, CSIQueryCacheStats *stats);
+
+#endif
+
+
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
@@ -0,0 +1,138 @@
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
+
+#ifndef __DATASET_COPY__
+#define __DATASET_COPY__ 1
+
+#include <stdbool.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "zowetypes.h"
+
+/*
+  Copies the members of one PDS to another with a bounded pool of reader
+  threads feeding a single writer.
+
+  Readers claim members in directory order and stage each one in memory as
+  length prefixed records; the writer, which is the caller's thread, writes
+  the staged members to the target in the same order. Only a few members may
+  be claimed ahead of the writer, so the memory used is bounded by the pool
+  size and not by the size of the PDS. A member too big to stage, or one no
+  reader got to, is copied by the writer straight from the source.
+
+  Writes are kept on one thread because members of a PDS cannot be written
+  concurrently. Both datasets are expected to be allocated once by the caller,
+  with the member paths built from sourcePattern and targetPattern, for
+  example "DD:SYS00012(%s)", so members are opened without allocating each.
+
+  Readers take on the identity of the given user before they read anything,
+  the same way the HTTP server impersonates for requests.
+ */
+
+#define PDS_COPY_DEFAULT_WORKERS     4
+#define PDS_COPY_MAX_WORKERS         16
+#define PDS_COPY_MAX_STAGED_BYTES    0x400000 /* per member */
+#define PDS_COPY_USER_LENGTH         16
+#define PDS_COPY_PATH_LENGTH         64
+
+#define PDS_COPY_MEMBER_PENDING  0
+#define PDS_COPY_MEMBER_READING  1
+#define PDS_COPY_MEMBER_STAGED   2
+#define PDS_COPY_MEMBER_DIRECT   3  /* to be copied by the writer from the source */
+#define PDS_COPY_MEMBER_COPIED   4
+#define PDS_COPY_MEMBER_FAILED   5
+#define PDS_COPY_MEMBER_SKIPPED  6  /* the copy stopped before it */
+
+typedef struct PDSCopyMember_tag {
+  char name[9];                 /* null terminated, no padding */
+  int state;
+  char *staged;                 /* records, each prefixed by a 2 byte length */
+  int stagedLength;
+  int stagedSize;
+  int records;
+  int64 bytes;
+  const char *error;            /* static message when FAILED */
+} PDSCopyMember;
+
+typedef struct PDSCopyProgress_tag {
+  int membersTotal;
+  int membersCopied;
+  int membersFailed;
+  int64 recordsCopied;
+  int64 bytesCopied;
+  time_t startTime;
+  time_t endTime;               /* 0 while running */
+} PDSCopyProgress;
+
+typedef struct PDSCopy_tag {
+  char user[PDS_COPY_USER_LENGTH + 1];
+  char sourcePattern[PDS_COPY_PATH_LENGTH];
+  char targetPattern[PDS_COPY_PATH_LENGTH];
+  const char *sourceMode;       /* fopen modes, record mode by default */
+  const char *targetMode;
+  int sourceLrecl;
+  int targetLrecl;
+  bool targetFixed;             /* pad short records to targetLrecl */
+  char padByte;
+  PDSCopyMember *members;
+  int memberCount;
+  int workerCount;
+  int maxAhead;                 /* members claimed but not yet written */
+
+  pthread_mutex_t lock;
+  pthread_cond_t changed;
+  int nextToRead;
+  int nextToWrite;
+  bool cancelled;
+  PDSCopyProgress progress;
+} PDSCopy;
+
+/* members holds memberCount names of up to 8 characters. Returns NULL when a
+   pattern does not fit or holds anything but one %s. */
+PDSCopy *makePDSCopy(const char *user, const char *sourcePattern, const char *targetPattern,
+                     int sourceLrecl, int targetLrecl, bool targetFixed,
+                     const char **members, int memberCount, int workerCount);
+void freePDSCopy(PDSCopy *copy);
+
+/* Runs the copy on the calling thread with workerCount readers beside it and
+   returns the number of members that failed. A failed write stops the copy,
+   and the members after it are SKIPPED; a failed read only fails its member. */
+int runPDSCopy(PDSCopy *copy);
+
+/* Asks a running copy to stop after the member being written */
+void cancelPDSCopy(PDSCopy *copy);
+
+/* A consistent snapshot, safe to take from another thread */
+void getPDSCopyProgress(PDSCopy *copy, PDSCopyProgress *progress);
+
+void setDefaultPDSCopyWorkers(int workerCount);
+int getDefaultPDSCopyWorkers(void);
+
+/* Gives the calling thread the identity of user, for threads that work on
+   behalf of a request but are not the request's own thread. This goes through
+   startImpersonating without a password, as the HTTP server does for a
+   request; no APPLID is given, as ZSS has no APPLID setting. false when user
+   is empty or cannot be impersonated */
+bool startDatasetCopyIdentity(const char *user);
+void endDatasetCopyIdentity(const char *user);
+
+#endif
+
+
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
@@ -0,0 +1,152 @@
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
+
+#ifndef __DATASET_COPY_JOBS__
+#define __DATASET_COPY_JOBS__ 1
+
+#include <stdbool.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "zowetypes.h"
+#include "scheduling.h"
+
+/*
+  Copies that run after the request that asked for them has been answered.
+
+  A request prepares the copy, i.e. creates the target and allocates what the
+  copy reads and writes, and submits a CopyJob; a pool of RLE tasks takes jobs
+  in order and runs them as the user who submitted them. Callers poll the job
+  by id for its progress. Finished jobs are kept so that their outcome can be
+  read, until room is needed for new ones or they are older than
+  COPY_JOB_RETAIN_SECONDS.
+ */
+
+#define COPY_JOB_DEFAULT_WORKERS   2
+#define COPY_JOB_MAX_WORKERS       8
+#define COPY_JOB_DEFAULT_MAX_JOBS  64
+#define COPY_JOB_RETAIN_SECONDS    3600
+#define COPY_JOB_USER_LENGTH       16
+#define COPY_JOB_PATH_LENGTH       64
+#define COPY_JOB_MESSAGE_LENGTH    256
+#define COPY_JOB_ETAG_LENGTH       128
+#define COPY_JOB_MAX_FAILURES      32
+
+#define COPY_JOB_QUEUED     0
+#define COPY_JOB_RUNNING    1
+#define COPY_JOB_SUCCEEDED  2
+#define COPY_JOB_FAILED     3
+
+typedef struct CopyJobProgress_tag {
+  int membersTotal;             /* 0 for sequential copies */
+  int membersCopied;
+  int membersFailed;
+  int64 recordsCopied;
+  int64 bytesCopied;
+} CopyJobProgress;
+
+typedef struct CopyJobFailure_tag {
+  char name[9];
+  char error[64];
+} CopyJobFailure;
+
+/* What a poll sees, copied out of the job under the pool's lock */
+typedef struct CopyJobStatus_tag {
+  int id;
+  int state;
+  char user[COPY_JOB_USER_LENGTH + 1];
+  char source[COPY_JOB_PATH_LENGTH];
+  char target[COPY_JOB_PATH_LENGTH];
+  CopyJobProgress progress;
+  time_t queuedTime;
+  time_t startTime;
+  time_t endTime;
+  char message[COPY_JOB_MESSAGE_LENGTH];
+  char eTag[COPY_JOB_ETAG_LENGTH];
+  int failureCount;             /* may be more than the failures kept */
+  CopyJobFailure failures[COPY_JOB_MAX_FAILURES];
+} CopyJobStatus;
+
+typedef struct CopyJob_tag CopyJob;
+typedef struct CopyJobPool_tag CopyJobPool;
+
+/* Runs the copy on a worker and returns 0 when it succeeded. message and eTag
+   have COPY_JOB_MESSAGE_LENGTH and COPY_JOB_ETAG_LENGTH bytes. */
+typedef int CopyJobRunner(CopyJob *job, char *message, char *eTag);
+/* Optional. Reads the progress of a running job from wherever the runner
+   keeps it, under the pool's lock. */
+typedef void CopyJobProgressReader(CopyJob *job, CopyJobProgress *progress);
+/* Releases userData and whatever was allocated for the copy. Called once,
+   after the job ran or when it could not be submitted. */
+typedef void CopyJobCleanup(CopyJob *job);
+
+struct CopyJob_tag {
+  CopyJobStatus status;
+  CopyJobRunner *run;
+  CopyJobProgressReader *readProgress;
+  CopyJobCleanup *cleanup;
+  void *userData;
+  CopyJobPool *pool;
+  CopyJob *next;                /* in the queue */
+};
+
+typedef struct CopyJobPoolStats_tag {
+  uint64 submitted;
+  uint64 rejected;
+  uint64 succeeded;
+  uint64 failed;
+} CopyJobPoolStats;
+
+struct CopyJobPool_tag {
+  pthread_mutex_t lock;
+  pthread_cond_t queued;
+  CopyJob **jobs;               /* every job kept, in submission order */
+  int jobCount;
+  int maxJobs;
+  CopyJob *queueHead;
+  CopyJob *queueTail;
+  int nextId;
+  int workerCount;
+  int workersRunning;
+  CopyJobPoolStats stats;
+};
+
+/* Starts workerCount RLE tasks on anchor. Returns NULL when none started. */
+CopyJobPool *makeCopyJobPool(RLEAnchor *anchor, int workerCount, int maxJobs);
+
+CopyJob *makeCopyJob(const char *user, const char *source, const char *target,
+                     CopyJobRunner *run, CopyJobCleanup *cleanup, void *userData);
+
+/* Returns the job id, or -1 when the pool holds maxJobs unfinished jobs, in
+   which case the job has been cleaned up and freed */
+int submitCopyJob(CopyJobPool *pool, CopyJob *job);
+
+/* false when there is no job id submitted by user */
+bool getCopyJobStatus(CopyJobPool *pool, int id, const char *user, CopyJobStatus *status);
+
+/* For runners, which may call them from any thread */
+void setCopyJobProgress(CopyJob *job, const CopyJobProgress *progress);
+void addCopyJobFailure(CopyJob *job, const char *name, const char *error);
+
+const char *getCopyJobStateName(int state);
+void getCopyJobPoolStats(CopyJobPool *pool, CopyJobPoolStats *stats);
+
+#endif
+
+
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
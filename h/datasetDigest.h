@@ -0,0 +1,105 @@
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
+
+#ifndef __DATASET_DIGEST__
+#define __DATASET_DIGEST__ 1
+
+#include <stdint.h>
+#ifdef __ZOWE_OS_ZOS
+#include "icsf.h"
+#endif
+
+/*
+  Hashing for dataset etags. Data given to datasetDigestUpdate is collected in
+  a batch buffer and only handed to the backend when the buffer is full or the
+  digest is finished, so that hashing record by record costs one backend call
+  per batch rather than one per record. That matters most for ICSF, where every
+  call goes through the callable service.
+
+  Besides ICSF there are portable implementations of SHA-1, which gives the
+  same etags as ICSF, and of xxHash64, which is much cheaper but gives
+  different ones. Switching between the two families makes the etags clients
+  hold stale, so they have to re-read before their next save.
+
+  Errors are sticky: once the backend fails every later call is a no-op that
+  returns the same code, so callers can check only the result of finish.
+ */
+
+#define DATASET_DIGEST_ICSF_SHA1 1  /* z/OS only */
+#define DATASET_DIGEST_SHA1      2
+#define DATASET_DIGEST_XXHASH64  3
+
+#define DATASET_DIGEST_MAX_HASH_LENGTH 20
+#define DATASET_DIGEST_MAX_HEX_LENGTH  (DATASET_DIGEST_MAX_HASH_LENGTH * 2)
+#define DATASET_DIGEST_BATCH_SIZE      0x10000
+
+#define DATASET_DIGEST_RC_OK          0
+#define DATASET_DIGEST_RC_UNSUPPORTED -1
+
+typedef struct DigestSHA1_tag {
+  uint32_t h[5];
+  uint64_t length;        /* bytes hashed so far */
+  unsigned char block[64];
+  int blockUsed;
+} DigestSHA1;
+
+typedef struct DigestXXH64_tag {
+  uint64_t v[4];
+  uint64_t length;
+  unsigned char stripe[32];
+  int stripeUsed;
+} DigestXXH64;
+
+typedef struct DatasetDigest_tag {
+  int type;
+  int hashLength;
+  int rc;
+  char *batch;            /* NULL hands every update straight to the backend */
+  int batchSize;
+  int batchUsed;
+  uint64_t backendCalls;  /* updates that reached the backend */
+  union {
+#ifdef __ZOWE_OS_ZOS
+    ICSFDigest icsf;
+#endif
+    DigestSHA1 sha1;
+    DigestXXH64 xxh64;
+  } state;
+} DatasetDigest;
+
+/* type 0 uses the default type. batch may be NULL, or a caller owned buffer
+   that must stay valid until the digest is finished. */
+int datasetDigestInit(DatasetDigest *digest, int type, char *batch, int batchSize);
+int datasetDigestUpdate(DatasetDigest *digest, const char *data, int length);
+/* hash receives hashLength bytes */
+int datasetDigestFinish(DatasetDigest *digest, char *hash);
+/* hex receives 2 * hashLength characters and a null */
+int datasetDigestFinishHex(DatasetDigest *digest, char *hex);
+
+/* "icsf-sha1", "sha1" or "xxhash64"; returns 0 for names not known or not
+   supported on this platform */
+int getDatasetDigestType(const char *name);
+const char *getDatasetDigestName(int type);
+
+void setDefaultDatasetDigestType(int type);
+int getDefaultDatasetDigestType(void);
+
+#endif
+
+
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
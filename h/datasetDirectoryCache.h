@@ -0,0 +1,143 @@
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
+
+#ifndef __DATASET_DIRECTORY_CACHE__
+#define __DATASET_DIRECTORY_CACHE__ 1
+
+#include <stdbool.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "zowetypes.h"
+#include "datasetETagCache.h"
+
+/*
+  Keeps the directories of PDSs and PDSEs, so that listing the members of a
+  large library does not read its whole directory for every request.
+
+  A directory is kept per user it was read for, as reading it is what checks
+  that the user may. It holds the members' directory entries in collating
+  order, as they are stored, so the members matching a pattern that starts
+  with a literal prefix, such as ABC*, are found with two binary searches. A
+  directory is only used when the change indicators given at lookup, which
+  the caller takes from the dataset's DSCB, are byte for byte those it was
+  stored with. Members added, deleted or renamed without the DSCB changing
+  show up when the directory is dropped: after ttlSeconds, or at once when
+  ZSS itself changed the members. That is any change to a PDSE, and on a PDS
+  a member deleted or renamed by STOW alone, which only rewrites a directory
+  block. Catching those would mean reading the directory the cache is there
+  to save, so ttlSeconds is kept short.
+
+  Directories are reference counted like catalog search results, so a large
+  one can be written out without holding the lock.
+ */
+
+#define DIRECTORY_CACHE_DSN_LENGTH        44
+#define DIRECTORY_CACHE_MEMBER_LENGTH     8
+#define DIRECTORY_CACHE_USER_LENGTH       16
+/* TTR, the C byte and up to 31 halfwords of user data */
+#define DIRECTORY_CACHE_MAX_ENTRY_DATA    66
+
+#define DIRECTORY_CACHE_DEFAULT_MAX_ENTRIES   32
+#define DIRECTORY_CACHE_DEFAULT_MAX_KILOBYTES 16384
+#define DIRECTORY_CACHE_DEFAULT_TTL_SECONDS   10
+
+typedef struct PDSMemberEntry_tag {
+  char name[DIRECTORY_CACHE_MEMBER_LENGTH];
+  unsigned char dataLength;
+  char data[DIRECTORY_CACHE_MAX_ENTRY_DATA];    /* the directory entry past the name */
+} PDSMemberEntry;
+
+typedef struct PDSDirectory_tag {
+  char dsn[DIRECTORY_CACHE_DSN_LENGTH];         /* space padded */
+  char user[DIRECTORY_CACHE_USER_LENGTH + 1];
+  DatasetChangeIndicators indicators;
+  int memberCount;
+  int capacity;
+  PDSMemberEntry *members;                      /* in collating order */
+  int size;                                     /* bytes, which the cache accounts for */
+  int refCount;
+  bool cached;
+  time_t storedTime;
+  uint64 lastUsed;
+} PDSDirectory;
+
+typedef struct PDSDirectoryCacheStats_tag {
+  uint64 hits;
+  uint64 misses;
+  uint64 changes;
+  uint64 stores;
+  uint64 evictions;
+  uint64 expirations;
+  uint64 invalidations;
+  int entries;
+  int64 bytes;
+} PDSDirectoryCacheStats;
+
+typedef struct PDSDirectoryCache_tag {
+  pthread_mutex_t lock;
+  int maxEntries;
+  int64 maxBytes;
+  int ttlSeconds;
+  PDSDirectory **directories;
+  int directoryCount;
+  int64 bytesUsed;
+  uint64 clock;
+  PDSDirectoryCacheStats stats;
+} PDSDirectoryCache;
+
+PDSDirectoryCache *makePDSDirectoryCache(int maxEntries, int64 maxBytes, int ttlSeconds);
+
+/* An empty directory with room for capacity members, of which the caller
+   holds the only reference */
+PDSDirectory *makePDSDirectory(const char *dsn, const char *user,
+                               const DatasetChangeIndicators *indicators, int capacity);
+
+/* Appends a member, growing the directory when it is full. Members must be
+   added in collating order, and only before the directory is stored. */
+void addPDSMember(PDSDirectory *directory, const char *name, const char *data, int dataLength);
+
+/* Returns the directory of dsn read for user, stored with the same indicators
+   and not ttlSeconds old, with a reference the caller must release, or NULL */
+PDSDirectory *lookupPDSDirectory(PDSDirectoryCache *cache, const char *dsn, const char *user,
+                                 const DatasetChangeIndicators *indicators);
+
+/* Adds the directory to the cache, replacing any for the same dataset and user. The
+   caller keeps its reference. Directories bigger than the cache are not kept. */
+void storePDSDirectory(PDSDirectoryCache *cache, PDSDirectory *directory);
+
+/* cache may be NULL for directories that were never stored */
+void releasePDSDirectory(PDSDirectoryCache *cache, PDSDirectory *directory);
+
+/* Drops the directories of dsn, for every user */
+void invalidatePDSDirectory(PDSDirectoryCache *cache, const char *dsn);
+
+/*
+  Sets first and end to the range of members whose names start with the first
+  prefixLength characters of prefix, and begin at or after from when from is
+  not NULL. from is space padded.
+ */
+void findPDSMemberRange(const PDSDirectory *directory, const char *prefix, int prefixLength,
+                        const char *from, int *first, int *end);
+
+void getPDSDirectoryCacheStats(PDSDirectoryCache *cache, PDSDirectoryCacheStats *stats);
+
+#endif
+
+
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
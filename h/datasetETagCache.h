@@ -0,0 +1,95 @@
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
+
+#ifndef __DATASET_ETAG_CACHE__
+#define __DATASET_ETAG_CACHE__ 1
+
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "zowetypes.h"
+
+/*
+  Remembers the etag (content hash) of datasets and members together with
+  metadata that changes whenever the content does, so an etag check can be
+  answered without reading the data. An entry is only used when the change
+  indicators given at lookup are byte for byte those it was stored with; any
+  difference is a miss and the caller hashes the content as before.
+
+  What the indicators are is up to the caller. For PDS and PDSE members the
+  directory entry is used: a member that is rewritten gets a new TTR, and
+  editors update the ISPF statistics in the user data.
+ */
+
+#define ETAG_CACHE_DSN_LENGTH        44
+#define ETAG_CACHE_MEMBER_LENGTH     8
+#define ETAG_CACHE_MAX_ETAG_LENGTH   64
+#define ETAG_CACHE_MAX_INDICATORS    72
+
+#define ETAG_CACHE_WAYS               4
+#define ETAG_CACHE_DEFAULT_MAX_ENTRIES 256
+
+typedef struct DatasetChangeIndicators_tag {
+  int length;
+  char data[ETAG_CACHE_MAX_INDICATORS];
+} DatasetChangeIndicators;
+
+typedef struct DatasetETagEntry_tag {
+  char dsn[ETAG_CACHE_DSN_LENGTH];
+  char member[ETAG_CACHE_MEMBER_LENGTH];
+  DatasetChangeIndicators indicators;
+  char eTag[ETAG_CACHE_MAX_ETAG_LENGTH + 1];
+  uint64 lastUsed;
+  bool valid;
+} DatasetETagEntry;
+
+typedef struct DatasetETagCacheStats_tag {
+  uint64 hits;
+  uint64 misses;
+  uint64 stores;
+  uint64 invalidations;
+  int entries;
+} DatasetETagCacheStats;
+
+typedef struct DatasetETagCache_tag {
+  pthread_mutex_t lock;
+  int setCount;          /* entries are kept in sets of ETAG_CACHE_WAYS */
+  DatasetETagEntry *entries;
+  uint64 clock;
+  DatasetETagCacheStats stats;
+} DatasetETagCache;
+
+DatasetETagCache *makeDatasetETagCache(int maxEntries);
+void freeDatasetETagCache(DatasetETagCache *cache);
+
+/* dsn and member are space padded. Copies the etag to eTag, which must hold
+   ETAG_CACHE_MAX_ETAG_LENGTH + 1 bytes, and returns true on a hit. */
+bool lookupDatasetETag(DatasetETagCache *cache, const char *dsn, const char *member,
+                       const DatasetChangeIndicators *indicators, char *eTag);
+void storeDatasetETag(DatasetETagCache *cache, const char *dsn, const char *member,
+                      const DatasetChangeIndicators *indicators, const char *eTag);
+
+/* member NULL drops the dataset and all its members */
+void invalidateDatasetETag(DatasetETagCache *cache, const char *dsn, const char *member);
+
+void getDatasetETagCacheStats(DatasetETagCache *cache, DatasetETagCacheStats *stats);
+
+#endif
+
+
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
@@ -0,0 +1,127 @@
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
+
+#ifndef __DATASET_HLQ_CACHE__
+#define __DATASET_HLQ_CACHE__ 1
+
+#include <stdbool.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "zowetypes.h"
+#include "scheduling.h"
+#include "datasetCSICache.h"
+
+/*
+  The list of high level qualifiers, kept as one catalog search result per
+  first character of the HLQ, i.e. per bucket.
+
+  Buckets are immutable once published. A refresh searches for a new bucket
+  without holding the lock and then swaps the pointer, so a reader is never
+  held up by a catalog search: it takes references to the buckets of the
+  moment, which stay valid until it releases them even when newer ones are
+  published meanwhile, and the last reference frees a replaced bucket.
+
+  A bucket older than ttlSeconds is still served, and queued for the
+  refresher task, which searches it again as the user whose read found it
+  stale; a read without a user does not queue a refresh. A single refresher
+  takes the queued buckets one at a time, so a slow catalog also delays the
+  refresh of every bucket queued behind it, though never a read.
+
+  The cache is built by the first read, and again when a read asks for that;
+  the 29 searches of a build are independent and are spread over
+  searchWorkers threads beside the reading one, so that a build takes about
+  as long as the slowest catalog.
+ */
+
+#define HLQ_CACHE_BUCKET_COUNT          29
+#define HLQ_CACHE_USER_LENGTH           16
+
+#define HLQ_CACHE_DEFAULT_TTL_SECONDS   300
+#define HLQ_CACHE_DEFAULT_SEARCH_WORKERS 8
+#define HLQ_CACHE_MAX_SEARCH_WORKERS    (HLQ_CACHE_BUCKET_COUNT - 1)
+
+extern const char hlqCacheFirstChars[HLQ_CACHE_BUCKET_COUNT];
+
+/* Searches the catalog for the HLQs starting with firstChar, as user, or as
+   the calling thread when user is NULL. Returns a result holding the only
+   reference, or NULL when the search failed. */
+typedef CSIQueryResult *HLQSearch(void *userData, const char *user, char firstChar,
+                                  const char *types, int workAreaSize);
+
+typedef struct HLQSnapshot_tag {
+  CSIQueryResult *buckets[HLQ_CACHE_BUCKET_COUNT];  /* NULL for a search that failed */
+} HLQSnapshot;
+
+typedef struct HLQCacheStats_tag {
+  uint64 hits;
+  uint64 staleHits;
+  uint64 misses;
+  uint64 refreshes;
+  uint64 refreshFailures;
+  int pendingRefreshes;
+} HLQCacheStats;
+
+typedef struct HLQCache_tag {
+  pthread_mutex_t lock;
+  pthread_cond_t refreshQueued;
+  HLQSearch *search;
+  void *searchData;
+  int ttlSeconds;                    /* 0 keeps buckets until a rebuild */
+  int searchWorkers;
+  bool built;
+  char types[CSI_CACHE_TYPES_LENGTH + 1];
+  int workAreaSize;
+  uint64 generation;                 /* changes with every rebuild */
+  CSIQueryResult *buckets[HLQ_CACHE_BUCKET_COUNT];
+  time_t refreshedTime[HLQ_CACHE_BUCKET_COUNT];
+  bool refreshPending[HLQ_CACHE_BUCKET_COUNT];
+  char refreshUser[HLQ_CACHE_BUCKET_COUNT][HLQ_CACHE_USER_LENGTH + 1];
+  bool refresherRunning;
+  HLQCacheStats stats;
+} HLQCache;
+
+HLQCache *makeHLQCache(HLQSearch *search, void *searchData, int ttlSeconds, int searchWorkers);
+
+/* Starts the refresher as an RLE task. Without it stale buckets are served
+   until the next rebuild. */
+bool startHLQCacheRefresher(HLQCache *cache, RLEAnchor *anchor);
+
+/*
+  Fills snapshot with references to the buckets and returns true, or returns
+  false when the cache was not built for types and workAreaSize. Stale
+  buckets are queued for refresh as user, unless user is NULL or empty.
+ */
+bool acquireHLQSnapshot(HLQCache *cache, const char *user, const char *types, int workAreaSize,
+                        HLQSnapshot *snapshot);
+
+/* Searches every bucket, on the calling thread and on searchWorkers threads
+   running as user, publishes the results for types and workAreaSize and
+   fills snapshot with them. A failed search keeps the bucket there was, if it
+   was for the same types. */
+void rebuildHLQCache(HLQCache *cache, const char *user, const char *types, int workAreaSize,
+                     HLQSnapshot *snapshot);
+
+void releaseHLQSnapshot(HLQCache *cache, HLQSnapshot *snapshot);
+
+void getHLQCacheStats(HLQCache *cache, HLQCacheStats *stats);
+
+#endif
+
+
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
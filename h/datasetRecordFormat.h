@@ -0,0 +1,48 @@
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
+
+#ifndef __DATASET_RECORD_FORMAT__
+#define __DATASET_RECORD_FORMAT__ 1
+
+#include <stdbool.h>
+
+/*
+  Fitting records given for a write to the dataset's LRECL. Whatever is past
+  the LRECL may only be blanks, anything up to X'40' counting as one, and is
+  dropped; fixed records shorter than the LRECL are padded. The checks look at
+  a word at a time and the copies are single memcpy/memset calls, rather than
+  going a byte at a time or through snprintf.
+ */
+
+#define DATASET_RECORD_BLANK_MAX 0x40
+
+/* Offset of the first byte at or past lrecl that is not a blank, or -1 when
+   the record fits */
+int findDatasetRecordOverflow(const char *record, int length, int lrecl);
+
+/* The record as it is to be written, trimmed to lrecl and, when fixed, padded
+   to it with pad. That is the record itself when it needs neither, otherwise
+   a copy in buffer, which must hold lrecl bytes. *outLength receives the
+   length; what was past lrecl is not checked here. */
+const char *formatDatasetRecord(const char *record, int length, int lrecl, bool fixed,
+                                char pad, char *buffer, int *outLength);
+
+#endif
+
+
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
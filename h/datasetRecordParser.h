@@ -0,0 +1,144 @@
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
+
+#ifndef __DATASET_RECORD_PARSER__
+#define __DATASET_RECORD_PARSER__ 1
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+  Incremental parser for dataset write bodies of the form
+
+    {"records": ["...", "...", ...], "etag": "..."}
+
+  Input is pushed in pieces of any size and each element of the records array
+  is handed to the record handler as soon as its closing quote is seen, with
+  escapes decoded to UTF-8. Nothing but the string being parsed is kept, so
+  memory does not grow with the number of records. Other string members of
+  the root object go to the property handler; members of any other type are
+  checked for syntax and skipped.
+
+  With fields set, records are instead objects such as
+
+    {"key": "...", "record": "..."}
+
+  and the string members named are handed to the fields handler together
+  when the record's closing brace is seen. Other members are skipped.
+
+  Root keys must be unique, so a second "records" member is an error rather
+  than more records. Keys over RECORD_PARSER_MAX_KEY bytes cannot name a
+  member of interest and are not checked. Escaped surrogates must come as a
+  high/low pair; a lone one has no UTF-8 form and is a syntax error.
+
+  Raw control characters inside strings are accepted as they are, as the DOM
+  parser used before did not reject them either.
+ */
+
+#define RECORD_PARSER_MAX_DEPTH     64
+#define RECORD_PARSER_MAX_KEY       32
+#define RECORD_PARSER_MAX_ROOT_KEYS 16
+#define RECORD_PARSER_MAX_FIELDS    4
+
+#define RECORD_PARSER_RC_OK            0
+#define RECORD_PARSER_RC_SYNTAX        1  /* errorOffset is set */
+#define RECORD_PARSER_RC_NOT_AN_OBJECT 2
+#define RECORD_PARSER_RC_NOT_A_STRING  3  /* errorIndex is the record position; with
+                                             fields, the record or field has the wrong type */
+#define RECORD_PARSER_RC_TOO_LONG      4  /* a string was over maxStringLength */
+#define RECORD_PARSER_RC_TOO_DEEP      5
+#define RECORD_PARSER_RC_INCOMPLETE    6  /* input ended inside the root object */
+#define RECORD_PARSER_RC_HANDLER       7  /* handlerRC is what the handler returned */
+#define RECORD_PARSER_RC_DUPLICATE_KEY 8  /* a root key, or a field of record errorIndex,
+                                             is repeated */
+#define RECORD_PARSER_RC_TOO_MANY_KEYS 9  /* over RECORD_PARSER_MAX_ROOT_KEYS root keys */
+
+/* value is not null-terminated. Returning non-zero stops the parse. */
+typedef int JsonRecordHandler(void *userData, const char *value, int length, int index);
+typedef int JsonPropertyHandler(void *userData, const char *name, const char *value, int length);
+/* values are in the order the fields were named in, NULL for those left out */
+typedef int JsonRecordFieldsHandler(void *userData, const char **values, const int *lengths, int index);
+
+typedef struct JsonRecordParser_tag {
+  JsonRecordHandler *recordHandler;
+  JsonPropertyHandler *propertyHandler;
+  void *userData;
+
+  /* lexer */
+  int tokenState;
+  bool keepString;
+  char *string;
+  int stringLength;
+  int stringCapacity;
+  int maxStringLength;
+  unsigned int codePoint;
+  int hexDigits;
+  unsigned int highSurrogate;
+  char literal[32];
+  int literalLength;
+
+  /* grammar */
+  int depth;
+  char containers[RECORD_PARSER_MAX_DEPTH];
+  char expect[RECORD_PARSER_MAX_DEPTH];
+  char key[RECORD_PARSER_MAX_KEY + 1]; /* last key of the root object */
+  char rootKeys[RECORD_PARSER_MAX_ROOT_KEYS][RECORD_PARSER_MAX_KEY];
+  int rootKeyLengths[RECORD_PARSER_MAX_ROOT_KEYS];
+  int rootKeyCount;
+  bool inRecords;
+  bool hasRecords;                     /* once the records array is opened */
+  bool rootDone;
+  int recordIndex;
+
+  /* record objects */
+  JsonRecordFieldsHandler *fieldsHandler;
+  const char *fieldNames[RECORD_PARSER_MAX_FIELDS];
+  int fieldCount;
+  int field;                            /* of the member being parsed, -1 for others */
+  bool fieldSeen[RECORD_PARSER_MAX_FIELDS];
+  char *fieldValues[RECORD_PARSER_MAX_FIELDS];
+  int fieldLengths[RECORD_PARSER_MAX_FIELDS];
+  int fieldCapacities[RECORD_PARSER_MAX_FIELDS];
+
+  int64_t offset;
+  int rc;
+  int handlerRC;
+  int64_t errorOffset;
+  int errorIndex;
+} JsonRecordParser;
+
+/* maxStringLength bounds the decoded length of strings handed to handlers */
+void initJsonRecordParser(JsonRecordParser *parser, int maxStringLength,
+                          JsonRecordHandler *recordHandler,
+                          JsonPropertyHandler *propertyHandler,
+                          void *userData);
+void termJsonRecordParser(JsonRecordParser *parser);
+
+/* Makes records objects, of which the string members named are kept, up to
+   RECORD_PARSER_MAX_FIELDS. names are UTF-8 and must outlive the parser. */
+void setJsonRecordParserFields(JsonRecordParser *parser, const char **names, int count,
+                               JsonRecordFieldsHandler *handler);
+
+/* Both return RECORD_PARSER_RC_OK or the first error, which sticks */
+int jsonRecordParserFeed(JsonRecordParser *parser, const char *data, int length);
+int jsonRecordParserFinish(JsonRecordParser *parser);
+
+#endif
+
+
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
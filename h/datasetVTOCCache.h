@@ -0,0 +1,117 @@
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
+
+#ifndef __DATASET_VTOC_CACHE__
+#define __DATASET_VTOC_CACHE__ 1
+
+#include <stdbool.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "zowetypes.h"
+
+/*
+  Looks up the format 1 (or 8) DSCBs of many datasets at once, as a detailed
+  listing does for every dataset it returns.
+
+  The lookups are sorted by volume and dataset name, so that the DSCBs of a
+  volume are read one after the other and a dataset asked for twice is only
+  read once. DSCBs that were read are kept per volume for ttlSeconds, counted
+  from when the first of them was read, so that browsing the same listing
+  again does not read the VTOCs again. A volume's DSCBs are dropped together
+  once they are too old, the least recently used volume makes room for a new
+  one, and a volume keeps at most maxDatasetsPerVolume DSCBs. The DSCBs of a
+  dataset that is created or deleted through ZSS are dropped right away;
+  other changes, such as the space used growing, show up after ttlSeconds.
+ */
+
+#define VTOC_CACHE_DSCB_SIZE        96
+#define VTOC_CACHE_NAME_LENGTH      44
+#define VTOC_CACHE_VOLSER_LENGTH    6
+
+#define VTOC_CACHE_DEFAULT_MAX_VOLUMES              64
+#define VTOC_CACHE_DEFAULT_MAX_DATASETS_PER_VOLUME  1024
+#define VTOC_CACHE_DEFAULT_TTL_SECONDS              30
+
+/* Reads the DSCB of dsname on volser, both space padded, and returns the
+   OBTAIN return code */
+typedef int VTOCObtain(void *userData, const char *dsname, const char *volser, char *dscb);
+
+typedef struct DSCBRequest_tag {
+  char name[VTOC_CACHE_NAME_LENGTH];            /* space padded */
+  char volser[VTOC_CACHE_VOLSER_LENGTH];        /* space padded */
+  char dscb[VTOC_CACHE_DSCB_SIZE];              /* set when rc is 0 */
+  int rc;
+} DSCBRequest;
+
+typedef struct VTOCDataset_tag {
+  char name[VTOC_CACHE_NAME_LENGTH];
+  char dscb[VTOC_CACHE_DSCB_SIZE];
+} VTOCDataset;
+
+typedef struct VTOCVolume_tag {
+  char volser[VTOC_CACHE_VOLSER_LENGTH];
+  time_t filledTime;
+  uint64 lastUsed;
+  int datasetCount;
+  VTOCDataset *datasets;                        /* sorted by name */
+} VTOCVolume;
+
+typedef struct VTOCCacheStats_tag {
+  uint64 hits;
+  uint64 misses;
+  uint64 obtains;
+  uint64 duplicates;
+  uint64 expirations;
+  uint64 evictions;
+  uint64 invalidations;
+  int volumes;
+  int datasets;
+} VTOCCacheStats;
+
+typedef struct VTOCCache_tag {
+  pthread_mutex_t lock;
+  int maxVolumes;
+  int maxDatasetsPerVolume;
+  int ttlSeconds;
+  VTOCVolume *volumes;
+  int volumeCount;
+  uint64 clock;
+  VTOCCacheStats stats;
+} VTOCCache;
+
+VTOCCache *makeVTOCCache(int maxVolumes, int maxDatasetsPerVolume, int ttlSeconds);
+
+/*
+  Fills in the DSCB and rc of every request, from the cache or with obtain.
+  cache may be NULL, which still reads a dataset asked for twice only once.
+  obtain is called without the lock held.
+ */
+void obtainDSCBs(VTOCCache *cache, VTOCObtain *obtain, void *userData,
+                 DSCBRequest *requests, int requestCount);
+
+/* Drops the DSCBs kept for dsn, which is space padded or NUL terminated, on
+   every volume */
+void invalidateVTOCCacheDataset(VTOCCache *cache, const char *dsn);
+
+void getVTOCCacheStats(VTOCCache *cache, VTOCCacheStats *stats);
+
+#endif
+
+
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
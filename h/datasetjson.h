@@ -18,9 +18,26 @@
 #include "json.h"
 #include "xml.h"
 #include "jcsi.h"
+#include "datasetAllocCache.h"
+#include "datasetETagCache.h"
+#include "datasetCopyJobs.h"
+#include "datasetCSICache.h"
+#include "datasetVTOCCache.h"
+#include "datasetDirectoryCache.h"
+#include "datasetHLQCache.h"
+#include "datasetACBPool.h"
 
 #define DATA_STREAM_BUFFER_SIZE 4096
 
+/* Values of jsonMode for respondWithDataset and updateDataset. JSON is the
+   {"records":[...]} body, TEXT has each record followed by a newline
+   (text/plain, UTF-8) and BINARY has each record prefixed by its RDW
+   (application/octet-stream). The VSAM counterparts take JSON, or BINARY as
+   frames of a length-prefixed key and a length-prefixed record. */
+#define DATASET_CONTENT_MODE_JSON   TRUE
+#define DATASET_CONTENT_MODE_TEXT   2
+#define DATASET_CONTENT_MODE_BINARY 3
+
 #define SAF_AUTHORIZATION_READ 0x04
 #define SAF_AUTHORIZATION_UPDATE 0x08
 #define MEMBER_MAX 8
@@ -28,29 +45,13 @@
 #define DATASET_MEMBER_MAXLEN DATASET_PATH_MAX + MEMBER_MAX + 6 /* 6 is for extra characters in filepath -- //, '', () */
 
 typedef struct MetadataQueryCache_tag{
-  EntryDataSet *cachedHLQSet;
-  csi_parmblock * __ptr32 * __ptr32 cachedCSIParmblocks;
+  HLQCache *hlqCache;
 } MetadataQueryCache;
 
 typedef struct serveVSAMCache_tag{
-  hashtable *acbTable;
+  ACBPool *acbPool;
 } serveVSAMCache;
 
-typedef struct StatefulACB_tag {
-  char *acb; /* contains 8-byte plist */
-#define VSAM_TYPE_KSDS  1
-#define VSAM_TYPE_ESDS  2
-#define VSAM_TYPE_LDS   3
-#define VSAM_TYPE_RRDS  4
-  int type;
-  union {
-    char *key;
-    int rba;
-    int ci;
-    int record;
-  } argPtr;
-} StatefulACB;
-
 int streamDataset(char *filename, int recordLength, jsonPrinter *jPrinter);
 int streamVSAMDataset(HttpResponse* response, char *acb, int maxRecordLength, int maxRecords, int maxBytes, int keyLoc, int keyLen, jsonPrinter *jPrinter);
 void addDetailedDatasetMetadata(char *datasetName, int nameLength,
@@ -60,19 +61,48 @@ void addMemberedDatasetMetadata(char *datasetName, int nameLength,
                                 char *volser, int volserLength,
                                 char *memberQuery, int memberLength,
                                 jsonPrinter *jPrinter,
-                                int includeUnprintable);
+                                int includeUnprintable, int includeStats);
 void respondWithDataset(HttpResponse* response, char* absolutePath, int jsonMode);
-void respondWithVSAMDataset(HttpResponse* response, char* absolutePath, hashtable *acbTable, int jsonMode);
+void respondWithVSAMDataset(HttpResponse* response, char* absolutePath, ACBPool *acbPool, int jsonMode);
 void respondWithDatasetMetadata(HttpResponse *response);
+/* HLQ buckets older than ttlSeconds are refreshed, 0 keeps them until
+   updateCache=true. Builds search with searchWorkers threads beside the
+   request's. */
+MetadataQueryCache *makeMetadataQueryCache(int ttlSeconds, int searchWorkers);
 void respondWithHLQNames(HttpResponse *response, MetadataQueryCache *metadataQueryCache);
 void createDatasetAndRespond(HttpResponse* response, char* absolutePath, int jsonMode);
 void updateDataset(HttpResponse* response, char* absolutePath, int jsonMode);
-void updateVSAMDataset(HttpResponse* response, char* absolutePath, hashtable *acbTable, int jsonMode);
-void deleteVSAMDataset(HttpResponse* response, char* absolutePath);
+void updateVSAMDataset(HttpResponse* response, char* absolutePath, ACBPool *acbPool, int jsonMode);
+void deleteVSAMDataset(HttpResponse* response, char* absolutePath, ACBPool *acbPool);
 void deleteDatasetFromRequest(HttpResponse* response, char* absolutePath);
-void copyDatasetAndRespond(HttpResponse *response, char* sourceDataset, char* targetDataset);
+/* With async the copy runs as a copy job and the response carries its id */
+void copyDatasetAndRespond(HttpResponse *response, char* sourceDataset, char* targetDataset, bool async);
+void respondWithCopyJob(HttpResponse *response, char *jobId);
 char getCSIType(char* absolutePath);
 bool isVsam(char CSIType);
+#ifdef __ZOWE_OS_ZOS
+/* Looks VSAM datasets up in the catalog and opens them for input */
+extern const ACBOpener vsamInputACBOpener;
+#endif
+
+/* Reads allocate through this cache when one is set; NULL allocates per request */
+void setDatasetAllocCache(DatasetAllocCache *cache);
+DatasetAllocCache *getDatasetAllocCache(void);
+/* Lets etag checks before writes skip hashing members that did not change */
+void setDatasetETagCache(DatasetETagCache *cache);
+DatasetETagCache *getDatasetETagCache(void);
+/* Runs copies asked for with async; NULL when copy jobs are disabled */
+void setCopyJobPool(CopyJobPool *pool);
+CopyJobPool *getCopyJobPool(void);
+/* Dataset listings reuse recent catalog searches when one is set */
+void setCSIQueryCache(CSIQueryCache *cache);
+CSIQueryCache *getCSIQueryCache(void);
+/* Detailed listings reuse recently read DSCBs when one is set */
+void setVTOCCache(VTOCCache *cache);
+VTOCCache *getVTOCCache(void);
+/* Member lists reuse directories that did not change when one is set */
+void setPDSDirectoryCache(PDSDirectoryCache *cache);
+PDSDirectoryCache *getPDSDirectoryCache(void);
 #endif
 
 
@@ -0,0 +1,262 @@
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
+
+/*
+  Checks the policy of the dataset allocation cache against a fake allocator
+  that hands out DD names and records what is still allocated: reuse per user,
+  dataset and member, eviction of the least recently used entry, allocations
+  that do not fit, invalidation while in use, idle sweeps and allocation
+  failures.
+
+    cc -O2 -I ../h -I ../../deps/zowe-common-c/h -o datasetAllocCacheTest \
+       datasetAllocCacheTest.c ../c/datasetAllocCache.c
+    ./datasetAllocCacheTest
+
+  The cache only needs safeMalloc, safeFree, zowelog and the RLE task calls
+  from zowe-common-c, which are stood in for below. The sweep check sleeps for
+  a couple of seconds.
+ */
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "zowetypes.h"
+#include "alloc.h"
+#include "logging.h"
+#include "scheduling.h"
+
+#include "datasetAllocCache.h"
+
+#define MAX_DDS 64
+
+char *safeMalloc(int size, char *site) {
+  return malloc(size);
+}
+
+void safeFree(char *data, int size) {
+  free(data);
+}
+
+void zowelog(LoggingContext *context, uint64 compID, int level, char *formatString, ...) {
+}
+
+RLETask *makeRLETask(RLEAnchor *anchor, int taskFlags, int (*mainFunction)(RLETask *task)) {
+  return NULL;
+}
+
+void startRLETask(RLETask *task, int *completionECB) {
+}
+
+typedef struct FakeAllocator_tag {
+  int nextDD;
+  int allocations;
+  int unallocations;
+  bool allocated[MAX_DDS];
+  bool failNext;
+} FakeAllocator;
+
+static int fakeAllocate(void *userData, const char *dsn, const char *member, char *ddName,
+                        int *sysRC, int *sysRSN) {
+  FakeAllocator *fake = (FakeAllocator *)userData;
+  if (fake->failNext) {
+    fake->failNext = false;
+    *sysRC = 4;
+    *sysRSN = 0x1708;
+    return 8;
+  }
+  int dd = fake->nextDD++;
+  char name[ALLOC_CACHE_DDNAME_LENGTH + 1];
+  snprintf(name, sizeof(name), "SYS%05d", dd);
+  memcpy(ddName, name, ALLOC_CACHE_DDNAME_LENGTH);
+  fake->allocated[dd] = true;
+  fake->allocations++;
+  return 0;
+}
+
+static int fakeUnallocate(void *userData, const char *ddName, int *sysRC, int *sysRSN) {
+  FakeAllocator *fake = (FakeAllocator *)userData;
+  char number[ALLOC_CACHE_DDNAME_LENGTH] = {0};
+  memcpy(number, ddName + 3, ALLOC_CACHE_DDNAME_LENGTH - 3);
+  int dd = atoi(number);
+  if (!fake->allocated[dd]) {
+    printf("  %8.8s unallocated twice\n", ddName);
+    return 8;
+  }
+  fake->allocated[dd] = false;
+  fake->unallocations++;
+  return 0;
+}
+
+static int failures = 0;
+
+static void check(bool condition, const char *what) {
+  if (!condition) {
+    printf("FAILED: %s\n", what);
+    failures++;
+  }
+}
+
+static int allocatedCount(const FakeAllocator *fake) {
+  int count = 0;
+  for (int i = 0; i < MAX_DDS; i++) {
+    count += fake->allocated[i];
+  }
+  return count;
+}
+
+static DatasetAllocCache *makeCache(FakeAllocator *fake, int maxEntries, int idleSeconds) {
+  memset(fake, 0, sizeof(FakeAllocator));
+  DatasetAllocator allocator = {
+    .allocate = fakeAllocate,
+    .unallocate = fakeUnallocate,
+    .userData = fake
+  };
+  return makeDatasetAllocCache(&allocator, maxEntries, idleSeconds);
+}
+
+/* Acquires and releases straight away, as a read does */
+static DatasetAllocation *acquire(DatasetAllocCache *cache, const char *user, const char *dsn,
+                                  const char *member) {
+  char paddedDSN[ALLOC_CACHE_DSN_LENGTH + 1];
+  char paddedMember[ALLOC_CACHE_MEMBER_LENGTH + 1];
+  snprintf(paddedDSN, sizeof(paddedDSN), "%-44s", dsn);
+  snprintf(paddedMember, sizeof(paddedMember), "%-8s", member);
+  int rc = 0, sysRC = 0, sysRSN = 0;
+  return acquireDatasetAllocation(cache, user, paddedDSN, paddedMember, &rc, &sysRC, &sysRSN);
+}
+
+static void readMember(DatasetAllocCache *cache, const char *user, const char *dsn, const char *member) {
+  DatasetAllocation *allocation = acquire(cache, user, dsn, member);
+  if (allocation) {
+    releaseDatasetAllocation(cache, allocation);
+  }
+}
+
+static void checkReuse(void) {
+  FakeAllocator fake;
+  DatasetAllocCache *cache = makeCache(&fake, 4, 60);
+  readMember(cache, "USER1", "A.PDS", "M1");
+  readMember(cache, "USER1", "A.PDS", "M1");
+  check(fake.allocations == 1, "a member read twice is allocated once");
+  readMember(cache, "USER2", "A.PDS", "M1");
+  check(fake.allocations == 2, "another user gets an allocation of its own");
+  readMember(cache, "USER1", "A.PDS", "M2");
+  check(fake.allocations == 3, "another member gets an allocation of its own");
+  DatasetAllocCacheStats stats;
+  getDatasetAllocCacheStats(cache, &stats);
+  check(stats.hits == 1 && stats.misses == 3 && stats.entries == 3, "hits, misses and entries are counted");
+  freeDatasetAllocCache(cache);
+  check(allocatedCount(&fake) == 0, "freeing the cache unallocates its entries");
+}
+
+static void checkEviction(void) {
+  FakeAllocator fake;
+  DatasetAllocCache *cache = makeCache(&fake, 2, 60);
+  readMember(cache, "USER1", "A.PDS", "M1");
+  sleep(1);
+  readMember(cache, "USER1", "A.PDS", "M2");
+  readMember(cache, "USER1", "A.PDS", "M3");
+  check(allocatedCount(&fake) == 2, "the cache holds maxEntries allocations");
+  readMember(cache, "USER1", "A.PDS", "M2");
+  check(fake.allocations == 3, "the most recently used entry is kept");
+  readMember(cache, "USER1", "A.PDS", "M1");
+  check(fake.allocations == 4, "the least recently used entry is evicted");
+  freeDatasetAllocCache(cache);
+  check(allocatedCount(&fake) == 0, "nothing is left allocated");
+}
+
+static void checkOverflow(void) {
+  FakeAllocator fake;
+  DatasetAllocCache *cache = makeCache(&fake, 1, 60);
+  DatasetAllocation *first = acquire(cache, "USER1", "A.PDS", "M1");
+  DatasetAllocation *second = acquire(cache, "USER1", "A.PDS", "M2");
+  check(first && second && first != second, "an allocation is made when every entry is in use");
+  releaseDatasetAllocation(cache, second);
+  check(allocatedCount(&fake) == 1, "an allocation that did not fit is unallocated on release");
+  releaseDatasetAllocation(cache, first);
+  check(allocatedCount(&fake) == 1, "a cached allocation stays allocated on release");
+  freeDatasetAllocCache(cache);
+}
+
+static void checkInvalidation(void) {
+  FakeAllocator fake;
+  DatasetAllocCache *cache = makeCache(&fake, 4, 60);
+  readMember(cache, "USER1", "A.PDS", "M1");
+  DatasetAllocation *inUse = acquire(cache, "USER2", "A.PDS", "M1");
+  readMember(cache, "USER1", "B.PDS", "M1");
+  char dsn[ALLOC_CACHE_DSN_LENGTH + 1];
+  snprintf(dsn, sizeof(dsn), "%-44s", "A.PDS");
+  invalidateDatasetAllocations(cache, dsn);
+  check(allocatedCount(&fake) == 2, "idle allocations of the dataset are dropped at once");
+  DatasetAllocation *again = acquire(cache, "USER2", "A.PDS", "M1");
+  check(again != inUse, "an invalidated allocation is not handed out again");
+  releaseDatasetAllocation(cache, again);
+  releaseDatasetAllocation(cache, inUse);
+  check(allocatedCount(&fake) == 2, "an allocation invalidated in use is dropped on release");
+  freeDatasetAllocCache(cache);
+  check(allocatedCount(&fake) == 0, "nothing is left allocated");
+}
+
+static void checkSweep(void) {
+  FakeAllocator fake;
+  DatasetAllocCache *cache = makeCache(&fake, 4, 1);
+  readMember(cache, "USER1", "A.PDS", "M1");
+  DatasetAllocation *inUse = acquire(cache, "USER1", "A.PDS", "M2");
+  sweepDatasetAllocCache(cache);
+  check(allocatedCount(&fake) == 2, "entries used within idleSeconds survive a sweep");
+  sleep(2);
+  sweepDatasetAllocCache(cache);
+  check(allocatedCount(&fake) == 1, "a sweep drops idle entries but not those in use");
+  releaseDatasetAllocation(cache, inUse);
+  freeDatasetAllocCache(cache);
+  check(allocatedCount(&fake) == 0, "nothing is left allocated");
+}
+
+static void checkFailure(void) {
+  FakeAllocator fake;
+  DatasetAllocCache *cache = makeCache(&fake, 4, 60);
+  char dsn[ALLOC_CACHE_DSN_LENGTH + 1];
+  snprintf(dsn, sizeof(dsn), "%-44s", "A.PDS");
+  int rc = 0, sysRC = 0, sysRSN = 0;
+  fake.failNext = true;
+  DatasetAllocation *allocation = acquireDatasetAllocation(cache, "USER1", dsn, "M1      ",
+                                                           &rc, &sysRC, &sysRSN);
+  check(allocation == NULL && rc == 8 && sysRC == 4 && sysRSN == 0x1708,
+        "allocation failures are returned with the allocator's codes");
+  readMember(cache, "USER1", "A.PDS", "M1");
+  check(fake.allocations == 1, "a failed allocation is not cached");
+  freeDatasetAllocCache(cache);
+}
+
+int main(int argc, char **argv) {
+  checkReuse();
+  checkEviction();
+  checkOverflow();
+  checkInvalidation();
+  checkSweep();
+  checkFailure();
+  printf("%s\n", failures ? "FAILED" : "OK");
+  return failures ? 8 : 0;
+}
+
+
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
@@ -0,0 +1,311 @@
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
+
+/*
+  Compares copying dataset images record by record with copying them a block
+  at a time, over synthetic FB and VB images written to a scratch directory,
+  and checks that every method produces the same image and etag. The FB image
+  is also copied the way dataset copies used to be done, with one fread and
+  one fwrite per record. Dataset copies only take the block path for FB, as
+  for VB it has not come out ahead of copying records:
+
+    cc -O2 -I ../h -I ../../deps/zowe-common-c/h -o datasetBlockCopyBench \
+       datasetBlockCopyBench.c ../c/datasetBlockCopy.c ../c/datasetBlockReader.c \
+       ../c/datasetRecordFormat.c ../c/datasetDigest.c
+    ./datasetBlockCopyBench [directory] [megabytes] [runs]
+
+  Every method copies the image runs times, 5 by default, and the median time
+  is reported, as single runs vary with the state of the page cache.
+
+  Etags are computed with xxHash64 so that hashing does not hide the cost of
+  the copy itself. The dataset modules only need safeMalloc, safeFree and
+  zowelog from zowe-common-c, which are stood in for below.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "zowetypes.h"
+#include "alloc.h"
+#include "logging.h"
+
+#include "datasetBlockReader.h"
+#include "datasetBlockCopy.h"
+#include "datasetDigest.h"
+
+#define DEFAULT_MEGABYTES 64
+#define DEFAULT_RUNS 5
+#define MAX_RUNS 99
+#define PATH_SIZE 1024
+
+char *safeMalloc(int size, char *site) {
+  return malloc(size);
+}
+
+void safeFree(char *data, int size) {
+  free(data);
+}
+
+void zowelog(LoggingContext *context, uint64 compID, int level, char *formatString, ...) {
+}
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int writeFBImage(const char *path, const DatasetBlockFormat *format, long long bytes) {
+  BlockSink *sink = openFileBlockSink(path, format);
+  if (sink == NULL) {
+    return -1;
+  }
+  char *record = malloc(format->lrecl);
+  int records = bytes / format->lrecl;
+  for (int i = 0; i < records; i++) {
+    for (int j = 0; j < format->lrecl; j++) {
+      record[j] = 'A' + (i + j) % 26;
+    }
+    sink->writeRecord(sink, record, format->lrecl);
+  }
+  free(record);
+  return closeBlockSink(sink) ? -1 : records;
+}
+
+static int writeVBImage(const char *path, const DatasetBlockFormat *format, long long bytes) {
+  BlockSink *sink = openFileBlockSink(path, format);
+  if (sink == NULL) {
+    return -1;
+  }
+  int maxLength = format->lrecl - 4;
+  char *record = malloc(maxLength);
+  unsigned int seed = 12345;
+  int records = 0;
+  for (long long written = 0; written < bytes; records++) {
+    seed = seed * 1103515245 + 12345;
+    int length = (seed >> 8) % (maxLength + 1);
+    for (int j = 0; j < length; j++) {
+      record[j] = 'a' + (records + j) % 26;
+    }
+    sink->writeRecord(sink, record, length);
+    written += length + 4;
+  }
+  free(record);
+  return closeBlockSink(sink) ? -1 : records;
+}
+
+typedef struct CopyRun_tag {
+  double seconds;
+  int records;
+  int blocks;
+  char eTag[DATASET_DIGEST_MAX_HEX_LENGTH + 1];
+} CopyRun;
+
+static int runCopy(const char *from, const char *to, const DatasetBlockFormat *format, int flags,
+                   CopyRun *run) {
+  char *batch = malloc(DATASET_DIGEST_BATCH_SIZE);
+  DatasetDigest digest;
+  int digestRC = datasetDigestInit(&digest, DATASET_DIGEST_XXHASH64, batch, DATASET_DIGEST_BATCH_SIZE);
+  double start = now();
+  BlockSource *source = openFileBlockSource(from, format);
+  BlockSink *sink = openFileBlockSink(to, format);
+  DatasetBlockReader *reader = makeDatasetBlockReader(source, NULL, 0);
+  DatasetCopyResult result;
+  int rc = copyDatasetBlocks(reader, sink, flags, ' ', &digest, &digestRC, NULL, NULL, &result);
+  freeDatasetBlockReader(reader);
+  closeBlockSource(source);
+  if (closeBlockSink(sink)) {
+    rc = BLOCK_COPY_RC_WRITE_ERROR;
+  }
+  run->seconds = now() - start;
+  run->records = result.records;
+  run->blocks = result.blocks;
+  if (!digestRC) {
+    digestRC = datasetDigestFinishHex(&digest, run->eTag);
+  }
+  free(batch);
+  return rc || digestRC;
+}
+
+/* One fread and one fwrite of an LRECL per record, with the RECFM looked at
+   for every record, as streamDatasetForCopyAndRespond used to do. The streams
+   are unbuffered, as every record mode fread and fwrite is a call into the
+   access method. */
+static int runStdioCopy(const char *from, const char *to, const DatasetBlockFormat *format,
+                        CopyRun *run) {
+  char *batch = malloc(DATASET_DIGEST_BATCH_SIZE);
+  DatasetDigest digest;
+  int digestRC = datasetDigestInit(&digest, DATASET_DIGEST_XXHASH64, batch, DATASET_DIGEST_BATCH_SIZE);
+  const char *recFormat = "F";
+  double start = now();
+  FILE *in = fopen(from, "rb");
+  FILE *out = fopen(to, "wb");
+  if (in == NULL || out == NULL) {
+    return -1;
+  }
+  setvbuf(in, NULL, _IONBF, 0);
+  setvbuf(out, NULL, _IONBF, 0);
+  int lrecl = format->lrecl;
+  char buffer[lrecl + 1];
+  memset(run, 0, sizeof(CopyRun));
+  while (!feof(in)) {
+    int bytesRead = fread(buffer, 1, lrecl, in);
+    if (bytesRead > 0) {
+      if ((bytesRead < lrecl) && !strcmp(recFormat, "F")) {
+        memset(buffer + bytesRead, ' ', lrecl - bytesRead);
+        bytesRead = lrecl;
+      }
+      int bytesWritten = fwrite(buffer, 1, bytesRead, out);
+      if (bytesWritten != bytesRead && strcmp(recFormat, "V")) {
+        return -1;
+      }
+      if (!digestRC) {
+        digestRC = datasetDigestUpdate(&digest, buffer, bytesWritten);
+      }
+      run->records++;
+    }
+  }
+  fclose(in);
+  fclose(out);
+  run->seconds = now() - start;
+  if (!digestRC) {
+    digestRC = datasetDigestFinishHex(&digest, run->eTag);
+  }
+  free(batch);
+  return digestRC;
+}
+
+static int sameFiles(const char *a, const char *b) {
+  FILE *fa = fopen(a, "rb");
+  FILE *fb = fopen(b, "rb");
+  int same = (fa != NULL && fb != NULL);
+  char bufferA[0x10000], bufferB[0x10000];
+  while (same) {
+    size_t lengthA = fread(bufferA, 1, sizeof(bufferA), fa);
+    size_t lengthB = fread(bufferB, 1, sizeof(bufferB), fb);
+    if (lengthA != lengthB || memcmp(bufferA, bufferB, lengthA)) {
+      same = 0;
+    } else if (lengthA == 0) {
+      break;
+    }
+  }
+  if (fa) {
+    fclose(fa);
+  }
+  if (fb) {
+    fclose(fb);
+  }
+  return same;
+}
+
+static void printRun(const char *name, const CopyRun *run, long long bytes) {
+  printf("%-8s %10.3f %14.0f %10.1f %10d\n", name, run->seconds, run->records / run->seconds,
+         bytes / run->seconds / (1024 * 1024), run->blocks);
+}
+
+static int compareSeconds(const void *a, const void *b) {
+  double difference = *(const double *)a - *(const double *)b;
+  return difference < 0 ? -1 : difference > 0;
+}
+
+/* Leaves the median of the times of runs copies in run */
+static void takeMedian(CopyRun *run, double *seconds, int runs) {
+  qsort(seconds, runs, sizeof(double), compareSeconds);
+  run->seconds = seconds[runs / 2];
+}
+
+static int benchImage(const char *directory, const char *name, const DatasetBlockFormat *format,
+                      long long bytes, int withStdio, int runs) {
+  char image[PATH_SIZE], recordCopy[PATH_SIZE], blockCopy[PATH_SIZE], stdioCopy[PATH_SIZE];
+  snprintf(image, sizeof(image), "%s/%s.img", directory, name);
+  snprintf(recordCopy, sizeof(recordCopy), "%s/%s.records.img", directory, name);
+  snprintf(blockCopy, sizeof(blockCopy), "%s/%s.blocks.img", directory, name);
+  snprintf(stdioCopy, sizeof(stdioCopy), "%s/%s.stdio.img", directory, name);
+
+  int records = (format->recfm == 'F') ? writeFBImage(image, format, bytes)
+                                       : writeVBImage(image, format, bytes);
+  if (records < 0) {
+    printf("could not write %s\n", image);
+    return 8;
+  }
+
+  CopyRun recordRun, blockRun, stdioRun;
+  double recordSeconds[MAX_RUNS], blockSeconds[MAX_RUNS], stdioSeconds[MAX_RUNS];
+  /* the methods take turns, so that none of them always finds a warmer cache */
+  for (int i = 0; i < runs; i++) {
+    if (runCopy(image, recordCopy, format, BLOCK_COPY_FLAG_RECORDS, &recordRun) ||
+        runCopy(image, blockCopy, format, 0, &blockRun) ||
+        (withStdio && runStdioCopy(image, stdioCopy, format, &stdioRun))) {
+      printf("%s copy failed\n", name);
+      return 8;
+    }
+    recordSeconds[i] = recordRun.seconds;
+    blockSeconds[i] = blockRun.seconds;
+    stdioSeconds[i] = withStdio ? stdioRun.seconds : 0;
+  }
+  takeMedian(&recordRun, recordSeconds, runs);
+  takeMedian(&blockRun, blockSeconds, runs);
+  if (withStdio) {
+    takeMedian(&stdioRun, stdioSeconds, runs);
+  }
+  int status = 0;
+  if (!sameFiles(image, recordCopy) || !sameFiles(image, blockCopy) ||
+      (withStdio && !sameFiles(image, stdioCopy))) {
+    printf("%s copies differ from the image\n", name);
+    status = 8;
+  }
+  if (strcmp(recordRun.eTag, blockRun.eTag) || recordRun.records != records ||
+      blockRun.records != records || (withStdio && strcmp(stdioRun.eTag, blockRun.eTag))) {
+    printf("%s etags or record counts differ\n", name);
+    status = 8;
+  }
+
+  printf("%s lrecl %d blksize %d, %d records, median of %d runs\n", name, format->lrecl,
+         format->blksize, records, runs);
+  printf("%-8s %10s %14s %10s %10s\n", "method", "seconds", "records/s", "MB/s", "blocks");
+  if (withStdio) {
+    printRun("stdio", &stdioRun, bytes);
+  }
+  printRun("records", &recordRun, bytes);
+  printRun("blocks", &blockRun, bytes);
+  printf("speedup over records %.1fx\n\n", recordRun.seconds / blockRun.seconds);
+  return status;
+}
+
+int main(int argc, char **argv) {
+  const char *directory = argc > 1 ? argv[1] : "/tmp";
+  int megabytes = argc > 2 ? atoi(argv[2]) : DEFAULT_MEGABYTES;
+  int runs = argc > 3 ? atoi(argv[3]) : DEFAULT_RUNS;
+  if (megabytes <= 0 || runs <= 0 || runs > MAX_RUNS) {
+    printf("usage: %s [directory] [megabytes] [runs]\n", argv[0]);
+    return 8;
+  }
+  long long bytes = (long long)megabytes * 1024 * 1024;
+
+  DatasetBlockFormat fb = {.recfm = 'F', .blocked = true, .lrecl = 80, .blksize = 27920};
+  DatasetBlockFormat vb = {.recfm = 'V', .blocked = true, .lrecl = 255, .blksize = 27998};
+  int status = benchImage(directory, "fb", &fb, bytes, 1, runs);
+  status |= benchImage(directory, "vb", &vb, bytes, 0, runs);
+  return status;
+}
+
+
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
@@ -0,0 +1,382 @@
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
+
+/*
+  Checks how the block reader splits FB and VB blocks into records: short last
+  blocks, FB blocks that are not a whole number of records, empty VB records,
+  skips across blocks, and blocks with bad BDW or RDW values. Blocks are handed
+  to the reader from memory, except for the checks of the BDW read from a
+  dataset image, which are written to a scratch directory.
+
+    cc -O2 -I ../h -I ../../deps/zowe-common-c/h -o datasetBlockReaderTest \
+       datasetBlockReaderTest.c ../c/datasetBlockReader.c
+    ./datasetBlockReaderTest [directory]
+
+  The reader only needs safeMalloc, safeFree and zowelog from zowe-common-c,
+  which are stood in for below.
+ */
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "zowetypes.h"
+#include "alloc.h"
+#include "logging.h"
+
+#include "datasetBlockReader.h"
+
+#define MAX_BLOCKS 8
+#define PATH_SIZE 1024
+
+char *safeMalloc(int size, char *site) {
+  return malloc(size);
+}
+
+void safeFree(char *data, int size) {
+  free(data);
+}
+
+void zowelog(LoggingContext *context, uint64 compID, int level, char *formatString, ...) {
+}
+
+/* Hands out the blocks it was given, one per read */
+typedef struct MemoryBlocks_tag {
+  const char *blocks[MAX_BLOCKS];
+  int lengths[MAX_BLOCKS];
+  int count;
+  int next;
+} MemoryBlocks;
+
+static int readMemoryBlock(BlockSource *source, char *buffer, int bufferSize) {
+  MemoryBlocks *memory = (MemoryBlocks *)source->handle;
+  if (memory->next >= memory->count) {
+    return 0;
+  }
+  int length = memory->lengths[memory->next];
+  if (length > bufferSize) {
+    return BLOCK_READER_RC_BAD_BLOCK;
+  }
+  memcpy(buffer, memory->blocks[memory->next++], length);
+  return length;
+}
+
+static void closeMemoryBlocks(BlockSource *source) {
+}
+
+static void addBlock(MemoryBlocks *memory, const char *block, int length) {
+  memory->blocks[memory->count] = block;
+  memory->lengths[memory->count++] = length;
+}
+
+static void makeMemorySource(BlockSource *source, MemoryBlocks *memory, char recfm, int lrecl,
+                             int blksize) {
+  memset(source, 0, sizeof(BlockSource));
+  source->readBlock = readMemoryBlock;
+  source->close = closeMemoryBlocks;
+  source->handle = memory;
+  source->format.recfm = recfm;
+  source->format.blocked = true;
+  source->format.lrecl = lrecl;
+  source->format.blksize = blksize;
+}
+
+/* A VB block of the given records, BDW and RDWs included; returns its length */
+static int makeVBBlock(char *block, const char **records, int count) {
+  int length = 4;
+  for (int i = 0; i < count; i++) {
+    int recordLength = strlen(records[i]);
+    block[length] = (recordLength + 4) >> 8;
+    block[length + 1] = (recordLength + 4) & 0xFF;
+    block[length + 2] = 0;
+    block[length + 3] = 0;
+    memcpy(block + length + 4, records[i], recordLength);
+    length += recordLength + 4;
+  }
+  block[0] = length >> 8;
+  block[1] = length & 0xFF;
+  block[2] = 0;
+  block[3] = 0;
+  return length;
+}
+
+static int failures = 0;
+
+static void check(bool condition, const char *what) {
+  if (!condition) {
+    printf("FAILED: %s\n", what);
+    failures++;
+  }
+}
+
+/* Reads every record into text, each followed by '|', and returns the rc
+   that ended the read */
+static int readAll(DatasetBlockReader *reader, char *text, int textSize, int *records) {
+  int used = 0;
+  *records = 0;
+  text[0] = '\0';
+  while (true) {
+    char *record = NULL;
+    int recordLength = 0;
+    int rc = blockReaderNextRecord(reader, &record, &recordLength);
+    if (rc != BLOCK_READER_RC_OK) {
+      return rc;
+    }
+    if (used + recordLength + 2 <= textSize) {
+      memcpy(text + used, record, recordLength);
+      used += recordLength;
+      text[used++] = '|';
+      text[used] = '\0';
+    }
+    (*records)++;
+  }
+}
+
+static void checkFormats(void) {
+  DatasetBlockFormat fb = {.recfm = 'F', .blocked = true, .lrecl = 4, .blksize = 12};
+  check(isBlockReadableFormat(&fb), "FB with BLKSIZE a multiple of LRECL is readable");
+  fb.blksize = 10;
+  check(!isBlockReadableFormat(&fb), "FB with BLKSIZE not a multiple of LRECL is not readable");
+  DatasetBlockFormat vb = {.recfm = 'V', .blocked = true, .lrecl = 84, .blksize = 800};
+  check(isBlockReadableFormat(&vb), "VB is readable");
+  vb.spanned = true;
+  check(!isBlockReadableFormat(&vb), "VBS is not readable");
+  vb.spanned = false;
+  vb.blksize = 7;
+  check(!isBlockReadableFormat(&vb), "VB with no room for a BDW and an RDW is not readable");
+  DatasetBlockFormat u = {.recfm = 'U', .lrecl = 0, .blksize = 800};
+  check(!isBlockReadableFormat(&u), "U is not readable");
+}
+
+static void checkFixed(void) {
+  MemoryBlocks memory = {0};
+  BlockSource source;
+  makeMemorySource(&source, &memory, 'F', 4, 12);
+  addBlock(&memory, "AAAABBBBCCCC", 12);
+  addBlock(&memory, "DDDDEEEEFFFF", 12);
+  addBlock(&memory, "GGGG", 4);
+  DatasetBlockReader *reader = makeDatasetBlockReader(&source, NULL, 0);
+  char text[64];
+  int records = 0;
+  int rc = readAll(reader, text, sizeof(text), &records);
+  check(rc == BLOCK_READER_RC_EOF, "FB ends with EOF");
+  check(records == 7 && !strcmp(text, "AAAA|BBBB|CCCC|DDDD|EEEE|FFFF|GGGG|"),
+        "FB blocks and a short last block split into LRECL records");
+  check(reader->blocksRead == 3 && reader->recordsRead == 7, "FB blocks and records are counted");
+  freeDatasetBlockReader(reader);
+}
+
+static void checkFixedPartialRecord(void) {
+  MemoryBlocks memory = {0};
+  BlockSource source;
+  makeMemorySource(&source, &memory, 'F', 4, 12);
+  addBlock(&memory, "AAAABBBBCC", 10);
+  DatasetBlockReader *reader = makeDatasetBlockReader(&source, NULL, 0);
+  char text[64];
+  int records = 0;
+  int rc = readAll(reader, text, sizeof(text), &records);
+  check(rc == BLOCK_READER_RC_BAD_BLOCK && records == 2,
+        "an FB block ending in part of a record is bad after its whole records");
+  freeDatasetBlockReader(reader);
+
+  memory = (MemoryBlocks){0};
+  makeMemorySource(&source, &memory, 'F', 4, 12);
+  addBlock(&memory, "AAAABBBBCC", 10);
+  reader = makeDatasetBlockReader(&source, NULL, 0);
+  char *block = NULL;
+  int blockLength = 0;
+  check(blockReaderNextBlock(reader, &block, &blockLength) == BLOCK_READER_RC_BAD_BLOCK,
+        "an FB block that is not whole records is not handed out as a block");
+  freeDatasetBlockReader(reader);
+}
+
+static void checkFixedSkipAndBlocks(void) {
+  MemoryBlocks memory = {0};
+  BlockSource source;
+  makeMemorySource(&source, &memory, 'F', 4, 12);
+  addBlock(&memory, "AAAABBBBCCCC", 12);
+  addBlock(&memory, "DDDDEEEEFFFF", 12);
+  addBlock(&memory, "GGGG", 4);
+  DatasetBlockReader *reader = makeDatasetBlockReader(&source, NULL, 0);
+  int skipped = 0;
+  int rc = blockReaderSkipRecords(reader, 4, &skipped);
+  check(rc == BLOCK_READER_RC_OK && skipped == 4, "FB records are skipped across blocks");
+  char *block = NULL;
+  int blockLength = 0;
+  rc = blockReaderNextBlock(reader, &block, &blockLength);
+  check(rc == BLOCK_READER_RC_OK && blockLength == 8 && !memcmp(block, "EEEEFFFF", 8),
+        "the rest of a partly read FB block is handed out first");
+  rc = blockReaderNextBlock(reader, &block, &blockLength);
+  check(rc == BLOCK_READER_RC_OK && blockLength == 4 && !memcmp(block, "GGGG", 4),
+        "a short last FB block is handed out as it is");
+  rc = blockReaderSkipRecords(reader, 3, &skipped);
+  check(rc == BLOCK_READER_RC_EOF && skipped == 0, "skipping past the end stops at EOF");
+  check(reader->recordsRead == 7, "skipped and block records are counted");
+  freeDatasetBlockReader(reader);
+}
+
+static void checkVariable(void) {
+  MemoryBlocks memory = {0};
+  BlockSource source;
+  makeMemorySource(&source, &memory, 'V', 84, 800);
+  char first[64], second[64];
+  const char *firstRecords[] = {"one", "", "three"};
+  const char *secondRecords[] = {"four"};
+  addBlock(&memory, first, makeVBBlock(first, firstRecords, 3));
+  addBlock(&memory, second, makeVBBlock(second, secondRecords, 1));
+  DatasetBlockReader *reader = makeDatasetBlockReader(&source, NULL, 0);
+  char text[64];
+  int records = 0;
+  int rc = readAll(reader, text, sizeof(text), &records);
+  check(rc == BLOCK_READER_RC_EOF, "VB ends with EOF");
+  check(records == 4 && !strcmp(text, "one||three|four|"),
+        "VB blocks split at their RDWs, empty records included");
+  freeDatasetBlockReader(reader);
+
+  memory.next = 0;
+  reader = makeDatasetBlockReader(&source, NULL, 0);
+  int skipped = 0;
+  rc = blockReaderSkipRecords(reader, 3, &skipped);
+  char *record = NULL;
+  int recordLength = 0;
+  check(rc == BLOCK_READER_RC_OK && skipped == 3 &&
+        blockReaderNextRecord(reader, &record, &recordLength) == BLOCK_READER_RC_OK &&
+        recordLength == 4 && !memcmp(record, "four", 4),
+        "VB records are skipped by their RDWs across blocks");
+  char *block = NULL;
+  int blockLength = 0;
+  check(blockReaderNextBlock(reader, &block, &blockLength) == BLOCK_READER_RC_BAD_FORMAT,
+        "VB blocks are not handed out as blocks");
+  freeDatasetBlockReader(reader);
+}
+
+/* Reads a single VB block that was spoiled after it was built */
+static int readBadVariable(char *block, int length) {
+  MemoryBlocks memory = {0};
+  BlockSource source;
+  makeMemorySource(&source, &memory, 'V', 84, 800);
+  addBlock(&memory, block, length);
+  DatasetBlockReader *reader = makeDatasetBlockReader(&source, NULL, 0);
+  char text[64];
+  int records = 0;
+  int rc = readAll(reader, text, sizeof(text), &records);
+  freeDatasetBlockReader(reader);
+  return rc;
+}
+
+static void checkBadVariable(void) {
+  const char *records[] = {"one", "two"};
+  char block[64];
+  int length = makeVBBlock(block, records, 2);
+  block[1] += 1;
+  check(readBadVariable(block, length) == BLOCK_READER_RC_BAD_BLOCK,
+        "a BDW that is not the block length is bad");
+
+  length = makeVBBlock(block, records, 2);
+  block[5] = 3;
+  check(readBadVariable(block, length) == BLOCK_READER_RC_BAD_BLOCK,
+        "an RDW shorter than itself is bad");
+
+  length = makeVBBlock(block, records, 2);
+  block[4 + 7 + 1] = 12;
+  check(readBadVariable(block, length) == BLOCK_READER_RC_BAD_BLOCK,
+        "an RDW past the end of the block is bad");
+
+  length = makeVBBlock(block, records, 2);
+  block[4 + 7 + 2] = 0x01;
+  check(readBadVariable(block, length) == BLOCK_READER_RC_BAD_BLOCK,
+        "an RDW with a segment descriptor is bad");
+
+  length = makeVBBlock(block, records, 1);
+  block[length] = 0;
+  block[length + 1] = 4;
+  length += 2;
+  block[0] = length >> 8;
+  block[1] = length & 0xFF;
+  check(readBadVariable(block, length) == BLOCK_READER_RC_BAD_BLOCK,
+        "a VB block ending in part of an RDW is bad");
+}
+
+static int writeImage(const char *path, const char *data, int length) {
+  FILE *out = fopen(path, "wb");
+  if (out == NULL) {
+    return -1;
+  }
+  int written = fwrite(data, 1, length, out);
+  fclose(out);
+  return written == length ? 0 : -1;
+}
+
+/* Reads the first record of a VB image file */
+static int readVariableImage(const char *path, const char *data, int length, int blksize) {
+  if (writeImage(path, data, length)) {
+    printf("could not write %s\n", path);
+    failures++;
+    return BLOCK_READER_RC_OK;
+  }
+  DatasetBlockFormat format = {.recfm = 'V', .blocked = true, .lrecl = 84, .blksize = blksize};
+  BlockSource *source = openFileBlockSource(path, &format);
+  DatasetBlockReader *reader = makeDatasetBlockReader(source, NULL, 0);
+  char *record = NULL;
+  int recordLength = 0;
+  int rc = blockReaderNextRecord(reader, &record, &recordLength);
+  freeDatasetBlockReader(reader);
+  closeBlockSource(source);
+  remove(path);
+  return rc;
+}
+
+static void checkVariableImage(const char *directory) {
+  char path[PATH_SIZE];
+  snprintf(path, sizeof(path), "%s/datasetBlockReaderTest.img", directory);
+  const char *records[] = {"one", "two"};
+  char block[64];
+  int length = makeVBBlock(block, records, 2);
+  check(readVariableImage(path, block, length, 800) == BLOCK_READER_RC_OK,
+        "a VB image block is read by its BDW");
+  check(readVariableImage(path, block, length, 16) == BLOCK_READER_RC_BAD_BLOCK,
+        "a BDW over BLKSIZE is bad");
+  check(readVariableImage(path, block, length - 1, 800) == BLOCK_READER_RC_BAD_BLOCK,
+        "a VB image that ends inside a block is bad");
+  check(readVariableImage(path, block, 2, 800) == BLOCK_READER_RC_BAD_BLOCK,
+        "a VB image that ends inside a BDW is bad");
+  block[0] = 0;
+  block[1] = 2;
+  check(readVariableImage(path, block, length, 800) == BLOCK_READER_RC_BAD_BLOCK,
+        "a BDW shorter than itself is bad");
+  check(readVariableImage(path, block, 0, 800) == BLOCK_READER_RC_EOF,
+        "an empty VB image has no records");
+}
+
+int main(int argc, char **argv) {
+  const char *directory = argc > 1 ? argv[1] : "/tmp";
+  checkFormats();
+  checkFixed();
+  checkFixedPartialRecord();
+  checkFixedSkipAndBlocks();
+  checkVariable();
+  checkBadVariable();
+  checkVariableImage(directory);
+  printf("%s\n", failures ? "FAILED" : "OK");
+  return failures ? 8 : 0;
+}
+
+
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
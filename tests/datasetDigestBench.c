@@ -0,0 +1,147 @@
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
+
+/*
+  Compares hashing a dataset's records one update per record with batched
+  updates, for every digest backend available on the platform, and checks that
+  both give the same etag. Off z/OS only the software backends are measured:
+
+    cc -O2 -I ../h -o datasetDigestBench datasetDigestBench.c ../c/datasetDigest.c
+    ./datasetDigestBench [records] [lrecl]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "datasetDigest.h"
+
+#define DEFAULT_RECORDS 1000000
+#define DEFAULT_LRECL   80
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int hashRecords(int type, const char *data, int records, int lrecl, char *batch,
+                       char *eTag, unsigned long long *backendCalls, double *seconds) {
+  DatasetDigest digest;
+  double start = now();
+  int rc = datasetDigestInit(&digest, type, batch, batch ? DATASET_DIGEST_BATCH_SIZE : 0);
+  for (int i = 0; i < records && !rc; i++) {
+    rc = datasetDigestUpdate(&digest, data + (size_t)i * lrecl, lrecl);
+  }
+  if (!rc) {
+    rc = datasetDigestFinishHex(&digest, eTag);
+  }
+  *seconds = now() - start;
+  *backendCalls = digest.backendCalls;
+  return rc;
+}
+
+static int checkKnownValues(void) {
+  struct {
+    int type;
+    const char *data;
+    const char *expected;
+  } vectors[] = {
+    {DATASET_DIGEST_SHA1, "abc", "a9993e364706816aba3e25717850c26c9cd0d89d"},
+    {DATASET_DIGEST_SHA1, "", "da39a3ee5e6b4b0d3255bfef95601890afd80709"},
+    {DATASET_DIGEST_XXHASH64, "", "ef46db3751d8e999"},
+  };
+  int failures = 0;
+  for (int i = 0; i < (int)(sizeof(vectors) / sizeof(vectors[0])); i++) {
+    DatasetDigest digest;
+    char eTag[DATASET_DIGEST_MAX_HEX_LENGTH + 1];
+    datasetDigestInit(&digest, vectors[i].type, NULL, 0);
+    datasetDigestUpdate(&digest, vectors[i].data, strlen(vectors[i].data));
+    datasetDigestFinishHex(&digest, eTag);
+    if (strcmp(eTag, vectors[i].expected)) {
+      printf("%s(\"%s\") = %s, expected %s\n", getDatasetDigestName(vectors[i].type),
+             vectors[i].data, eTag, vectors[i].expected);
+      failures++;
+    }
+  }
+  return failures;
+}
+
+int main(int argc, char **argv) {
+  int records = argc > 1 ? atoi(argv[1]) : DEFAULT_RECORDS;
+  int lrecl = argc > 2 ? atoi(argv[2]) : DEFAULT_LRECL;
+  if (records <= 0 || lrecl <= 0) {
+    printf("usage: %s [records] [lrecl]\n", argv[0]);
+    return 8;
+  }
+  if (checkKnownValues()) {
+    return 12;
+  }
+
+  size_t dataSize = (size_t)records * lrecl;
+  char *data = malloc(dataSize);
+  char *batch = malloc(DATASET_DIGEST_BATCH_SIZE);
+  if (data == NULL || batch == NULL) {
+    printf("could not allocate %zu bytes\n", dataSize);
+    return 8;
+  }
+  for (size_t i = 0; i < dataSize; i++) {
+    data[i] = (char)(i * 31 + (i >> 7));
+  }
+
+  int types[] = {
+#ifdef __ZOWE_OS_ZOS
+    DATASET_DIGEST_ICSF_SHA1,
+#endif
+    DATASET_DIGEST_SHA1,
+    DATASET_DIGEST_XXHASH64
+  };
+  int status = 0;
+  printf("%d records of %d bytes\n", records, lrecl);
+  printf("%-10s %-10s %12s %10s %10s\n", "backend", "mode", "calls", "seconds", "MB/s");
+  for (int t = 0; t < (int)(sizeof(types) / sizeof(types[0])); t++) {
+    char perRecordETag[DATASET_DIGEST_MAX_HEX_LENGTH + 1] = {0};
+    char batchedETag[DATASET_DIGEST_MAX_HEX_LENGTH + 1] = {0};
+    unsigned long long calls = 0;
+    double seconds = 0;
+    const char *name = getDatasetDigestName(types[t]);
+
+    int rc = hashRecords(types[t], data, records, lrecl, NULL, perRecordETag, &calls, &seconds);
+    printf("%-10s %-10s %12llu %10.3f %10.1f\n", name, "record", calls, seconds,
+           dataSize / seconds / (1024 * 1024));
+    if (rc == 0) {
+      rc = hashRecords(types[t], data, records, lrecl, batch, batchedETag, &calls, &seconds);
+      printf("%-10s %-10s %12llu %10.3f %10.1f\n", name, "batched", calls, seconds,
+             dataSize / seconds / (1024 * 1024));
+    }
+    if (rc) {
+      printf("%s failed, rc=%d\n", name, rc);
+      status = 8;
+    } else if (strcmp(perRecordETag, batchedETag)) {
+      printf("%s etags differ: %s %s\n", name, perRecordETag, batchedETag);
+      status = 8;
+    }
+  }
+  free(batch);
+  free(data);
+  return status;
+}
+
+
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
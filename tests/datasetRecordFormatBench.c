@@ -0,0 +1,183 @@
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
+
+/*
+  Compares fitting records to a fixed LRECL the way dataset writes used to,
+  with strlen, a byte by byte scan of what is past the LRECL and
+  snprintf("%-*s"), with findDatasetRecordOverflow and formatDatasetRecord,
+  and checks that both give the same records:
+
+    cc -O2 -I ../h -o datasetRecordFormatBench datasetRecordFormatBench.c ../c/datasetRecordFormat.c
+    ./datasetRecordFormatBench [records] [lrecl]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "datasetRecordFormat.h"
+
+#define DEFAULT_RECORDS 1000000
+#define DEFAULT_LRECL   80
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Lengths spread around the LRECL, with only blanks past it */
+static char **makeRecords(int records, int lrecl, int **lengths) {
+  char **data = malloc(records * sizeof(char *));
+  *lengths = malloc(records * sizeof(int));
+  unsigned int seed = 12345;
+  for (int i = 0; i < records; i++) {
+    seed = seed * 1103515245 + 12345;
+    int length = (seed >> 8) % (lrecl + lrecl / 4 + 1);
+    data[i] = malloc(length + 1);
+    for (int j = 0; j < length; j++) {
+      data[i][j] = (j < lrecl) ? 'A' + (i + j) % 26 : ' ';
+    }
+    data[i][length] = '\0';
+    (*lengths)[i] = length;
+  }
+  return data;
+}
+
+static unsigned long long checksum(unsigned long long sum, const char *record, int length) {
+  for (int i = 0; i < length; i++) {
+    sum = sum * 31 + (unsigned char)record[i];
+  }
+  return sum;
+}
+
+static double runSnprintf(char **data, int records, int lrecl, char *buffer,
+                          unsigned long long *sum, int *rejected) {
+  double start = now();
+  for (int i = 0; i < records; i++) {
+    char *record = data[i];
+    int recordLength = strlen(record);
+    if (recordLength > lrecl) {
+      for (int j = recordLength - 1; j >= lrecl; j--) {
+        if ((unsigned char)record[j] > DATASET_RECORD_BLANK_MAX) {
+          (*rejected)++;
+          break;
+        }
+      }
+    }
+    int length = snprintf(buffer, lrecl + 1, "%-*s", lrecl, record);
+    if (length > lrecl) {
+      length = lrecl;
+    }
+    if (sum) {
+      *sum = checksum(*sum, buffer, length);
+    }
+  }
+  return now() - start;
+}
+
+static double runKernel(char **data, const int *lengths, int records, int lrecl, char *buffer,
+                        unsigned long long *sum, int *rejected) {
+  double start = now();
+  for (int i = 0; i < records; i++) {
+    if (findDatasetRecordOverflow(data[i], lengths[i], lrecl) >= 0) {
+      (*rejected)++;
+    }
+    int length = 0;
+    const char *record = formatDatasetRecord(data[i], lengths[i], lrecl, true, ' ', buffer, &length);
+    if (sum) {
+      *sum = checksum(*sum, record, length);
+    }
+  }
+  return now() - start;
+}
+
+static int checkKnownValues(void) {
+  int failures = 0;
+  char blanks[] = "ABC     \x40\x40\x01";
+  char dirty[] = "ABC                 x";
+  if (findDatasetRecordOverflow(blanks, sizeof(blanks) - 1, 3) != -1) {
+    printf("blanks past the lrecl were rejected\n");
+    failures++;
+  }
+  if (findDatasetRecordOverflow(dirty, sizeof(dirty) - 1, 3) != sizeof(dirty) - 2) {
+    printf("a non-blank past the lrecl was not found\n");
+    failures++;
+  }
+  char buffer[8];
+  int length = 0;
+  const char *record = formatDatasetRecord("AB", 2, 5, true, '.', buffer, &length);
+  if (length != 5 || memcmp(record, "AB...", 5)) {
+    printf("fixed record was not padded\n");
+    failures++;
+  }
+  record = formatDatasetRecord("AB", 2, 5, false, '.', buffer, &length);
+  if (length != 2 || record == buffer) {
+    printf("variable record was copied or padded\n");
+    failures++;
+  }
+  return failures;
+}
+
+int main(int argc, char **argv) {
+  int records = argc > 1 ? atoi(argv[1]) : DEFAULT_RECORDS;
+  int lrecl = argc > 2 ? atoi(argv[2]) : DEFAULT_LRECL;
+  if (records <= 0 || lrecl <= 0) {
+    printf("usage: %s [records] [lrecl]\n", argv[0]);
+    return 8;
+  }
+  if (checkKnownValues()) {
+    return 12;
+  }
+
+  int *lengths = NULL;
+  char **data = makeRecords(records, lrecl, &lengths);
+  char *buffer = malloc(lrecl + 1);
+
+  unsigned long long snprintfSum = 0, kernelSum = 0;
+  int snprintfRejected = 0, kernelRejected = 0;
+  runSnprintf(data, records, lrecl, buffer, &snprintfSum, &snprintfRejected);
+  runKernel(data, lengths, records, lrecl, buffer, &kernelSum, &kernelRejected);
+  int status = 0;
+  if (snprintfSum != kernelSum || snprintfRejected != kernelRejected) {
+    printf("records differ: checksum %llx/%llx, rejected %d/%d\n",
+           snprintfSum, kernelSum, snprintfRejected, kernelRejected);
+    status = 8;
+  }
+
+  int dummy = 0;
+  double snprintfSeconds = runSnprintf(data, records, lrecl, buffer, NULL, &dummy);
+  double kernelSeconds = runKernel(data, lengths, records, lrecl, buffer, NULL, &dummy);
+  printf("%d records, lrecl %d\n", records, lrecl);
+  printf("%-10s %10s %14s\n", "method", "seconds", "records/s");
+  printf("%-10s %10.3f %14.0f\n", "snprintf", snprintfSeconds, records / snprintfSeconds);
+  printf("%-10s %10.3f %14.0f\n", "kernel", kernelSeconds, records / kernelSeconds);
+  printf("speedup %.1fx\n", snprintfSeconds / kernelSeconds);
+
+  for (int i = 0; i < records; i++) {
+    free(data[i]);
+  }
+  free(data);
+  free(lengths);
+  free(buffer);
+  return status;
+}
+
+
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
@@ -0,0 +1,316 @@
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/
+
+/*
+  Checks the incremental parser for dataset write bodies: every body is fed
+  whole and then one byte at a time, and both must give the same records and
+  return code. Covers escapes and surrogate pairs, lone surrogates, records
+  that are not strings or are too long, input that ends early, trailing
+  garbage, repeated root keys, and records given as objects with fields.
+
+    cc -O2 -I ../h -I ../../deps/zowe-common-c/h -o datasetRecordParserTest \
+       datasetRecordParserTest.c ../c/datasetRecordParser.c
+    ./datasetRecordParserTest
+
+  The bodies below are string literals and the parser reads UTF-8, so on z/OS
+  build with -qascii. The parser only needs safeMalloc, safeFree and zowelog
+  from zowe-common-c, which are stood in for below.
+ */
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "zowetypes.h"
+#include "alloc.h"
+#include "logging.h"
+
+#include "datasetRecordParser.h"
+
+#define TEXT_SIZE 256
+#define MAX_LENGTH 16
+
+char *safeMalloc(int size, char *site) {
+  return malloc(size);
+}
+
+void safeFree(char *data, int size) {
+  free(data);
+}
+
+void zowelog(LoggingContext *context, uint64 compID, int level, char *formatString, ...) {
+}
+
+/* Records joined with '|', and the last etag seen */
+typedef struct ParseResult_tag {
+  char text[TEXT_SIZE];
+  int textLength;
+  int records;
+  bool indexesInOrder;
+  char etag[TEXT_SIZE];
+  int rc;
+  int errorIndex;
+} ParseResult;
+
+static int failures = 0;
+
+static void check(bool condition, const char *what) {
+  if (!condition) {
+    printf("FAILED: %s\n", what);
+    failures++;
+  }
+}
+
+static int addRecord(void *userData, const char *value, int length, int index) {
+  ParseResult *result = userData;
+  if (index != result->records) {
+    result->indexesInOrder = false;
+  }
+  if (result->textLength + length + 1 < TEXT_SIZE) {
+    memcpy(result->text + result->textLength, value, length);
+    result->textLength += length;
+    result->text[result->textLength++] = '|';
+    result->text[result->textLength] = '\0';
+  }
+  result->records++;
+  return 0;
+}
+
+static int addProperty(void *userData, const char *name, const char *value, int length) {
+  ParseResult *result = userData;
+  if (!strcmp(name, "etag") && length < TEXT_SIZE) {
+    memcpy(result->etag, value, length);
+    result->etag[length] = '\0';
+  }
+  return 0;
+}
+
+/* Fields as "key=record", with "-" for one left out */
+static int addFields(void *userData, const char **values, const int *lengths, int index) {
+  char text[TEXT_SIZE];
+  int length = 0;
+  for (int i = 0; i < 2; i++) {
+    if (values[i] == NULL) {
+      text[length++] = '-';
+    } else if (length + lengths[i] < TEXT_SIZE - 2) {
+      memcpy(text + length, values[i], lengths[i]);
+      length += lengths[i];
+    }
+    if (i == 0) {
+      text[length++] = '=';
+    }
+  }
+  return addRecord(userData, text, length, index);
+}
+
+static const char *fieldNames[] = {"key", "record"};
+static bool withFields = false;
+
+static void parseInPieces(const char *body, int pieceLength, ParseResult *result) {
+  memset(result, 0, sizeof(ParseResult));
+  result->indexesInOrder = true;
+  JsonRecordParser parser;
+  initJsonRecordParser(&parser, MAX_LENGTH, addRecord, addProperty, result);
+  if (withFields) {
+    setJsonRecordParserFields(&parser, fieldNames, 2, addFields);
+  }
+  int length = strlen(body);
+  int rc = RECORD_PARSER_RC_OK;
+  for (int i = 0; i < length && !rc; i += pieceLength) {
+    int piece = (length - i < pieceLength) ? length - i : pieceLength;
+    rc = jsonRecordParserFeed(&parser, body + i, piece);
+  }
+  if (!rc) {
+    rc = jsonRecordParserFinish(&parser);
+  }
+  result->rc = rc;
+  result->errorIndex = parser.errorIndex;
+  termJsonRecordParser(&parser);
+}
+
+/* Parses whole and a byte at a time, and checks both agree */
+static void parse(const char *body, ParseResult *result) {
+  ParseResult bytewise;
+  parseInPieces(body, 1, &bytewise);
+  parseInPieces(body, strlen(body) ? strlen(body) : 1, result);
+  if (bytewise.rc != result->rc || bytewise.records != result->records ||
+      strcmp(bytewise.text, result->text) || strcmp(bytewise.etag, result->etag)) {
+    printf("FAILED: 1-byte feeds differ for %s\n", body);
+    failures++;
+  }
+}
+
+static void checkRecords(void) {
+  ParseResult result;
+  parse("{\"records\": [\"one\", \"\", \"three\"], \"etag\": \"ABC\"}", &result);
+  check(result.rc == RECORD_PARSER_RC_OK && result.records == 3 &&
+        !strcmp(result.text, "one||three|") && !strcmp(result.etag, "ABC"),
+        "records and etag are parsed");
+  check(result.indexesInOrder, "record indexes count up from 0");
+
+  parse(" {\"etag\":\"X\",\"other\":{\"a\":[1,-2.5e3,true,null]},\"records\":[]} ", &result);
+  check(result.rc == RECORD_PARSER_RC_OK && result.records == 0 && !strcmp(result.etag, "X"),
+        "other members are skipped and an empty records array is fine");
+
+  parse("{\"records\": [\"a\\\"b\\\\c\\/d\\te\"]}", &result);
+  check(result.rc == RECORD_PARSER_RC_OK && !strcmp(result.text, "a\"b\\c/d\te|"),
+        "simple escapes are decoded");
+
+  parse("{\"records\": [\"\\u0041\\u00e9\\u20ac\"]}", &result);
+  check(result.rc == RECORD_PARSER_RC_OK && !strcmp(result.text, "A\xC3\xA9\xE2\x82\xAC|"),
+        "unicode escapes are decoded to UTF-8");
+
+  parse("{\"records\": [\"\\ud83d\\ude00\"]}", &result);
+  check(result.rc == RECORD_PARSER_RC_OK && !strcmp(result.text, "\xF0\x9F\x98\x80|"),
+        "a surrogate pair is decoded to one code point");
+}
+
+static void checkSurrogates(void) {
+  static const char *lone[] = {
+    "{\"records\": [\"\\ud800\"]}",
+    "{\"records\": [\"\\ud800x\"]}",
+    "{\"records\": [\"\\ud800\\n\"]}",
+    "{\"records\": [\"\\ud800\\u0041\"]}",
+    "{\"records\": [\"\\ud800\\ud800\\udc00\"]}",
+    "{\"records\": [\"\\udc00\"]}",
+    "{\"records\": [\"a\\udfff\"]}",
+    "{\"etag\": \"\\ud800\"}"
+  };
+  for (int i = 0; i < (int)(sizeof(lone) / sizeof(lone[0])); i++) {
+    ParseResult result;
+    parse(lone[i], &result);
+    if (result.rc != RECORD_PARSER_RC_SYNTAX || result.records != 0) {
+      printf("FAILED: lone surrogate is not rejected in %s\n", lone[i]);
+      failures++;
+    }
+  }
+}
+
+static void checkErrors(void) {
+  ParseResult result;
+  parse("{\"records\": [\"one\", 2, \"three\"]}", &result);
+  check(result.rc == RECORD_PARSER_RC_NOT_A_STRING && result.errorIndex == 1,
+        "a record that is not a string gives its position");
+  parse("{\"records\": [\"one\", [\"two\"]]}", &result);
+  check(result.rc == RECORD_PARSER_RC_NOT_A_STRING && result.errorIndex == 1,
+        "a record that is an array is not a string");
+
+  parse("{\"records\": [\"0123456789abcdef\"]}", &result);
+  check(result.rc == RECORD_PARSER_RC_OK, "a record of the max length is fine");
+  parse("{\"records\": [\"0123456789abcdefg\"]}", &result);
+  check(result.rc == RECORD_PARSER_RC_TOO_LONG, "a record over the max length is too long");
+  parse("{\"records\": [\"0123456789abcde\\u00e9\"]}", &result);
+  check(result.rc == RECORD_PARSER_RC_TOO_LONG, "the max length counts decoded bytes");
+
+  parse("{\"records\": [\"one\"", &result);
+  check(result.rc == RECORD_PARSER_RC_INCOMPLETE, "input ending in the records is incomplete");
+  parse("{\"records\": [\"on", &result);
+  check(result.rc == RECORD_PARSER_RC_INCOMPLETE, "input ending in a string is incomplete");
+  parse("{\"records\": [\"\\u00", &result);
+  check(result.rc == RECORD_PARSER_RC_INCOMPLETE, "input ending in an escape is incomplete");
+  parse("", &result);
+  check(result.rc == RECORD_PARSER_RC_NOT_AN_OBJECT, "no input is not an object");
+  parse("[\"one\"]", &result);
+  check(result.rc == RECORD_PARSER_RC_NOT_AN_OBJECT, "an array body is not an object");
+
+  parse("{\"records\": [\"one\"]} x", &result);
+  check(result.rc == RECORD_PARSER_RC_SYNTAX, "trailing garbage is an error");
+  parse("{\"records\": [\"one\"]}{}", &result);
+  check(result.rc == RECORD_PARSER_RC_SYNTAX, "a second root object is an error");
+  parse("{\"records\": [\"one\",]}", &result);
+  check(result.rc == RECORD_PARSER_RC_SYNTAX, "a trailing comma is an error");
+  parse("{\"records\": [\"\\q\"]}", &result);
+  check(result.rc == RECORD_PARSER_RC_SYNTAX, "an unknown escape is an error");
+  parse("{\"records\": [\"one\"], \"n\": 01x}", &result);
+  check(result.rc == RECORD_PARSER_RC_SYNTAX, "a bad number is an error");
+}
+
+static void checkDuplicateKeys(void) {
+  ParseResult result;
+  parse("{\"records\": [\"one\"], \"records\": [\"two\"]}", &result);
+  check(result.rc == RECORD_PARSER_RC_DUPLICATE_KEY && result.records == 1,
+        "a second records array is rejected");
+  parse("{\"records\": 5, \"records\": [\"two\"]}", &result);
+  check(result.rc == RECORD_PARSER_RC_DUPLICATE_KEY && result.records == 0,
+        "records is a repeated key whatever its first value");
+  parse("{\"etag\": \"A\", \"records\": [], \"etag\": \"B\"}", &result);
+  check(result.rc == RECORD_PARSER_RC_DUPLICATE_KEY && !strcmp(result.etag, "A"),
+        "a second etag is rejected");
+  parse("{\"a\": {\"x\": 1, \"x\": 2}, \"records\": [\"one\"]}", &result);
+  check(result.rc == RECORD_PARSER_RC_OK && result.records == 1,
+        "keys below the root are not checked");
+  parse("{\"a\\u0000b\": 1, \"a\\u0000c\": 2, \"records\": []}", &result);
+  check(result.rc == RECORD_PARSER_RC_OK, "keys differing after a NUL are different");
+
+  char body[TEXT_SIZE];
+  int length = sprintf(body, "{");
+  for (int i = 0; i <= RECORD_PARSER_MAX_ROOT_KEYS; i++) {
+    length += sprintf(body + length, "\"k%d\": %d, ", i, i);
+  }
+  sprintf(body + length, "\"records\": []}");
+  parse(body, &result);
+  check(result.rc == RECORD_PARSER_RC_TOO_MANY_KEYS, "too many root keys are rejected");
+}
+
+static void checkFields(void) {
+  ParseResult result;
+  withFields = true;
+  parse("{\"records\": [{\"key\": \"k1\", \"record\": \"one\"}, {\"record\": \"two\", \"x\": [1, {\"key\": 2}]},"
+        " {\"key\": \"\", \"record\": \"th\\u0072ee\"}, {}], \"etag\": \"E\"}", &result);
+  check(result.rc == RECORD_PARSER_RC_OK && result.records == 4 &&
+        !strcmp(result.text, "k1=one|-=two|=three|-=-|") && !strcmp(result.etag, "E"),
+        "fields of record objects are handed over together");
+  check(result.indexesInOrder, "record object indexes count up from 0");
+
+  parse("{\"records\": [{\"record\": \"one\"}, \"two\"]}", &result);
+  check(result.rc == RECORD_PARSER_RC_NOT_A_STRING && result.errorIndex == 1 && result.records == 1,
+        "a record that is not an object is rejected with fields");
+  parse("{\"records\": [{\"record\": 1}]}", &result);
+  check(result.rc == RECORD_PARSER_RC_NOT_A_STRING && result.errorIndex == 0,
+        "a field that is not a string is rejected");
+  parse("{\"records\": [{\"record\": {\"a\": 1}}]}", &result);
+  check(result.rc == RECORD_PARSER_RC_NOT_A_STRING && result.errorIndex == 0,
+        "a field that is an object is rejected");
+  parse("{\"records\": [{\"record\": \"one\", \"record\": \"two\"}]}", &result);
+  check(result.rc == RECORD_PARSER_RC_DUPLICATE_KEY && result.errorIndex == 0 && result.records == 0,
+        "a repeated field is rejected");
+  parse("{\"records\": [{\"record\": \"0123456789abcdefg\"}]}", &result);
+  check(result.rc == RECORD_PARSER_RC_TOO_LONG, "a field over the max length is too long");
+  parse("{\"records\": [{\"record\": \"one\"}", &result);
+  check(result.rc == RECORD_PARSER_RC_INCOMPLETE && result.records == 1,
+        "input ending after a record object is incomplete");
+  parse("{\"records\": [{\"record\": \"one\"", &result);
+  check(result.rc == RECORD_PARSER_RC_INCOMPLETE && result.records == 0,
+        "a record object that is not closed is not handed over");
+  withFields = false;
+}
+
+int main(int argc, char **argv) {
+  checkRecords();
+  checkSurrogates();
+  checkErrors();
+  checkDuplicateKeys();
+  checkFields();
+  printf("%s\n", failures ? "FAILED" : "OK");
+  return failures ? 8 : 0;
+}
+
+
+/*
+  This program and the accompanying materials are
+  made available under the terms of the Eclipse Public License v2.0 which accompanies
+  this distribution, and is available at https://www.eclipse.org/legal/epl-v20.html
+
+  SPDX-License-Identifier: EPL-2.0
+
+  Copyright Contributors to the Zowe Project.
+*/